@@ -0,0 +1,44 @@
+/*
+ * Benchmark.h
+ *
+ *  Created on: 16 Oct 2026
+ *
+ *  Timing helpers for the host benchmarks. The timings are printed for information only and are not checked, because they depend on the host.
+ *  They show the relative speed of alternative implementations; the absolute figures on the target processors are much lower.
+ */
+
+#ifndef TESTS_BENCHMARK_H_
+#define TESTS_BENCHMARK_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+namespace Benchmark
+{
+	// Call func(i) for i from 0 to count - 1 and return the average time per call in nanoseconds.
+	// The function should pass its results to KeepResult so that the compiler doesn't remove the work.
+	template<class F> double NanosecondsPerCall(size_t count, F func) noexcept
+	{
+		const auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < count; ++i)
+		{
+			func(i);
+		}
+		const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+		return elapsed.count()/(double)count;
+	}
+
+	template<class T> inline void KeepResult(const T& val) noexcept
+	{
+		asm volatile("" : : "g"(&val) : "memory");
+	}
+
+	// Print the time per call of an existing implementation and of its replacement
+	inline void Report(const char *what, const char *unit, double nsBefore, double nsAfter) noexcept
+	{
+		printf("  %s: before %.1f ns (%.2fM %s/sec), after %.1f ns (%.2fM %s/sec)\n", what, nsBefore, 1000.0/nsBefore, unit, nsAfter, 1000.0/nsAfter, unit);
+	}
+}
+
+#endif /* TESTS_BENCHMARK_H_ */
@@ -0,0 +1,320 @@
+/*
+ * BinaryGCodeTests.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *
+ *  Tests of the binary G-code block decoder. The encoder here does the same as Tools/bgcode/bgcconvert.py.
+ *  Decoded values must be exactly what the G-code parser gets from the decoded text, because the firmware uses them instead of parsing the text.
+ */
+
+#include "TestFramework.h"
+#include <GCodes/BinaryGCodeBlock.h>
+#include <Platform/FloatConversion.h>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace BinaryGCode;
+
+namespace
+{
+	constexpr const char *ParameterLetters = "XYZEF";
+	constexpr unsigned int ParameterDecimals[NumMoveParameters] = { 3, 3, 3, 5, 1 };
+
+	struct TestMove
+	{
+		unsigned int commandNumber;
+		uint8_t parametersPresent;
+		int64_t values[NumMoveParameters];
+	};
+
+	// Encoder, the same as bgcconvert.py
+	class Encoder
+	{
+	public:
+		Encoder() noexcept : data("RRFB\x01\x0c\x00\x00", HeaderSize) { ResetPrevious(); }
+
+		void AddText(const std::string& line) noexcept
+		{
+			if ((uint8_t)line[0] >= 0x80)
+			{
+				data += (char)EscapedTextTag;
+			}
+			data += line;
+			data += '\n';
+		}
+
+		void AddMove(const TestMove& move) noexcept
+		{
+			data += (char)(MoveTagValue | ((move.commandNumber == 1) ? G1TagBit : 0) | move.parametersPresent);
+			for (size_t i = 0; i < NumMoveParameters; ++i)
+			{
+				if (move.parametersPresent & (1u << i))
+				{
+					AddVarint(move.values[i] - previous[i]);
+					previous[i] = move.values[i];
+				}
+			}
+		}
+
+		const std::string& GetData() const noexcept { return data; }
+
+	private:
+		void ResetPrevious() noexcept
+		{
+			for (int64_t& v : previous)
+			{
+				v = 0;
+			}
+		}
+
+		void AddVarint(int64_t val) noexcept
+		{
+			uint64_t u = ((uint64_t)val << 1) ^ (uint64_t)(val >> 63);
+			while (u >= 0x80)
+			{
+				data += (char)((u & 0x7F) | 0x80);
+				u >>= 7;
+			}
+			data += (char)u;
+		}
+
+		std::string data;
+		int64_t previous[NumMoveParameters];
+	};
+
+	// The text that bgcconvert.py generates when decoding a scaled value
+	std::string FormatScaled(int64_t val, unsigned int decimals) noexcept
+	{
+		const uint64_t magnitude = (val < 0) ? -(uint64_t)val : (uint64_t)val;
+		std::string digits = std::to_string(magnitude);
+		if (digits.length() <= decimals)
+		{
+			digits.insert(0, decimals + 1 - digits.length(), '0');
+		}
+		std::string fraction = digits.substr(digits.length() - decimals);
+		while (!fraction.empty() && fraction.back() == '0')
+		{
+			fraction.pop_back();
+		}
+		return ((val < 0) ? "-" : "") + digits.substr(0, digits.length() - decimals) + ((fraction.empty()) ? "" : "." + fraction);
+	}
+
+	std::string ExpectedText(const TestMove& move) noexcept
+	{
+		std::string text = (move.commandNumber == 1) ? "G1" : "G0";
+		for (size_t i = 0; i < NumMoveParameters; ++i)
+		{
+			if (move.parametersPresent & (1u << i))
+			{
+				text += ' ';
+				text += ParameterLetters[i];
+				text += FormatScaled(move.values[i], ParameterDecimals[i]);
+			}
+		}
+		return text;
+	}
+
+	// Check a decoded move against the move that we encoded
+	void CheckMove(const BinaryGCodeMove& decoded, const TestMove& move) noexcept
+	{
+		const std::string expectedText = ExpectedText(move);
+		const char *const context = expectedText.c_str();
+		CHECK_MSG(std::string(decoded.text) == expectedText, context);
+		CHECK_MSG(decoded.textLength == expectedText.length(), context);
+		CHECK_MSG(decoded.commandNumber == move.commandNumber, context);
+		CHECK_MSG(decoded.parametersPresent == move.parametersPresent, context);
+		for (size_t i = 0; i < NumMoveParameters; ++i)
+		{
+			if (move.parametersPresent & (1u << i))
+			{
+				CHECK_MSG(decoded.text[decoded.letterOffsets[i]] == ParameterLetters[i], context);
+				CHECK_MSG(BinaryGCodeMove::GetParameterIndex(decoded.text[decoded.letterOffsets[i]]) == (int)i, context);
+
+				// The value must be the same as the parser reads from the text
+				const char *const valueText = decoded.text + decoded.letterOffsets[i] + 1;
+				float parsed;
+				const char *endptr;
+				const bool accepted = ReadDecimalFloat(valueText, parsed, endptr);
+				if (decoded.valuesConverted & (1u << i))
+				{
+					CHECK_MSG(accepted, context);
+					CHECK_MSG(memcmp(&parsed, &decoded.values[i], sizeof(float)) == 0, context);
+				}
+				else
+				{
+					CHECK_MSG(move.values[i] > (1 << 24) || move.values[i] < -(1 << 24), context);
+				}
+				if (accepted)
+				{
+					CHECK_MSG(endptr == decoded.text + decoded.valueEnds[i], context);
+				}
+			}
+		}
+	}
+}
+
+TEST(BinaryGCode_Header)
+{
+	static const char header[] = "RRFB\x01\x0c\x00\x00";
+	CHECK(IsHeader(header, HeaderSize));
+	CHECK(!IsHeader(header, HeaderSize - 1));
+	CHECK(!IsHeader("RRFB\x02\x0c\x00\x00", HeaderSize));
+	CHECK(!IsHeader("RRFB\x01\x0d\x00\x00", HeaderSize));
+	CHECK(!IsHeader("; G-code", HeaderSize));
+}
+
+// A block encoded by bgcconvert.py from "; hello\nG1 X10 Y-0.5 E1.23456\nG0 F3000\nG1 X10.001 Y-0.5\n"
+TEST(BinaryGCode_DecodeConverterOutput)
+{
+	static const uint8_t data[] =
+	{
+		0x52, 0x52, 0x46, 0x42, 0x01, 0x0c, 0x00, 0x00, 0x3b, 0x20, 0x68, 0x65, 0x6c, 0x6c, 0x6f, 0x0a,
+		0xcb, 0xa0, 0x9c, 0x01, 0xe7, 0x07, 0x80, 0x89, 0x0f, 0x90, 0xe0, 0xd4, 0x03, 0xc3, 0x02, 0x00
+	};
+	const char *const block = (const char *)data;
+	CHECK(IsHeader(block, sizeof(data)));
+
+	BinaryGCodeBlockDecoder decoder;
+	decoder.Init(block, sizeof(data), HeaderSize);
+	CHECK(decoder.DecodeRecord() == BinaryGCodeBlockDecoder::RecordType::text);
+	CHECK(decoder.GetTextOffset() == HeaderSize && decoder.GetTextLength() == 8);
+	CHECK(memcmp(block + decoder.GetTextOffset(), "; hello\n", 8) == 0);
+
+	CHECK(decoder.DecodeRecord() == BinaryGCodeBlockDecoder::RecordType::move);
+	CHECK(decoder.GetRecordOffset() == 16);
+	CHECK(strcmp(decoder.GetMove().text, "G1 X10 Y-0.5 E1.23456") == 0);
+	CHECK(decoder.GetMove().values[0] == 10.0f);
+	CHECK(decoder.GetMove().values[1] == -0.5f);
+	CHECK(decoder.GetMove().values[3] == 1.23456f);
+
+	CHECK(decoder.DecodeRecord() == BinaryGCodeBlockDecoder::RecordType::move);
+	CHECK(strcmp(decoder.GetMove().text, "G0 F3000") == 0);
+	CHECK(decoder.GetMove().values[4] == 3000.0f);
+
+	CHECK(decoder.DecodeRecord() == BinaryGCodeBlockDecoder::RecordType::move);
+	CHECK(strcmp(decoder.GetMove().text, "G1 X10.001 Y-0.5") == 0);
+	CHECK(decoder.GetNextRecordOffset() == sizeof(data));
+
+	CHECK(decoder.DecodeRecord() == BinaryGCodeBlockDecoder::RecordType::endOfBlock);
+}
+
+TEST(BinaryGCode_RoundTrip)
+{
+	std::mt19937_64 rng(1);
+	std::uniform_int_distribution<int64_t> smallValues(-300000, 300000);			// typical coordinates and feed rates
+	std::uniform_int_distribution<int64_t> largeValues(-(1ll << 40), 1ll << 40);	// large absolute extrusion values
+	std::uniform_int_distribution<unsigned int> choice(0, 99);
+
+	for (unsigned int blockNumber = 0; blockNumber < 200; ++blockNumber)
+	{
+		// Build a block of text lines and moves that fits in BlockSize
+		Encoder encoder;
+		std::vector<TestMove> moves;
+		std::vector<std::string> lines;
+		std::vector<bool> isMove;
+		while (encoder.GetData().length() < BlockSize - 200)
+		{
+			if (choice(rng) < 10)
+			{
+				std::string line = (choice(rng) < 50) ? "M106 S" + std::to_string(choice(rng)) : "\xC2\xB0 comment " + std::to_string(blockNumber);
+				encoder.AddText(line);
+				lines.push_back(line);
+				isMove.push_back(false);
+			}
+			else
+			{
+				TestMove move;
+				move.commandNumber = choice(rng) & 1;
+				move.parametersPresent = choice(rng) & ((1u << NumMoveParameters) - 1);
+				for (int64_t& v : move.values)
+				{
+					v = (choice(rng) < 90) ? smallValues(rng) : largeValues(rng);
+				}
+				encoder.AddMove(move);
+				moves.push_back(move);
+				isMove.push_back(true);
+			}
+		}
+
+		const std::string& data = encoder.GetData();
+		BinaryGCodeBlockDecoder decoder;
+		decoder.Init(data.data(), data.length(), HeaderSize);
+		size_t moveNumber = 0, lineNumber = 0;
+		for (bool wantMove : isMove)
+		{
+			const BinaryGCodeBlockDecoder::RecordType type = decoder.DecodeRecord();
+			if (wantMove)
+			{
+				CHECK(type == BinaryGCodeBlockDecoder::RecordType::move);
+				if (type == BinaryGCodeBlockDecoder::RecordType::move)
+				{
+					CheckMove(decoder.GetMove(), moves[moveNumber]);
+				}
+				++moveNumber;
+			}
+			else
+			{
+				CHECK(type == BinaryGCodeBlockDecoder::RecordType::text);
+				if (type == BinaryGCodeBlockDecoder::RecordType::text)
+				{
+					CHECK(std::string(data, decoder.GetTextOffset(), decoder.GetTextLength()) == lines[lineNumber] + "\n");
+				}
+				++lineNumber;
+			}
+		}
+		CHECK(decoder.GetNextRecordOffset() == data.length());
+		CHECK(decoder.DecodeRecord() == BinaryGCodeBlockDecoder::RecordType::endOfBlock);
+	}
+}
+
+TEST(BinaryGCode_ExtremeValues)
+{
+	static const int64_t values[] =
+	{
+		0, 1, -1, 9, 10, 99, 100, 1000, -1000, 12345, (1 << 24), -(1 << 24), (1 << 24) + 1, -(1 << 24) - 1,
+		INT64_MAX, INT64_MIN + 1, INT64_MIN
+	};
+
+	for (int64_t v : values)
+	{
+		// Put each value in a block of its own so that the differences from zero don't overflow
+		Encoder encoder;
+		const TestMove move = { 1, (1u << NumMoveParameters) - 1, { v, v, v, v, v } };
+		encoder.AddMove(move);
+		BinaryGCodeBlockDecoder decoder;
+		decoder.Init(encoder.GetData().data(), encoder.GetData().length(), HeaderSize);
+		CHECK(decoder.DecodeRecord() == BinaryGCodeBlockDecoder::RecordType::move);
+		CheckMove(decoder.GetMove(), move);
+		CHECK(decoder.GetMove().textLength <= BinaryGCodeMove::MaxTextLength);
+	}
+}
+
+TEST(BinaryGCode_BadRecords)
+{
+	BinaryGCodeBlockDecoder decoder;
+
+	static const char truncatedVarint[] = "\xC1\x80\x80";
+	decoder.Init(truncatedVarint, sizeof(truncatedVarint) - 1, 0);
+	CHECK(decoder.DecodeRecord() == BinaryGCodeBlockDecoder::RecordType::bad);
+
+	static const char badTag[] = "\xFF";
+	decoder.Init(badTag, sizeof(badTag) - 1, 0);
+	CHECK(decoder.DecodeRecord() == BinaryGCodeBlockDecoder::RecordType::bad);
+
+	static const char unterminatedText[] = "G28";
+	decoder.Init(unterminatedText, sizeof(unterminatedText) - 1, 0);
+	CHECK(decoder.DecodeRecord() == BinaryGCodeBlockDecoder::RecordType::bad);
+
+	static const char padding[] = "G28\n\0\0";
+	decoder.Init(padding, sizeof(padding) - 1, 0);
+	CHECK(decoder.DecodeRecord() == BinaryGCodeBlockDecoder::RecordType::text);
+	CHECK(decoder.DecodeRecord() == BinaryGCodeBlockDecoder::RecordType::endOfBlock);
+
+	CHECK(BinaryGCodeMove::GetParameterIndex('X') == 0);
+	CHECK(BinaryGCodeMove::GetParameterIndex('F') == 4);
+	CHECK(BinaryGCodeMove::GetParameterIndex('G') == -1);
+	CHECK(BinaryGCodeMove::GetParameterIndex(0) == -1);
+}
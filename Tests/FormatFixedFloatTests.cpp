@@ -0,0 +1,116 @@
+/*
+ * FormatFixedFloatTests.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *
+ *  Tests of FormatFixedFloat. The result must always be the same as printf format "%.Nf" gives.
+ */
+
+#include "TestFramework.h"
+#include <Platform/FloatConversion.h>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+
+namespace
+{
+	// Check that FormatFixedFloat gives the same result as snprintf. Return true if it did.
+	bool CheckAgainstPrintf(float val, unsigned int numDigitsAfterPoint) noexcept
+	{
+		char buf[FormattedFloatBufferSize];
+		const size_t len = FormatFixedFloat(buf, val, numDigitsAfterPoint);
+
+		char format[8], expected[FormattedFloatBufferSize];
+		snprintf(format, sizeof(format), "%%.%uf", numDigitsAfterPoint);
+		snprintf(expected, sizeof(expected), format, (double)val);
+		if (strcmp(buf, expected) == 0 && len == strlen(expected))
+		{
+			return true;
+		}
+
+		const std::string detail = std::string("got ") + buf + ", expected " + expected;
+		CHECK_MSG(false, detail.c_str());
+		return false;
+	}
+}
+
+TEST(FormatFixedFloat_TypicalValues)
+{
+	static const float values[] =
+	{
+		0.0f, -0.0f, 1.0f, -1.0f, 0.5f, 1.5f, 2.5f, -2.5f, 0.05f, 0.15f, 0.25f, 0.125f, 0.375f, 21.7f, 210.0f, 60.25f, 1.0e-7f, 4.9999995e-8f,
+		123456.789f, 16777216.0f, 1.0e12f, 4.0e11f, 3.0e12f, 1.0e20f, std::numeric_limits<float>::max(), std::numeric_limits<float>::min(),
+		std::numeric_limits<float>::denorm_min(), -std::numeric_limits<float>::max(),
+	};
+
+	for (float val : values)
+	{
+		for (unsigned int digits = 0; digits <= MaxFloatDigitsDisplayedAfterPoint; ++digits)
+		{
+			CheckAgainstPrintf(val, digits);
+		}
+	}
+}
+
+TEST(FormatFixedFloat_NansAndInfinities)
+{
+	for (unsigned int digits = 0; digits <= MaxFloatDigitsDisplayedAfterPoint; ++digits)
+	{
+		CheckAgainstPrintf(std::numeric_limits<float>::infinity(), digits);
+		CheckAgainstPrintf(-std::numeric_limits<float>::infinity(), digits);
+		CheckAgainstPrintf(std::numeric_limits<float>::quiet_NaN(), digits);
+	}
+}
+
+TEST(FormatFixedFloat_LimitsDigits)
+{
+	char buf[FormattedFloatBufferSize];
+	FormatFixedFloat(buf, 1.0f/3.0f, MaxFloatDigitsDisplayedAfterPoint + 5);
+	CHECK(strcmp(buf, "0.3333333") == 0);
+}
+
+// Exact ties must round to even, as printf does
+TEST(FormatFixedFloat_Ties)
+{
+	for (int i = -2000; i <= 2000; ++i)
+	{
+		const float val = (float)i + 0.5f;
+		CheckAgainstPrintf(val, 0);
+		CheckAgainstPrintf((float)i * 0.25f + 0.125f, 2);
+	}
+}
+
+TEST(FormatFixedFloat_RandomBitPatterns)
+{
+	std::mt19937 rng(1);
+	unsigned int failures = 0;
+	for (unsigned int i = 0; i < 200000 && failures < 10; ++i)
+	{
+		const uint32_t bits = rng();
+		float val;
+		memcpy(&val, &bits, sizeof(val));
+		if (!CheckAgainstPrintf(val, i % (MaxFloatDigitsDisplayedAfterPoint + 1)))
+		{
+			++failures;
+		}
+	}
+}
+
+TEST(FormatFixedFloat_TypicalRanges)
+{
+	// Every float between 0.001 and 1000 would take too long, so step through them
+	unsigned int failures = 0;
+	for (float val = 0.001f; val < 1000.0f && failures < 10; val = std::nextafter(val, 2000.0f) + val * 1.0e-5f)
+	{
+		for (unsigned int digits = 1; digits <= 3; ++digits)
+		{
+			if (!CheckAgainstPrintf(val, digits) || !CheckAgainstPrintf(-val, digits))
+			{
+				++failures;
+			}
+		}
+	}
+}
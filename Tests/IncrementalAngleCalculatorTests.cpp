@@ -0,0 +1,177 @@
+/*
+ * IncrementalAngleCalculatorTests.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *
+ *  Tests of the incremental angle calculation used by polar and SCARA kinematics when segmenting moves, and benchmarks of the angle
+ *  calculations of those kinematics before and after it was introduced. The benchmarks convert the positions of the segments of straight moves.
+ */
+
+#include "TestFramework.h"
+#include "Benchmark.h"
+#include <Movement/Kinematics/IncrementalAngleCalculator.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace
+{
+	constexpr float Pi = 3.141592653589793;
+	constexpr float MaxAngleError = 2e-6;					// radians, about 0.0001 degrees
+
+	struct Point
+	{
+		float x, y;
+	};
+
+	// Return the positions of the segments of straight moves between the corners, with segments of about the specified length
+	std::vector<Point> SegmentedPath(const std::vector<Point>& corners, float segmentLength) noexcept
+	{
+		std::vector<Point> points;
+		for (size_t i = 1; i < corners.size(); ++i)
+		{
+			const float dx = corners[i].x - corners[i - 1].x, dy = corners[i].y - corners[i - 1].y;
+			const unsigned int numSegments = std::max<unsigned int>(1, (unsigned int)lrintf(sqrtf(dx * dx + dy * dy)/segmentLength));
+			for (unsigned int j = 1; j <= numSegments; ++j)
+			{
+				const float fraction = (float)j/(float)numSegments;
+				points.push_back(Point{corners[i - 1].x + fraction * dx, corners[i - 1].y + fraction * dy});
+			}
+		}
+		return points;
+	}
+
+	// Square and star shaped paths around a polar bed centre, including moves that cross the -X axis where atan2 wraps round
+	std::vector<Point> PolarPath() noexcept
+	{
+		return SegmentedPath({ {100, 100}, {-100, 100}, {-100, -100}, {100, -100}, {100, 100}, {-80, 5}, {120, -3}, {-60, -1}, {-60, 1}, {0.5, 0.5} }, 0.25);
+	}
+
+	// Paths within reach of a SCARA arm with proximal and distal arms of 150mm and 100mm
+	constexpr float ProximalArmLength = 150.0, DistalArmLength = 100.0;
+
+	std::vector<Point> ScaraPath() noexcept
+	{
+		return SegmentedPath({ {200, 0}, {150, 100}, {-50, 180}, {-200, 20}, {-200, -20}, {60, -120}, {200, 0} }, 0.25);
+	}
+
+	// The SCARA angle calculation, as in ScaraKinematics::CalculateThetaAndPsi for arm mode 0
+	bool ScaraCosSinPsi(Point p, float& cosPsi, float& sinPsi) noexcept
+	{
+		cosPsi = (p.x * p.x + p.y * p.y - ProximalArmLength * ProximalArmLength - DistalArmLength * DistalArmLength)/(2.0f * ProximalArmLength * DistalArmLength);
+		const float square = 1.0f - cosPsi * cosPsi;
+		if (square < 0.01f)
+		{
+			return false;
+		}
+		sinPsi = sqrtf(square);
+		return true;
+	}
+
+	// Return the difference between two angles. Angles of +Pi and -Pi are the same direction, and near there the calculator and atan2f may round differently.
+	float AngleError(float angle, float expected) noexcept
+	{
+		const float error = fabsf(angle - expected);
+		return std::min(error, fabsf(error - 2.0f * Pi));
+	}
+
+	// Check the calculator against atan2f along a path
+	void CheckPath(const std::vector<Point>& points, const char *name) noexcept
+	{
+		IncrementalAngleCalculator calculator;
+		float maxError = 0.0;
+		for (const Point& p : points)
+		{
+			const float expected = atan2f(p.y, p.x);
+			const float angle = calculator.Atan2(p.y, p.x);
+			CHECK_MSG(angle > -Pi && angle <= Pi, name);
+			maxError = std::max(maxError, AngleError(angle, expected));
+		}
+		CHECK_MSG(maxError <= MaxAngleError, (std::string(name) + " error " + std::to_string(maxError)).c_str());
+	}
+}
+
+TEST(IncrementalAngleCalculator_SegmentedPaths)
+{
+	CheckPath(PolarPath(), "polar");
+	CheckPath(SegmentedPath({ {100, 0}, {100, 100} }, 0.01), "short segments");
+	CheckPath(SegmentedPath({ {-100, -30}, {-100, 30}, {-100, -30} }, 2.0), "across the -X axis");
+}
+
+TEST(IncrementalAngleCalculator_ScaraAngles)
+{
+	IncrementalAngleCalculator psiCalculator, thetaCalculator;
+	float maxError = 0.0;
+	for (const Point& p : ScaraPath())
+	{
+		float cosPsi, sinPsi;
+		CHECK(ScaraCosSinPsi(p, cosPsi, sinPsi));
+		const float k1 = ProximalArmLength + DistalArmLength * cosPsi, k2 = DistalArmLength * sinPsi;
+		maxError = std::max(maxError, fabsf(psiCalculator.Atan2(sinPsi, cosPsi) - acosf(cosPsi)));
+		maxError = std::max(maxError, fabsf(thetaCalculator.Atan2(k1 * p.y - k2 * p.x, k1 * p.x + k2 * p.y) - atan2f(k1 * p.y - k2 * p.x, k1 * p.x + k2 * p.y)));
+	}
+	CHECK_MSG(maxError <= MaxAngleError, std::to_string(maxError).c_str());
+}
+
+TEST(IncrementalAngleCalculator_Jumps)
+{
+	// Vectors that are far apart or point in opposite directions must use the full calculation
+	IncrementalAngleCalculator calculator;
+	const Point points[] = { {1, 0}, {0, 1}, {-1, 0}, {1, 1e-3}, {-1, 1e-3}, {-1, -1e-3}, {0, -1}, {1e-3, -1}, {-1e-3, -1}, {1, 0} };
+	for (unsigned int repeat = 0; repeat < 3; ++repeat)
+	{
+		for (const Point& p : points)
+		{
+			CHECK(AngleError(calculator.Atan2(p.y, p.x), atan2f(p.y, p.x)) <= MaxAngleError);
+		}
+	}
+}
+
+TEST(IncrementalAngleCalculator_PolarBenchmark)
+{
+	const std::vector<Point> points = PolarPath();
+	const double before = Benchmark::NanosecondsPerCall(200 * points.size(), [&points](size_t i)
+		{
+			const Point& p = points[i % points.size()];
+			Benchmark::KeepResult(atan2f(p.y, p.x));
+		});
+	IncrementalAngleCalculator calculator;
+	const double after = Benchmark::NanosecondsPerCall(200 * points.size(), [&points, &calculator](size_t i)
+		{
+			const Point& p = points[i % points.size()];
+			Benchmark::KeepResult(calculator.Atan2(p.y, p.x));
+		});
+	Benchmark::Report("polar turntable angle", "conversions", before, after);
+}
+
+TEST(IncrementalAngleCalculator_ScaraBenchmark)
+{
+	const std::vector<Point> points = ScaraPath();
+	const double before = Benchmark::NanosecondsPerCall(200 * points.size(), [&points](size_t i)
+		{
+			const Point& p = points[i % points.size()];
+			float cosPsi, sinPsi;
+			if (ScaraCosSinPsi(p, cosPsi, sinPsi))
+			{
+				const float k1 = ProximalArmLength + DistalArmLength * cosPsi, k2 = DistalArmLength * sinPsi;
+				Benchmark::KeepResult(acosf(cosPsi));
+				Benchmark::KeepResult(atan2f(k1 * p.y - k2 * p.x, k1 * p.x + k2 * p.y));
+			}
+		});
+	IncrementalAngleCalculator psiCalculator, thetaCalculator;
+	const double after = Benchmark::NanosecondsPerCall(200 * points.size(), [&points, &psiCalculator, &thetaCalculator](size_t i)
+		{
+			const Point& p = points[i % points.size()];
+			float cosPsi, sinPsi;
+			if (ScaraCosSinPsi(p, cosPsi, sinPsi))
+			{
+				const float k1 = ProximalArmLength + DistalArmLength * cosPsi, k2 = DistalArmLength * sinPsi;
+				Benchmark::KeepResult(psiCalculator.Atan2(sinPsi, cosPsi));
+				Benchmark::KeepResult(thetaCalculator.Atan2(k1 * p.y - k2 * p.x, k1 * p.x + k2 * p.y));
+			}
+		});
+	Benchmark::Report("SCARA theta and psi", "conversions", before, after);
+}
+
+// End
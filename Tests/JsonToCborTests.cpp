@@ -0,0 +1,328 @@
+/*
+ * JsonToCborTests.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *
+ *  Tests of the JSON to CBOR conversion used for object model responses. The decoder here turns the CBOR back into compact JSON,
+ *  so each test converts some JSON and checks that decoding the result gives the same values.
+ */
+
+#include "TestFramework.h"
+#include <ObjectModel/JsonToCborConverter.h>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+	// A buffer in a chain of JSON buffers, like OutputBuffer
+	struct TestBuffer
+	{
+		std::string data;
+		const TestBuffer *next;
+
+		const char *Data() const noexcept { return data.c_str(); }
+		size_t DataLength() const noexcept { return data.size(); }
+		const TestBuffer *Next() const noexcept { return next; }
+	};
+
+	struct TestOutput
+	{
+		std::string data;
+
+		void cat(char c) noexcept { data += c; }
+		void cat(const char *s, size_t len) noexcept { data.append(s, len); }
+	};
+
+	// Convert JSON split into buffers of the specified size, returning false if the converter reported an error
+	bool Convert(const std::string& json, size_t bufferSize, std::string& cbor) noexcept
+	{
+		std::vector<TestBuffer> buffers((json.size() + bufferSize - 1)/bufferSize);
+		for (size_t i = 0; i < buffers.size(); ++i)
+		{
+			buffers[i].data = json.substr(i * bufferSize, bufferSize);
+			buffers[i].next = (i + 1 < buffers.size()) ? &buffers[i + 1] : nullptr;
+		}
+
+		TestOutput out;
+		JsonToCborConverter<TestBuffer, TestOutput> converter((buffers.empty()) ? nullptr : &buffers[0], out);
+		while (!converter.IsFinished())
+		{
+			if (!converter.ConvertNext())
+			{
+				return false;
+			}
+		}
+		cbor = out.data;
+		return true;
+	}
+
+	// Decoder for the subset of CBOR that the converter generates, producing compact JSON. Floats are written with enough digits to identify them exactly.
+	class Decoder
+	{
+	public:
+		explicit Decoder(const std::string& p_cbor) noexcept : cbor(p_cbor), pos(0) { }
+
+		bool Decode(std::string& json) noexcept { return DecodeItem(json) && pos == cbor.size(); }
+
+	private:
+		bool GetByte(uint8_t& b) noexcept
+		{
+			if (pos >= cbor.size())
+			{
+				return false;
+			}
+			b = (uint8_t)cbor[pos++];
+			return true;
+		}
+
+		bool GetArgument(uint8_t info, uint64_t& val) noexcept
+		{
+			if (info < 24)
+			{
+				val = info;
+				return true;
+			}
+			if (info > 27)
+			{
+				return false;
+			}
+			val = 0;
+			for (unsigned int i = 0; i < (1u << (info - 24)); ++i)
+			{
+				uint8_t b;
+				if (!GetByte(b))
+				{
+					return false;
+				}
+				val = (val << 8) | b;
+			}
+			return true;
+		}
+
+		static void AppendFloat(std::string& json, double d) noexcept
+		{
+			char buf[40];
+			snprintf(buf, sizeof(buf), "%.9g", d);
+			json += buf;
+		}
+
+		bool DecodeItem(std::string& json) noexcept
+		{
+			uint8_t initial;
+			if (!GetByte(initial))
+			{
+				return false;
+			}
+
+			switch (initial)
+			{
+			case Cbor::IndefiniteArray:
+			case Cbor::IndefiniteMap:
+				{
+					const bool isMap = (initial == Cbor::IndefiniteMap);
+					json += (isMap) ? '{' : '[';
+					for (unsigned int n = 0; ; ++n)
+					{
+						if (pos < cbor.size() && (uint8_t)cbor[pos] == Cbor::Break)
+						{
+							++pos;
+							break;
+						}
+						if (n != 0)
+						{
+							json += ',';
+						}
+						if (!DecodeItem(json))
+						{
+							return false;
+						}
+						if (isMap)
+						{
+							json += ':';
+							if (!DecodeItem(json))
+							{
+								return false;
+							}
+						}
+					}
+					json += (isMap) ? '}' : ']';
+					return true;
+				}
+
+			case Cbor::False:
+				json += "false";
+				return true;
+
+			case Cbor::True:
+				json += "true";
+				return true;
+
+			case Cbor::Null:
+				json += "null";
+				return true;
+
+			case Cbor::HalfFloat:
+				{
+					uint64_t half;
+					if (!GetArgument(25, half))
+					{
+						return false;
+					}
+					const int exponent = (int)((half >> 10) & 0x1F);
+					const double mantissa = (double)(half & 0x3FF);
+					const double magnitude = (exponent == 0) ? ldexp(mantissa, -24)
+											: (exponent == 31) ? ((mantissa == 0) ? INFINITY : NAN)
+												: ldexp(mantissa + 1024, exponent - 25);
+					AppendFloat(json, (half & 0x8000) ? -magnitude : magnitude);
+					return true;
+				}
+
+			case Cbor::SingleFloat:
+				{
+					uint64_t bits;
+					if (!GetArgument(26, bits))
+					{
+						return false;
+					}
+					const uint32_t bits32 = (uint32_t)bits;
+					float f;
+					memcpy(&f, &bits32, sizeof(f));
+					AppendFloat(json, f);
+					return true;
+				}
+
+			default:
+				break;
+			}
+
+			uint64_t val;
+			if (!GetArgument(initial & 0x1F, val))
+			{
+				return false;
+			}
+			switch (initial >> 5)
+			{
+			case Cbor::UnsignedInteger:
+				json += std::to_string(val);
+				return true;
+
+			case Cbor::NegativeInteger:
+				json += '-';
+				json += std::to_string(val + 1);
+				return true;
+
+			case Cbor::TextString:
+				if (val > cbor.size() - pos)
+				{
+					return false;
+				}
+				json += '"';
+				for (size_t i = 0; i < val; ++i)
+				{
+					const char c = cbor[pos + i];
+					if (c == '"' || c == '\\')
+					{
+						json += '\\';
+					}
+					json += c;
+				}
+				json += '"';
+				pos += val;
+				return true;
+
+			default:
+				return false;
+			}
+		}
+
+		const std::string& cbor;
+		size_t pos;
+	};
+
+	// Convert the JSON with several buffer sizes and check that the CBOR is always the same and decodes to the expected JSON
+	void CheckRoundTrip(const std::string& json, const std::string& expected) noexcept
+	{
+		std::string firstCbor;
+		for (size_t bufferSize : { json.size() + 1, (size_t)7, (size_t)3, (size_t)1 })
+		{
+			std::string cbor;
+			CHECK_MSG(Convert(json, bufferSize, cbor), json.c_str());
+			if (firstCbor.empty())
+			{
+				firstCbor = cbor;
+			}
+			else
+			{
+				CHECK_MSG(cbor == firstCbor, json.c_str());
+			}
+		}
+
+		std::string decoded;
+		CHECK_MSG(Decoder(firstCbor).Decode(decoded), json.c_str());
+		CHECK_MSG(decoded == expected, decoded.c_str());
+	}
+
+	std::string Bytes(std::initializer_list<uint8_t> bytes) noexcept
+	{
+		return std::string(bytes.begin(), bytes.end());
+	}
+}
+
+TEST(JsonToCbor_RoundTripObjectModel)
+{
+	const std::string json =
+		"{\"key\":\"heat\",\"flags\":\"d99fb\",\"result\":{\"bedHeaters\":[0,-1,-1],\"heaters\":[{\"active\":60,\"avgPwm\":0.125,"
+		"\"current\":21.7,\"model\":{\"enabled\":true,\"inverted\":false},\"sensor\":0,\"state\":\"off\"}],\"coldExtrudeTemperature\":160.0,"
+		"\"name\":null,\"big\":4294967296,\"neg\":-25,\"small\":-1.5e-3}}";
+	const std::string expected =
+		"{\"key\":\"heat\",\"flags\":\"d99fb\",\"result\":{\"bedHeaters\":[0,-1,-1],\"heaters\":[{\"active\":60,\"avgPwm\":0.125,"
+		"\"current\":21.7000008,\"model\":{\"enabled\":true,\"inverted\":false},\"sensor\":0,\"state\":\"off\"}],\"coldExtrudeTemperature\":160,"
+		"\"name\":null,\"big\":4294967296,\"neg\":-25,\"small\":-0.00150000001}}";
+	CheckRoundTrip(json, expected);
+}
+
+TEST(JsonToCbor_RoundTripStrings)
+{
+	CheckRoundTrip("[\"\",\"plain\",\"quote \\\" backslash \\\\ slash \\/\"]", "[\"\",\"plain\",\"quote \\\" backslash \\\\ slash /\"]");
+	CheckRoundTrip("[\"a\\nb\\tc\\rd\"]", "[\"a\nb\tc\rd\"]");
+	CheckRoundTrip("[\"\\u0041\\u00e9\\u20AC\"]", "[\"A\xC3\xA9\xE2\x82\xAC\"]");
+	CheckRoundTrip(" { \"a\" : [ 1 , 2 ] ,\n\"b\" : { } }\n", "{\"a\":[1,2],\"b\":{}}");
+}
+
+TEST(JsonToCbor_Encoding)
+{
+	std::string cbor;
+
+	// Integer heads use the shortest encoding
+	CHECK(Convert("[0,23,24,255,256,65535,65536,-1,-24,-25,-0]", 100, cbor));
+	CHECK(cbor == Bytes({ 0x9F, 0x00, 0x17, 0x18, 0x18, 0x18, 0xFF, 0x19, 0x01, 0x00, 0x19, 0xFF, 0xFF, 0x1A, 0x00, 0x01, 0x00, 0x00,
+							0x20, 0x37, 0x38, 0x18, 0x00, 0xFF }));
+
+	// Floats use half precision when that is exact
+	CHECK(Convert("[0.0,-0.0,0.5,25.0,65504.0,0.1,1e10]", 100, cbor));
+	CHECK(cbor == Bytes({ 0x9F, 0xF9, 0x00, 0x00, 0xF9, 0x80, 0x00, 0xF9, 0x38, 0x00, 0xF9, 0x4E, 0x40, 0xF9, 0x7B, 0xFF,
+							0xFA, 0x3D, 0xCC, 0xCC, 0xCD, 0xFA, 0x50, 0x15, 0x02, 0xF9, 0xFF }));
+
+	// Keys are definite-length text strings and literals are simple values
+	CHECK(Convert("{\"ab\":true,\"c\":null}", 100, cbor));
+	CHECK(cbor == Bytes({ 0xBF, 0x62, 'a', 'b', 0xF5, 0x61, 'c', 0xF6, 0xFF }));
+}
+
+TEST(JsonToCbor_Malformed)
+{
+	std::string cbor;
+	CHECK(!Convert("[\"unterminated]", 100, cbor));
+	CHECK(!Convert("[\"bad escape \\x\"]", 100, cbor));
+	CHECK(!Convert("[\"short \\u12\"]", 100, cbor));
+	CHECK(!Convert("[tru]", 100, cbor));
+	CHECK(!Convert("[nul", 100, cbor));
+	CHECK(!Convert("[-]", 100, cbor));
+	CHECK(!Convert("[1.2.3]", 100, cbor));
+	CHECK(!Convert("[@]", 100, cbor));
+}
+
+// End
@@ -0,0 +1,204 @@
+/*
+ * ModelChangeTrackerTests.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *
+ *  Tests that a client that merges object model reports requested with the 'u' flag ends up with the same model as a full report.
+ *  The model here has a few sections, each with live values that change without notification and other values whose changes are notified as
+ *  the XxxUpdated functions of class RepRap do. A report includes a section in full if the tracker says that it has changed since the client's token,
+ *  otherwise only its live values, as ObjectModel::ReportAsJson does. The client merges each report into its copy of the model in the same way that
+ *  DWC merges 'f' reports, by replacing the values that the report contains.
+ */
+
+#include "TestFramework.h"
+#include <ObjectModel/ModelChangeTracker.h>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+
+namespace
+{
+	constexpr size_t NumSections = 4;
+	constexpr size_t ValuesPerSection = 6;
+
+	typedef ModelChangeTracker<NumSections> Tracker;
+	typedef std::map<size_t, std::map<size_t, int>> Report;			// the values reported for each section, by value number
+
+	// Even numbered values in each section are live, the others change only with notification
+	bool IsLive(size_t valueNumber) noexcept { return valueNumber % 2 == 0; }
+
+	class Machine
+	{
+	public:
+		Machine() noexcept
+		{
+			for (size_t s = 0; s < NumSections; ++s)
+			{
+				for (size_t v = 0; v < ValuesPerSection; ++v)
+				{
+					values[s][v] = 0;
+				}
+			}
+		}
+
+		// Change a value, notifying the change if it isn't live
+		void Change(size_t section, size_t valueNumber, int newValue) noexcept
+		{
+			values[section][valueNumber] = newValue;
+			if (!IsLive(valueNumber))
+			{
+				tracker.SectionChanged(section);
+			}
+		}
+
+		// Generate a report with the 'u' flag and the specified token, returning the token for the next report.
+		// The function is called before each section is reported, so that the caller can change the model while the report is being generated.
+		uint32_t ReportChanges(uint32_t token, Report& report, const std::function<void()>& betweenSections) noexcept
+		{
+			const uint32_t nextToken = tracker.GetToken();
+			report.clear();
+			for (size_t s = 0; s < NumSections; ++s)
+			{
+				betweenSections();
+				const bool inFull = tracker.ChangedSinceToken(tracker.GetSectionSeq(s), token);
+				for (size_t v = 0; v < ValuesPerSection; ++v)
+				{
+					if (inFull || IsLive(v))
+					{
+						report[s][v] = values[s][v];
+					}
+				}
+			}
+			return nextToken;
+		}
+
+		Report FullReport() const noexcept
+		{
+			Report report;
+			for (size_t s = 0; s < NumSections; ++s)
+			{
+				for (size_t v = 0; v < ValuesPerSection; ++v)
+				{
+					report[s][v] = values[s][v];
+				}
+			}
+			return report;
+		}
+
+	private:
+		Tracker tracker;
+		int values[NumSections][ValuesPerSection];
+	};
+
+	class Client
+	{
+	public:
+		// Request a report of the changes since the last one and merge it into our model
+		void Update(Machine& machine, const std::function<void()>& betweenSections = []() { }) noexcept
+		{
+			Report report;
+			token = machine.ReportChanges(token, report, betweenSections);
+			for (const auto& section : report)
+			{
+				for (const auto& value : section.second)
+				{
+					model[section.first][value.first] = value.second;
+				}
+			}
+		}
+
+		const Report& GetModel() const noexcept { return model; }
+		uint32_t GetToken() const noexcept { return token; }
+
+	private:
+		uint32_t token = 0;
+		Report model;
+	};
+
+	void RandomChanges(Machine& machine, std::mt19937& rng, unsigned int numChanges) noexcept
+	{
+		for (unsigned int i = 0; i < numChanges; ++i)
+		{
+			machine.Change(rng() % NumSections, rng() % ValuesPerSection, (int)(rng() % 1000));
+		}
+	}
+}
+
+TEST(ModelChangeTracker_FirstReportIsFull)
+{
+	Machine machine;
+	std::mt19937 rng(1);
+	RandomChanges(machine, rng, 3);
+	Client client;
+	client.Update(machine);
+	CHECK(client.GetModel() == machine.FullReport());
+}
+
+TEST(ModelChangeTracker_MergedReportsMatchFullReport)
+{
+	Machine machine;
+	Client client;
+	std::mt19937 rng(2);
+	for (unsigned int round = 0; round < 2000; ++round)
+	{
+		RandomChanges(machine, rng, rng() % 4);
+
+		// Sometimes change the model while the report is being generated, in which case the client may not be up to date until the next report
+		bool changedDuringReport = false;
+		client.Update(machine, [&machine, &rng, &changedDuringReport]()
+			{
+				if (rng() % 8 == 0)
+				{
+					RandomChanges(machine, rng, 1);
+					changedDuringReport = true;
+				}
+			});
+		if (!changedDuringReport)
+		{
+			CHECK(client.GetModel() == machine.FullReport());
+		}
+	}
+	client.Update(machine);
+	CHECK(client.GetModel() == machine.FullReport());
+}
+
+TEST(ModelChangeTracker_TokenFromBeforeRestart)
+{
+	// A client that was connected before the machine restarted may have a token that is ahead of the new change counter
+	std::mt19937 rng(3);
+	Client client;
+	{
+		Machine before;
+		for (unsigned int i = 0; i < 50; ++i)
+		{
+			RandomChanges(before, rng, 2);
+			client.Update(before);
+		}
+	}
+
+	Machine after;
+	RandomChanges(after, rng, 5);
+	client.Update(after);
+	CHECK(client.GetModel() == after.FullReport());
+}
+
+TEST(ModelChangeTracker_Tokens)
+{
+	Tracker tracker;
+	CHECK(tracker.GetToken() == Tracker::InitialSeq);
+	CHECK(tracker.ChangedSinceToken(tracker.GetSectionSeq(0), 0));				// token 0 means everything
+	CHECK(!tracker.ChangedSinceToken(tracker.GetSectionSeq(0), tracker.GetToken()));
+
+	const uint32_t token = tracker.GetToken();
+	tracker.SectionChanged(1);
+	CHECK(!tracker.ChangedSinceToken(tracker.GetSectionSeq(0), token));
+	CHECK(tracker.ChangedSinceToken(tracker.GetSectionSeq(1), token));
+	CHECK(!tracker.ChangedSinceToken(tracker.GetSectionSeq(1), tracker.GetToken()));
+
+	// Tokens that haven't been issued yet are treated as 0
+	CHECK(tracker.ChangedSinceToken(tracker.GetSectionSeq(0), tracker.GetToken() + 1));
+	CHECK(tracker.ChangedSinceToken(tracker.GetSectionSeq(0), 0xFFFFFFFF));
+}
+
+// End
@@ -0,0 +1,329 @@
+/*
+ * ObjectModelTableSearchTests.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *
+ *  Tests of finding object model table entries. The hash index must find the same entry as the binary search for every ID.
+ *  The tables are the names from the largest object model tables in the firmware, so building their hash indices here at compile time
+ *  with the compiler's default constexpr limits shows that the firmware build will succeed.
+ *  The benchmark at the end compares the time taken by the two methods to resolve the elements of some typical object model paths.
+ */
+
+#include "TestFramework.h"
+#include "Benchmark.h"
+#include <ObjectModel/ObjectModelTableSearch.h>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace ObjectModelTableSearch;
+
+namespace
+{
+	struct TestEntry
+	{
+		const char *name;
+	};
+
+	template<class T, size_t N> constexpr size_t ArraySize(const T (&)[N]) noexcept { return N; }
+
+	// The names in the RepRap table with every optional entry included
+	constexpr TestEntry repRapTable[] =
+	{
+		{ "boards" }, { "directories" }, { "fans" }, { "global" }, { "heat" }, { "inputs" }, { "job" }, { "limits" }, { "move" }, { "network" },
+		{ "scanner" }, { "sensors" }, { "seqs" }, { "spindles" }, { "state" }, { "tools" }, { "volumes" },
+		{ "filaments" }, { "firmware" }, { "gCodes" }, { "macros" }, { "menu" }, { "scans" }, { "system" }, { "web" },
+		{ "axes" }, { "axesPlusExtruders" }, { "bedHeaters" }, { "boards" }, { "chamberHeaters" }, { "drivers" }, { "driversPerAxis" }, { "extruders" },
+		{ "extrudersPerTool" }, { "fans" }, { "gpInPorts" }, { "gpOutPorts" }, { "heaters" }, { "heatersPerTool" }, { "monitorsPerHeater" },
+		{ "restorePoints" }, { "sensors" }, { "spindles" }, { "tools" }, { "trackedObjects" }, { "triggers" }, { "volumes" }, { "workplaces" },
+		{ "zProbeProgramBytes" }, { "zProbes" },
+		{ "atxPower" }, { "atxPowerPort" }, { "beep" }, { "currentTool" }, { "deferredPowerDown" }, { "displayMessage" }, { "gpOut" }, { "laserPwm" },
+		{ "logFile" }, { "logLevel" }, { "machineMode" }, { "macroCache" }, { "macroRestarted" }, { "messageBox" }, { "msUpTime" }, { "nextTool" },
+		{ "powerFailScript" }, { "previousTool" }, { "restorePoints" }, { "status" }, { "thisInput" }, { "time" }, { "upTime" },
+		{ "duration" }, { "frequency" },
+		{ "axisControls" }, { "message" }, { "mode" }, { "seq" }, { "timeout" }, { "title" },
+		{ "boards" }, { "directories" }, { "fans" }, { "global" }, { "heat" }, { "inputs" }, { "job" }, { "move" }, { "network" }, { "reply" },
+		{ "scanner" }, { "sensors" }, { "spindles" }, { "state" }, { "tools" }, { "volChanges" }, { "volumes" },
+		{ "files" }, { "hits" }, { "misses" }, { "size" }, { "used" },
+	};
+	constexpr uint8_t repRapDescriptor[] = { 8, 17, 8, 25, 23, 2, 6, 17, 5 };
+
+	// The names in the Platform table with every optional entry included
+	constexpr TestEntry platformTable[] =
+	{
+		{ "accelerometer" }, { "canAddress" }, { "directDisplay" }, { "firmwareDate" }, { "firmwareFileName" }, { "firmwareName" }, { "firmwareVersion" },
+		{ "iapFileNameSBC" }, { "iapFileNameSD" }, { "maxHeaters" }, { "maxMotors" }, { "mcuTemp" }, { "name" }, { "shortName" },
+		{ "supportsDirectDisplay" }, { "uniqueId" }, { "v12" }, { "vIn" },
+		{ "current" }, { "max" }, { "min" },
+		{ "current" }, { "max" }, { "min" },
+		{ "acceleration" }, { "babystep" }, { "current" }, { "drivers" }, { "homed" }, { "jerk" }, { "letter" }, { "machinePosition" }, { "max" },
+		{ "maxProbed" }, { "microstepping" }, { "min" }, { "minProbed" }, { "percentCurrent" }, { "percentStstCurrent" }, { "speed" }, { "stepsPerMm" },
+		{ "userPosition" }, { "visible" }, { "workplaceOffsets" },
+		{ "acceleration" }, { "current" }, { "driver" }, { "factor" }, { "filament" }, { "jerk" }, { "microstepping" }, { "nonlinear" },
+		{ "percentCurrent" }, { "percentStstCurrent" }, { "position" }, { "pressureAdvance" }, { "rawPosition" }, { "speed" }, { "stepsPerMm" },
+		{ "a" }, { "b" }, { "upperLimit" },
+		{ "current" }, { "max" }, { "min" },
+		{ "interpolated" }, { "value" },
+		{ "interpolated" }, { "value" },
+		{ "points" }, { "runs" },
+	};
+	constexpr uint8_t platformDescriptor[] = { 10, 18, 3, 3, 20, 15, 3, 3, 2, 2, 2 };
+
+	// The names in the Move table with every optional entry included
+	constexpr TestEntry moveTable[] =
+	{
+		{ "axes" }, { "calibration" }, { "compensation" }, { "currentMove" }, { "diagnostics" }, { "extruders" }, { "idle" }, { "kinematics" },
+		{ "limitAxes" }, { "noMovesBeforeHoming" }, { "printingAcceleration" }, { "queue" }, { "rotation" }, { "shaping" }, { "speedFactor" },
+		{ "travelAcceleration" }, { "virtualEPos" }, { "workplaceNumber" }, { "workspaceNumber" },
+		{ "factor" }, { "timeout" },
+		{ "acceleration" }, { "deceleration" }, { "laserPwm" }, { "requestedSpeed" }, { "topSpeed" },
+		{ "final" }, { "initial" }, { "numFactors" },
+		{ "deviation" }, { "mean" },
+		{ "deviation" }, { "mean" },
+		{ "fadeHeight" }, { "file" }, { "liveGrid" }, { "meshDeviation" }, { "probeGrid" }, { "skew" }, { "type" },
+		{ "deviation" }, { "mean" },
+		{ "compensateXY" }, { "tanXY" }, { "tanXZ" }, { "tanYZ" },
+		{ "angle" }, { "centre" }, { "isrDurationMax" }, { "isrDurationP50" }, { "isrDurationP99" }, { "isrLatenessMax" }, { "isrLatenessP99" },
+		{ "isrStepsMax" }, { "isrStepsP99" }, { "numIsrs" },
+	};
+	constexpr uint8_t moveDescriptor[] = { 10, 19, 2, 5, 3, 2, 2, 7, 2, 4, 10 };
+
+	// A section where one name is a prefix of another, so that the character after the shorter name in an ID decides the search direction
+	constexpr TestEntry prefixTable[] = { { "file" }, { "fileName" }, { "files" }, { "filesAndDirs" }, { "first" } };
+	constexpr uint8_t prefixDescriptor[] = { 1, 5 };
+
+	constexpr ObjectModelTableHashIndex<HashIndexSize(repRapDescriptor)> repRapIndex(repRapDescriptor, repRapTable, ArraySize(repRapTable));
+	constexpr ObjectModelTableHashIndex<HashIndexSize(platformDescriptor)> platformIndex(platformDescriptor, platformTable, ArraySize(platformTable));
+	constexpr ObjectModelTableHashIndex<HashIndexSize(moveDescriptor)> moveIndex(moveDescriptor, moveTable, ArraySize(moveTable));
+	constexpr ObjectModelTableHashIndex<HashIndexSize(prefixDescriptor)> prefixIndex(prefixDescriptor, prefixTable, ArraySize(prefixTable));
+
+	static_assert(repRapIndex.ok && platformIndex.ok && moveIndex.ok && prefixIndex.ok, "Failed to build hash index");
+
+	struct TestTable
+	{
+		const TestEntry *entries;
+		const uint8_t *descriptor;
+		const uint8_t *hashIndex;
+	};
+
+	const TestTable tables[] =
+	{
+		{ repRapTable, repRapDescriptor, repRapIndex.data },
+		{ platformTable, platformDescriptor, platformIndex.data },
+		{ moveTable, moveDescriptor, moveIndex.data },
+		{ prefixTable, prefixDescriptor, prefixIndex.data },
+	};
+
+	// Check that both search methods find the same entry in a section, and that it is the expected one
+	void CheckFind(const TestEntry *section, size_t numEntries, const uint8_t *hashIndex, const std::string& id, const TestEntry *expected) noexcept
+	{
+		const TestEntry *const viaBinarySearch = FindUsingBinarySearch(section, numEntries, id.c_str());
+		const TestEntry *const viaHashIndex = FindUsingHashIndex(section, numEntries, hashIndex, id.c_str());
+		CHECK_MSG(viaBinarySearch == viaHashIndex, id.c_str());
+		CHECK_MSG(viaBinarySearch == expected, id.c_str());
+	}
+
+	// Return the entry whose name is the first element of the ID, found by linear search
+	const TestEntry *FindLinear(const TestEntry *section, size_t numEntries, const std::string& id) noexcept
+	{
+		const std::string element = id.substr(0, id.find_first_of(".[^"));
+		for (size_t i = 0; i < numEntries; ++i)
+		{
+			if (element == section[i].name)
+			{
+				return &section[i];
+			}
+		}
+		return nullptr;
+	}
+
+	// A section of one of the test tables
+	struct TestSection
+	{
+		const TestEntry *entries;
+		size_t numEntries;
+		const uint8_t *hashIndex;
+	};
+
+	TestSection GetSection(const TestTable& table, size_t sectionNumber) noexcept
+	{
+		TestSection section{ table.entries, table.descriptor[sectionNumber + 1], table.hashIndex };
+		for (size_t i = 1; i <= sectionNumber; ++i)
+		{
+			section.entries += table.descriptor[i];
+			section.hashIndex += HashIndexSectionSize(table.descriptor[i]);
+		}
+		return section;
+	}
+
+	// Call a function for each section of each test table
+	template<class F> void ForEachSection(F func) noexcept
+	{
+		for (const TestTable& table : tables)
+		{
+			const TestEntry *section = table.entries;
+			const uint8_t *hashIndex = table.hashIndex;
+			for (size_t i = 1; i <= table.descriptor[0]; ++i)
+			{
+				const size_t numEntries = table.descriptor[i];
+				func(section, numEntries, hashIndex);
+				section += numEntries;
+				hashIndex += HashIndexSectionSize(numEntries);
+			}
+		}
+	}
+}
+
+TEST(ObjectModelTableSearch_SectionsAreOrdered)
+{
+	ForEachSection([](const TestEntry *section, size_t numEntries, const uint8_t *)
+		{
+			for (size_t i = 1; i < numEntries; ++i)
+			{
+				CHECK_MSG(strcmp(section[i - 1].name, section[i].name) < 0, section[i].name);
+			}
+		});
+}
+
+TEST(ObjectModelTableSearch_SeedsLeaveMargin)
+{
+	// The seed search is bounded to keep the constexpr evaluation small, so check that the tables need only a small fraction of the seeds it may try
+	ForEachSection([](const TestEntry *section, size_t numEntries, const uint8_t *hashIndex)
+		{
+			if (numEntries != 0)
+			{
+				const unsigned int seed = hashIndex[0] | ((unsigned int)hashIndex[1] << 8);
+				CHECK_MSG(seed < ObjectModelTableHashIndex<1>::MaxSeeds/16, section[0].name);
+			}
+		});
+}
+
+TEST(ObjectModelTableSearch_IdsWithSuffixes)
+{
+	static const char *const suffixes[] = { "", "[0]", "[12].name", ".x", ".", "^", "s", "A", "z", "_", "0", "~" };
+	ForEachSection([](const TestEntry *section, size_t numEntries, const uint8_t *hashIndex)
+		{
+			for (size_t i = 0; i < numEntries; ++i)
+			{
+				const std::string name = section[i].name;
+				for (const char *suffix : suffixes)
+				{
+					const std::string id = name + suffix;
+					CheckFind(section, numEntries, hashIndex, id, FindLinear(section, numEntries, id));
+				}
+				for (size_t len = 1; len < name.size(); ++len)
+				{
+					const std::string prefix = name.substr(0, len);
+					CheckFind(section, numEntries, hashIndex, prefix, FindLinear(section, numEntries, prefix));
+					CheckFind(section, numEntries, hashIndex, prefix + "[1]", FindLinear(section, numEntries, prefix));
+				}
+			}
+		});
+}
+
+TEST(ObjectModelTableSearch_NameFollowedByIndex)
+{
+	// These used to be missed by the binary search because '[' sorts after the capital letters
+	CheckFind(prefixTable, 5, prefixIndex.data, "file[1]", &prefixTable[0]);
+	CheckFind(prefixTable, 5, prefixIndex.data, "file^", &prefixTable[0]);
+	CheckFind(prefixTable, 5, prefixIndex.data, "files[2].size", &prefixTable[2]);
+	CheckFind(prefixTable, 5, prefixIndex.data, "fileName.x", &prefixTable[1]);
+	CheckFind(prefixTable, 5, prefixIndex.data, "fil", nullptr);
+	CheckFind(prefixTable, 5, prefixIndex.data, "fileN", nullptr);
+}
+
+TEST(ObjectModelTableSearch_RandomIds)
+{
+	std::mt19937 rng(1);
+	static const char chars[] = "abcdeflmnorstuvxyzABCDMNPTXZ019.[^";
+	ForEachSection([&rng](const TestEntry *section, size_t numEntries, const uint8_t *hashIndex)
+		{
+			for (unsigned int i = 0; i < 2000; ++i)
+			{
+				// Start with part of a name so that some of the IDs match
+				std::string id = (numEntries != 0) ? std::string(section[rng() % numEntries].name).substr(0, rng() % 8) : std::string();
+				const size_t extra = rng() % 4;
+				for (size_t j = 0; j < extra; ++j)
+				{
+					id += chars[rng() % (sizeof(chars) - 1)];
+				}
+				if (id.empty() || IsIdTerminator(id[0]))
+				{
+					continue;
+				}
+				CheckFind(section, numEntries, hashIndex, id, FindLinear(section, numEntries, id));
+			}
+		});
+}
+
+TEST(ObjectModelTableSearch_Benchmark)
+{
+	// The lookups needed to resolve the elements of some paths that clients and macros often use, as far as the test tables go.
+	// For example "move.axes[2].machinePosition" is resolved by finding "move" in the RepRap table, then "axes" in the Move table,
+	// then "machinePosition" in the Axis section of the Platform table. The heater, job and tool tables aren't included here.
+	const TestTable& repRap = tables[0];
+	const TestTable& platform = tables[1];
+	const TestTable& move = tables[2];
+	struct Lookup
+	{
+		TestSection section;
+		const char *id;
+	};
+	const Lookup lookups[] =
+	{
+		{ GetSection(repRap, 0), "heat.heaters[1].current" },
+		{ GetSection(repRap, 0), "state.status" },
+		{ GetSection(repRap, 3), "status" },
+		{ GetSection(repRap, 0), "state.upTime" },
+		{ GetSection(repRap, 3), "upTime" },
+		{ GetSection(repRap, 0), "boards[0].vIn.current" },
+		{ GetSection(platform, 0), "vIn.current" },
+		{ GetSection(platform, 1), "current" },
+		{ GetSection(repRap, 0), "move.axes[2].machinePosition" },
+		{ GetSection(move, 0), "axes[2].machinePosition" },
+		{ GetSection(platform, 3), "machinePosition" },
+		{ GetSection(repRap, 0), "move.axes[0].homed" },
+		{ GetSection(move, 0), "axes[0].homed" },
+		{ GetSection(platform, 3), "homed" },
+		{ GetSection(repRap, 0), "move.extruders[0].position" },
+		{ GetSection(move, 0), "extruders[0].position" },
+		{ GetSection(platform, 4), "position" },
+		{ GetSection(repRap, 0), "move.currentMove.topSpeed" },
+		{ GetSection(move, 0), "currentMove.topSpeed" },
+		{ GetSection(move, 2), "topSpeed" },
+		{ GetSection(repRap, 0), "job.file.fileName" },
+		{ GetSection(repRap, 0), "sensors.probes[0].value[0]" },
+	};
+	constexpr size_t NumLookups = ArraySize(lookups);
+
+	for (const Lookup& l : lookups)
+	{
+		const TestEntry *const expected = FindLinear(l.section.entries, l.section.numEntries, l.id);
+		CHECK_MSG(expected != nullptr, l.id);
+		CheckFind(l.section.entries, l.section.numEntries, l.section.hashIndex, l.id, expected);
+	}
+
+	// Do the lookups in a random order, so that the host's branch prediction doesn't learn the sequence
+	std::mt19937 rng(1);
+	std::vector<uint8_t> order(4096);
+	for (uint8_t& n : order)
+	{
+		n = (uint8_t)(rng() % NumLookups);
+	}
+
+	const double binarySearch = Benchmark::NanosecondsPerCall(1000000, [&lookups, &order](size_t i)
+		{
+			const Lookup& l = lookups[order[i % order.size()]];
+			Benchmark::KeepResult(FindUsingBinarySearch(l.section.entries, l.section.numEntries, l.id));
+		});
+	const double hashIndex = Benchmark::NanosecondsPerCall(1000000, [&lookups, &order](size_t i)
+		{
+			const Lookup& l = lookups[order[i % order.size()]];
+			Benchmark::KeepResult(FindUsingHashIndex(l.section.entries, l.section.numEntries, l.section.hashIndex, l.id));
+		});
+	Benchmark::Report("path element lookup", "lookups", binarySearch, hashIndex);
+}
+
+// End
@@ -0,0 +1,108 @@
+/*
+ * ReadDecimalFloatTests.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *
+ *  Tests of ReadDecimalFloat. Whenever it accepts a number it must give the same result and end pointer as strtof.
+ */
+
+#include "TestFramework.h"
+#include <Platform/FloatConversion.h>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+namespace
+{
+	// Check that ReadDecimalFloat either declines the string or converts it exactly as strtof does. Return true if it accepted the string.
+	bool CheckAgainstStrtof(const char *s) noexcept
+	{
+		float rslt;
+		const char *endptr;
+		if (!ReadDecimalFloat(s, rslt, endptr))
+		{
+			return false;
+		}
+
+		char *expectedEnd;
+		const float expected = strtof(s, &expectedEnd);
+		CHECK_MSG(memcmp(&rslt, &expected, sizeof(float)) == 0, s);
+		CHECK_MSG(endptr == expectedEnd, s);
+		return true;
+	}
+}
+
+TEST(ReadDecimalFloat_TypicalGCodeNumbers)
+{
+	static const char *const numbers[] =
+	{
+		"0", "-0", "+0", "0.0", "1", "-1", "10", "100.5", "-123.456", "0.1", "0.2", "0.3", "0.001", "5.", ".5", "-.5", "+.25",
+		"12345.678", "9999.999", "0.0000001", "16777216", "1677721.6", "007.500", "3.14159", "-0.0125", "1200", "60000",
+		"210 ", "1.5Y", "-2.25;comment", "7.5\t", "1.2.3", "4:5", "0.0000000001",
+	};
+
+	for (const char *s : numbers)
+	{
+		CHECK_MSG(CheckAgainstStrtof(s), s);
+	}
+}
+
+TEST(ReadDecimalFloat_DeclinesUnusualNumbers)
+{
+	static const char *const numbers[] =
+	{
+		"", "-", "+", ".", "-.", "X1", " 1", "1e3", "1.5E-2", "0x1A", "0X10", "inf", "nan", "1234567890", "16777217", "0.00000000000",
+		"1.23456789012", "99999.999", "0.00000000001", "1.5X",
+	};
+
+	for (const char *s : numbers)
+	{
+		CHECK_MSG(!CheckAgainstStrtof(s), s);
+	}
+}
+
+TEST(ReadDecimalFloat_RandomNumbersMatchStrtof)
+{
+	std::mt19937 rng(12345);
+	std::uniform_int_distribution<int> digitDist(0, 9);
+	std::uniform_int_distribution<int> lengthDist(0, 6);
+	std::uniform_int_distribution<int> signDist(0, 3);
+
+	unsigned int numAccepted = 0;
+	for (unsigned int i = 0; i < 1000000; ++i)
+	{
+		std::string s;
+		switch (signDist(rng))
+		{
+		case 0:		s += '-'; break;
+		case 1:		s += '+'; break;
+		default:	break;
+		}
+
+		const int intDigits = lengthDist(rng);
+		for (int j = 0; j < intDigits; ++j)
+		{
+			s += (char)('0' + digitDist(rng));
+		}
+		const int fracDigits = lengthDist(rng);
+		if (fracDigits != 0 || intDigits == 0)
+		{
+			s += '.';
+			for (int j = 0; j < fracDigits; ++j)
+			{
+				s += (char)('0' + digitDist(rng));
+			}
+		}
+		s += ' ';
+
+		if (CheckAgainstStrtof(s.c_str()))
+		{
+			++numAccepted;
+		}
+	}
+
+	CHECK(numAccepted > 500000);				// most of these should take the fast path
+}
+
+// End
@@ -0,0 +1,23 @@
+/*
+ * SafeStrtod.h
+ *
+ *  Host build replacement for the RRFLibraries number conversion functions, using the C library versions.
+ */
+
+#ifndef TESTS_STUBS_GENERAL_SAFESTRTOD_H_
+#define TESTS_STUBS_GENERAL_SAFESTRTOD_H_
+
+#include <cstdlib>
+
+inline float SafeStrtof(const char *s, const char **endptr = nullptr) noexcept
+{
+	char *end;
+	const float ret = strtof(s, &end);
+	if (endptr != nullptr)
+	{
+		*endptr = end;
+	}
+	return ret;
+}
+
+#endif /* TESTS_STUBS_GENERAL_SAFESTRTOD_H_ */
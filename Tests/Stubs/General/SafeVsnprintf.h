@@ -0,0 +1,28 @@
+/*
+ * SafeVsnprintf.h
+ *
+ *  Host build replacement for the RRFLibraries formatting functions, using the C library versions.
+ */
+
+#ifndef TESTS_STUBS_GENERAL_SAFEVSNPRINTF_H_
+#define TESTS_STUBS_GENERAL_SAFEVSNPRINTF_H_
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdio>
+
+inline int SafeVsnprintf(char *buffer, size_t buf_size, const char *format, va_list args) noexcept
+{
+	return vsnprintf(buffer, buf_size, format, args);
+}
+
+inline int SafeSnprintf(char *buffer, size_t buf_size, const char *format, ...) noexcept
+{
+	va_list args;
+	va_start(args, format);
+	const int ret = vsnprintf(buffer, buf_size, format, args);
+	va_end(args);
+	return ret;
+}
+
+#endif /* TESTS_STUBS_GENERAL_SAFEVSNPRINTF_H_ */
@@ -0,0 +1,17 @@
+/*
+ * ecv_duet3d.h
+ *
+ *  Host build replacement for the eCv annotation header, so that firmware sources can be compiled for the host unit tests.
+ */
+
+#ifndef TESTS_STUBS_ECV_DUET3D_H_
+#define TESTS_STUBS_ECV_DUET3D_H_
+
+#define _ecv_array
+#define _ecv_null
+#define null
+#define pre(...)
+#define post(...)
+#define decrease(...)
+
+#endif /* TESTS_STUBS_ECV_DUET3D_H_ */
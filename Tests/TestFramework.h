@@ -0,0 +1,38 @@
+/*
+ * TestFramework.h
+ *
+ *  Created on: 16 Oct 2026
+ *
+ *  A minimal unit test framework for the host tests. Each TEST registers a function that TestMain runs.
+ *  CHECK records a failure and carries on, so that one run reports every failing case.
+ */
+
+#ifndef TESTS_TESTFRAMEWORK_H_
+#define TESTS_TESTFRAMEWORK_H_
+
+#include <cstdio>
+
+namespace TestFramework
+{
+	typedef void (*TestFunction)();
+
+	struct TestRegistration
+	{
+		TestRegistration(const char *name, TestFunction func) noexcept;
+	};
+
+	void ReportFailure(const char *file, int line, const char *expression, const char *detail) noexcept;
+}
+
+#define TEST(name) \
+	static void name(); \
+	static TestFramework::TestRegistration name##_registration(#name, name); \
+	static void name()
+
+#define CHECK(expr) \
+	do { if (!(expr)) { TestFramework::ReportFailure(__FILE__, __LINE__, #expr, nullptr); } } while (false)
+
+#define CHECK_MSG(expr, detail) \
+	do { if (!(expr)) { TestFramework::ReportFailure(__FILE__, __LINE__, #expr, (detail)); } } while (false)
+
+#endif /* TESTS_TESTFRAMEWORK_H_ */
@@ -0,0 +1,55 @@
+/*
+ * TestMain.cpp
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#include "TestFramework.h"
+#include <vector>
+
+namespace
+{
+	struct Test
+	{
+		const char *name;
+		TestFramework::TestFunction func;
+	};
+
+	std::vector<Test>& Tests() noexcept
+	{
+		static std::vector<Test> tests;
+		return tests;
+	}
+
+	unsigned int numFailures = 0;
+	const char *currentTest = "";
+}
+
+TestFramework::TestRegistration::TestRegistration(const char *name, TestFunction func) noexcept
+{
+	Tests().push_back(Test{name, func});
+}
+
+void TestFramework::ReportFailure(const char *file, int line, const char *expression, const char *detail) noexcept
+{
+	++numFailures;
+	if (numFailures <= 50)
+	{
+		printf("%s:%d: %s: CHECK(%s) failed%s%s\n", file, line, currentTest, expression, (detail != nullptr) ? ": " : "", (detail != nullptr) ? detail : "");
+	}
+}
+
+int main()
+{
+	for (const Test& t : Tests())
+	{
+		currentTest = t.name;
+		const unsigned int failuresBefore = numFailures;
+		t.func();
+		printf("%-50s %s\n", t.name, (numFailures == failuresBefore) ? "passed" : "FAILED");
+	}
+	printf("%u tests, %u failures\n", (unsigned int)Tests().size(), numFailures);
+	return (numFailures == 0) ? 0 : 1;
+}
+
+// End
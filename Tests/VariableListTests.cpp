@@ -0,0 +1,323 @@
+/*
+ * VariableListTests.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *
+ *  Tests of the list and hash index that hold the variables of a VariableSet, and benchmarks comparing it with the linear search it replaced.
+ *  A model of the expected contents is updated alongside the list, and after each operation the list must hold the same entries in the same order
+ *  and find each of them by name. Removed entries are kept until the end of each test, so that an entry left in the index would be found.
+ */
+
+#include "TestFramework.h"
+#include "Benchmark.h"
+#include <ObjectModel/VariableList.h>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	struct TestEntry
+	{
+		TestEntry(const std::string& p_name, int p_scope) noexcept
+			: next(nullptr), nextInBucket(nullptr), hash(VariableList<TestEntry>::Hash(p_name.c_str())), name(p_name), scope(p_scope) { }
+
+		int GetScope() const noexcept { return scope; }
+		bool HasName(const char *str) const noexcept { return name == str; }
+
+		TestEntry *next;
+		TestEntry *nextInBucket;
+		uint32_t hash;
+		std::string name;
+		int scope;
+	};
+
+	typedef VariableList<TestEntry> TestList;
+
+	// A variable list and the entries we expect it to hold, in the same order
+	class CheckedList
+	{
+	public:
+		void Insert(const std::string& name, int scope) noexcept
+		{
+			entries.push_back(std::unique_ptr<TestEntry>(new TestEntry(name, scope)));
+			list.InsertFirst(entries.back().get());
+			expected.insert(expected.begin(), entries.back().get());
+			Check();
+		}
+
+		void EndScope(int blockNesting) noexcept
+		{
+			TestEntry *entry;
+			while ((entry = list.RemoveFirstOutOfScope(blockNesting)) != nullptr)
+			{
+				CHECK_MSG(!expected.empty() && entry == expected.front(), entry->name.c_str());
+				if (!expected.empty())
+				{
+					removed.push_back(expected.front());
+					expected.erase(expected.begin());
+				}
+			}
+			CHECK(expected.empty() || expected.front()->scope <= blockNesting);
+			Check();
+		}
+
+		void Delete(size_t index) noexcept
+		{
+			TestEntry * const entry = list.Find(expected[index]->name.c_str());
+			CHECK_MSG(entry == expected[index], expected[index]->name.c_str());
+			list.Remove(expected[index]);
+			removed.push_back(expected[index]);
+			expected.erase(expected.begin() + index);
+			Check();
+		}
+
+		void Clear() noexcept
+		{
+			TestEntry *entry = list.RemoveAll();
+			for (TestEntry *e : expected)
+			{
+				CHECK(entry == e);
+				entry = (entry == nullptr) ? nullptr : entry->next;
+				removed.push_back(e);
+			}
+			CHECK(entry == nullptr);
+			expected.clear();
+			Check();
+		}
+
+		void TakeFrom(CheckedList& other) noexcept
+		{
+			Clear();
+			list.TakeFrom(other.list);
+			expected.swap(other.expected);
+			Check();
+			other.Check();
+		}
+
+		size_t Size() const noexcept { return expected.size(); }
+		unsigned int GetNumBuckets() const noexcept { return list.GetNumBuckets(); }
+
+	private:
+		// Check that the list holds the expected entries in order, that each one is found by name and that no removed entry is found
+		void Check() const noexcept
+		{
+			CHECK(list.GetNumEntries() == expected.size());
+			const TestEntry *entry = list.GetFirst();
+			for (const TestEntry *e : expected)
+			{
+				CHECK_MSG(entry == e, e->name.c_str());
+				CHECK_MSG(list.Find(e->name.c_str()) == e, e->name.c_str());
+				entry = (entry == nullptr) ? nullptr : entry->next;
+			}
+			CHECK(entry == nullptr);
+			for (const TestEntry *e : removed)
+			{
+				CHECK_MSG(list.Find(e->name.c_str()) == nullptr, e->name.c_str());
+			}
+		}
+
+		TestList list;
+		std::vector<std::unique_ptr<TestEntry>> entries;				// every entry created, so that they outlive the list
+		std::vector<TestEntry *> expected;
+		std::vector<TestEntry *> removed;
+	};
+
+	// The linear search that VariableSet used before the hash index was added
+	struct LinearEntry
+	{
+		LinearEntry *next;
+		std::string name;
+	};
+
+	const LinearEntry *FindLinear(const LinearEntry *root, const char *name) noexcept
+	{
+		for (const LinearEntry *entry = root; entry != nullptr; entry = entry->next)
+		{
+			if (strcmp(entry->name.c_str(), name) == 0)
+			{
+				return entry;
+			}
+		}
+		return nullptr;
+	}
+
+	std::vector<std::string> VariableNames(size_t count) noexcept
+	{
+		static const char *const stems[] = { "probePoint", "toolOffset", "count", "maxTemp", "axisMin", "i" };
+		std::vector<std::string> names;
+		for (size_t i = 0; i < count; ++i)
+		{
+			names.push_back(stems[i % 6] + std::to_string(i));
+		}
+		return names;
+	}
+}
+
+TEST(VariableList_IndexGrows)
+{
+	TestList list;
+	const std::vector<std::string> names = VariableNames(2 * TestList::MaxAverageChainLength * TestList::MaxNumBuckets);
+	std::vector<std::unique_ptr<TestEntry>> entries;
+	for (const std::string& name : names)
+	{
+		entries.push_back(std::unique_ptr<TestEntry>(new TestEntry(name, 0)));
+		list.InsertFirst(entries.back().get());
+		const unsigned int numBuckets = list.GetNumBuckets();
+		if (list.GetNumEntries() < TestList::MinEntriesToIndex)
+		{
+			CHECK(numBuckets == 0);
+		}
+		else
+		{
+			CHECK(numBuckets >= TestList::InitialNumBuckets && numBuckets <= TestList::MaxNumBuckets && (numBuckets & (numBuckets - 1)) == 0);
+			CHECK(numBuckets == TestList::MaxNumBuckets || list.GetNumEntries() <= TestList::MaxAverageChainLength * numBuckets);
+		}
+	}
+	CHECK(list.GetNumBuckets() == TestList::MaxNumBuckets);
+	for (const std::unique_ptr<TestEntry>& entry : entries)
+	{
+		CHECK_MSG(list.Find(entry->name.c_str()) == entry.get(), entry->name.c_str());
+	}
+}
+
+TEST(VariableList_EndScope)
+{
+	// Parameters, then variables created in nested blocks as a macro would, then leave the blocks in turn
+	CheckedList list;
+	const std::vector<std::string> names = VariableNames(60);
+	list.Insert("param.X", -1);
+	list.Insert("param.Y", -1);
+	size_t next = 0;
+	for (int nesting = 0; nesting <= 5; ++nesting)
+	{
+		for (int i = 0; i < 2 * nesting + 1; ++i)
+		{
+			list.Insert(names[next++], nesting);
+		}
+	}
+	for (int nesting = 4; nesting >= -1; --nesting)
+	{
+		list.EndScope(nesting);
+	}
+	CHECK(list.Size() == 2);
+	list.EndScope(-2);
+	CHECK(list.Size() == 0);
+}
+
+TEST(VariableList_RandomOperations)
+{
+	// Interleave creating variables, entering and leaving blocks, deleting variables and replacing the whole list, so that removals happen
+	// both before and after the index is created and while it is being resized
+	std::mt19937 rng(1);
+	for (unsigned int run = 0; run < 20; ++run)
+	{
+		CheckedList list, other;
+		int nesting = 0;
+		unsigned int nameNumber = 0;
+		for (unsigned int op = 0; op < 400; ++op)
+		{
+			const unsigned int choice = rng() % 100;
+			if (choice < 55)
+			{
+				list.Insert("v" + std::to_string(run) + "_" + std::to_string(nameNumber++), nesting);
+			}
+			else if (choice < 70)
+			{
+				++nesting;
+			}
+			else if (choice < 85)
+			{
+				if (nesting > 0)
+				{
+					--nesting;
+					list.EndScope(nesting);
+				}
+			}
+			else if (choice < 97)
+			{
+				if (list.Size() != 0)
+				{
+					list.Delete(rng() % list.Size());
+				}
+			}
+			else if (choice < 98)
+			{
+				other.Insert("w" + std::to_string(run) + "_" + std::to_string(nameNumber++), 0);
+				list.TakeFrom(other);
+				nesting = 0;
+			}
+			else
+			{
+				list.Clear();
+				nesting = 0;
+			}
+		}
+		list.EndScope(-1);
+		CHECK(list.Size() == 0);
+	}
+}
+
+TEST(VariableList_Benchmark)
+{
+	for (size_t count : { (size_t)10, (size_t)100, (size_t)1000 })
+	{
+		const std::vector<std::string> names = VariableNames(count);
+		const size_t numCalls = 2000000/count * count;
+
+		// Look up each variable in turn
+		std::vector<LinearEntry> linearEntries(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			linearEntries[i].name = names[i];
+			linearEntries[i].next = (i == 0) ? nullptr : &linearEntries[i - 1];
+		}
+		const LinearEntry * const linearRoot = &linearEntries[count - 1];
+		std::vector<std::unique_ptr<TestEntry>> entries;
+		TestList list;
+		for (const std::string& name : names)
+		{
+			entries.push_back(std::unique_ptr<TestEntry>(new TestEntry(name, 0)));
+			list.InsertFirst(entries.back().get());
+		}
+		const double lookupBefore = Benchmark::NanosecondsPerCall(numCalls/10, [&names, linearRoot](size_t i)
+			{
+				Benchmark::KeepResult(FindLinear(linearRoot, names[i % names.size()].c_str()));
+			});
+		const double lookupAfter = Benchmark::NanosecondsPerCall(numCalls, [&names, &list](size_t i)
+			{
+				Benchmark::KeepResult(list.Find(names[i % names.size()].c_str()));
+			});
+
+		// Create the variables, checking first that each one doesn't already exist as the 'var' command does, then remove them all
+		const size_t numRuns = numCalls/count/10 + 1;
+		const double insertBefore = Benchmark::NanosecondsPerCall(numRuns, [&linearEntries, &names](size_t)
+			{
+				const LinearEntry *root = nullptr;
+				for (size_t i = 0; i < names.size(); ++i)
+				{
+					Benchmark::KeepResult(FindLinear(root, names[i].c_str()));
+					linearEntries[i].next = const_cast<LinearEntry *>(root);
+					root = &linearEntries[i];
+				}
+				Benchmark::KeepResult(root);
+			})/count;
+		const double insertAfter = Benchmark::NanosecondsPerCall(numRuns, [&entries, &names, &list](size_t)
+			{
+				while (list.RemoveFirstOutOfScope(-1) != nullptr) { }
+				for (size_t i = 0; i < names.size(); ++i)
+				{
+					Benchmark::KeepResult(list.Find(names[i].c_str()));
+					list.InsertFirst(entries[i].get());
+				}
+			})/count;
+
+		const std::string what = std::to_string(count) + " variables";
+		Benchmark::Report((what + ", lookup").c_str(), "lookups", lookupBefore, lookupAfter);
+		Benchmark::Report((what + ", check and insert").c_str(), "inserts", insertBefore, insertAfter);
+	}
+}
+
+// End
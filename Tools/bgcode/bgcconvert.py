@@ -0,0 +1,183 @@
+#!/usr/bin/env python3
+# Convert a G-code file to the compact binary G-code format that RepRapFirmware can print from SD card, or convert a binary G-code file back to text.
+# G0 and G1 commands whose only parameters are X, Y, Z, E and F are stored as differences from the previous values. All other lines are stored as text.
+# See src/GCodes/BinaryGCodeBlock.h in the firmware sources for a description of the format.
+import sys
+import re
+import argparse
+from decimal import Decimal
+
+HEADER_SIGNATURE = b"RRFB"
+FORMAT_VERSION = 1
+LOG_BLOCK_SIZE = 12
+BLOCK_SIZE = 1 << LOG_BLOCK_SIZE
+HEADER_SIZE = 8
+
+ESCAPED_TEXT_TAG = 0xA0
+MOVE_TAG = 0x80
+G1_TAG_BIT = 0x40
+
+PARAMETER_LETTERS = "XYZEF"
+PARAMETER_DECIMALS = (3, 3, 3, 5, 1)
+
+MOVE_COMMAND = re.compile(rb"G0?([01])(?=[ \t;]|$)")
+MOVE_PARAMETER = re.compile(rb"[ \t]*([XYZEF])([-+]?(?:[0-9]+\.?[0-9]*|\.[0-9]+))")
+TRAILER = re.compile(rb"[ \t]*(;.*)?$")
+
+
+def parse_move(line):
+    """Return (command number, list of scaled values or None) if the line can be stored as a move record, else None"""
+    m = MOVE_COMMAND.match(line)
+    if m is None:
+        return None
+    values = [None] * len(PARAMETER_LETTERS)
+    pos = m.end()
+    while True:
+        m2 = MOVE_PARAMETER.match(line, pos)
+        if m2 is None:
+            break
+        index = PARAMETER_LETTERS.index(m2.group(1).decode())
+        if values[index] is not None:
+            return None
+        scaled = Decimal(m2.group(2).decode()).scaleb(PARAMETER_DECIMALS[index])
+        if scaled != scaled.to_integral_value():
+            return None                     # too many decimal places to store exactly
+        values[index] = int(scaled)
+        pos = m2.end()
+    if TRAILER.match(line, pos) is None:
+        return None
+    return int(m.group(1)), values
+
+
+def encode_varint(val):
+    u = (val << 1) if val >= 0 else ((-val << 1) - 1)
+    out = bytearray()
+    while True:
+        b = u & 0x7F
+        u >>= 7
+        if u == 0:
+            out.append(b)
+            return bytes(out)
+        out.append(b | 0x80)
+
+
+def encode_move(command, values, previous):
+    tag = MOVE_TAG | (G1_TAG_BIT if command == 1 else 0)
+    data = bytearray()
+    for i, val in enumerate(values):
+        if val is not None:
+            tag |= 1 << i
+            data += encode_varint(val - previous[i])
+    return bytes([tag]) + bytes(data)
+
+
+def encode_text(line):
+    text = line + b"\n"
+    return text if 0 < text[0] < 0x80 else bytes([ESCAPED_TEXT_TAG]) + text
+
+
+def convert(data):
+    out = bytearray(HEADER_SIGNATURE + bytes([FORMAT_VERSION, LOG_BLOCK_SIZE, 0, 0]))
+    previous = [0] * len(PARAMETER_LETTERS)
+    num_moves = 0
+    lines = data.split(b"\n")
+    if lines[-1] == b"":
+        lines.pop()
+    for line in lines:
+        line = line.rstrip(b"\r")
+        if len(out) % BLOCK_SIZE == 0:
+            previous = [0] * len(PARAMETER_LETTERS)         # the previous block was filled exactly
+        move = parse_move(line)
+        record = encode_move(move[0], move[1], previous) if move is not None else encode_text(line)
+        if len(out) % BLOCK_SIZE + len(record) > BLOCK_SIZE:
+            # Pad the rest of this block and start a new one, resetting the previous values
+            out += bytes(-len(out) % BLOCK_SIZE)
+            previous = [0] * len(PARAMETER_LETTERS)
+            if move is not None:
+                record = encode_move(move[0], move[1], previous)
+            elif len(record) > BLOCK_SIZE:
+                raise ValueError("line too long: %s..." % line[:40])
+        if move is not None:
+            num_moves += 1
+            for i, val in enumerate(move[1]):
+                if val is not None:
+                    previous[i] = val
+        out += record
+    return bytes(out), len(lines), num_moves
+
+
+def format_scaled(val, decimals):
+    sign = "-" if val < 0 else ""
+    digits = str(abs(val)).rjust(decimals + 1, "0")
+    integer, fraction = digits[:len(digits) - decimals], digits[len(digits) - decimals:].rstrip("0")
+    return sign + integer + ("." + fraction if fraction else "")
+
+
+def read_varint(data, pos):
+    u = 0
+    shift = 0
+    while True:
+        b = data[pos]
+        pos += 1
+        u |= (b & 0x7F) << shift
+        if (b & 0x80) == 0:
+            return ((u >> 1) ^ -(u & 1)), pos
+        shift += 7
+
+
+def decode(data):
+    """Convert binary G-code to the same text that the firmware generates from it"""
+    if data[0:4] != HEADER_SIGNATURE or data[4] != FORMAT_VERSION or data[5] != LOG_BLOCK_SIZE:
+        raise ValueError("not a binary G-code file")
+    out = bytearray()
+    for block_start in range(0, len(data), BLOCK_SIZE):
+        block = data[block_start:block_start + BLOCK_SIZE]
+        pos = HEADER_SIZE if block_start == 0 else 0
+        previous = [0] * len(PARAMETER_LETTERS)
+        while pos < len(block) and block[pos] != 0:
+            tag = block[pos]
+            if (tag & 0xA0) == MOVE_TAG:
+                pos += 1
+                out += b"G1" if (tag & G1_TAG_BIT) else b"G0"
+                for i, letter in enumerate(PARAMETER_LETTERS):
+                    if tag & (1 << i):
+                        delta, pos = read_varint(block, pos)
+                        previous[i] += delta
+                        out += (" " + letter + format_scaled(previous[i], PARAMETER_DECIMALS[i])).encode()
+                out += b"\n"
+            elif tag < 0x80 or tag == ESCAPED_TEXT_TAG:
+                if tag == ESCAPED_TEXT_TAG:
+                    pos += 1
+                end = block.index(b"\n", pos) + 1
+                out += block[pos:end]
+                pos = end
+            else:
+                raise ValueError("bad record tag 0x%02x at offset %d" % (tag, block_start + pos))
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert G-code to binary G-code for RepRapFirmware")
+    parser.add_argument("input", help="input file")
+    parser.add_argument("output", help="output file")
+    parser.add_argument("-d", "--decode", action="store_true", help="convert binary G-code back to text")
+    args = parser.parse_args()
+
+    try:
+        with open(args.input, mode='rb') as f:
+            data = f.read()
+        if args.decode:
+            result = decode(data)
+        else:
+            result, num_lines, num_moves = convert(data)
+            print("%d lines, %d stored as moves, %d bytes -> %d bytes (%.2f:1)"
+                  % (num_lines, num_moves, len(data), len(result), len(data) / max(len(result), 1)))
+        with open(args.output, mode='wb') as f:
+            f.write(result)
+    except (OSError, ValueError) as e:
+        print("Error: %s" % e)
+        sys.exit(2)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+# Compare two step trace files recorded using M37 S1 T"filename" and report the differences in the step streams for each drive.
+# Typical use is to check that a change to the motion planner has not changed the step timings by more than a given tolerance.
+import sys
+import struct
+import argparse
+
+TRACE_MAGIC = b"RRFSTEP\0"
+TRACE_VERSION = 1
+HEADER_SIZE = 16
+RECORD_SIZE = 6
+
+
+def read_trace(filename):
+    with open(filename, mode='rb') as f:
+        buf = f.read()
+    if len(buf) < HEADER_SIZE or buf[0:8] != TRACE_MAGIC:
+        raise ValueError("%s is not a step trace file" % filename)
+    version, clock_rate = struct.unpack("<II", buf[8:HEADER_SIZE])
+    if version != TRACE_VERSION:
+        raise ValueError("%s has unsupported format version %d" % (filename, version))
+    if (len(buf) - HEADER_SIZE) % RECORD_SIZE != 0:
+        print("Warning: %s is truncated" % filename)
+
+    # Group the steps by drive, unwrapping the 32-bit step times as we go
+    drives = {}
+    offset = 0
+    last_time = 0
+    for pos in range(HEADER_SIZE, len(buf) - RECORD_SIZE + 1, RECORD_SIZE):
+        t, drive, direction = struct.unpack("<IBB", buf[pos:pos + RECORD_SIZE])
+        t += offset
+        if t + (1 << 31) < last_time:
+            offset += 1 << 32
+            t += 1 << 32
+        last_time = t
+        drives.setdefault(drive, []).append((t, direction))
+    return clock_rate, drives
+
+
+def compare_drive(steps1, steps2):
+    num_compared = min(len(steps1), len(steps2))
+    max_diff = 0
+    max_diff_index = 0
+    dir_mismatches = 0
+    for i in range(num_compared):
+        diff = abs(steps1[i][0] - steps2[i][0])
+        if diff > max_diff:
+            max_diff = diff
+            max_diff_index = i
+        if steps1[i][1] != steps2[i][1]:
+            dir_mismatches += 1
+    return max_diff, max_diff_index, dir_mismatches
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare two RepRapFirmware step trace files.")
+    parser.add_argument("reference", help="reference (golden) trace file")
+    parser.add_argument("trace", help="trace file to compare against the reference")
+    parser.add_argument("-t", "--tolerance", type=int, default=0,
+                        help="maximum allowed difference in step time, in step clocks (default 0)")
+    args = parser.parse_args()
+
+    try:
+        rate1, drives1 = read_trace(args.reference)
+        rate2, drives2 = read_trace(args.trace)
+    except (OSError, ValueError) as e:
+        print("Error: %s" % e)
+        sys.exit(2)
+    if rate1 != rate2:
+        print("Error: step clock rates differ (%d and %d)" % (rate1, rate2))
+        sys.exit(2)
+
+    ok = True
+    for drive in sorted(set(drives1) | set(drives2)):
+        steps1 = drives1.get(drive, [])
+        steps2 = drives2.get(drive, [])
+        max_diff, max_diff_index, dir_mismatches = compare_drive(steps1, steps2)
+        drive_ok = len(steps1) == len(steps2) and dir_mismatches == 0 and max_diff <= args.tolerance
+        print("Drive %d: steps %d/%d, direction mismatches %d, max time difference %d clocks (%.1fus) at step %d%s"
+              % (drive, len(steps1), len(steps2), dir_mismatches, max_diff, max_diff * 1.0e6 / rate1, max_diff_index,
+                 "" if drive_ok else " *"))
+        ok = ok and drive_ok
+
+    print("Traces match" if ok else "Traces differ")
+    sys.exit(0 if ok else 1)
+
+
+if __name__ == "__main__":
+    main()
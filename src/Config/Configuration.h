@@ -201,7 +201,8 @@ constexpr size_t RESERVED_OUTPUT_BUFFERS = 2;           // Number of reserved ou
 # error
 #endif
 
-constexpr size_t maxQueuedCodes = 16;					// How many codes can be queued?
+constexpr size_t maxQueuedCodes = 16;					// How many codes can be queued by default?
+constexpr size_t MaxQueuedCodesLimit = 256;				// The maximum number of codes that M595 C can allow to be queued
 
 // These two definitions are only used if TRACK_OBJECT_NAMES is defined, however that definition isn't available in this file
 #if SAME70 || SAME5x
@@ -247,6 +248,14 @@ constexpr float NOZZLE_DIAMETER = 0.5;					// Millimetres
 constexpr float FILAMENT_WIDTH = 1.75;					// Millimetres
 
 constexpr unsigned int MaxStackDepth = 10;				// Maximum depth of stack (was 5 in 3.01-RC2, increased to 7 for 3.01-RC3, 10 for 3.4.0beta6)
+constexpr size_t DefaultMacroCacheSize = 16 * 1024;	// Default maximum number of bytes used to cache macro files, if SUPPORT_MACRO_CACHE is enabled
+constexpr size_t NumCompiledExpressionCacheEntries = 16;	// Number of compiled expressions that we cache, if SUPPORT_COMPILED_EXPRESSIONS is enabled
+constexpr size_t DefaultFileReadAheadBufferSize = 4096;	// Default size of each of the two file read-ahead buffers, if SUPPORT_FILE_READ_AHEAD is enabled. M595 F changes it.
+constexpr size_t MinFileReadAheadBufferSize = 512;		// The read-ahead buffer size is rounded up to a multiple of this
+constexpr size_t MaxFileReadAheadBufferSize = 32 * 1024;
+constexpr unsigned int MinFileBuffersForReadAhead = 3;	// Files smaller than this number of read-ahead buffers, such as most macros, are read directly
+constexpr size_t NumObjectModelCacheEntries = 24;		// Number of object model entries whose JSON we cache, if SUPPORT_OBJECT_MODEL_CACHE is enabled
+constexpr size_t ObjectModelCacheSize = 8 * 1024;		// Maximum number of bytes of string heap used to cache object model JSON
 
 // CNC and laser support
 constexpr int32_t DefaultMinSpindleRpm = 60;			// Default minimum available spindle RPM
@@ -218,6 +218,57 @@
 # define SUPPORT_ACCELEROMETERS	0
 #endif
 
+// Native G2/G3 arc moves need extra RAM in every DDA and DM, so by default we only support them on processors with plenty of RAM
+#ifndef SUPPORT_NATIVE_ARCS
+# define SUPPORT_NATIVE_ARCS	(SAME70 || SAME5x)
+#endif
+
+// Calculating the first few step times of each drive when a move is prepared reduces the work done by the step ISR at the start of a move, but needs 34 bytes of RAM per DM
+#ifndef SUPPORT_PRECALCULATED_STEPS
+# define SUPPORT_PRECALCULATED_STEPS	(SAME70 || SAME5x)
+#endif
+
+// Precomputing the bilinear coefficients of each height map cell speeds up mesh compensation but needs 16 bytes of RAM per grid point
+#ifndef USE_MESH_CELL_COEFFICIENTS
+# define USE_MESH_CELL_COEFFICIENTS	(SAME70 || SAME5x)
+#endif
+
+// Caching compiled versions of the expressions in macros and job files speeds up evaluating them, but the cache needs about 3.5Kb of RAM
+#ifndef SUPPORT_COMPILED_EXPRESSIONS
+# define SUPPORT_COMPILED_EXPRESSIONS	(SAME70 || SAME5x)
+#endif
+
+// Caching frequently-used macro files in RAM avoids reading them from SD card each time they are run
+#ifndef SUPPORT_MACRO_CACHE
+# define SUPPORT_MACRO_CACHE	(HAS_MASS_STORAGE && (SAME70 || SAME5x))
+#endif
+
+// Reading job files ahead in a separate task stops SD card latency from holding up command parsing, but needs 8Kb of buffers by default
+#ifndef SUPPORT_FILE_READ_AHEAD
+# define SUPPORT_FILE_READ_AHEAD	(HAS_MASS_STORAGE && (SAME70 || SAME5x))
+#endif
+
+// Printing binary G-code files from SD card needs a 4Kb block buffer for each input that is reading one
+#ifndef SUPPORT_BINARY_GCODE
+# define SUPPORT_BINARY_GCODE	(HAS_MASS_STORAGE && (SAME70 || SAME5x))
+#endif
+
+// Caching the JSON of object model entries that change only when their section's sequence number changes speeds up object model reports,
+// but the cached text takes up to 8Kb of string heap
+#ifndef SUPPORT_OBJECT_MODEL_CACHE
+# define SUPPORT_OBJECT_MODEL_CACHE	(SUPPORT_OBJECT_MODEL && (SAME70 || SAME5x))
+#endif
+
+// Object model responses can be converted to CBOR for clients that ask for them in binary, which makes them smaller to send
+#ifndef SUPPORT_BINARY_OBJECT_MODEL
+# define SUPPORT_BINARY_OBJECT_MODEL	(SUPPORT_OBJECT_MODEL && (SAME70 || SAME5x))
+#endif
+
+// Finding object model table entries using perfect hash indices built at compile time is faster than binary search, but the indices need about 2Kb of flash memory
+#ifndef USE_OBJECT_MODEL_HASH_INDEX
+# define USE_OBJECT_MODEL_HASH_INDEX	(SUPPORT_OBJECT_MODEL && (SAME70 || SAME5x))
+#endif
+
 // Optional kinematics support, to allow us to reduce flash memory usage
 #ifndef SUPPORT_LINEAR_DELTA
 # define SUPPORT_LINEAR_DELTA	1
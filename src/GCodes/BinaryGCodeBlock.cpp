@@ -0,0 +1,202 @@
+/*
+ * BinaryGCodeBlock.cpp
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#include "BinaryGCodeBlock.h"
+#include <cstring>
+#include <limits>
+
+using namespace BinaryGCode;
+
+static constexpr char HeaderSignature[4] = { 'R', 'R', 'F', 'B' };
+
+// The letter and number of decimal places of each move parameter, in the order of the bits in the tag
+static constexpr char MoveParameterLetters[] = "XYZEF";
+static constexpr uint8_t MoveParameterDecimals[] = { 3, 3, 3, 5, 1 };
+static constexpr float PowersOfTen[] = { 1.0, 1.0e1, 1.0e2, 1.0e3, 1.0e4, 1.0e5 };		// these are all exact
+
+// The largest magnitude of a scaled value that we convert to float. Smaller values are exactly representable, so dividing by a power of 10 gives
+// the correctly-rounded result, which is what ReadDecimalFloat returns when the G-code parser reads the text of the value.
+static constexpr int64_t MaxConvertedValue = (int64_t)1 << 24;
+
+// Append the decimal representation of val / 10^decimals to the buffer, omitting trailing zeros after the decimal point
+static char *_ecv_array AppendScaledValue(char *_ecv_array p, int64_t val, unsigned int decimals) noexcept
+{
+	uint64_t u;
+	if (val < 0)
+	{
+		*p++ = '-';
+		u = -(uint64_t)val;
+	}
+	else
+	{
+		u = (uint64_t)val;
+	}
+
+	// Generate the digits in reverse order, at least one more than the number of decimal places. Avoid 64-bit division when we can.
+	char digits[21];
+	size_t numDigits = 0;
+	while (u > std::numeric_limits<uint32_t>::max())
+	{
+		digits[numDigits++] = '0' + (char)(u % 10);
+		u /= 10;
+	}
+	uint32_t u32 = (uint32_t)u;
+	do
+	{
+		digits[numDigits++] = '0' + (char)(u32 % 10);
+		u32 /= 10;
+	} while (u32 != 0 || numDigits <= decimals);
+
+	size_t numZeros = 0;
+	while (numZeros < decimals && digits[numZeros] == '0')
+	{
+		++numZeros;
+	}
+
+	for (size_t i = numDigits; i > decimals; )
+	{
+		*p++ = digits[--i];
+	}
+	if (numZeros < decimals)
+	{
+		*p++ = '.';
+		for (size_t i = decimals; i > numZeros; )
+		{
+			*p++ = digits[--i];
+		}
+	}
+	return p;
+}
+
+// Return true if the data starts with a binary G-code header
+bool BinaryGCode::IsHeader(const char *_ecv_array data, size_t length) noexcept
+{
+	return length >= HeaderSize
+		&& memcmp(data, HeaderSignature, sizeof(HeaderSignature)) == 0
+		&& (uint8_t)data[4] == FormatVersion
+		&& (uint8_t)data[5] == LogBlockSize;
+}
+
+// Return the index of a move parameter letter, or -1 if it isn't one
+/*static*/ int BinaryGCodeMove::GetParameterIndex(char letter) noexcept
+{
+	const char *_ecv_array null const p = (letter != 0) ? strchr(MoveParameterLetters, letter) : nullptr;
+	return (p == nullptr) ? -1 : p - MoveParameterLetters;
+}
+
+BinaryGCodeBlockDecoder::BinaryGCodeBlockDecoder() noexcept
+	: block(nullptr), blockLength(0), recordOffset(0), nextRecordOffset(0), textOffset(0), textLength(0)
+{
+	for (int64_t& v : previousValues)
+	{
+		v = 0;
+	}
+}
+
+// Start decoding a block, resetting the previous move values
+void BinaryGCodeBlockDecoder::Init(const char *_ecv_array p_block, size_t p_blockLength, size_t startOffset) noexcept
+{
+	block = p_block;
+	blockLength = p_blockLength;
+	recordOffset = nextRecordOffset = textOffset = startOffset;
+	textLength = 0;
+	for (int64_t& v : previousValues)
+	{
+		v = 0;
+	}
+}
+
+// Decode the next record
+BinaryGCodeBlockDecoder::RecordType BinaryGCodeBlockDecoder::DecodeRecord() noexcept
+{
+	if (nextRecordOffset >= blockLength || block[nextRecordOffset] == 0)
+	{
+		return RecordType::endOfBlock;
+	}
+
+	recordOffset = nextRecordOffset;
+	const uint8_t tag = (uint8_t)block[recordOffset];
+	if ((tag & MoveTagMask) == MoveTagValue)
+	{
+		return (DecodeMove(tag)) ? RecordType::move : RecordType::bad;
+	}
+
+	if (tag != EscapedTextTag && tag >= 0x80)
+	{
+		return RecordType::bad;
+	}
+
+	textOffset = (tag == EscapedTextTag) ? recordOffset + 1 : recordOffset;
+	const char *_ecv_array null const end = (const char *_ecv_array)memchr(block + textOffset, '\n', blockLength - textOffset);
+	if (end == nullptr)
+	{
+		return RecordType::bad;
+	}
+	textLength = end + 1 - (block + textOffset);
+	nextRecordOffset = textOffset + textLength;
+	return RecordType::text;
+}
+
+// Decode a move record, generating both its text and the values of its parameters
+bool BinaryGCodeBlockDecoder::DecodeMove(uint8_t tag) noexcept
+{
+	nextRecordOffset = recordOffset + 1;
+	move.commandNumber = (tag & G1TagBit) ? 1 : 0;
+	move.parametersPresent = tag & ((1u << NumMoveParameters) - 1);
+	move.valuesConverted = 0;
+
+	char *_ecv_array p = move.text;
+	*p++ = 'G';
+	*p++ = '0' + move.commandNumber;
+	for (size_t i = 0; i < NumMoveParameters; ++i)
+	{
+		if (move.parametersPresent & (1u << i))
+		{
+			int64_t delta;
+			if (!ReadVarint(delta))
+			{
+				return false;
+			}
+			const int64_t val = previousValues[i] = (int64_t)((uint64_t)previousValues[i] + (uint64_t)delta);	// wrap around if the file is corrupt
+			*p++ = ' ';
+			move.letterOffsets[i] = p - move.text;
+			*p++ = MoveParameterLetters[i];
+			p = AppendScaledValue(p, val, MoveParameterDecimals[i]);
+			move.valueEnds[i] = p - move.text;
+			if (val <= MaxConvertedValue && val >= -MaxConvertedValue)
+			{
+				move.values[i] = (float)val / PowersOfTen[MoveParameterDecimals[i]];
+				move.valuesConverted |= 1u << i;
+			}
+		}
+	}
+	*p = 0;
+	move.textLength = p - move.text;
+	return true;
+}
+
+// Read a zigzag-encoded varint
+bool BinaryGCodeBlockDecoder::ReadVarint(int64_t& val) noexcept
+{
+	uint64_t u = 0;
+	for (unsigned int shift = 0; shift < 64; shift += 7)
+	{
+		if (nextRecordOffset >= blockLength)
+		{
+			return false;
+		}
+		const uint8_t b = (uint8_t)block[nextRecordOffset++];
+		u |= (uint64_t)(b & 0x7F) << shift;
+		if ((b & 0x80) == 0)
+		{
+			val = (int64_t)(u >> 1) ^ -(int64_t)(u & 1);
+			return true;
+		}
+	}
+	return false;
+}
+
+// End
@@ -0,0 +1,96 @@
+/*
+ * BinaryGCodeBlock.h
+ *
+ *  Created on: 16 Oct 2026
+ *
+ *  Binary G-code files are produced from ordinary G-code files by the converter in Tools/bgcode. They are typically 3 to 4 times smaller,
+ *  because G0 and G1 moves with X, Y, Z, E and F parameters are stored as differences from the previous values instead of as text.
+ *
+ *  The file starts with an 8-byte header and is divided into blocks of BlockSize bytes, the first of which includes the header.
+ *  Each block holds a sequence of records that do not cross block boundaries. A zero byte means that the rest of the block is unused.
+ *  The first byte of each record is its tag:
+ *   0x01-0x7F	a line of text, starting with the tag byte itself and ending with newline
+ *   0xA0		a line of text that starts after the tag byte and ends with newline, used when the first character isn't plain ASCII
+ *   100PPPPP	a G0 move with the parameters whose bits are set in PPPPP (bit 0 = X, then Y, Z, E, F)
+ *   110PPPPP	a G1 move, likewise
+ *  Each move parameter is stored as the signed difference from the previous value of that parameter, encoded as a zigzag varint.
+ *  Values are in units of 0.001 for X, Y and Z, 0.00001 for E and 0.1 for F. The previous values are reset to zero at the start of each block,
+ *  so that we can start decoding at the start of any block, for example when resuming a paused print.
+ *
+ *  This file decodes the records in a block. It only depends on the standard library so that it can be tested on the host (see folder Tests).
+ *  Class BinaryGCodeDecoder reads the blocks from the file.
+ */
+
+#ifndef SRC_GCODES_BINARYGCODEBLOCK_H_
+#define SRC_GCODES_BINARYGCODEBLOCK_H_
+
+#include <ecv_duet3d.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace BinaryGCode
+{
+	constexpr size_t HeaderSize = 8;
+	constexpr unsigned int LogBlockSize = 12;
+	constexpr size_t BlockSize = 1u << LogBlockSize;
+	constexpr uint8_t FormatVersion = 1;
+	constexpr size_t NumMoveParameters = 5;
+
+	constexpr uint8_t EscapedTextTag = 0xA0;
+	constexpr uint8_t MoveTagMask = 0xA0;
+	constexpr uint8_t MoveTagValue = 0x80;
+	constexpr uint8_t G1TagBit = 0x40;
+
+	bool IsHeader(const char *_ecv_array data, size_t length) noexcept;		// return true if the data starts with a binary G-code header
+}
+
+// A G0 or G1 command decoded from a move record. We provide the text of the command as well as the parameter values, because the text is needed
+// for error messages, debug output and queued commands. Values that we can't convert exactly as the G-code parser would must be parsed from the text.
+struct BinaryGCodeMove
+{
+	static constexpr size_t MaxTextLength = 2 + BinaryGCode::NumMoveParameters * 24;	// "G1" then space, letter, sign, 20 digits and point for each parameter
+
+	static int GetParameterIndex(char letter) noexcept;		// return the index of a move parameter letter, or -1 if it isn't one
+
+	char text[MaxTextLength + 1];							// the command as text, null-terminated but without a newline
+	uint8_t textLength;
+	uint8_t commandNumber;									// 0 or 1
+	uint8_t parametersPresent;								// bitmap of the parameters in the command, bit 0 = X then Y, Z, E, F
+	uint8_t valuesConverted;								// bitmap of the parameters whose values we have converted
+	uint8_t letterOffsets[BinaryGCode::NumMoveParameters];	// the index in the text of the letter of each parameter that is present
+	uint8_t valueEnds[BinaryGCode::NumMoveParameters];		// the index in the text of the character after the value of each parameter that is present
+	float values[BinaryGCode::NumMoveParameters];			// the values of the parameters whose bits are set in valuesConverted
+};
+
+// Decoder for the records in one block of a binary G-code file
+class BinaryGCodeBlockDecoder
+{
+public:
+	enum class RecordType : uint8_t { text, move, endOfBlock, bad };
+
+	BinaryGCodeBlockDecoder() noexcept;
+
+	void Init(const char *_ecv_array p_block, size_t p_blockLength, size_t startOffset) noexcept;	// start decoding a block, resetting the previous move values
+	RecordType DecodeRecord() noexcept;						// decode the next record
+
+	size_t GetRecordOffset() const noexcept { return recordOffset; }
+	size_t GetNextRecordOffset() const noexcept { return nextRecordOffset; }
+	size_t GetTextOffset() const noexcept { return textOffset; }	// for text records, the offset in the block of the text
+	size_t GetTextLength() const noexcept { return textLength; }	// for text records, the length of the text including the newline
+	const BinaryGCodeMove& GetMove() const noexcept { return move; }
+
+private:
+	bool DecodeMove(uint8_t tag) noexcept;
+	bool ReadVarint(int64_t& val) noexcept;
+
+	const char *_ecv_array null block;
+	size_t blockLength;
+	size_t recordOffset;
+	size_t nextRecordOffset;
+	size_t textOffset;
+	size_t textLength;
+	int64_t previousValues[BinaryGCode::NumMoveParameters];
+	BinaryGCodeMove move;
+};
+
+#endif /* SRC_GCODES_BINARYGCODEBLOCK_H_ */
@@ -0,0 +1,167 @@
+/*
+ * BinaryGCodeDecoder.cpp
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#include "BinaryGCodeDecoder.h"
+
+#if SUPPORT_BINARY_GCODE
+
+#include "GCodeInput.h"
+
+using namespace BinaryGCode;
+
+BinaryGCodeDecoder::BinaryGCodeDecoder() noexcept
+	: block(nullptr), blockPosition(0), blockLength(0), textLength(0), textUsed(0), isMove(false), moveUsed(false)
+{
+}
+
+// Return true if the file has a binary G-code header, leaving the file position unchanged.
+// We only need this when we start printing a file before the file information parser has read its header.
+/*static*/ bool BinaryGCodeDecoder::CheckHeader(FileData& file) noexcept
+{
+	const FilePosition pos = file.GetPosition();
+	char header[HeaderSize];
+	const bool ok = file.Seek(0) && file.Read(header, HeaderSize) == (int)HeaderSize && IsHeader(header, HeaderSize);
+	(void)file.Seek(pos);
+	return ok;
+}
+
+// Start decoding the file from its current position. Because the move parameters are differences from previous values,
+// we start decoding at the start of the block and skip the records that come before the position we want.
+bool BinaryGCodeDecoder::Start(const FileData& file) noexcept
+{
+	decodingFile.CopyFrom(file);
+	if (block == nullptr)
+	{
+		block = new char[BlockSize];
+	}
+
+	const FilePosition target = max<FilePosition>(decodingFile.GetPosition(), HeaderSize);
+	if (!LoadBlock(target & ~(FilePosition)(BlockSize - 1)))
+	{
+		Stop();
+		return false;
+	}
+
+	while (blockPosition + blockDecoder.GetNextRecordOffset() < target)
+	{
+		switch (blockDecoder.DecodeRecord())
+		{
+		case BinaryGCodeBlockDecoder::RecordType::endOfBlock:
+			return true;
+
+		case BinaryGCodeBlockDecoder::RecordType::bad:
+			Stop();
+			return false;
+
+		case BinaryGCodeBlockDecoder::RecordType::move:
+			isMove = moveUsed = true;
+			break;
+
+		case BinaryGCodeBlockDecoder::RecordType::text:
+			isMove = false;
+			textLength = blockDecoder.GetTextLength();
+			{
+				const FilePosition textPosition = blockPosition + blockDecoder.GetTextOffset();
+				if (target < textPosition + textLength)
+				{
+					// The position is within this line of text, so we resume from there
+					textUsed = (target > textPosition) ? target - textPosition : 0;
+					return true;
+				}
+			}
+			textUsed = textLength;
+			break;
+		}
+	}
+	return true;
+}
+
+// Stop decoding and release the file
+void BinaryGCodeDecoder::Stop() noexcept
+{
+	decodingFile.Close();
+	textLength = textUsed = 0;
+	isMove = false;
+}
+
+// Decode the next record, moving on to the next block if necessary
+GCodeInputReadResult BinaryGCodeDecoder::DecodeRecord() noexcept
+{
+	for (;;)
+	{
+		switch (blockDecoder.DecodeRecord())
+		{
+		case BinaryGCodeBlockDecoder::RecordType::move:
+			isMove = true;
+			moveUsed = false;
+			return GCodeInputReadResult::haveData;
+
+		case BinaryGCodeBlockDecoder::RecordType::text:
+			isMove = false;
+			textLength = blockDecoder.GetTextLength();
+			textUsed = 0;
+			return GCodeInputReadResult::haveData;
+
+		case BinaryGCodeBlockDecoder::RecordType::bad:
+			return GCodeInputReadResult::error;
+
+		case BinaryGCodeBlockDecoder::RecordType::endOfBlock:
+			if (blockLength < BlockSize)
+			{
+				return GCodeInputReadResult::noData;				// we have reached the end of the last block
+			}
+			if (!LoadBlock(blockPosition + BlockSize))
+			{
+				return GCodeInputReadResult::error;
+			}
+			break;
+		}
+	}
+}
+
+// Get the text of the current text record that we haven't passed on
+const char *_ecv_array BinaryGCodeDecoder::GetUnusedText(size_t& length) const noexcept
+{
+	length = textLength - textUsed;
+	return block + blockDecoder.GetTextOffset() + textUsed;
+}
+
+// Get the file position of the text that is 'numCharsBack' characters before the end of the text we have used.
+// A move record maps to its start until it has been used, and to the start of the next record after that.
+FilePosition BinaryGCodeDecoder::GetPosition(size_t numCharsBack) const noexcept
+{
+	if (isMove)
+	{
+		return blockPosition + ((moveUsed && numCharsBack == 0) ? blockDecoder.GetNextRecordOffset() : blockDecoder.GetRecordOffset());
+	}
+	const size_t numCharsUsed = (textUsed > numCharsBack) ? textUsed - numCharsBack : 0;
+	return blockPosition + blockDecoder.GetTextOffset() + numCharsUsed;
+}
+
+// Read the block at the specified file position
+bool BinaryGCodeDecoder::LoadBlock(FilePosition pos) noexcept
+{
+	if (decodingFile.GetPosition() != pos && !decodingFile.Seek(pos))
+	{
+		return false;
+	}
+	const int bytesRead = decodingFile.Read(block, BlockSize);
+	if (bytesRead < 0)
+	{
+		return false;
+	}
+
+	blockPosition = pos;
+	blockLength = (size_t)bytesRead;
+	blockDecoder.Init(block, blockLength, (pos == 0) ? HeaderSize : 0);
+	textLength = textUsed = 0;
+	isMove = false;
+	return true;
+}
+
+#endif
+
+// End
@@ -0,0 +1,61 @@
+/*
+ * BinaryGCodeDecoder.h
+ *
+ *  Created on: 16 Oct 2026
+ *
+ *  This class reads a binary G-code file one block at a time and decodes its records. See BinaryGCodeBlock.h for a description of the format.
+ *  Text records are passed on as text. Move records are passed on as decoded commands, so that the G-code parser doesn't need to parse them.
+ */
+
+#ifndef SRC_GCODES_BINARYGCODEDECODER_H_
+#define SRC_GCODES_BINARYGCODEDECODER_H_
+
+#include <RepRapFirmware.h>
+
+#if SUPPORT_BINARY_GCODE
+
+#include "BinaryGCodeBlock.h"
+#include <Storage/FileData.h>
+
+enum class GCodeInputReadResult : uint8_t;
+
+class BinaryGCodeDecoder
+{
+public:
+	BinaryGCodeDecoder() noexcept;
+
+	static bool CheckHeader(FileData& file) noexcept;				// return true if the file has a binary G-code header, leaving the file position unchanged
+
+	bool IsDecoding(const FileData& file) const noexcept { return decodingFile.IsLive() && decodingFile == file; }
+	bool Start(const FileData& file) noexcept;						// start decoding the file from its current position, returning false if we failed to read it
+	void Stop() noexcept;											// stop decoding and release the file
+
+	GCodeInputReadResult DecodeRecord() noexcept;					// decode the next record, moving on to the next block if necessary
+
+	bool HaveUnusedText() const noexcept { return textUsed < textLength; }
+	const char *_ecv_array GetUnusedText(size_t& length) const noexcept;	// get the text of the current text record that we haven't passed on
+	void UseText(size_t numChars) noexcept { textUsed += numChars; }
+
+	bool HaveUnusedMove() const noexcept { return isMove && !moveUsed; }
+	const BinaryGCodeMove& GetMove() const noexcept { return blockDecoder.GetMove(); }
+	void UseMove() noexcept { moveUsed = true; }
+
+	FilePosition GetPosition(size_t numCharsBack) const noexcept;	// get the file position of the text that is 'numCharsBack' characters before the end of the text we have used
+
+private:
+	bool LoadBlock(FilePosition pos) noexcept;
+
+	FileData decodingFile;											// our own reference to the file we are decoding
+	char *block;													// the block we are decoding, allocated when we first decode a file
+	FilePosition blockPosition;										// the file position of the start of the block
+	size_t blockLength;												// how many bytes of the block we read, less than BlockSize only for the last block in the file
+	BinaryGCodeBlockDecoder blockDecoder;
+	size_t textLength;												// for text records, the length of the text
+	size_t textUsed;												// for text records, how many characters of the text have been passed on
+	bool isMove;													// true if the current record is a move
+	bool moveUsed;													// for move records, true if the move has been passed on
+};
+
+#endif
+
+#endif /* SRC_GCODES_BINARYGCODEDECODER_H_ */
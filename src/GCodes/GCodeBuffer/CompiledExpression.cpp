@@ -0,0 +1,193 @@
+/*
+ * CompiledExpression.cpp
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#include "CompiledExpression.h"
+
+#if SUPPORT_COMPILED_EXPRESSIONS
+
+#include <Platform/RepRap.h>
+#include <Platform/Platform.h>
+#include <RTOSIface/RTOSIface.h>
+
+void CompiledExpression::EmitOp(ExpressionOp op, int stackChange) noexcept
+{
+	EmitByte((uint8_t)op);
+	const int newDepth = (int)stackDepth + stackChange;
+	if (newDepth < 0 || newDepth > (int)MaxStackDepth)
+	{
+		overflowed = true;
+	}
+	else
+	{
+		stackDepth = (uint8_t)newDepth;
+	}
+}
+
+void CompiledExpression::EmitBytes(const void *p, size_t len) noexcept
+{
+	if (codeLength + len > MaxCodeLength)
+	{
+		overflowed = true;
+	}
+	else
+	{
+		memcpy(code + codeLength, p, len);
+		codeLength += len;
+	}
+}
+
+size_t CompiledExpression::EmitJump(ExpressionOp op, int stackChange) noexcept
+{
+	EmitOp(op, stackChange);
+	const size_t where = codeLength;
+	const uint16_t dummy = 0;
+	EmitBytes(&dummy, sizeof(dummy));
+	return where;
+}
+
+void CompiledExpression::PatchJump(size_t where) noexcept
+{
+	if (where + sizeof(uint16_t) <= codeLength)
+	{
+		const uint16_t target = codeLength;
+		memcpy(code + where, &target, sizeof(target));
+	}
+}
+
+int32_t CompiledExpression::GetInt32(size_t& pc) const noexcept
+{
+	int32_t rslt;
+	memcpy(&rslt, code + pc, sizeof(rslt));
+	pc += sizeof(rslt);
+	return rslt;
+}
+
+float CompiledExpression::GetFloat(size_t& pc) const noexcept
+{
+	float rslt;
+	memcpy(&rslt, code + pc, sizeof(rslt));
+	pc += sizeof(rslt);
+	return rslt;
+}
+
+uint16_t CompiledExpression::GetAddress(size_t& pc) const noexcept
+{
+	uint16_t rslt;
+	memcpy(&rslt, code + pc, sizeof(rslt));
+	pc += sizeof(rslt);
+	return rslt;
+}
+
+const char *CompiledExpression::GetString(size_t& pc) const noexcept
+{
+	const char * const rslt = (const char *)(code + pc);
+	pc += strlen(rslt) + 1;
+	return rslt;
+}
+
+const void *CompiledExpression::GetPointer(size_t& pc) const noexcept
+{
+	const void *rslt;
+	memcpy(&rslt, code + pc, sizeof(rslt));
+	pc += sizeof(rslt);
+	return rslt;
+}
+
+// Static data
+CompiledExpressionCache::Entry CompiledExpressionCache::entries[NumCompiledExpressionCacheEntries];
+uint32_t CompiledExpressionCache::numHits = 0;
+uint32_t CompiledExpressionCache::numMisses = 0;
+uint32_t CompiledExpressionCache::numNotCompilable = 0;
+uint32_t CompiledExpressionCache::numFailures = 0;
+
+// FNV-1a hash of the text and its length
+/*static*/ uint32_t CompiledExpressionCache::Hash(const char *text, size_t length) noexcept
+{
+	uint32_t hash = InitialHash;
+	for (size_t i = 0; i < length; ++i)
+	{
+		hash = AddToHash(hash, text[i]);
+	}
+	return hash ^ length;
+}
+
+// Check whether a cache entry matches the text. The caller has already checked the hash.
+// An entry matches if the text of the expression and the character that terminated it are the same, because nothing else affects how it was parsed.
+/*static*/ bool CompiledExpressionCache::Matches(const Entry& e, const char *text, size_t available) noexcept
+{
+	const size_t textLength = e.keyLength - 1;
+	return textLength <= available
+		&& memcmp(e.key, text, textLength) == 0
+		&& e.key[textLength] == ((textLength < available) ? text[textLength] : 0);
+}
+
+// Look for a compiled expression that starts at 'text'. If we find it, copy it to 'ce'.
+// We don't know how long the expression is until we have parsed it, so we look for an entry keyed by each possible length of it in turn.
+// Until we find a candidate each probe only compares a stored hash, which is much cheaper than parsing the expression.
+/*static*/ CompiledExpressionCache::LookupResult CompiledExpressionCache::Lookup(const char *text, const char *textLimit, CompiledExpression& ce) noexcept
+{
+	const size_t available = textLimit - text;
+	const size_t maxLength = min<size_t>(available, CompiledExpression::MaxTextLength);
+	uint32_t partialHash = InitialHash;
+
+	TaskCriticalSectionLocker lock;
+	for (size_t length = 1; length <= maxLength; ++length)
+	{
+		partialHash = AddToHash(partialHash, text[length - 1]);
+		const uint32_t hash = partialHash ^ length;
+		const Entry& e = entries[hash % NumCompiledExpressionCacheEntries];
+		if (e.isValid && e.hash == hash && e.keyLength == length + 1 && Matches(e, text, available))
+		{
+			if (e.isCompilable)
+			{
+				++numHits;
+				ce = e.compiled;
+				return LookupResult::found;
+			}
+			++numNotCompilable;
+			return LookupResult::notCompilable;
+		}
+	}
+	++numMisses;
+	return LookupResult::notFound;
+}
+
+// Store the result of compiling the expression that starts at 'text' and occupies 'textLength' characters, replacing any other entry in the same slot.
+// If the expression could not be compiled then 'textLength' is the number of characters we parsed before we gave up.
+/*static*/ void CompiledExpressionCache::Store(const char *text, size_t textLength, const char *textLimit, const CompiledExpression *ce) noexcept
+{
+	const size_t available = textLimit - text;
+	textLength = min<size_t>(textLength, min<size_t>(available, CompiledExpression::MaxTextLength));
+	if (textLength == 0)
+	{
+		return;
+	}
+
+	const uint32_t hash = Hash(text, textLength);
+	Entry& e = entries[hash % NumCompiledExpressionCacheEntries];
+
+	TaskCriticalSectionLocker lock;
+	e.hash = hash;
+	memcpy(e.key, text, textLength);
+	e.key[textLength] = (textLength < available) ? text[textLength] : 0;
+	e.keyLength = textLength + 1;
+	e.isCompilable = (ce != nullptr);
+	if (ce != nullptr)
+	{
+		e.compiled = *ce;
+	}
+	e.isValid = true;
+}
+
+/*static*/ void CompiledExpressionCache::Diagnostics(MessageType mtype) noexcept
+{
+	reprap.GetPlatform().MessageF(mtype, "Expression cache hits %" PRIu32 ", misses %" PRIu32 ", not compilable %" PRIu32 ", failures %" PRIu32 "\n",
+									numHits, numMisses, numNotCompilable, numFailures);
+}
+
+#endif
+
+// End
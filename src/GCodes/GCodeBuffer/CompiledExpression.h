@@ -0,0 +1,124 @@
+/*
+ * CompiledExpression.h
+ *
+ *  Created on: 16 Oct 2026
+ *
+ *  A CompiledExpression holds an expression that has been converted to a simple stack-based byte code, so that when a macro or job file evaluates
+ *  the same expression repeatedly (e.g. inside a loop) we don't need to parse it again. Class ExpressionParser compiles and executes it.
+ *  Class CompiledExpressionCache holds recently-compiled expressions, indexed by the text they were compiled from.
+ */
+
+#ifndef SRC_GCODES_GCODEBUFFER_COMPILEDEXPRESSION_H_
+#define SRC_GCODES_GCODEBUFFER_COMPILEDEXPRESSION_H_
+
+#include <RepRapFirmware.h>
+
+#if SUPPORT_COMPILED_EXPRESSIONS
+
+// Byte code instructions. Jump addresses are absolute 16-bit offsets into the code. Multi-byte operands are not aligned.
+enum class ExpressionOp : uint8_t
+{
+	pushInt,				// followed by int32_t value
+	pushFloat,				// followed by float value and uint8_t number of decimal digits
+	pushString,				// followed by null-terminated string
+	pushConstant,			// followed by uint8_t NamedConstant value
+	unaryOperator,			// followed by operator character, applied to the top of the stack
+	binaryOperator,			// followed by operator character and uint8_t invert flag, applied to the top two stack entries
+	unaryFunction,			// followed by uint8_t Function value, applied to the top of the stack
+	binaryFunction,			// followed by uint8_t Function value, applied to the top two stack entries
+	pushBool,				// followed by uint8_t value
+	parameter,				// followed by uint8_t flags, uint8_t number of indices to pop and null-terminated name without the "param." prefix; pushes the value
+	localVariable,			// followed by uint8_t flags, uint8_t number of indices to pop and null-terminated name without the "var." prefix; pushes the value
+	globalVariable,			// followed by uint8_t flags, uint8_t number of indices to pop and null-terminated name without the "global." prefix; pushes the value
+	objectModel,			// followed by uint8_t flags, uint8_t number of indices to pop and null-terminated path; pushes the value
+	objectModelEntry,		// followed by uint8_t flags, uint8_t number of indices to pop, class descriptor pointer, table entry pointer for the first element of the path,
+							// uint8_t offset of the rest of the path and null-terminated path; pushes the value
+	toBool,					// check that the top of the stack is Boolean
+	andJump,				// if the top of the stack is false then jump, else pop it
+	orJump,					// if the top of the stack is true then jump, else pop it
+	jumpIfFalse,			// pop the top of the stack and jump if it is false
+	jump,					// unconditional jump
+};
+
+class CompiledExpression
+{
+public:
+	static constexpr size_t MaxCodeLength = 100;
+	static constexpr size_t MaxTextLength = 96;			// the maximum length of expression text that we compile
+	static constexpr size_t MaxStackDepth = 8;
+
+	// Flags that follow the parameter, variable and object model opcodes
+	static constexpr uint8_t FlagWantLength = 0x01;
+	static constexpr uint8_t FlagWantExists = 0x02;
+
+	CompiledExpression() noexcept : codeLength(0), textLength(0), stackDepth(0), overflowed(false) { }
+
+	size_t GetTextLength() const noexcept { return textLength; }
+	void SetTextLength(size_t len) noexcept { textLength = len; }
+	bool IsComplete() const noexcept { return !overflowed && stackDepth == 1; }
+
+	// Functions used when compiling
+	void EmitOp(ExpressionOp op, int stackChange) noexcept;
+	void EmitByte(uint8_t b) noexcept { EmitBytes(&b, sizeof(b)); }
+	void EmitBytes(const void *p, size_t len) noexcept;
+	void EmitString(const char *s) noexcept { EmitBytes(s, strlen(s) + 1); }
+	void EmitPointer(const void *p) noexcept { EmitBytes(&p, sizeof(p)); }
+	size_t EmitJump(ExpressionOp op, int stackChange) noexcept;		// emit a jump with a target address to be patched later, returning where the address is
+	void PatchJump(size_t where) noexcept;								// set the target of a jump to the current address
+	size_t GetStackDepth() const noexcept { return stackDepth; }
+	void SetStackDepth(size_t d) noexcept { stackDepth = d; }
+
+	// Functions used when executing
+	size_t GetCodeLength() const noexcept { return codeLength; }
+	uint8_t GetByte(size_t& pc) const noexcept { return code[pc++]; }
+	int32_t GetInt32(size_t& pc) const noexcept;
+	float GetFloat(size_t& pc) const noexcept;
+	uint16_t GetAddress(size_t& pc) const noexcept;
+	const char *GetString(size_t& pc) const noexcept;
+	const void *GetPointer(size_t& pc) const noexcept;
+	bool IsInCode(const char *p) const noexcept { return p >= (const char *)code && p < (const char *)code + codeLength; }
+
+private:
+	uint8_t code[MaxCodeLength];
+	uint8_t codeLength;
+	uint8_t textLength;
+	uint8_t stackDepth;
+	bool overflowed;
+};
+
+// Cache of recently-compiled expressions. Expressions that could not be compiled are cached too, so that we don't keep trying to compile them.
+class CompiledExpressionCache
+{
+public:
+	enum class LookupResult : uint8_t { notFound, notCompilable, found };
+
+	static LookupResult Lookup(const char *text, const char *textLimit, CompiledExpression& ce) noexcept;
+	static void Store(const char *text, size_t textLength, const char *textLimit, const CompiledExpression *ce) noexcept;	// pass nullptr if the expression could not be compiled
+	static void NoteExecutionFailure() noexcept { ++numFailures; }
+	static void Diagnostics(MessageType mtype) noexcept;
+
+private:
+	static constexpr size_t MaxKeyLength = CompiledExpression::MaxTextLength + 1;
+
+	struct Entry
+	{
+		uint32_t hash;
+		uint8_t keyLength;
+		bool isValid;
+		bool isCompilable;
+		char key[MaxKeyLength];										// the expression text and the character that follows it
+		CompiledExpression compiled;
+	};
+
+	static constexpr uint32_t InitialHash = 2166136261u;
+	static uint32_t AddToHash(uint32_t hash, char c) noexcept { return (hash ^ (uint8_t)c) * 16777619u; }
+	static uint32_t Hash(const char *text, size_t length) noexcept;
+	static bool Matches(const Entry& e, const char *text, size_t available) noexcept;
+
+	static Entry entries[NumCompiledExpressionCacheEntries];
+	static uint32_t numHits, numMisses, numNotCompilable, numFailures;
+};
+
+#endif
+
+#endif /* SRC_GCODES_GCODEBUFFER_COMPILEDEXPRESSION_H_ */
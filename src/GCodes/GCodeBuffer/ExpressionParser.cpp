@@ -8,6 +8,7 @@
 #include "ExpressionParser.h"
 
 #include "GCodeBuffer.h"
+#include "CompiledExpression.h"
 #include <Platform/RepRap.h>
 #include <Platform/Platform.h>
 #include <General/NamedEnum.h>
@@ -21,6 +22,7 @@
 #endif
 
 constexpr size_t MaxStringExpressionLength = StringLength100;
+constexpr uint8_t UnaryPriority = 10;									// must be higher than any binary operator priority
 
 namespace StackUsage
 {
@@ -59,7 +61,12 @@ ExpressionValue ExpressionParser::Parse(bool evaluate) THROWS(GCodeException)
 {
 	obsoleteField.Clear();
 	ExpressionValue result;
-	ParseInternal(result, evaluate, 0);
+#if SUPPORT_COMPILED_EXPRESSIONS
+	if (!evaluate || !EvaluateCompiled(result))
+#endif
+	{
+		ParseInternal(result, evaluate, 0);
+	}
 	if (!obsoleteField.IsEmpty())
 	{
 		reprap.GetPlatform().MessageF(WarningMessage, "obsolete object model field %s queried\n", obsoleteField.c_str());
@@ -71,12 +78,6 @@ ExpressionValue ExpressionParser::Parse(bool evaluate) THROWS(GCodeException)
 // This is recursive, so avoid allocating large amounts of data on the stack
 void ExpressionParser::ParseInternal(ExpressionValue& val, bool evaluate, uint8_t priority) THROWS(GCodeException)
 {
-	// Lists of binary operators and their priorities
-	static constexpr const char *operators = "?^&|!=<>+-*/";				// for multi-character operators <= and >= and != this is the first character
-	static constexpr uint8_t priorities[] = { 1, 2, 3, 3, 4, 4, 4, 4, 5, 5, 6, 6 };
-	constexpr uint8_t UnaryPriority = 10;									// must be higher than any binary operator priority
-	static_assert(ARRAY_SIZE(priorities) == strlen(operators));
-
 	// Start by looking for a unary operator or opening bracket
 	SkipWhiteSpace();
 	const char c = CurrentCharacter();
@@ -87,48 +88,12 @@ void ExpressionParser::ParseInternal(ExpressionValue& val, bool evaluate, uint8_
 		break;
 
 	case '-':
-		AdvancePointer();
-		CheckStack(StackUsage::ParseInternal);
-		ParseInternal(val, evaluate, UnaryPriority);
-		switch (val.GetType())
-		{
-		case TypeCode::Int32:
-			val.iVal = -val.iVal;		//TODO overflow check
-			break;
-
-		case TypeCode::Float:
-			val.fVal = -val.fVal;
-			break;
-
-		default:
-			ThrowParseException("expected numeric value after '-'");
-		}
-		break;
-
 	case '+':
+	case '!':
 		AdvancePointer();
 		CheckStack(StackUsage::ParseInternal);
 		ParseInternal(val, evaluate, UnaryPriority);
-		switch (val.GetType())
-		{
-		case TypeCode::Uint32:
-			// Convert enumeration to integer
-			val.iVal = (int32_t)val.uVal;
-			val.SetType(TypeCode::Int32);
-			break;
-
-		case TypeCode::Int32:
-		case TypeCode::Float:
-			break;
-
-		case TypeCode::DateTime_tc:					// unary + converts a DateTime to a seconds count
-			val.iVal = (uint32_t)val.Get56BitValue();
-			val.SetType(TypeCode::Int32);
-			break;
-
-		default:
-			ThrowParseException("expected numeric or enumeration value after '+'");
-		}
+		ApplyUnaryOperator(c, val, evaluate);
 		break;
 
 	case '#':
@@ -144,18 +109,7 @@ void ExpressionParser::ParseInternal(ExpressionValue& val, bool evaluate, uint8_
 		{
 			CheckStack(StackUsage::ParseInternal);
 			ParseInternal(val, evaluate, UnaryPriority);
-			if (val.GetType() == TypeCode::CString)
-			{
-				val.Set((int32_t)strlen(val.sVal));
-			}
-			else if (val.GetType() == TypeCode::HeapString)
-			{
-				val.Set((int32_t)val.shVal.GetLength());
-			}
-			else
-			{
-				ThrowParseException("expected object model value or string after '#");
-			}
+			ApplyUnaryOperator(c, val, evaluate);
 		}
 		break;
 
@@ -169,14 +123,6 @@ void ExpressionParser::ParseInternal(ExpressionValue& val, bool evaluate, uint8_
 		ParseExpectKet(val, evaluate, ')');
 		break;
 
-	case '!':
-		AdvancePointer();
-		CheckStack(StackUsage::ParseInternal);
-		ParseInternal(val, evaluate, UnaryPriority);
-		ConvertToBool(val, evaluate);
-		val.bVal = !val.bVal;
-		break;
-
 	default:
 		if (isdigit(c))						// looks like a number
 		{
@@ -195,54 +141,11 @@ void ExpressionParser::ParseInternal(ExpressionValue& val, bool evaluate, uint8_
 	}
 
 	// See if it is followed by a binary operator
-	do
+	char opChar;
+	bool invert;
+	uint8_t opPrio;
+	while (ParseBinaryOperator(priority, opChar, invert, opPrio))
 	{
-		SkipWhiteSpace();
-		char opChar = CurrentCharacter();
-		if (opChar == 0)	// don't pass null to strchr
-		{
-			return;
-		}
-
-		const char * const q = strchr(operators, opChar);
-		if (q == nullptr)
-		{
-			return;
-		}
-		const size_t index = q - operators;
-		const uint8_t opPrio = priorities[index];
-		if (opPrio <= priority)
-		{
-			return;
-		}
-
-		AdvancePointer();								// skip the [first] operator character
-
-		// Handle >= and <= and !=
-		bool invert = false;
-		if (opChar == '!')
-		{
-			if (CurrentCharacter() != '=')
-			{
-				ThrowParseException("expected '='");
-			}
-			invert = true;
-			AdvancePointer();
-			opChar = '=';
-		}
-		else if ((opChar == '>' || opChar == '<') && CurrentCharacter() == '=')
-		{
-			invert = true;
-			AdvancePointer();
-			opChar ^= ('>' ^ '<');			// change < to > or vice versa
-		}
-
-		// Allow == && || as alternatives to = & |
-		if ((opChar == '=' || opChar == '&' || opChar == '|') && CurrentCharacter() == opChar)
-		{
-			AdvancePointer();
-		}
-
 		// Handle operators that do not always evaluate their second operand
 		switch (opChar)
 		{
@@ -297,303 +200,437 @@ void ExpressionParser::ParseInternal(ExpressionValue& val, bool evaluate, uint8_
 				ExpressionValue val2;
 				CheckStack(StackUsage::ParseInternal);
 				ParseInternal(val2, evaluate, opPrio);	// get the next operand
-				switch(opChar)
-				{
-				case '+':
-					if (val.GetType() == TypeCode::DateTime_tc)
-					{
-						if (val2.GetType() == TypeCode::Uint32)
-						{
-							val.Set56BitValue(val.Get56BitValue() + val2.uVal);
-						}
-						else if (val2.GetType() == TypeCode::Int32)
-						{
-							val.Set56BitValue((int64_t)val.Get56BitValue() + val2.iVal);
-						}
-						else if (evaluate)
-						{
-							ThrowParseException("invalid operand types");
-						}
-					}
-					else
-					{
-						BalanceNumericTypes(val, val2, evaluate);
-						if (val.GetType() == TypeCode::Float)
-						{
-							val.fVal += val2.fVal;
-							val.param = max(val.param, val2.param);
-						}
-						else
-						{
-							val.iVal += val2.iVal;
-						}
-					}
-					break;
-
-				case '-':
-					if (val.GetType() == TypeCode::DateTime_tc)
-					{
-						if (val2.GetType() == TypeCode::DateTime_tc)
-						{
-							// Difference of two data/times
-							val.SetType(TypeCode::Int32);
-							val.iVal = (int32_t)(val.Get56BitValue() - val2.Get56BitValue());
-						}
-						else if (val2.GetType() == TypeCode::Uint32)
-						{
-							val.Set56BitValue(val.Get56BitValue() - val2.uVal);
-						}
-						else if (val2.GetType() == TypeCode::Int32)
-						{
-							val.Set56BitValue((int64_t)val.Get56BitValue() - val2.iVal);
-						}
-						else if (evaluate)
-						{
-							ThrowParseException("invalid operand types");
-						}
-					}
-					else
-					{
-						BalanceNumericTypes(val, val2, evaluate);
-						if (val.GetType() == TypeCode::Float)
-						{
-							val.fVal -= val2.fVal;
-							val.param = max(val.param, val2.param);
-						}
-						else
-						{
-							val.iVal -= val2.iVal;
-						}
-					}
-					break;
-
-				case '*':
-					BalanceNumericTypes(val, val2, evaluate);
-					if (val.GetType() == TypeCode::Float)
-					{
-						val.fVal *= val2.fVal;
-						val.param = max(val.param, val2.param);
-					}
-					else
-					{
-						val.iVal *= val2.iVal;
-					}
-					break;
-
-				case '/':
-					ConvertToFloat(val, evaluate);
-					ConvertToFloat(val2, evaluate);
-					val.fVal /= val2.fVal;
-					val.param = MaxFloatDigitsDisplayedAfterPoint;
-					break;
-
-				case '>':
-					BalanceTypes(val, val2, evaluate);
-					switch (val.GetType())
-					{
-					case TypeCode::Int32:
-						val.bVal = (val.iVal > val2.iVal);
-						break;
-
-					case TypeCode::Float:
-						val.bVal = (val.fVal > val2.fVal);
-						break;
-
-					case TypeCode::DateTime_tc:
-						val.bVal = val.Get56BitValue() > val2.Get56BitValue();
-						break;
-
-					case TypeCode::Bool:
-						val.bVal = (val.bVal && !val2.bVal);
-						break;
-
-					default:
-						if (evaluate)
-						{
-							ThrowParseException("expected numeric or Boolean operands to comparison operator");
-						}
-						val.bVal = false;
-						break;
-					}
-					val.SetType(TypeCode::Bool);
-					if (invert)
-					{
-						val.bVal = !val.bVal;
-					}
-					break;
-
-				case '<':
-					BalanceTypes(val, val2, evaluate);
-					switch (val.GetType())
-					{
-					case TypeCode::Int32:
-						val.bVal = (val.iVal < val2.iVal);
-						break;
-
-					case TypeCode::Float:
-						val.bVal = (val.fVal < val2.fVal);
-						break;
-
-					case TypeCode::DateTime_tc:
-						val.bVal = val.Get56BitValue() < val2.Get56BitValue();
-						break;
-
-					case TypeCode::Bool:
-						val.bVal = (!val.bVal && val2.bVal);
-						break;
-
-					default:
-						if (evaluate)
-						{
-							ThrowParseException("expected numeric or Boolean operands to comparison operator");
-						}
-						val.bVal = false;
-						break;
-					}
-					val.SetType(TypeCode::Bool);
-					if (invert)
-					{
-						val.bVal = !val.bVal;
-					}
-					break;
-
-				case '=':
-					// Before balancing, handle comparisons with null
-					if (val.GetType() == TypeCode::None)
-					{
-						val.bVal = (val2.GetType() == TypeCode::None);
-					}
-					else if (val2.GetType() == TypeCode::None)
-					{
-						val.bVal = false;
-					}
-					else
-					{
-						BalanceTypes(val, val2, evaluate);
-						switch (val.GetType())
-						{
-						case TypeCode::ObjectModel_tc:
-							ThrowParseException("cannot compare objects");
-
-						case TypeCode::Int32:
-							val.bVal = (val.iVal == val2.iVal);
-							break;
-
-						case TypeCode::Uint32:
-							val.bVal = (val.uVal == val2.uVal);
-							break;
-
-						case TypeCode::Float:
-							val.bVal = (val.fVal == val2.fVal);
-							break;
-
-						case TypeCode::DateTime_tc:
-							val.bVal = val.Get56BitValue() == val2.Get56BitValue();
-							break;
-
-						case TypeCode::Bool:
-							val.bVal = (val.bVal == val2.bVal);
-							break;
-
-						case TypeCode::CString:
-							val.bVal = (strcmp(val.sVal, (val2.GetType() == TypeCode::HeapString) ? val2.shVal.Get().Ptr() : val2.sVal) == 0);
-							break;
-
-						case TypeCode::HeapString:
-							val.bVal = (strcmp(val.shVal.Get().Ptr(), (val2.GetType() == TypeCode::HeapString) ? val2.shVal.Get().Ptr() : val2.sVal) == 0);
-							break;
-
-						default:
-							if (evaluate)
-							{
-								ThrowParseException("unexpected operand type to equality operator");
-							}
-							val.bVal = false;
-							break;
-						}
-					}
-					val.SetType(TypeCode::Bool);
-					if (invert)
-					{
-						val.bVal = !val.bVal;
-					}
-					break;
-
-				case '^':
-					StringConcat(val, val2);
-					break;
-				}
+				ApplyBinaryOperator(opChar, invert, val, val2, evaluate);
 			}
+			break;
 		}
-	} while (true);
-}
-
-// Concatenate val1 and val2 and assign the result to val1
-// This is written as a separate function because it needs a temporary string buffer, and its caller is recursive. Its declaration must be declared 'noinline'.
-/*static*/ void  ExpressionParser::StringConcat(ExpressionValue &val, ExpressionValue &val2) noexcept
-{
-    String<MaxStringExpressionLength> str;
-    val.AppendAsString(str.GetRef());
-    val2.AppendAsString(str.GetRef());
-    StringHandle sh(str.c_str());
-    val.Set(sh);
+	}
 }
 
-bool ExpressionParser::ParseBoolean() THROWS(GCodeException)
+// Check whether the next token is a binary operator with priority higher than 'priority'.
+// If it is then skip it and return true with its details, else leave the read pointer at the token and return false.
+// Multi-character operators >= and <= and != are returned as the inverse of < and > and = respectively.
+bool ExpressionParser::ParseBinaryOperator(uint8_t priority, char& opChar, bool& invert, uint8_t& opPrio) THROWS(GCodeException)
 {
-	ExpressionValue val = Parse();
-	ConvertToBool(val, true);
-	return val.bVal;
-}
+	// Lists of binary operators and their priorities
+	static constexpr const char *operators = "?^&|!=<>+-*/";				// for multi-character operators <= and >= and != this is the first character
+	static constexpr uint8_t priorities[] = { 1, 2, 3, 3, 4, 4, 4, 4, 5, 5, 6, 6 };
+	static_assert(ARRAY_SIZE(priorities) == strlen(operators));
 
-float ExpressionParser::ParseFloat() THROWS(GCodeException)
-{
-	ExpressionValue val = Parse();
-	ConvertToFloat(val, true);
-	return val.fVal;
-}
+	SkipWhiteSpace();
+	opChar = CurrentCharacter();
+	if (opChar == 0)	// don't pass null to strchr
+	{
+		return false;
+	}
 
-int32_t ExpressionParser::ParseInteger() THROWS(GCodeException)
-{
-	ExpressionValue val = Parse();
-	switch (val.GetType())
+	const char * const q = strchr(operators, opChar);
+	if (q == nullptr)
 	{
-	case TypeCode::Int32:
-		return val.iVal;
+		return false;
+	}
+	const size_t index = q - operators;
+	opPrio = priorities[index];
+	if (opPrio <= priority)
+	{
+		return false;
+	}
 
-	case TypeCode::Uint32:
-		if (val.uVal > (uint32_t)std::numeric_limits<int32_t>::max())
+	AdvancePointer();								// skip the [first] operator character
+
+	// Handle >= and <= and !=
+	invert = false;
+	if (opChar == '!')
+	{
+		if (CurrentCharacter() != '=')
 		{
-			ThrowParseException("unsigned integer too large");
+			ThrowParseException("expected '='");
 		}
-		return (int32_t)val.uVal;
+		invert = true;
+		AdvancePointer();
+		opChar = '=';
+	}
+	else if ((opChar == '>' || opChar == '<') && CurrentCharacter() == '=')
+	{
+		invert = true;
+		AdvancePointer();
+		opChar ^= ('>' ^ '<');			// change < to > or vice versa
+	}
 
-	default:
-		ThrowParseException("expected integer value");
+	// Allow == && || as alternatives to = & |
+	if ((opChar == '=' || opChar == '&' || opChar == '|') && CurrentCharacter() == opChar)
+	{
+		AdvancePointer();
 	}
+	return true;
 }
 
-uint32_t ExpressionParser::ParseUnsigned() THROWS(GCodeException)
+// Apply a unary operator to a value that has already been evaluated
+void ExpressionParser::ApplyUnaryOperator(char op, ExpressionValue& val, bool evaluate) THROWS(GCodeException)
 {
-	ExpressionValue val = Parse();
-	switch (val.GetType())
+	switch (op)
 	{
-	case TypeCode::Uint32:
-		return val.uVal;
-
-	case TypeCode::Int32:
-		if (val.iVal >= 0)
+	case '-':
+		switch (val.GetType())
 		{
-			return (uint32_t)val.iVal;
-		}
-		ThrowParseException("value must be non-negative");
-
-	default:
-		ThrowParseException("expected non-negative integer value");
-	}
-}
+		case TypeCode::Int32:
+			val.iVal = -val.iVal;		//TODO overflow check
+			break;
 
-DriverId ExpressionParser::ParseDriverId() THROWS(GCodeException)
+		case TypeCode::Float:
+			val.fVal = -val.fVal;
+			break;
+
+		default:
+			ThrowParseException("expected numeric value after '-'");
+		}
+		break;
+
+	case '+':
+		switch (val.GetType())
+		{
+		case TypeCode::Uint32:
+			// Convert enumeration to integer
+			val.iVal = (int32_t)val.uVal;
+			val.SetType(TypeCode::Int32);
+			break;
+
+		case TypeCode::Int32:
+		case TypeCode::Float:
+			break;
+
+		case TypeCode::DateTime_tc:					// unary + converts a DateTime to a seconds count
+			val.iVal = (uint32_t)val.Get56BitValue();
+			val.SetType(TypeCode::Int32);
+			break;
+
+		default:
+			ThrowParseException("expected numeric or enumeration value after '+'");
+		}
+		break;
+
+	case '#':
+		if (val.GetType() == TypeCode::CString)
+		{
+			val.Set((int32_t)strlen(val.sVal));
+		}
+		else if (val.GetType() == TypeCode::HeapString)
+		{
+			val.Set((int32_t)val.shVal.GetLength());
+		}
+		else
+		{
+			ThrowParseException("expected object model value or string after '#");
+		}
+		break;
+
+	case '!':
+		ConvertToBool(val, evaluate);
+		val.bVal = !val.bVal;
+		break;
+
+	default:
+		THROW_INTERNAL_ERROR;
+	}
+}
+
+// Apply a binary operator that always evaluates both operands, leaving the result in 'val'
+void ExpressionParser::ApplyBinaryOperator(char opChar, bool invert, ExpressionValue& val, ExpressionValue& val2, bool evaluate) THROWS(GCodeException)
+{
+	switch(opChar)
+	{
+	case '+':
+		if (val.GetType() == TypeCode::DateTime_tc)
+		{
+			if (val2.GetType() == TypeCode::Uint32)
+			{
+				val.Set56BitValue(val.Get56BitValue() + val2.uVal);
+			}
+			else if (val2.GetType() == TypeCode::Int32)
+			{
+				val.Set56BitValue((int64_t)val.Get56BitValue() + val2.iVal);
+			}
+			else if (evaluate)
+			{
+				ThrowParseException("invalid operand types");
+			}
+		}
+		else
+		{
+			BalanceNumericTypes(val, val2, evaluate);
+			if (val.GetType() == TypeCode::Float)
+			{
+				val.fVal += val2.fVal;
+				val.param = max(val.param, val2.param);
+			}
+			else
+			{
+				val.iVal += val2.iVal;
+			}
+		}
+		break;
+
+	case '-':
+		if (val.GetType() == TypeCode::DateTime_tc)
+		{
+			if (val2.GetType() == TypeCode::DateTime_tc)
+			{
+				// Difference of two data/times
+				val.SetType(TypeCode::Int32);
+				val.iVal = (int32_t)(val.Get56BitValue() - val2.Get56BitValue());
+			}
+			else if (val2.GetType() == TypeCode::Uint32)
+			{
+				val.Set56BitValue(val.Get56BitValue() - val2.uVal);
+			}
+			else if (val2.GetType() == TypeCode::Int32)
+			{
+				val.Set56BitValue((int64_t)val.Get56BitValue() - val2.iVal);
+			}
+			else if (evaluate)
+			{
+				ThrowParseException("invalid operand types");
+			}
+		}
+		else
+		{
+			BalanceNumericTypes(val, val2, evaluate);
+			if (val.GetType() == TypeCode::Float)
+			{
+				val.fVal -= val2.fVal;
+				val.param = max(val.param, val2.param);
+			}
+			else
+			{
+				val.iVal -= val2.iVal;
+			}
+		}
+		break;
+
+	case '*':
+		BalanceNumericTypes(val, val2, evaluate);
+		if (val.GetType() == TypeCode::Float)
+		{
+			val.fVal *= val2.fVal;
+			val.param = max(val.param, val2.param);
+		}
+		else
+		{
+			val.iVal *= val2.iVal;
+		}
+		break;
+
+	case '/':
+		ConvertToFloat(val, evaluate);
+		ConvertToFloat(val2, evaluate);
+		val.fVal /= val2.fVal;
+		val.param = MaxFloatDigitsDisplayedAfterPoint;
+		break;
+
+	case '>':
+		BalanceTypes(val, val2, evaluate);
+		switch (val.GetType())
+		{
+		case TypeCode::Int32:
+			val.bVal = (val.iVal > val2.iVal);
+			break;
+
+		case TypeCode::Float:
+			val.bVal = (val.fVal > val2.fVal);
+			break;
+
+		case TypeCode::DateTime_tc:
+			val.bVal = val.Get56BitValue() > val2.Get56BitValue();
+			break;
+
+		case TypeCode::Bool:
+			val.bVal = (val.bVal && !val2.bVal);
+			break;
+
+		default:
+			if (evaluate)
+			{
+				ThrowParseException("expected numeric or Boolean operands to comparison operator");
+			}
+			val.bVal = false;
+			break;
+		}
+		val.SetType(TypeCode::Bool);
+		if (invert)
+		{
+			val.bVal = !val.bVal;
+		}
+		break;
+
+	case '<':
+		BalanceTypes(val, val2, evaluate);
+		switch (val.GetType())
+		{
+		case TypeCode::Int32:
+			val.bVal = (val.iVal < val2.iVal);
+			break;
+
+		case TypeCode::Float:
+			val.bVal = (val.fVal < val2.fVal);
+			break;
+
+		case TypeCode::DateTime_tc:
+			val.bVal = val.Get56BitValue() < val2.Get56BitValue();
+			break;
+
+		case TypeCode::Bool:
+			val.bVal = (!val.bVal && val2.bVal);
+			break;
+
+		default:
+			if (evaluate)
+			{
+				ThrowParseException("expected numeric or Boolean operands to comparison operator");
+			}
+			val.bVal = false;
+			break;
+		}
+		val.SetType(TypeCode::Bool);
+		if (invert)
+		{
+			val.bVal = !val.bVal;
+		}
+		break;
+
+	case '=':
+		// Before balancing, handle comparisons with null
+		if (val.GetType() == TypeCode::None)
+		{
+			val.bVal = (val2.GetType() == TypeCode::None);
+		}
+		else if (val2.GetType() == TypeCode::None)
+		{
+			val.bVal = false;
+		}
+		else
+		{
+			BalanceTypes(val, val2, evaluate);
+			switch (val.GetType())
+			{
+			case TypeCode::ObjectModel_tc:
+				ThrowParseException("cannot compare objects");
+
+			case TypeCode::Int32:
+				val.bVal = (val.iVal == val2.iVal);
+				break;
+
+			case TypeCode::Uint32:
+				val.bVal = (val.uVal == val2.uVal);
+				break;
+
+			case TypeCode::Float:
+				val.bVal = (val.fVal == val2.fVal);
+				break;
+
+			case TypeCode::DateTime_tc:
+				val.bVal = val.Get56BitValue() == val2.Get56BitValue();
+				break;
+
+			case TypeCode::Bool:
+				val.bVal = (val.bVal == val2.bVal);
+				break;
+
+			case TypeCode::CString:
+				val.bVal = (strcmp(val.sVal, (val2.GetType() == TypeCode::HeapString) ? val2.shVal.Get().Ptr() : val2.sVal) == 0);
+				break;
+
+			case TypeCode::HeapString:
+				val.bVal = (strcmp(val.shVal.Get().Ptr(), (val2.GetType() == TypeCode::HeapString) ? val2.shVal.Get().Ptr() : val2.sVal) == 0);
+				break;
+
+			default:
+				if (evaluate)
+				{
+					ThrowParseException("unexpected operand type to equality operator");
+				}
+				val.bVal = false;
+				break;
+			}
+		}
+		val.SetType(TypeCode::Bool);
+		if (invert)
+		{
+			val.bVal = !val.bVal;
+		}
+		break;
+
+	case '^':
+		StringConcat(val, val2);
+		break;
+	}
+}
+
+// Concatenate val1 and val2 and assign the result to val1
+// This is written as a separate function because it needs a temporary string buffer, and its caller is recursive. Its declaration must be declared 'noinline'.
+/*static*/ void  ExpressionParser::StringConcat(ExpressionValue &val, ExpressionValue &val2) noexcept
+{
+    String<MaxStringExpressionLength> str;
+    val.AppendAsString(str.GetRef());
+    val2.AppendAsString(str.GetRef());
+    StringHandle sh(str.c_str());
+    val.Set(sh);
+}
+
+bool ExpressionParser::ParseBoolean() THROWS(GCodeException)
+{
+	ExpressionValue val = Parse();
+	ConvertToBool(val, true);
+	return val.bVal;
+}
+
+float ExpressionParser::ParseFloat() THROWS(GCodeException)
+{
+	ExpressionValue val = Parse();
+	ConvertToFloat(val, true);
+	return val.fVal;
+}
+
+int32_t ExpressionParser::ParseInteger() THROWS(GCodeException)
+{
+	ExpressionValue val = Parse();
+	switch (val.GetType())
+	{
+	case TypeCode::Int32:
+		return val.iVal;
+
+	case TypeCode::Uint32:
+		if (val.uVal > (uint32_t)std::numeric_limits<int32_t>::max())
+		{
+			ThrowParseException("unsigned integer too large");
+		}
+		return (int32_t)val.uVal;
+
+	default:
+		ThrowParseException("expected integer value");
+	}
+}
+
+uint32_t ExpressionParser::ParseUnsigned() THROWS(GCodeException)
+{
+	ExpressionValue val = Parse();
+	switch (val.GetType())
+	{
+	case TypeCode::Uint32:
+		return val.uVal;
+
+	case TypeCode::Int32:
+		if (val.iVal >= 0)
+		{
+			return (uint32_t)val.iVal;
+		}
+		ThrowParseException("value must be non-negative");
+
+	default:
+		ThrowParseException("expected non-negative integer value");
+	}
+}
+
+DriverId ExpressionParser::ParseDriverId() THROWS(GCodeException)
 {
 	ExpressionValue val = Parse();
 	ConvertToDriverId(val, true);
@@ -937,73 +974,16 @@ void ExpressionParser::ParseIdentifierExpression(ExpressionValue& rslt, bool eva
 		{
 			ThrowParseException(InvalidExistsMessage);
 		}
+		GetNamedConstantValue(rslt, whichConstant.RawValue());
+		return;
+	}
 
-		switch (whichConstant.RawValue())
-		{
-		case NamedConstant::_true:
-			rslt.Set(true);
-			return;
-
-		case NamedConstant::_false:
-			rslt.Set(false);
-			return;
-
-		case NamedConstant::_null:
-			rslt.Set(nullptr);
-			return;
-
-		case NamedConstant::pi:
-			rslt.Set(Pi);
-			return;
-
-		case NamedConstant::iterations:
-			{
-				const int32_t v = gb.CurrentFileMachineState().GetIterations();
-				if (v < 0)
-				{
-					ThrowParseException("'iterations' used when not inside a loop");
-				}
-				rslt.Set(v);
-			}
-			return;
-
-		case NamedConstant::_result:
-			{
-				int32_t res;
-				switch (gb.GetLastResult())
-				{
-				case GCodeResult::ok:
-					res = 0;
-					break;
-
-				case GCodeResult::warning:
-				case GCodeResult::warningNotSupported:
-					res = 1;
-					break;
-
-				default:
-					res = 2;
-					break;
-				}
-				rslt.Set(res);
-			}
-			return;
-
-		case NamedConstant::line:
-			rslt.Set((int32_t)gb.GetLineNumber());
-			return;
-
-		default:
-			THROW_INTERNAL_ERROR;
-		}
-	}
-
-	// Check whether it is a function call
-	SkipWhiteSpace();
-	if (CurrentCharacter() == '(')
-	{
-		// It's a function call
-		if (context.WantExists())
+	// Check whether it is a function call
+	SkipWhiteSpace();
+	if (CurrentCharacter() == '(')
+	{
+		// It's a function call
+		if (context.WantExists())
 		{
 			ThrowParseException(InvalidExistsMessage);
 		}
@@ -1027,121 +1007,9 @@ void ExpressionParser::ParseIdentifierExpression(ExpressionValue& rslt, bool eva
 
 			switch (func.RawValue())
 			{
-			case Function::abs:
-				switch (rslt.GetType())
-				{
-				case TypeCode::Int32:
-					rslt.iVal = labs(rslt.iVal);
-					break;
-
-				case TypeCode::Float:
-					rslt.fVal = fabsf(rslt.fVal);
-					break;
-
-				default:
-					if (evaluate)
-					{
-						ThrowParseException("expected numeric operand");
-					}
-					rslt.Set((int32_t)0);
-				}
-				break;
-
-			case Function::sin:
-				ConvertToFloat(rslt, evaluate);
-				rslt.fVal = sinf(rslt.fVal);
-				rslt.param = MaxFloatDigitsDisplayedAfterPoint;
-				break;
-
-			case Function::cos:
-				ConvertToFloat(rslt, evaluate);
-				rslt.fVal = cosf(rslt.fVal);
-				rslt.param = MaxFloatDigitsDisplayedAfterPoint;
-				break;
-
-			case Function::tan:
-				ConvertToFloat(rslt, evaluate);
-				rslt.fVal = tanf(rslt.fVal);
-				rslt.param = MaxFloatDigitsDisplayedAfterPoint;
-				break;
-
-			case Function::asin:
-				ConvertToFloat(rslt, evaluate);
-				rslt.fVal = asinf(rslt.fVal);
-				rslt.param = MaxFloatDigitsDisplayedAfterPoint;
-				break;
-
-			case Function::acos:
-				ConvertToFloat(rslt, evaluate);
-				rslt.fVal = acosf(rslt.fVal);
-				rslt.param = MaxFloatDigitsDisplayedAfterPoint;
-				break;
-
-			case Function::atan:
-				ConvertToFloat(rslt, evaluate);
-				rslt.fVal = atanf(rslt.fVal);
-				rslt.param = MaxFloatDigitsDisplayedAfterPoint;
-				break;
-
 			case Function::atan2:
-				{
-					ConvertToFloat(rslt, evaluate);
-					SkipWhiteSpace();
-					if (CurrentCharacter() != ',')
-					{
-						ThrowParseException("expected ','");
-					}
-					AdvancePointer();
-					SkipWhiteSpace();
-					ExpressionValue nextOperand;
-					// We recently checked the stack for a call to ParseInternal, no need to do it again
-					ParseInternal(nextOperand, evaluate, 0);
-					ConvertToFloat(nextOperand, evaluate);
-					rslt.fVal = atan2f(rslt.fVal, nextOperand.fVal);
-					rslt.param = MaxFloatDigitsDisplayedAfterPoint;
-				}
-				break;
-
-			case Function::degrees:
-				ConvertToFloat(rslt, evaluate);
-				rslt.fVal = rslt.fVal * RadiansToDegrees;
-				rslt.param = MaxFloatDigitsDisplayedAfterPoint;
-				break;
-
-			case Function::radians:
-				ConvertToFloat(rslt, evaluate);
-				rslt.fVal = rslt.fVal * DegreesToRadians;
-				rslt.param = MaxFloatDigitsDisplayedAfterPoint;
-				break;
-
-			case Function::sqrt:
-				ConvertToFloat(rslt, evaluate);
-				rslt.fVal = fastSqrtf(rslt.fVal);
-				rslt.param = MaxFloatDigitsDisplayedAfterPoint;
-				break;
-
-			case Function::isnan:
 				ConvertToFloat(rslt, evaluate);
-				rslt.SetType(TypeCode::Bool);
-				rslt.bVal = (std::isnan(rslt.fVal) != 0);
-				break;
-
-			case Function::floor:
-				{
-					ConvertToFloat(rslt, evaluate);
-					const float f = floorf(rslt.fVal);
-					if (f <= (float)std::numeric_limits<int32_t>::max() && f >= (float)std::numeric_limits<int32_t>::min())
-					{
-						rslt.SetType(TypeCode::Int32);
-						rslt.iVal = (int32_t)f;
-					}
-					else
-					{
-						rslt.fVal = f;
-					}
-				}
-				break;
-
+				// no break
 			case Function::mod:
 				{
 					SkipWhiteSpace();
@@ -1154,48 +1022,11 @@ void ExpressionParser::ParseIdentifierExpression(ExpressionValue& rslt, bool eva
 					ExpressionValue nextOperand;
 					// We recently checked the stack for a call to ParseInternal, no need to do it again
 					ParseInternal(nextOperand, evaluate, 0);
-					BalanceNumericTypes(rslt, nextOperand, evaluate);
-					if (rslt.GetType() == TypeCode::Float)
-					{
-						rslt.fVal = fmod(rslt.fVal, nextOperand.fVal);
-					}
-					else if (nextOperand.iVal == 0)
-					{
-						rslt.iVal = 0;
-					}
-					else
-					{
-						rslt.iVal %= nextOperand.iVal;
-					}
+					ApplyBinaryFunction(func.RawValue(), rslt, nextOperand, evaluate);
 				}
 				break;
 
 			case Function::max:
-				for (;;)
-				{
-					SkipWhiteSpace();
-					if (CurrentCharacter() != ',')
-					{
-						break;
-					}
-					AdvancePointer();
-					SkipWhiteSpace();
-					ExpressionValue nextOperand;
-					// We recently checked the stack for a call to ParseInternal, no need to do it again
-					ParseInternal(nextOperand, evaluate, 0);
-					BalanceNumericTypes(rslt, nextOperand, evaluate);
-					if (rslt.GetType() == TypeCode::Float)
-					{
-						rslt.fVal = max<float>(rslt.fVal, nextOperand.fVal);
-						rslt.param = max(rslt.param, nextOperand.param);
-					}
-					else
-					{
-						rslt.iVal = max<int32_t>(rslt.iVal, nextOperand.iVal);
-					}
-				}
-				break;
-
 			case Function::min:
 				for (;;)
 				{
@@ -1209,74 +1040,13 @@ void ExpressionParser::ParseIdentifierExpression(ExpressionValue& rslt, bool eva
 					ExpressionValue nextOperand;
 					// We recently checked the stack for a call to ParseInternal, no need to do it again
 					ParseInternal(nextOperand, evaluate, 0);
-					BalanceNumericTypes(rslt, nextOperand, evaluate);
-					if (rslt.GetType() == TypeCode::Float)
-					{
-						rslt.fVal = min<float>(rslt.fVal, nextOperand.fVal);
-						rslt.param = max(rslt.param, nextOperand.param);
-					}
-					else
-					{
-						rslt.iVal = min<int32_t>(rslt.iVal, nextOperand.iVal);
-					}
-				}
-				break;
-
-			case Function::random:
-				{
-					uint32_t limit;
-					if (rslt.GetType() == TypeCode::Uint32)
-					{
-						limit = rslt.uVal;
-					}
-					else if (rslt.GetType() == TypeCode::Int32 && rslt.iVal > 0)
-					{
-						limit = rslt.iVal;
-					}
-					else
-					{
-						ThrowParseException("expected positive integer");
-					}
-					rslt.Set((int32_t)random(limit));
-				}
-				break;
-
-			case Function::datetime:
-				{
-					uint64_t val;
-					switch (rslt.GetType())
-					{
-					case TypeCode::Int32:
-						val = (uint64_t)max<uint32_t>(rslt.iVal, 0);
-						break;
-
-					case TypeCode::Uint32:
-						val = (uint64_t)rslt.uVal;
-						break;
-
-					case TypeCode::Uint64:
-					case TypeCode::DateTime_tc:
-						val = rslt.Get56BitValue();
-						break;
-
-					case TypeCode::CString:
-						val = ParseDateTime(rslt.sVal);
-						break;
-
-					case TypeCode::HeapString:
-						val = ParseDateTime(rslt.shVal.Get().Ptr());
-						break;
-
-					default:
-						ThrowParseException("can't convert value to DateTime");
-					}
-					rslt.SetType(TypeCode::DateTime_tc);
-					rslt.Set56BitValue(val);
+					ApplyBinaryFunction(func.RawValue(), rslt, nextOperand, evaluate);
 				}
 				break;
 
 			default:
-				THROW_INTERNAL_ERROR;
+				ApplyUnaryFunction(func.RawValue(), rslt, evaluate);
+				break;
 			}
 		}
 
@@ -1292,45 +1062,890 @@ void ExpressionParser::ParseIdentifierExpression(ExpressionValue& rslt, bool eva
 	// If we are not evaluating then the object expression doesn't have to exist, so don't retrieve it because that might throw an error
 	if (evaluate)
 	{
-		// Check for a parameter, local or global variable
-		if (StringStartsWith(id.c_str(), "param."))
+		GetIdentifierValue(rslt, context, id.c_str(), applyExists);
+		return;
+	}
+	rslt.Set(nullptr);
+}
+
+// Get the value of a named constant
+void ExpressionParser::GetNamedConstantValue(ExpressionValue& rslt, unsigned int whichConstant) const THROWS(GCodeException)
+{
+	switch (whichConstant)
+	{
+	case NamedConstant::_true:
+		rslt.Set(true);
+		return;
+
+	case NamedConstant::_false:
+		rslt.Set(false);
+		return;
+
+	case NamedConstant::_null:
+		rslt.Set(nullptr);
+		return;
+
+	case NamedConstant::pi:
+		rslt.Set(Pi);
+		return;
+
+	case NamedConstant::iterations:
 		{
-			GetVariableValue(rslt, &gb.GetVariables(), id.c_str() + strlen("param."), true, applyExists);
-			return;
+			const int32_t v = gb.CurrentFileMachineState().GetIterations();
+			if (v < 0)
+			{
+				ThrowParseException("'iterations' used when not inside a loop");
+			}
+			rslt.Set(v);
 		}
+		return;
 
-		if (StringStartsWith(id.c_str(), "global."))
+	case NamedConstant::_result:
 		{
-			auto vars = reprap.GetGlobalVariablesForReading();
-			GetVariableValue(rslt, vars.Ptr(), id.c_str() + strlen("global."), false, applyExists);
-			return;
+			int32_t res;
+			switch (gb.GetLastResult())
+			{
+			case GCodeResult::ok:
+				res = 0;
+				break;
+
+			case GCodeResult::warning:
+			case GCodeResult::warningNotSupported:
+				res = 1;
+				break;
+
+			default:
+				res = 2;
+				break;
+			}
+			rslt.Set(res);
 		}
+		return;
+
+	case NamedConstant::line:
+		rslt.Set((int32_t)gb.GetLineNumber());
+		return;
+
+	default:
+		THROW_INTERNAL_ERROR;
+	}
+}
 
-		if (StringStartsWith(id.c_str(), "var."))
+// Apply a function that takes a single argument, which has already been evaluated
+void ExpressionParser::ApplyUnaryFunction(unsigned int func, ExpressionValue& rslt, bool evaluate) THROWS(GCodeException)
+{
+	switch (func)
+	{
+	case Function::abs:
+		switch (rslt.GetType())
 		{
-			GetVariableValue(rslt, &gb.GetVariables(), id.c_str() + strlen("var."), false, applyExists);
-			return;
+		case TypeCode::Int32:
+			rslt.iVal = labs(rslt.iVal);
+			break;
+
+		case TypeCode::Float:
+			rslt.fVal = fabsf(rslt.fVal);
+			break;
+
+		default:
+			if (evaluate)
+			{
+				ThrowParseException("expected numeric operand");
+			}
+			rslt.Set((int32_t)0);
 		}
+		break;
+
+	case Function::sin:
+		ConvertToFloat(rslt, evaluate);
+		rslt.fVal = sinf(rslt.fVal);
+		rslt.param = MaxFloatDigitsDisplayedAfterPoint;
+		break;
+
+	case Function::cos:
+		ConvertToFloat(rslt, evaluate);
+		rslt.fVal = cosf(rslt.fVal);
+		rslt.param = MaxFloatDigitsDisplayedAfterPoint;
+		break;
+
+	case Function::tan:
+		ConvertToFloat(rslt, evaluate);
+		rslt.fVal = tanf(rslt.fVal);
+		rslt.param = MaxFloatDigitsDisplayedAfterPoint;
+		break;
+
+	case Function::asin:
+		ConvertToFloat(rslt, evaluate);
+		rslt.fVal = asinf(rslt.fVal);
+		rslt.param = MaxFloatDigitsDisplayedAfterPoint;
+		break;
+
+	case Function::acos:
+		ConvertToFloat(rslt, evaluate);
+		rslt.fVal = acosf(rslt.fVal);
+		rslt.param = MaxFloatDigitsDisplayedAfterPoint;
+		break;
+
+	case Function::atan:
+		ConvertToFloat(rslt, evaluate);
+		rslt.fVal = atanf(rslt.fVal);
+		rslt.param = MaxFloatDigitsDisplayedAfterPoint;
+		break;
+
+	case Function::degrees:
+		ConvertToFloat(rslt, evaluate);
+		rslt.fVal = rslt.fVal * RadiansToDegrees;
+		rslt.param = MaxFloatDigitsDisplayedAfterPoint;
+		break;
+
+	case Function::radians:
+		ConvertToFloat(rslt, evaluate);
+		rslt.fVal = rslt.fVal * DegreesToRadians;
+		rslt.param = MaxFloatDigitsDisplayedAfterPoint;
+		break;
+
+	case Function::sqrt:
+		ConvertToFloat(rslt, evaluate);
+		rslt.fVal = fastSqrtf(rslt.fVal);
+		rslt.param = MaxFloatDigitsDisplayedAfterPoint;
+		break;
 
-		// "exists(var)", "exists(param)" and "exists(global)" should return true.
-		// "exists(global)" will anyway because "global" is a root key in the object model. Handle the other two here.
-		if (applyExists && (strcmp(id.c_str(), "param") == 0 || strcmp(id.c_str(), "var") == 0))
+	case Function::isnan:
+		ConvertToFloat(rslt, evaluate);
+		rslt.SetType(TypeCode::Bool);
+		rslt.bVal = (std::isnan(rslt.fVal) != 0);
+		break;
+
+	case Function::floor:
 		{
-			rslt.Set(true);
-			return;
+			ConvertToFloat(rslt, evaluate);
+			const float f = floorf(rslt.fVal);
+			if (f <= (float)std::numeric_limits<int32_t>::max() && f >= (float)std::numeric_limits<int32_t>::min())
+			{
+				rslt.SetType(TypeCode::Int32);
+				rslt.iVal = (int32_t)f;
+			}
+			else
+			{
+				rslt.fVal = f;
+			}
 		}
+		break;
 
-		// Else assume an object model value
-		CheckStack(StackUsage::GetObjectValueUsingTableNumber);
-		rslt = reprap.GetObjectValueUsingTableNumber(context, nullptr, id.c_str(), 0);
-		if (context.ObsoleteFieldQueried() && obsoleteField.IsEmpty())
+	case Function::random:
 		{
-			obsoleteField.copy(id.c_str());
+			uint32_t limit;
+			if (rslt.GetType() == TypeCode::Uint32)
+			{
+				limit = rslt.uVal;
+			}
+			else if (rslt.GetType() == TypeCode::Int32 && rslt.iVal > 0)
+			{
+				limit = rslt.iVal;
+			}
+			else
+			{
+				ThrowParseException("expected positive integer");
+			}
+			rslt.Set((int32_t)random(limit));
 		}
-		return;
-	}
-	rslt.Set(nullptr);
-}
+		break;
+
+	case Function::datetime:
+		{
+			uint64_t val;
+			switch (rslt.GetType())
+			{
+			case TypeCode::Int32:
+				val = (uint64_t)max<uint32_t>(rslt.iVal, 0);
+				break;
+
+			case TypeCode::Uint32:
+				val = (uint64_t)rslt.uVal;
+				break;
+
+			case TypeCode::Uint64:
+			case TypeCode::DateTime_tc:
+				val = rslt.Get56BitValue();
+				break;
+
+			case TypeCode::CString:
+				val = ParseDateTime(rslt.sVal);
+				break;
+
+			case TypeCode::HeapString:
+				val = ParseDateTime(rslt.shVal.Get().Ptr());
+				break;
+
+			default:
+				ThrowParseException("can't convert value to DateTime");
+			}
+			rslt.SetType(TypeCode::DateTime_tc);
+			rslt.Set56BitValue(val);
+		}
+		break;
+
+	default:
+		THROW_INTERNAL_ERROR;
+	}
+}
+
+// Apply a function that takes two or more arguments to the result so far and the next argument
+void ExpressionParser::ApplyBinaryFunction(unsigned int func, ExpressionValue& rslt, ExpressionValue& nextOperand, bool evaluate) THROWS(GCodeException)
+{
+	switch (func)
+	{
+	case Function::atan2:
+		ConvertToFloat(rslt, evaluate);
+		ConvertToFloat(nextOperand, evaluate);
+		rslt.fVal = atan2f(rslt.fVal, nextOperand.fVal);
+		rslt.param = MaxFloatDigitsDisplayedAfterPoint;
+		break;
+
+	case Function::mod:
+		BalanceNumericTypes(rslt, nextOperand, evaluate);
+		if (rslt.GetType() == TypeCode::Float)
+		{
+			rslt.fVal = fmod(rslt.fVal, nextOperand.fVal);
+		}
+		else if (nextOperand.iVal == 0)
+		{
+			rslt.iVal = 0;
+		}
+		else
+		{
+			rslt.iVal %= nextOperand.iVal;
+		}
+		break;
+
+	case Function::max:
+		BalanceNumericTypes(rslt, nextOperand, evaluate);
+		if (rslt.GetType() == TypeCode::Float)
+		{
+			rslt.fVal = max<float>(rslt.fVal, nextOperand.fVal);
+			rslt.param = max(rslt.param, nextOperand.param);
+		}
+		else
+		{
+			rslt.iVal = max<int32_t>(rslt.iVal, nextOperand.iVal);
+		}
+		break;
+
+	case Function::min:
+		BalanceNumericTypes(rslt, nextOperand, evaluate);
+		if (rslt.GetType() == TypeCode::Float)
+		{
+			rslt.fVal = min<float>(rslt.fVal, nextOperand.fVal);
+			rslt.param = max(rslt.param, nextOperand.param);
+		}
+		else
+		{
+			rslt.iVal = min<int32_t>(rslt.iVal, nextOperand.iVal);
+		}
+		break;
+
+	default:
+		THROW_INTERNAL_ERROR;
+	}
+}
+
+// Get the value of a parameter, variable or object model field. The context must already hold any indices needed.
+void ExpressionParser::GetIdentifierValue(ExpressionValue& rslt, ObjectExplorationContext& context, const char *id, bool applyExists) THROWS(GCodeException)
+{
+	// Check for a parameter, local or global variable
+	if (StringStartsWith(id, "param."))
+	{
+		GetVariableValue(rslt, &gb.GetVariables(), id + strlen("param."), true, applyExists);
+		return;
+	}
+
+	if (StringStartsWith(id, "global."))
+	{
+		auto vars = reprap.GetGlobalVariablesForReading();
+		GetVariableValue(rslt, vars.Ptr(), id + strlen("global."), false, applyExists);
+		return;
+	}
+
+	if (StringStartsWith(id, "var."))
+	{
+		GetVariableValue(rslt, &gb.GetVariables(), id + strlen("var."), false, applyExists);
+		return;
+	}
+
+	// "exists(var)", "exists(param)" and "exists(global)" should return true.
+	// "exists(global)" will anyway because "global" is a root key in the object model. Handle the other two here.
+	if (applyExists && (strcmp(id, "param") == 0 || strcmp(id, "var") == 0))
+	{
+		rslt.Set(true);
+		return;
+	}
+
+	// Else assume an object model value
+	CheckStack(StackUsage::GetObjectValueUsingTableNumber);
+	rslt = reprap.GetObjectValueUsingTableNumber(context, nullptr, id, 0);
+	if (context.ObsoleteFieldQueried() && obsoleteField.IsEmpty())
+	{
+		obsoleteField.copy(id);
+	}
+}
+
+#if SUPPORT_COMPILED_EXPRESSIONS
+
+// Try to evaluate the expression using a cached compiled version of it, compiling it if it isn't already in the cache.
+// If we return false then the read pointer is unchanged and the caller must parse the expression in the usual way.
+// If executing the compiled expression fails then we return false too, so that the error message reports the same column as it did before.
+bool ExpressionParser::EvaluateCompiled(ExpressionValue& result) noexcept
+{
+	const char * const start = currentp;
+	CompiledExpression ce;
+	switch (CompiledExpressionCache::Lookup(start, endp, ce))
+	{
+	case CompiledExpressionCache::LookupResult::notCompilable:
+		return false;
+
+	case CompiledExpressionCache::LookupResult::notFound:
+		{
+			bool ok;
+			try
+			{
+				CompileInternal(ce, 0);
+				ok = ce.IsComplete() && (size_t)(currentp - start) <= CompiledExpression::MaxTextLength;
+			}
+			catch (const GCodeException&)
+			{
+				ok = false;
+			}
+			const size_t textLength = currentp - start;
+			ce.SetTextLength(min<size_t>(textLength, CompiledExpression::MaxTextLength));
+			currentp = start;
+			CompiledExpressionCache::Store(start, textLength, endp, (ok) ? &ce : nullptr);
+			if (!ok)
+			{
+				return false;
+			}
+		}
+		break;
+
+	case CompiledExpressionCache::LookupResult::found:
+		break;
+	}
+
+	try
+	{
+		ExecuteCompiled(ce, result);
+	}
+	catch (const GCodeException&)
+	{
+		CompiledExpressionCache::NoteExecutionFailure();
+		result.Set(nullptr);
+		obsoleteField.Clear();
+		return false;
+	}
+	currentp = start + ce.GetTextLength();
+	return true;
+}
+
+// Compile a bracketed expression
+void ExpressionParser::CompileExpectKet(CompiledExpression& ce, char closingBracket) THROWS(GCodeException)
+{
+	CheckStack(StackUsage::ParseInternal);
+	CompileInternal(ce, 0);
+	if (CurrentCharacter() != closingBracket)
+	{
+		ThrowParseException("expected '%c'", (uint32_t)closingBracket);
+	}
+	AdvancePointer();
+}
+
+// Compile an expression, stopping before any binary operators with priority 'priority' or lower. This must accept exactly the same syntax as ParseInternal.
+// Operands that are not always evaluated are skipped using jumps.
+// This is recursive, so avoid allocating large amounts of data on the stack
+void ExpressionParser::CompileInternal(CompiledExpression& ce, uint8_t priority) THROWS(GCodeException)
+{
+	SkipWhiteSpace();
+	const char c = CurrentCharacter();
+	switch (c)
+	{
+	case '"':
+		{
+			ExpressionValue val;
+			ParseQuotedString(val);
+			ce.EmitOp(ExpressionOp::pushString, 1);
+			ce.EmitString(val.shVal.Get().Ptr());
+		}
+		break;
+
+	case '-':
+	case '+':
+	case '!':
+		AdvancePointer();
+		CheckStack(StackUsage::ParseInternal);
+		CompileInternal(ce, UnaryPriority);
+		ce.EmitOp(ExpressionOp::unaryOperator, 0);
+		ce.EmitByte(c);
+		break;
+
+	case '#':
+		AdvancePointer();
+		SkipWhiteSpace();
+		if (isalpha(CurrentCharacter()))
+		{
+			CheckStack(StackUsage::ParseIdentifierExpression);
+			CompileIdentifierExpression(ce, true, false);
+		}
+		else
+		{
+			CheckStack(StackUsage::ParseInternal);
+			CompileInternal(ce, UnaryPriority);
+			ce.EmitOp(ExpressionOp::unaryOperator, 0);
+			ce.EmitByte(c);
+		}
+		break;
+
+	case '{':
+		AdvancePointer();
+		CompileExpectKet(ce, '}');
+		break;
+
+	case '(':
+		AdvancePointer();
+		CompileExpectKet(ce, ')');
+		break;
+
+	default:
+		if (isdigit(c))						// looks like a number
+		{
+			ExpressionValue val;
+			ParseNumber(val);
+			if (val.GetType() == TypeCode::Int32)
+			{
+				ce.EmitOp(ExpressionOp::pushInt, 1);
+				ce.EmitBytes(&val.iVal, sizeof(val.iVal));
+			}
+			else
+			{
+				ce.EmitOp(ExpressionOp::pushFloat, 1);
+				ce.EmitBytes(&val.fVal, sizeof(val.fVal));
+				ce.EmitByte(val.param);
+			}
+		}
+		else if (isalpha(c))				// looks like a variable name
+		{
+			CheckStack(StackUsage::ParseIdentifierExpression);
+			CompileIdentifierExpression(ce, false, false);
+		}
+		else
+		{
+			ThrowParseException("expected an expression");
+		}
+		break;
+	}
+
+	// See if it is followed by a binary operator
+	char opChar;
+	bool invert;
+	uint8_t opPrio;
+	while (ParseBinaryOperator(priority, opChar, invert, opPrio))
+	{
+		CheckStack(StackUsage::ParseInternal);
+		switch (opChar)
+		{
+		case '&':
+		case '|':
+			{
+				const size_t jumpAddress = ce.EmitJump((opChar == '&') ? ExpressionOp::andJump : ExpressionOp::orJump, -1);
+				CompileInternal(ce, opPrio);				// compile the second operand
+				ce.EmitOp(ExpressionOp::toBool, 0);
+				ce.PatchJump(jumpAddress);
+			}
+			break;
+
+		case '?':
+			{
+				const size_t falseJumpAddress = ce.EmitJump(ExpressionOp::jumpIfFalse, -1);
+				CompileInternal(ce, opPrio);				// compile the second operand
+				if (CurrentCharacter() != ':')
+				{
+					ThrowParseException("expected ':'");
+				}
+				AdvancePointer();
+				const size_t endJumpAddress = ce.EmitJump(ExpressionOp::jump, 0);
+				ce.SetStackDepth(ce.GetStackDepth() - 1);	// the third operand starts with the stack as it was before the second one
+				ce.PatchJump(falseJumpAddress);
+				CompileInternal(ce, opPrio - 1);			// compile the third operand, which may be a further conditional expression
+				ce.PatchJump(endJumpAddress);
+			}
+			return;
+
+		default:
+			CompileInternal(ce, opPrio);					// compile the second operand
+			ce.EmitOp(ExpressionOp::binaryOperator, -1);
+			ce.EmitByte(opChar);
+			ce.EmitByte(invert);
+			break;
+		}
+	}
+}
+
+// Compile an identifier expression. This must accept exactly the same syntax as ParseIdentifierExpression.
+// Index expressions are compiled so that they leave their values on the stack for the instruction that looks up the identifier to use.
+// *** This function is recursive, so keep its stack usage low!
+void ExpressionParser::CompileIdentifierExpression(CompiledExpression& ce, bool applyLengthOperator, bool applyExists) THROWS(GCodeException)
+{
+	if (!isalpha(CurrentCharacter()))
+	{
+		ThrowParseException("expected an identifier");
+	}
+
+	String<MaxVariableNameLength> id;
+	unsigned int numIndices = 0;
+	char c;
+	while (isalpha((c = CurrentCharacter())) || isdigit(c) || c == '_' || c == '.' || c == '[')
+	{
+		AdvancePointer();
+		if (c == '[')
+		{
+			CheckStack(StackUsage::ParseInternal);
+			CompileInternal(ce, 0);
+			if (CurrentCharacter() != ']')
+			{
+				ThrowParseException("expected ']'");
+			}
+			AdvancePointer();										// skip the ']'
+			++numIndices;
+			c = '^';												// add the marker
+		}
+		if (id.cat(c))
+		{
+			ThrowParseException("variable name too long");
+		}
+	}
+
+	// Check for the names of constants. Their values may depend on the state of the GCodeBuffer, so look them up when we execute the code.
+	NamedConstant whichConstant(id.c_str());
+	if (whichConstant.IsValid())
+	{
+		if (applyExists)
+		{
+			ThrowParseException(InvalidExistsMessage);
+		}
+		ce.EmitOp(ExpressionOp::pushConstant, 1);
+		ce.EmitByte(whichConstant.RawValue());
+		return;
+	}
+
+	// Check whether it is a function call
+	SkipWhiteSpace();
+	if (CurrentCharacter() == '(')
+	{
+		if (applyExists)
+		{
+			ThrowParseException(InvalidExistsMessage);
+		}
+
+		const Function func(id.c_str());
+		if (!func.IsValid())
+		{
+			ThrowParseException("unknown function");
+		}
+
+		AdvancePointer();
+		if (func == Function::exists)
+		{
+			CheckStack(StackUsage::ParseIdentifierExpression);
+			CompileIdentifierExpression(ce, false, true);
+		}
+		else
+		{
+			CheckStack(StackUsage::ParseInternal);
+			CompileInternal(ce, 0);									// compile the first operand
+
+			switch (func.RawValue())
+			{
+			case Function::atan2:
+			case Function::mod:
+				SkipWhiteSpace();
+				if (CurrentCharacter() != ',')
+				{
+					ThrowParseException("expected ','");
+				}
+				AdvancePointer();
+				SkipWhiteSpace();
+				CompileInternal(ce, 0);
+				ce.EmitOp(ExpressionOp::binaryFunction, -1);
+				ce.EmitByte(func.RawValue());
+				break;
+
+			case Function::max:
+			case Function::min:
+				for (;;)
+				{
+					SkipWhiteSpace();
+					if (CurrentCharacter() != ',')
+					{
+						break;
+					}
+					AdvancePointer();
+					SkipWhiteSpace();
+					CompileInternal(ce, 0);
+					ce.EmitOp(ExpressionOp::binaryFunction, -1);
+					ce.EmitByte(func.RawValue());
+				}
+				break;
+
+			default:
+				ce.EmitOp(ExpressionOp::unaryFunction, 0);
+				ce.EmitByte(func.RawValue());
+				break;
+			}
+		}
+
+		SkipWhiteSpace();
+		if (CurrentCharacter() != ')')
+		{
+			ThrowParseException("expected ')'");
+		}
+		AdvancePointer();
+		return;
+	}
+
+	// It's a parameter, variable or object model value. Work out which one now, but look up variables by name each time because they may be created and deleted.
+	// The top-level object model table never changes, so we can find the entry for the first element of an object model path now.
+	const uint8_t flags = ((applyLengthOperator) ? CompiledExpression::FlagWantLength : 0) | ((applyExists) ? CompiledExpression::FlagWantExists : 0);
+	const char *name = id.c_str();
+	ExpressionOp op;
+	if (StringStartsWith(name, "param."))
+	{
+		op = ExpressionOp::parameter;
+		name += strlen("param.");
+	}
+	else if (StringStartsWith(name, "global."))
+	{
+		op = ExpressionOp::globalVariable;
+		name += strlen("global.");
+	}
+	else if (StringStartsWith(name, "var."))
+	{
+		op = ExpressionOp::localVariable;
+		name += strlen("var.");
+	}
+	else if (applyExists && (strcmp(name, "param") == 0 || strcmp(name, "var") == 0))
+	{
+		ce.EmitOp(ExpressionOp::pushBool, 1);						// see GetIdentifierValue
+		ce.EmitByte(1);
+		return;
+	}
+	else
+	{
+		const ObjectModelClassDescriptor *classDescriptor;
+		const ObjectModelTableEntry * const e = reprap.FindFirstElementEntry(name, classDescriptor);
+		if (e != nullptr)
+		{
+			ce.EmitOp(ExpressionOp::objectModelEntry, 1 - (int)numIndices);
+			ce.EmitByte(flags);
+			ce.EmitByte(numIndices);
+			ce.EmitPointer(classDescriptor);
+			ce.EmitPointer(e);
+			ce.EmitByte(ObjectModel::GetNextElement(name) - name);
+			ce.EmitString(name);
+			return;
+		}
+		op = ExpressionOp::objectModel;								// it will fail when we execute it, but with the same message as the interpreter gives
+	}
+
+	ce.EmitOp(op, 1 - (int)numIndices);
+	ce.EmitByte(flags);
+	ce.EmitByte(numIndices);
+	ce.EmitString(name);
+}
+
+// Execute a compiled expression, which gives the same result as ParseInternal would with 'evaluate' true
+void ExpressionParser::ExecuteCompiled(const CompiledExpression& ce, ExpressionValue& result) THROWS(GCodeException)
+{
+	ExpressionValue stack[CompiledExpression::MaxStackDepth];
+	size_t sp = 0;
+	size_t pc = 0;
+	while (pc < ce.GetCodeLength())
+	{
+		const ExpressionOp op = (ExpressionOp)ce.GetByte(pc);
+		switch (op)
+		{
+		case ExpressionOp::pushInt:
+			stack[sp++].Set(ce.GetInt32(pc));
+			break;
+
+		case ExpressionOp::pushFloat:
+			{
+				const float f = ce.GetFloat(pc);
+				stack[sp++].Set(f, ce.GetByte(pc));
+			}
+			break;
+
+		case ExpressionOp::pushString:
+			stack[sp++].Set(ce.GetString(pc));
+			break;
+
+		case ExpressionOp::pushConstant:
+			GetNamedConstantValue(stack[sp++], ce.GetByte(pc));
+			break;
+
+		case ExpressionOp::unaryOperator:
+			ApplyUnaryOperator((char)ce.GetByte(pc), stack[sp - 1], true);
+			break;
+
+		case ExpressionOp::binaryOperator:
+			{
+				const char opChar = (char)ce.GetByte(pc);
+				const bool invert = (ce.GetByte(pc) != 0);
+				--sp;
+				ApplyBinaryOperator(opChar, invert, stack[sp - 1], stack[sp], true);
+				stack[sp].Set(nullptr);								// release any string that the operand holds
+			}
+			break;
+
+		case ExpressionOp::unaryFunction:
+			ApplyUnaryFunction(ce.GetByte(pc), stack[sp - 1], true);
+			break;
+
+		case ExpressionOp::binaryFunction:
+			--sp;
+			ApplyBinaryFunction(ce.GetByte(pc), stack[sp - 1], stack[sp], true);
+			stack[sp].Set(nullptr);
+			break;
+
+		case ExpressionOp::pushBool:
+			stack[sp++].Set(ce.GetByte(pc) != 0);
+			break;
+
+		case ExpressionOp::parameter:
+		case ExpressionOp::localVariable:
+		case ExpressionOp::globalVariable:
+		case ExpressionOp::objectModel:
+		case ExpressionOp::objectModelEntry:
+			{
+				const uint8_t flags = ce.GetByte(pc);
+				const size_t numIndices = ce.GetByte(pc);
+				const bool wantExists = (flags & CompiledExpression::FlagWantExists) != 0;
+				ObjectExplorationContext context(&gb, (flags & CompiledExpression::FlagWantLength) != 0, wantExists, gb.GetLineNumber(), GetColumn());
+				sp -= numIndices;
+				for (size_t i = 0; i < numIndices; ++i)
+				{
+					if (stack[sp + i].GetType() != TypeCode::Int32)
+					{
+						ThrowParseException("expected integer expression");
+					}
+					context.ProvideIndex(stack[sp + i].iVal);
+				}
+
+				ExpressionValue& rslt = stack[sp++];
+				switch (op)
+				{
+				case ExpressionOp::parameter:
+					GetVariableValue(rslt, &gb.GetVariables(), ce.GetString(pc), true, wantExists);
+					break;
+
+				case ExpressionOp::localVariable:
+					GetVariableValue(rslt, &gb.GetVariables(), ce.GetString(pc), false, wantExists);
+					break;
+
+				case ExpressionOp::globalVariable:
+					{
+						auto vars = reprap.GetGlobalVariablesForReading();
+						GetVariableValue(rslt, vars.Ptr(), ce.GetString(pc), false, wantExists);
+					}
+					break;
+
+				case ExpressionOp::objectModel:
+					GetIdentifierValue(rslt, context, ce.GetString(pc), wantExists);
+					break;
+
+				default:
+					{
+						const ObjectModelClassDescriptor * const classDescriptor = (const ObjectModelClassDescriptor *)ce.GetPointer(pc);
+						const ObjectModelTableEntry * const e = (const ObjectModelTableEntry *)ce.GetPointer(pc);
+						const size_t restOffset = ce.GetByte(pc);
+						const char * const id = ce.GetString(pc);
+						CheckStack(StackUsage::GetObjectValueUsingTableNumber);
+						rslt = reprap.GetObjectValueUsingTableEntry(context, classDescriptor, e, id + restOffset);
+						if (context.ObsoleteFieldQueried() && obsoleteField.IsEmpty())
+						{
+							obsoleteField.copy(id);
+						}
+					}
+					break;
+				}
+			}
+			break;
+
+		case ExpressionOp::toBool:
+			ConvertToBool(stack[sp - 1], true);
+			break;
+
+		case ExpressionOp::andJump:
+			{
+				const uint16_t target = ce.GetAddress(pc);
+				ConvertToBool(stack[sp - 1], true);
+				if (stack[sp - 1].bVal)
+				{
+					--sp;
+				}
+				else
+				{
+					pc = target;
+				}
+			}
+			break;
+
+		case ExpressionOp::orJump:
+			{
+				const uint16_t target = ce.GetAddress(pc);
+				ConvertToBool(stack[sp - 1], true);
+				if (stack[sp - 1].bVal)
+				{
+					pc = target;
+				}
+				else
+				{
+					--sp;
+				}
+			}
+			break;
+
+		case ExpressionOp::jumpIfFalse:
+			{
+				const uint16_t target = ce.GetAddress(pc);
+				--sp;
+				ConvertToBool(stack[sp], true);
+				if (!stack[sp].bVal)
+				{
+					pc = target;
+				}
+			}
+			break;
+
+		case ExpressionOp::jump:
+			{
+				const uint16_t target = ce.GetAddress(pc);
+				pc = target;
+			}
+			break;
+
+		default:
+			THROW_INTERNAL_ERROR;
+		}
+	}
+
+	result = stack[0];
+
+	// String literals point into the code, which the caller is about to discard
+	if (result.GetType() == TypeCode::CString && ce.IsInCode(result.sVal))
+	{
+		StringHandle sh(result.sVal);
+		result.Set(sh);
+	}
+}
+
+#endif
 
 // Parse a string to a DateTime
 time_t ExpressionParser::ParseDateTime(const char *s) const THROWS(GCodeException)
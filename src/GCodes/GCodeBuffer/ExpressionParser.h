@@ -13,6 +13,7 @@
 #include <GCodes/GCodeException.h>
 
 class VariableSet;
+class CompiledExpression;
 
 class ExpressionParser
 {
@@ -42,6 +43,7 @@ private:
 	[[noreturn]] void __attribute__((noinline)) ThrowParseException(const char *str, uint32_t param) const THROWS(GCodeException);
 
 	void ParseInternal(ExpressionValue& val, bool evaluate, uint8_t priority) THROWS(GCodeException);
+	bool ParseBinaryOperator(uint8_t priority, char& opChar, bool& invert, uint8_t& opPrio) THROWS(GCodeException);
 	void ParseExpectKet(ExpressionValue& rslt, bool evaluate, char expectedKet) THROWS(GCodeException);
 	void __attribute__((noinline)) ParseNumber(ExpressionValue& rslt) noexcept
 		pre(readPointer >= 0; isdigit(gb.buffer[readPointer]));
@@ -53,6 +55,21 @@ private:
 	time_t ParseDateTime(const char *s) const THROWS(GCodeException);
 
 	void GetVariableValue(ExpressionValue& rslt, const VariableSet *vars, const char *name, bool parameter, bool wantExists) THROWS(GCodeException);
+	void GetIdentifierValue(ExpressionValue& rslt, ObjectExplorationContext& context, const char *id, bool applyExists) THROWS(GCodeException);
+	void GetNamedConstantValue(ExpressionValue& rslt, unsigned int whichConstant) const THROWS(GCodeException);
+
+	void ApplyUnaryOperator(char op, ExpressionValue& val, bool evaluate) THROWS(GCodeException);
+	void ApplyBinaryOperator(char opChar, bool invert, ExpressionValue& val, ExpressionValue& val2, bool evaluate) THROWS(GCodeException);
+	void ApplyUnaryFunction(unsigned int func, ExpressionValue& rslt, bool evaluate) THROWS(GCodeException);
+	void ApplyBinaryFunction(unsigned int func, ExpressionValue& rslt, ExpressionValue& nextOperand, bool evaluate) THROWS(GCodeException);
+
+#if SUPPORT_COMPILED_EXPRESSIONS
+	bool EvaluateCompiled(ExpressionValue& result) noexcept;
+	void CompileInternal(CompiledExpression& ce, uint8_t priority) THROWS(GCodeException);
+	void CompileExpectKet(CompiledExpression& ce, char closingBracket) THROWS(GCodeException);
+	void __attribute__((noinline)) CompileIdentifierExpression(CompiledExpression& ce, bool applyLengthOperator, bool applyExists) THROWS(GCodeException);
+	void ExecuteCompiled(const CompiledExpression& ce, ExpressionValue& result) THROWS(GCodeException);
+#endif
 
 	void ConvertToFloat(ExpressionValue& val, bool evaluate) const THROWS(GCodeException);
 	void ConvertToBool(ExpressionValue& val, bool evaluate) const THROWS(GCodeException);
@@ -61,10 +61,17 @@ constexpr ObjectModelTableEntry GCodeBuffer::objectModelTable[] =
 	{ "name",				OBJECT_MODEL_FUNC(self->codeChannel.ToString()),									ObjectModelEntryFlags::none },
 	{ "stackDepth",			OBJECT_MODEL_FUNC((int32_t)self->GetStackDepth()),									ObjectModelEntryFlags::none },
 	{ "state",				OBJECT_MODEL_FUNC(self->GetStateText()),											ObjectModelEntryFlags::live },
+	{ "stats",				OBJECT_MODEL_FUNC(self, 1),															ObjectModelEntryFlags::live },
 	{ "volumetric",			OBJECT_MODEL_FUNC((bool)self->machineState->volumetricExtrusion),					ObjectModelEntryFlags::none },
+
+	// 1. inputs[].stats
+	{ "commandsExecuted",	OBJECT_MODEL_FUNC((int32_t)self->stats.commandsExecuted),							ObjectModelEntryFlags::live },
+	{ "inputWaitTime",		OBJECT_MODEL_FUNC((float)self->stats.inputWaitMillis * MillisToSeconds, 1),		ObjectModelEntryFlags::live },
+	{ "linesReceived",		OBJECT_MODEL_FUNC((int32_t)self->stats.linesReceived),								ObjectModelEntryFlags::live },
+	{ "resourceWaitTime",	OBJECT_MODEL_FUNC((float)self->stats.resourceWaitMillis * MillisToSeconds, 1),	ObjectModelEntryFlags::live },
 };
 
-constexpr uint8_t GCodeBuffer::objectModelTableDescriptor[] = { 1, 12 };
+constexpr uint8_t GCodeBuffer::objectModelTableDescriptor[] = { 2, 13, 4 };
 
 DEFINE_GET_OBJECT_MODEL_TABLE(GCodeBuffer)
 
@@ -142,6 +149,7 @@ void GCodeBuffer::Init() noexcept
 #endif
 	stringParser.Init();
 	timerRunning = false;
+	NoteIdle();
 }
 
 void GCodeBuffer::StartTimer() noexcept
@@ -230,6 +238,62 @@ void GCodeBuffer::Diagnostics(MessageType mtype) noexcept
 	}
 	scratchString.cat('\n');
 	reprap.GetPlatform().Message(mtype, scratchString.c_str());
+
+	if (stats.linesReceived != 0)
+	{
+		const uint32_t now = millis();
+		const float linesPerSecond = (now == stats.lastReportTime) ? 0.0
+										: (float)(stats.linesReceived - stats.linesAtLastReport) * 1000.0/(float)(now - stats.lastReportTime);
+		reprap.GetPlatform().MessageF(mtype, " lines %" PRIu32 " (%.1f/sec), commands %" PRIu32 ", input wait %.1fs, resource wait %.1fs\n",
+										stats.linesReceived, (double)linesPerSecond, stats.commandsExecuted,
+										(double)(stats.inputWaitMillis * MillisToSeconds), (double)(stats.resourceWaitMillis * MillisToSeconds));
+		stats.lastReportTime = now;
+		stats.linesAtLastReport = stats.linesReceived;
+	}
+}
+
+// Record that we have received a complete line or binary code
+void GCodeBuffer::NoteLineReceived() noexcept
+{
+	++stats.linesReceived;
+	if (stats.idle)
+	{
+		stats.idle = false;
+		stats.inputWaitMillis += millis() - stats.idleStartTime;
+	}
+}
+
+// Record that we have finished with the last line we received
+void GCodeBuffer::NoteIdle() noexcept
+{
+	if (!stats.idle)
+	{
+		stats.idle = true;
+		stats.idleStartTime = millis();
+	}
+}
+
+// Record that the current command can't proceed until it gets a lock or movement stops.
+// This is called each time we try again, so we add up the intervals between consecutive attempts.
+void GCodeBuffer::NoteResourceWait() const noexcept
+{
+	const uint32_t now = millis();
+	if (stats.waitingForResource)
+	{
+		stats.resourceWaitMillis += now - stats.lastResourceWaitTime;
+	}
+	stats.lastResourceWaitTime = now;
+	stats.waitingForResource = true;
+}
+
+// Record that the current command got the lock or movement stopped, so that a later wait by the same command starts a new interval
+void GCodeBuffer::NoteResourceWaitEnded() const noexcept
+{
+	if (stats.waitingForResource)
+	{
+		stats.resourceWaitMillis += millis() - stats.lastResourceWaitTime;
+		stats.waitingForResource = false;
+	}
 }
 
 // Add a character to the end
@@ -239,9 +303,29 @@ bool GCodeBuffer::Put(char c) noexcept
 	machineState->lastCodeFromSbc = false;
 	isBinaryBuffer = false;
 #endif
-	return stringParser.Put(c);
+	if (stringParser.Put(c))
+	{
+		NoteLineReceived();
+		return true;
+	}
+	return false;
+}
+
+#if SUPPORT_BINARY_GCODE
+
+// Add a move decoded from a binary G-code file, overwriting any existing content
+void GCodeBuffer::PutDecodedMove(const BinaryGCodeMove& move) noexcept
+{
+# if HAS_SBC_INTERFACE
+	machineState->lastCodeFromSbc = false;
+	isBinaryBuffer = false;
+# endif
+	stringParser.PutDecodedMove(move);
+	NoteLineReceived();
 }
 
+#endif
+
 // Decode the command in the buffer when it is complete
 void GCodeBuffer::DecodeCommand() noexcept
 {
@@ -264,6 +348,7 @@ void GCodeBuffer::PutBinary(const uint32_t *data, size_t len) noexcept
 	isBinaryBuffer = true;
 	macroJustStarted = false;
 	binaryParser.Put(data, len);
+	NoteLineReceived();
 }
 
 #endif
@@ -276,6 +361,7 @@ void GCodeBuffer::PutAndDecode(const char *str, size_t len) noexcept
 	isBinaryBuffer = false;
 #endif
 	stringParser.PutAndDecode(str, len);
+	NoteLineReceived();
 }
 
 // Add a null-terminated string, overwriting any existing content
@@ -286,6 +372,7 @@ void GCodeBuffer::PutAndDecode(const char *str) noexcept
 	isBinaryBuffer = false;
 #endif
 	stringParser.PutAndDecode(str);
+	NoteLineReceived();
 }
 
 void GCodeBuffer::StartNewFile() noexcept
@@ -300,7 +387,12 @@ void GCodeBuffer::StartNewFile() noexcept
 // Called when we reach the end of the file we are reading from. Return true if there is a line waiting to be processed.
 bool GCodeBuffer::FileEnded() noexcept
 {
-	return NOT_BINARY_AND(stringParser.FileEnded());
+	if (NOT_BINARY_AND(stringParser.FileEnded()))
+	{
+		NoteLineReceived();
+		return true;
+	}
+	return false;
 }
 
 char GCodeBuffer::GetCommandLetter() const noexcept
@@ -745,6 +837,12 @@ void GCodeBuffer::SetFinished(bool f) noexcept
 #endif
 		LatestMachineState().firstCommandAfterRestart = false;
 		PARSER_OPERATION(SetFinished());
+		++stats.commandsExecuted;
+		stats.waitingForResource = false;
+		if (bufferState != GCodeBufferState::ready)
+		{
+			NoteIdle();
+		}
 	}
 	else
 	{
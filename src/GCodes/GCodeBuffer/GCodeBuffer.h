@@ -10,6 +10,7 @@
 
 #include "BinaryParser.h"
 #include "StringParser.h"
+#include "GCodeChannelStatistics.h"
 
 #include <RepRapFirmware.h>
 #include <GCodes/GCodeChannel.h>
@@ -52,6 +53,9 @@ public:
 	bool Put(char c) noexcept SPEED_CRITICAL;									// Add a character to the end
 #if HAS_SBC_INTERFACE
 	void PutBinary(const uint32_t *data, size_t len) noexcept;					// Add an entire binary G-Code, overwriting any existing content
+#endif
+#if SUPPORT_BINARY_GCODE
+	void PutDecodedMove(const BinaryGCodeMove& move) noexcept;					// Add a move decoded from a binary G-code file, overwriting any existing content
 #endif
 	void PutAndDecode(const char *data, size_t len) noexcept;					// Add an entire G-Code, overwriting any existing content
 	void PutAndDecode(const char *str) noexcept;								// Add a null-terminated string, overwriting any existing content
@@ -238,6 +242,9 @@ public:
 	void MotionStopped() noexcept { motionCommanded = false; }
 	bool WasMotionCommanded() const noexcept { return motionCommanded; }
 
+	void NoteResourceWait() const noexcept;						// Record that the current command can't proceed until it gets a lock or movement stops
+	void NoteResourceWaitEnded() const noexcept;					// Record that the current command got the lock or movement stopped
+
 	void AddParameters(VariableSet& vars, int codeRunning) noexcept;
 	VariableSet& GetVariables() const noexcept;
 
@@ -265,6 +272,9 @@ private:
 	const char *GetStateText() const noexcept;
 #endif
 
+	void NoteLineReceived() noexcept;
+	void NoteIdle() noexcept;
+
 	const GCodeChannel codeChannel;						// Channel number of this instance
 	GCodeInput *normalInput;							// Our normal input stream, or nullptr if there isn't one
 
@@ -295,6 +305,8 @@ private:
 	bool timerRunning;									// True if we are waiting
 	bool motionCommanded;								// true if this GCode stream has commanded motion since it last waited for motion to stop
 
+	mutable GCodeChannelStatistics stats;				// mutable so that functions that lock resources can record waits
+
 	alignas(4) char buffer[MaxGCodeLength];				// must be aligned because in SBC binary mode we do dword fetches from it
 
 #if HAS_SBC_INTERFACE
@@ -0,0 +1,27 @@
+/*
+ * GCodeChannelStatistics.h
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#ifndef SRC_GCODES_GCODEBUFFER_GCODECHANNELSTATISTICS_H_
+#define SRC_GCODES_GCODEBUFFER_GCODECHANNELSTATISTICS_H_
+
+#include <cstdint>
+
+// Counters that show how busy a G-code channel is and what it spends its time waiting for
+struct GCodeChannelStatistics
+{
+	uint32_t linesReceived = 0;						// how many complete lines or binary codes we have received
+	uint32_t commandsExecuted = 0;					// how many commands have finished executing
+	uint32_t inputWaitMillis = 0;					// total time spent idle waiting for the next line
+	uint32_t resourceWaitMillis = 0;				// total time commands spent waiting for a lock or for movement to stop
+	uint32_t idleStartTime = 0;
+	uint32_t lastResourceWaitTime = 0;
+	uint32_t lastReportTime = 0;					// when we last reported the statistics in M122, so that we can report the rate of receiving lines
+	uint32_t linesAtLastReport = 0;
+	bool idle = true;
+	bool waitingForResource = false;
+};
+
+#endif /* SRC_GCODES_GCODEBUFFER_GCODECHANNELSTATISTICS_H_ */
@@ -15,6 +15,7 @@
 #include <Platform/Platform.h>
 #include <Platform/RepRap.h>
 #include <Networking/NetworkDefs.h>
+#include <Platform/FloatConversion.h>
 
 // Replace the default definition of THROW_INTERNAL_ERROR by one that gives line information
 #undef THROW_INTERNAL_ERROR
@@ -37,7 +38,10 @@ void StringParser::Init() noexcept
 	gcodeLineEnd = 0;
 	commandStart = commandLength = 0;								// set both to zero so that calls to GetFilePosition don't return negative values
 	readPointer = -1;
-	hadLineNumber = hadChecksum = overflowed = seenExpression = false;
+	hadLineNumber = hadChecksum = overflowed = seenExpression = parameterIndexValid = false;
+#if SUPPORT_BINARY_GCODE
+	isDecodedMove = false;
+#endif
 	computedChecksum = 0;
 	gb.bufferState = GCodeBufferState::parseNotStarted;
 	commandIndent = 0;
@@ -874,6 +878,16 @@ bool StringParser::EvaluateCondition() THROWS(GCodeException)
 // On return, the state must be set to 'ready' to indicate that a command is available and we should stop adding characters.
 void StringParser::DecodeCommand() noexcept
 {
+#if SUPPORT_BINARY_GCODE
+	if (isDecodedMove)
+	{
+		gb.bufferState = GCodeBufferState::ready;	// PutDecodedMove has already set up the command and its parameters
+		return;
+	}
+#endif
+
+	parameterIndexValid = false;					// FindParameters will set this if it indexes the parameters
+
 	// Check for a valid command letter at the start
 	char cl = gb.buffer[commandStart];
 	if (cl == '\'')									// check for a lowercase axis letter in Fanuc mode
@@ -981,11 +995,14 @@ void StringParser::DecodeCommand() noexcept
 
 // Find where the end of the command is. We assume that a G or M not inside quotes or { } and not preceded by ' is the start of a new command.
 // This isn't true if the command has an unquoted string argument, but we deal with that later.
+// While we are doing this we record where the first occurrence of each uppercase parameter letter is, so that Seen doesn't need to search for it.
 void StringParser::FindParameters() noexcept
 {
 	bool inQuotes = false;
+	bool escaped = false;
 	unsigned int localBraceCount = 0;
 	parametersPresent.Clear();
+	parametersIndexed.Clear();
 	for (commandEnd = parameterStart; commandEnd < gcodeLineEnd; ++commandEnd)
 	{
 		const char c = gb.buffer[commandEnd];
@@ -995,6 +1012,8 @@ void StringParser::FindParameters() noexcept
 		}
 		else if (!inQuotes)
 		{
+			const bool wasEscaped = escaped;
+			escaped = (c == '\'' && !wasEscaped);				// this must match the way that Seen recognises escaped letters
 			if (c == '{')
 			{
 				++localBraceCount;
@@ -1016,10 +1035,16 @@ void StringParser::FindParameters() noexcept
 				if (c2 >= 'A' && c2 <= 'Z' && (c2 != 'E' || commandEnd == parameterStart || !isdigit(gb.buffer[commandEnd - 1])))
 				{
 					parametersPresent.SetBit(c2 - 'A');
+					if (!wasEscaped && !parametersIndexed.IsBitSet(c2 - 'A'))
+					{
+						parameterOffsets[c2 - 'A'] = commandEnd;
+						parametersIndexed.SetBit(c2 - 'A');
+					}
 				}
 			}
 		}
 	}
+	parameterIndexValid = true;
 }
 
 // Add an entire string, overwriting any existing content and adding '\n' at the end if necessary to make it a complete line
@@ -1055,6 +1080,55 @@ void StringParser::PutCommand(const char *str) noexcept
 	} while (c != 0);
 }
 
+#if SUPPORT_BINARY_GCODE
+
+// Put a G0 or G1 command decoded from a binary G-code file. We set up the state that LineFinished, DecodeCommand and FindParameters
+// would have set up if we had parsed its text, and ReadFloatValue returns the decoded values instead of parsing them.
+// We still copy the text to the buffer, because error messages, debug output, queued commands and file uploads use it.
+void StringParser::PutDecodedMove(const BinaryGCodeMove& move) noexcept
+{
+	static_assert(BinaryGCodeMove::MaxTextLength < MaxGCodeLength);
+
+	Init();
+	++gb.CurrentFileMachineState().lineNumber;
+	memcpy(gb.buffer, move.text, move.textLength + 1);
+	gcodeLineEnd = move.textLength;
+	commandStart = 0;
+	commandLength = 1;								// so that GetFilePosition returns the position of the move record until we have finished with it
+	if (reprap.GetDebugFlags(moduleGcodes).IsBitSet(gb.GetChannel().ToBaseType()) && fileBeingWritten == nullptr)
+	{
+		debugPrintf("%s: %s\n", gb.GetChannel().ToString(), gb.buffer);
+	}
+
+	commandLetter = 'G';
+	hasCommandNumber = true;
+	commandNumber = move.commandNumber;
+	commandFraction = -1;
+	parameterStart = min<unsigned int>(3, gcodeLineEnd);	// skip "G0 " or "G1 "
+	commandEnd = gcodeLineEnd;
+	parametersPresent.Clear();
+	parametersIndexed.Clear();
+	for (size_t i = 0; i < BinaryGCode::NumMoveParameters; ++i)
+	{
+		if (move.parametersPresent & (1u << i))
+		{
+			const unsigned int letterOffset = move.letterOffsets[i];
+			const unsigned int letterIndex = gb.buffer[letterOffset] - 'A';
+			parametersPresent.SetBit(letterIndex);
+			parametersIndexed.SetBit(letterIndex);
+			parameterOffsets[letterIndex] = letterOffset;
+			decodedValueEnds[i] = move.valueEnds[i];
+			decodedValues[i] = move.values[i];
+		}
+	}
+	parameterIndexValid = true;
+	decodedValuesPresent = move.valuesConverted;
+	isDecodedMove = true;
+	gb.bufferState = GCodeBufferState::parsingGCode;
+}
+
+#endif
+
 void StringParser::SetFinished() noexcept
 {
 	if (commandEnd < gcodeLineEnd)
@@ -1080,7 +1154,7 @@ FilePosition StringParser::GetFilePosition() const noexcept
 # endif
 	   )
 	{
-		return gb.LatestMachineState().fileState.GetPosition() - gb.fileInput->BytesCached() - commandLength + commandStart;
+		return gb.fileInput->GetPosition(gb.LatestMachineState().fileState, commandLength - commandStart);
 	}
 #endif
 	return noFilePosition;
@@ -1115,6 +1189,17 @@ bool StringParser::Seen(char c) noexcept
 	{
 		return false;
 	}
+	else if (parameterIndexValid)
+	{
+		// FindParameters has already found where the first unescaped occurrence of this letter is, if there is one
+		if (parametersIndexed.IsBitSet(c - 'A'))
+		{
+			readPointer = parameterOffsets[c - 'A'] + 1;
+			return true;
+		}
+		readPointer = -1;
+		return false;
+	}
 
 	bool inQuotes = false;
 	bool escaped = false;
@@ -1429,6 +1514,7 @@ void StringParser::InternalGetPossiblyQuotedString(const StringRef& str) THROWS(
 	else
 	{
 		commandEnd = gcodeLineEnd;				// the string is the remainder of the line of gcode
+		parameterIndexValid = false;			// the parameter index doesn't cover the extra characters
 		for (;;)
 		{
 			const char c = gb.buffer[readPointer++];
@@ -1787,8 +1873,22 @@ void StringParser::CheckNumberFound(const char *endptr) THROWS(GCodeException)
 }
 
 // Functions to read values from lines of GCode, allowing for expressions and variable substitution
+
 float StringParser::ReadFloatValue() THROWS(GCodeException)
 {
+#if SUPPORT_BINARY_GCODE
+	if (isDecodedMove)
+	{
+		// Return the decoded value if we have it, which is exactly what we would get by parsing it
+		const int index = BinaryGCodeMove::GetParameterIndex(gb.buffer[readPointer - 1]);
+		if (index >= 0 && (decodedValuesPresent & (1u << index)))
+		{
+			readPointer = decodedValueEnds[index];
+			return decodedValues[index];
+		}
+	}
+#endif
+
 	if (gb.buffer[readPointer] == '{')
 	{
 		ExpressionParser parser(gb, gb.buffer + readPointer, gb.buffer + ARRAY_SIZE(gb.buffer), commandIndent + readPointer);
@@ -1798,7 +1898,11 @@ float StringParser::ReadFloatValue() THROWS(GCodeException)
 	}
 
 	const char *endptr;
-	const float rslt = SafeStrtof(gb.buffer + readPointer, &endptr);
+	float rslt;
+	if (!ReadDecimalFloat(gb.buffer + readPointer, rslt, endptr))
+	{
+		rslt = SafeStrtof(gb.buffer + readPointer, &endptr);
+	}
 	CheckNumberFound(endptr);
 	return rslt;
 }
@@ -16,6 +16,10 @@
 #include <Networking/NetworkDefs.h>
 #include <Storage/CRC16.h>
 
+#if SUPPORT_BINARY_GCODE
+# include <GCodes/BinaryGCodeBlock.h>
+#endif
+
 class GCodeBuffer;
 class IPAddress;
 class MacAddress;
@@ -29,6 +33,9 @@ public:
 	void Diagnostics(MessageType mtype) noexcept;							// Write some debug info
 	bool Put(char c) noexcept SPEED_CRITICAL;				// Add a character to the end
 	void PutCommand(const char *str) noexcept;								// Put a complete command but don't decode it
+#if SUPPORT_BINARY_GCODE
+	void PutDecodedMove(const BinaryGCodeMove& move) noexcept;				// Put a move decoded from a binary G-code file, which doesn't need to be parsed
+#endif
 	void DecodeCommand() noexcept;											// Decode the next command in the line
 	void PutAndDecode(const char *str, size_t len) noexcept;				// Add an entire string, overwriting any existing content
 	void PutAndDecode(const char *str) noexcept;							// Add a null-terminated string, overwriting any existing content
@@ -132,6 +139,8 @@ private:
 	unsigned int braceCount;							// how many nested { } we are inside
 	unsigned int gcodeLineEnd;							// Number of characters in the entire line of gcode
 	Bitmap<uint32_t> parametersPresent;					// which parameters are present in this command
+	Bitmap<uint32_t> parametersIndexed;					// which uppercase parameters have their positions recorded in parameterOffsets
+	uint16_t parameterOffsets[26];						// index in the buffer of the first unescaped occurrence of each parameter letter
 	int readPointer;									// Where in the buffer to read next, or -1
 
 	FileStore *fileBeingWritten;						// If we are copying GCodes to a file, which file it is
@@ -163,6 +172,13 @@ private:
 	bool warnedAboutMixedSpacesAndTabs;
 	bool overflowed;
 	bool seenExpression;
+	bool parameterIndexValid;							// true if parametersIndexed and parameterOffsets are valid for this command
+#if SUPPORT_BINARY_GCODE
+	bool isDecodedMove;									// true if the command is a move decoded from a binary G-code file
+	uint8_t decodedValuesPresent;						// bitmap of the parameters of a decoded move whose values we have, in the order used by BinaryGCodeMove
+	uint8_t decodedValueEnds[BinaryGCode::NumMoveParameters];	// index in the buffer of the end of the text of each decoded value
+	float decodedValues[BinaryGCode::NumMoveParameters];		// the decoded values
+#endif
 
 	bool checksumRequired;								// True if we only accept commands with a valid checksum
 	bool crcRequired;									// True if we only accept commands with a valid CRC, except for M409 commands
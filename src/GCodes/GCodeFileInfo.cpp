@@ -7,6 +7,10 @@
 
 #include "GCodeFileInfo.h"
 
+#if SUPPORT_BINARY_GCODE
+# include <Storage/FileStore.h>
+#endif
+
 void GCodeFileInfo::Init() noexcept
 {
 	isValid = false;
@@ -19,6 +23,9 @@ void GCodeFileInfo::Init() noexcept
 	lastModifiedTime = 0;
 	generatedBy.Clear();
 	fileSize = 0;
+#if SUPPORT_BINARY_GCODE
+	gcodeFileFormat = GCodeFileFormat::unknown;
+#endif
 	for (float& f : filamentNeeded)
 	{
 		f = 0.0;
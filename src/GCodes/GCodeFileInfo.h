@@ -10,6 +10,10 @@
 
 #include "RepRapFirmware.h"
 
+#if SUPPORT_BINARY_GCODE
+enum class GCodeFileFormat : uint8_t;
+#endif
+
 // Struct to hold Gcode file information
 struct GCodeFileInfo
 {
@@ -40,6 +44,9 @@ struct GCodeFileInfo
 	unsigned int numFilaments;
 	bool isValid;
 	bool incomplete;
+#if SUPPORT_BINARY_GCODE
+	GCodeFileFormat gcodeFileFormat;					// unknown if we didn't read the header
+#endif
 	ThumbnailInfo thumbnails[MaxThumbnails];
 	String<StringLength50> generatedBy;
 };
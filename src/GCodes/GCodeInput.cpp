@@ -11,6 +11,10 @@
 #include "GCodes.h"
 #include "GCodeBuffer/GCodeBuffer.h"
 
+#if SUPPORT_BINARY_GCODE
+# include <PrintMonitor/PrintMonitor.h>
+#endif
+
 const size_t GCodeInputFileReadThreshold = 128;		// How many free bytes must be available before data is read from the file
 const size_t GCodeInputUSBReadThreshold = 128;		// How many free bytes must be available before we read more data from USB
 
@@ -250,9 +254,74 @@ bool NetworkGCodeInput::FillBuffer(GCodeBuffer *gb) noexcept /*override*/
 
 // File-based G-code input source
 
+#if SUPPORT_FILE_READ_AHEAD
+
+# include <Platform/Platform.h>
+# include <Platform/TaskPriorities.h>
+# include <Platform/Tasks.h>
+
+constexpr size_t FileReadAheadTaskStackWords = 300;
+constexpr size_t ReadAheadAlignment = 512;						// we align reads after the first one to sector boundaries, so that FatFs can transfer whole sectors directly to our buffer
+static_assert(MinFileReadAheadBufferSize % ReadAheadAlignment == 0);
+constexpr uint32_t ReadAheadWaitTimeout = 10;					// in case we miss a wakeup
+static Task<FileReadAheadTaskStackWords> *fileReadAheadTask = nullptr;
+
+extern "C" [[noreturn]] void FileReadAheadTaskStart(void *param) noexcept
+{
+	static_cast<FileGCodeInput*>(param)->ReadAheadTask();
+}
+
+#endif
+
+FileGCodeInput::FileGCodeInput() noexcept : RegularGCodeInput()
+#if SUPPORT_FILE_READ_AHEAD
+	, waitingTask(nullptr), readAheadBufferSize(DefaultFileReadAheadBufferSize), allocatedBufferSize(0), consumeBufferPosition(0), consumeOffset(0), consumeIndex(0), fillIndex(0), stopRequested(false), readAheadError(false),
+	  numWaits(0), totalWaitMillis(0), maxWaitMillis(0)
+#endif
+{
+#if SUPPORT_FILE_READ_AHEAD
+	for (ReadAheadBuffer& buf : readAheadBuffers)
+	{
+		buf.data = nullptr;
+		buf.length = 0;
+		buf.full = buf.endOfFile = false;
+	}
+#endif
+}
+
+#if SUPPORT_BINARY_GCODE
+
+// Fill a GCodeBuffer with the last available G-code. A move decoded from a binary G-code file is passed on without converting it to text and parsing it.
+// The ring buffer is always empty when we have a move to pass on, because we only decode a record when it is empty and text records end with newline.
+bool FileGCodeInput::FillBuffer(GCodeBuffer *gb) noexcept
+{
+	if (binaryDecoder.HaveUnusedMove() && BytesCached() == 0)
+	{
+		gb->PutDecodedMove(binaryDecoder.GetMove());
+		binaryDecoder.UseMove();
+# if HAS_MASS_STORAGE
+		if (gb->IsWritingFile())
+		{
+			gb->WriteToFile();
+			return false;
+		}
+# endif
+		return true;
+	}
+	return RegularGCodeInput::FillBuffer(gb);
+}
+
+#endif
+
 // Reset this input. Should be called when the associated file is being closed
 void FileGCodeInput::Reset() noexcept
 {
+#if SUPPORT_FILE_READ_AHEAD
+	StopReadAhead();
+#endif
+#if SUPPORT_BINARY_GCODE
+	binaryDecoder.Stop();
+#endif
 	lastFileRead.Close();
 	RegularGCodeInput::Reset();
 }
@@ -266,6 +335,24 @@ void FileGCodeInput::Reset(const FileData &file) noexcept
 	}
 }
 
+// Get the position in the file of the character 'bytesBack' before the next character that has not been read from our buffer
+FilePosition FileGCodeInput::GetPosition(const FileData &file, size_t bytesBack) const noexcept
+{
+#if SUPPORT_BINARY_GCODE
+	if (binaryDecoder.IsDecoding(file))
+	{
+		return binaryDecoder.GetPosition(BytesCached() + bytesBack);
+	}
+#endif
+#if SUPPORT_FILE_READ_AHEAD
+	if (IsReadingAhead(file))
+	{
+		return consumeBufferPosition + consumeOffset - BytesCached() - bytesBack;
+	}
+#endif
+	return file.GetPosition() - BytesCached() - bytesBack;
+}
+
 // Read another chunk of G-codes from the file and return true if more data is available
 GCodeInputReadResult FileGCodeInput::ReadFromFile(FileData &file) noexcept
 {
@@ -274,6 +361,26 @@ GCodeInputReadResult FileGCodeInput::ReadFromFile(FileData &file) noexcept
 	// Keep track of the last file we read from
 	if (lastFileRead.IsLive() && lastFileRead != file)
 	{
+#if SUPPORT_BINARY_GCODE
+		if (binaryDecoder.IsDecoding(lastFileRead))
+		{
+			// Rewind back to the first record we haven't finished with. The decoder resynchronises when we start reading the file again.
+			const FilePosition pos = GetPosition(lastFileRead);
+			binaryDecoder.Stop();
+			lastFileRead.Seek(pos);
+		}
+		else
+#endif
+#if SUPPORT_FILE_READ_AHEAD
+		if (IsReadingAhead(lastFileRead))
+		{
+			// Rewind back to the first character we haven't parsed, taking account of the data in the read-ahead buffers
+			const FilePosition pos = GetPosition(lastFileRead);
+			StopReadAhead();
+			lastFileRead.Seek(pos);
+		}
+		else
+#endif
 		if (bytesCached > 0)
 		{
 			// Rewind back to the right position so we can resume at the right position later.
@@ -285,6 +392,30 @@ GCodeInputReadResult FileGCodeInput::ReadFromFile(FileData &file) noexcept
 	}
 	lastFileRead.CopyFrom(file);
 
+#if SUPPORT_BINARY_GCODE
+	if (!binaryDecoder.IsDecoding(file) && IsBinaryGCodeFile(file) && !binaryDecoder.Start(file))
+	{
+		return GCodeInputReadResult::error;
+	}
+
+	if (binaryDecoder.IsDecoding(file))
+	{
+		return ReadFromBinaryFile(bytesCached);
+	}
+#endif
+
+#if SUPPORT_FILE_READ_AHEAD
+	if (!IsReadingAhead(file) && file.Length() >= MinFileBuffersForReadAhead * readAheadBufferSize)
+	{
+		StartReadAhead(file);
+	}
+
+	if (IsReadingAhead(file))
+	{
+		return (bytesCached < GCodeInputFileReadThreshold) ? CopyFromReadAheadBuffer() : GCodeInputReadResult::haveData;
+	}
+#endif
+
 	// Read more from the file
 	if (bytesCached < GCodeInputFileReadThreshold)
 	{
@@ -312,6 +443,249 @@ GCodeInputReadResult FileGCodeInput::ReadFromFile(FileData &file) noexcept
 	return (bytesCached > 0) ? GCodeInputReadResult::haveData : GCodeInputReadResult::noData;
 }
 
+#if SUPPORT_BINARY_GCODE
+
+// Return true if the file is a binary G-code file. Only the file being printed has unknown format when we start reading it (see GCodes::QueueFileToPrint).
+// We decide its format once, normally from the file information that the print monitor has already parsed. Only if that isn't available yet
+// do we read the header here. We record the format in the file object so that we don't need to decide again.
+bool FileGCodeInput::IsBinaryGCodeFile(FileData& file) noexcept
+{
+	if (file.GetGCodeFileFormat() == GCodeFileFormat::unknown)
+	{
+		GCodeFileFormat fmt = reprap.GetPrintMonitor().GetPrintingFileFormat();
+		if (fmt == GCodeFileFormat::unknown)
+		{
+			fmt = (BinaryGCodeDecoder::CheckHeader(file)) ? GCodeFileFormat::binary : GCodeFileFormat::text;
+		}
+		file.SetGCodeFileFormat(fmt);
+	}
+	return file.GetGCodeFileFormat() == GCodeFileFormat::binary;
+}
+
+// Decode another record if we have finished with the previous one, and transfer any text to our ring buffer. We only decode another record
+// when the ring buffer is empty, so that the buffered data always belongs to a single record and the decoder can tell us its file position.
+// Moves are not transferred to the ring buffer, FillBuffer passes them directly to the GCodeBuffer.
+GCodeInputReadResult FileGCodeInput::ReadFromBinaryFile(size_t bytesCached) noexcept
+{
+	if (binaryDecoder.HaveUnusedMove() || (bytesCached != 0 && !binaryDecoder.HaveUnusedText()))
+	{
+		return GCodeInputReadResult::haveData;
+	}
+
+	if (!binaryDecoder.HaveUnusedText())
+	{
+		const GCodeInputReadResult rslt = binaryDecoder.DecodeRecord();
+		if (rslt != GCodeInputReadResult::haveData || binaryDecoder.HaveUnusedMove())
+		{
+			return rslt;
+		}
+	}
+
+	size_t length;
+	const char *_ecv_array const text = binaryDecoder.GetUnusedText(length);
+
+	// Reset the read+write pointers for better performance if possible
+	if (readingPointer == writingPointer)
+	{
+		readingPointer = writingPointer = 0;
+	}
+
+	const size_t bytesToCopy = min<size_t>(min<size_t>(BufferSpaceLeft(), GCodeInputBufferSize - writingPointer), length);
+	memcpy(buffer + writingPointer, text, bytesToCopy);
+	writingPointer = (writingPointer + bytesToCopy) % GCodeInputBufferSize;
+	binaryDecoder.UseText(bytesToCopy);
+	return GCodeInputReadResult::haveData;
+}
+
+#endif
+
+#if SUPPORT_FILE_READ_AHEAD
+
+// Start reading ahead in the file, from its current position
+void FileGCodeInput::StartReadAhead(const FileData& file) noexcept
+{
+	if (fileReadAheadTask == nullptr)
+	{
+		readAheadMutex.Create("FileReadAhead");
+		fileReadAheadTask = new Task<FileReadAheadTaskStackWords>;
+		fileReadAheadTask->Create(FileReadAheadTaskStart, "FILEREAD", this, TaskPriority::FileReadAheadPriority);
+	}
+
+	{
+		MutexLocker lock(readAheadMutex);
+		if (allocatedBufferSize != readAheadBufferSize)
+		{
+			// This is the first time we have read ahead, or the buffer size has been changed since we last did
+			for (ReadAheadBuffer& buf : readAheadBuffers)
+			{
+				delete[] buf.data;
+				buf.data = new char[readAheadBufferSize];
+			}
+			allocatedBufferSize = readAheadBufferSize;
+		}
+		readAheadFile.CopyFrom(file);
+		consumeBufferPosition = file.GetPosition();
+		consumeOffset = 0;
+		consumeIndex = fillIndex = 0;
+		for (ReadAheadBuffer& buf : readAheadBuffers)
+		{
+			buf.full = false;
+		}
+		readAheadError = false;
+	}
+	fileReadAheadTask->Give();
+}
+
+// Stop reading ahead and discard the read-ahead data. The caller must seek the file if it is to be read again.
+void FileGCodeInput::StopReadAhead() noexcept
+{
+	if (readAheadFile.IsLive())
+	{
+		stopRequested = true;
+		MutexLocker lock(readAheadMutex);								// wait for the read-ahead task to finish any read that it has started
+		readAheadFile.Close();
+		for (ReadAheadBuffer& buf : readAheadBuffers)
+		{
+			buf.full = false;
+		}
+		stopRequested = false;
+		readAheadError = false;
+	}
+}
+
+// Transfer some data from the read-ahead buffers to our ring buffer. If we have nothing left to parse then wait for the read-ahead task to provide more data.
+GCodeInputReadResult FileGCodeInput::CopyFromReadAheadBuffer() noexcept
+{
+	for (;;)
+	{
+		ReadAheadBuffer& buf = readAheadBuffers[consumeIndex];
+		if (buf.full)
+		{
+			if (consumeOffset < buf.length)
+			{
+				// Reset the read+write pointers for better performance if possible
+				if (readingPointer == writingPointer)
+				{
+					readingPointer = writingPointer = 0;
+				}
+
+				const size_t bytesToCopy = min<size_t>(min<size_t>(BufferSpaceLeft(), GCodeInputBufferSize - writingPointer), buf.length - consumeOffset);
+				memcpy(buffer + writingPointer, buf.data + consumeOffset, bytesToCopy);
+				consumeOffset += bytesToCopy;
+				writingPointer = (writingPointer + bytesToCopy) % GCodeInputBufferSize;
+				return GCodeInputReadResult::haveData;
+			}
+
+			if (buf.endOfFile)
+			{
+				break;
+			}
+
+			// We have used all the data in this buffer, so ask the read-ahead task to fill it again and move on to the other one
+			consumeBufferPosition += buf.length;
+			consumeOffset = 0;
+			buf.full = false;
+			consumeIndex ^= 1;
+			fileReadAheadTask->Give();
+		}
+		else if (readAheadError)
+		{
+			return GCodeInputReadResult::error;
+		}
+		else if (BytesCached() != 0)
+		{
+			break;														// the next buffer isn't ready yet, but we still have data to parse
+		}
+		else
+		{
+			// We have run out of data to parse, so we have to wait for the read-ahead task
+			const uint32_t startTime = millis();
+			waitingTask = TaskBase::GetCallerTaskHandle();
+			while (!buf.full && !readAheadError)
+			{
+				(void)TaskBase::Take(ReadAheadWaitTimeout);
+			}
+			waitingTask = nullptr;
+
+			const uint32_t waitTime = millis() - startTime;
+			++numWaits;
+			totalWaitMillis += waitTime;
+			if (waitTime > maxWaitMillis)
+			{
+				maxWaitMillis = waitTime;
+			}
+		}
+	}
+
+	return (BytesCached() > 0) ? GCodeInputReadResult::haveData : GCodeInputReadResult::noData;
+}
+
+// This is the body of the read-ahead task. It fills the read-ahead buffers in turn.
+[[noreturn]] void FileGCodeInput::ReadAheadTask() noexcept
+{
+	for (;;)
+	{
+		(void)TaskBase::Take(TaskBase::TimeoutUnlimited);				// wait until we are asked to fill a buffer
+		MutexLocker lock(readAheadMutex);
+		while (!stopRequested && readAheadFile.IsLive() && !readAheadError)
+		{
+			ReadAheadBuffer& buf = readAheadBuffers[fillIndex];
+			const ReadAheadBuffer& otherBuf = readAheadBuffers[fillIndex ^ 1];
+			if (buf.full || (otherBuf.full && otherBuf.endOfFile))
+			{
+				break;													// nothing to do until a buffer has been used, or we have already reached the end of the file
+			}
+
+			const size_t bytesToRead = allocatedBufferSize - (readAheadFile.GetPosition() % ReadAheadAlignment);
+			const int bytesRead = readAheadFile.Read(buf.data, bytesToRead);
+			if (bytesRead < 0)
+			{
+				readAheadError = true;
+			}
+			else
+			{
+				buf.length = (size_t)bytesRead;
+				buf.endOfFile = ((size_t)bytesRead < bytesToRead);
+				buf.full = true;
+				fillIndex ^= 1;
+			}
+
+			const TaskHandle t = waitingTask;
+			if (t != nullptr)
+			{
+				t->Give();
+			}
+		}
+	}
+}
+
+// Set the size of each of the read-ahead buffers. We apply the new size the next time we start reading ahead, because the read-ahead task may be using the old buffers.
+GCodeResult FileGCodeInput::SetReadAheadBufferSize(size_t size, const StringRef& reply) noexcept
+{
+	size = ((size + MinFileReadAheadBufferSize - 1)/MinFileReadAheadBufferSize) * MinFileReadAheadBufferSize;
+	if (size > allocatedBufferSize)
+	{
+		const ptrdiff_t memoryNeeded = 2 * size + 1024;									// allow some margin, and assume that the old buffers don't get reused
+		const ptrdiff_t memoryAvailable = Tasks::GetNeverUsedRam();
+		if (memoryNeeded >= memoryAvailable)
+		{
+			reply.printf("insufficient RAM (available %d, needed %d)", memoryAvailable, memoryNeeded);
+			return GCodeResult::error;
+		}
+	}
+	readAheadBufferSize = size;
+	return GCodeResult::ok;
+}
+
+void FileGCodeInput::Diagnostics(MessageType mtype) noexcept
+{
+	reprap.GetPlatform().MessageF(mtype, "File read-ahead waits %" PRIu32 ", total wait time %" PRIu32 "ms, max wait time %" PRIu32 "ms\n",
+									numWaits, totalWaitMillis, maxWaitMillis);
+	maxWaitMillis = 0;
+}
+
+#endif
+
 #endif
 
 // End
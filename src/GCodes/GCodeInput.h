@@ -11,6 +11,7 @@
 #include <RepRapFirmware.h>
 #include <Storage/FileData.h>
 #include <RTOSIface/RTOSIface.h>
+#include "BinaryGCodeDecoder.h"
 
 #include <Stream.h>
 
@@ -105,19 +106,72 @@ enum class GCodeInputReadResult : uint8_t { haveData, noData, error };
 
 // This class is an expansion of the RegularGCodeInput class to buffer G-codes and to rewind file positions when
 // nested G-code files are started. However buffered codes are not explicitly checked for M112.
+// If SUPPORT_FILE_READ_AHEAD is enabled then large files are read into two large buffers by a separate task, so that the GCodes task doesn't have to wait
+// for the SD card while there is data to parse. The read-ahead task uses its own reference to the file, so that the file stays open until we stop reading ahead.
+// If SUPPORT_BINARY_GCODE is enabled then binary G-code files are decoded one record at a time, and are not read ahead.
+// Text records are passed on in the ring buffer as usual. Decoded moves are passed directly to the GCodeBuffer, so they are not parsed.
 class FileGCodeInput : public RegularGCodeInput
 {
 public:
 
-	FileGCodeInput() noexcept : RegularGCodeInput() { }
+	FileGCodeInput() noexcept;
 
 	void Reset() noexcept override;								// Clears the buffer. Should be called when the associated file is being closed
 	void Reset(const FileData &file) noexcept;					// Clears the buffer of a specific file. Should be called when it is closed or re-opened outside the reading context
 
 	GCodeInputReadResult ReadFromFile(FileData &file) noexcept;	// Read another chunk of G-codes from the file and return true if more data is available
+#if SUPPORT_BINARY_GCODE
+	bool FillBuffer(GCodeBuffer *gb) noexcept override;			// Fill a GCodeBuffer with the last available G-code
+#endif
+	FilePosition GetPosition(const FileData &file, size_t bytesBack = 0) const noexcept;	// Get the position in the file of the character 'bytesBack' before the next one that has not been read from our buffer
+
+#if SUPPORT_FILE_READ_AHEAD
+	GCodeResult SetReadAheadBufferSize(size_t size, const StringRef& reply) noexcept;	// Set the size of each read-ahead buffer, taking effect when we next start reading ahead
+	size_t GetReadAheadBufferSize() const noexcept { return readAheadBufferSize; }
+	void Diagnostics(MessageType mtype) noexcept;
+	[[noreturn]] void ReadAheadTask() noexcept;					// The body of the read-ahead task
+#endif
 
 private:
 	FileData lastFileRead;
+
+#if SUPPORT_BINARY_GCODE
+	bool IsBinaryGCodeFile(FileData& file) noexcept;
+	GCodeInputReadResult ReadFromBinaryFile(size_t bytesCached) noexcept;
+
+	BinaryGCodeDecoder binaryDecoder;
+#endif
+
+#if SUPPORT_FILE_READ_AHEAD
+	struct ReadAheadBuffer
+	{
+		char *data;
+		size_t length;											// the number of bytes in the buffer, if it is full
+		volatile bool full;										// set by the read-ahead task when it has filled this buffer, cleared by the GCodes task when it has used the data
+		bool endOfFile;											// true if this is the last buffer of the file
+	};
+
+	void StartReadAhead(const FileData& file) noexcept;
+	void StopReadAhead() noexcept;
+	bool IsReadingAhead(const FileData& file) const noexcept { return readAheadFile.IsLive() && readAheadFile == file; }
+	GCodeInputReadResult CopyFromReadAheadBuffer() noexcept;
+
+	ReadAheadBuffer readAheadBuffers[2];
+	FileData readAheadFile;										// the file we are reading ahead, accessed by the read-ahead task while it owns the mutex
+	Mutex readAheadMutex;										// owned by the read-ahead task while it is reading the file
+	volatile TaskHandle waitingTask;							// the task that is waiting for the read-ahead task to fill a buffer
+	size_t readAheadBufferSize;									// the size of read-ahead buffers that we use when we next start reading ahead
+	size_t allocatedBufferSize;									// the size of the read-ahead buffers that we have allocated, or 0 if we haven't allocated them
+	FilePosition consumeBufferPosition;							// the file position of the start of the buffer that we are transferring data from
+	size_t consumeOffset;										// how many bytes we have transferred from that buffer
+	uint8_t consumeIndex;										// which buffer we are transferring data from
+	uint8_t fillIndex;											// which buffer the read-ahead task fills next
+	volatile bool stopRequested;
+	volatile bool readAheadError;
+
+	uint32_t numWaits;											// how many times we had to wait for the read-ahead task
+	uint32_t totalWaitMillis, maxWaitMillis;
+#endif
 };
 
 #endif
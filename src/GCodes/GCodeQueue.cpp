@@ -11,11 +11,14 @@
 #include "GCodes.h"
 #include "GCodeBuffer/GCodeBuffer.h"
 #include <Movement/Move.h>
+#include <Platform/Tasks.h>
 #include <Fans/LedStripDriver.h>
 
 // GCodeQueue class
 
-GCodeQueue::GCodeQueue() noexcept : freeItems(nullptr), queuedItems(nullptr)
+GCodeQueue::GCodeQueue() noexcept
+	: freeItems(nullptr), queuedItems(nullptr), lastQueuedItem(nullptr), capacity(maxQueuedCodes), numItems(maxQueuedCodes), numQueued(0), maxQueued(0),
+	  numCodesQueued(0), numStalls(0), stallStartTime(0), totalStallMillis(0), stalled(false)
 {
 	for (size_t i = 0; i < maxQueuedCodes; i++)
 	{
@@ -123,31 +126,53 @@ bool GCodeQueue::QueueCode(GCodeBuffer &gb, uint32_t scheduleAt) noexcept
 	// Can we queue this code somewhere?
 	if (freeItems == nullptr)
 	{
+		if (!stalled)
+		{
+			stalled = true;
+			++numStalls;
+			stallStartTime = millis();
+		}
 		return false;
 	}
+	EndStall();
 
 	// Unlink a free element and assign gb's code to it
 	QueuedCode * const code = freeItems;
 	freeItems = code->next;
 	code->AssignFrom(gb);
 	code->executeAtMove = scheduleAt;
-	code->next = nullptr;
 
-	// Append it to the list of queued codes
-	if (queuedItems == nullptr)
+	// Add it to the list of queued codes. The move count doesn't normally decrease, so it almost always goes at the end.
+	if (lastQueuedItem == nullptr || lastQueuedItem->executeAtMove <= scheduleAt)
 	{
-		queuedItems = code;
+		code->next = nullptr;
+		if (lastQueuedItem == nullptr)
+		{
+			queuedItems = code;
+		}
+		else
+		{
+			lastQueuedItem->next = code;
+		}
+		lastQueuedItem = code;
 	}
 	else
 	{
-		QueuedCode *last = queuedItems;
-		while (last->Next() != nullptr)
+		QueuedCode **pp = &queuedItems;
+		while ((*pp)->executeAtMove <= scheduleAt)
 		{
-			last = last->Next();
+			pp = &(*pp)->next;
 		}
-		last->next = code;
+		code->next = *pp;
+		*pp = code;
 	}
 
+	++numCodesQueued;
+	++numQueued;
+	if (numQueued > maxQueued)
+	{
+		maxQueued = numQueued;
+	}
 	return true;
 }
 
@@ -166,11 +191,73 @@ bool GCodeQueue::FillBuffer(GCodeBuffer *gb) noexcept
 
 	// Release this item again
 	queuedItems = queuedItems->next;
-	code->next = freeItems;
-	freeItems = code;
+	if (queuedItems == nullptr)
+	{
+		lastQueuedItem = nullptr;
+	}
+	ReleaseItem(code);
 	return true;
 }
 
+// Return an item that has been unlinked from the queue to the free list, or delete it if the capacity has been reduced
+void GCodeQueue::ReleaseItem(QueuedCode *item) noexcept
+{
+	--numQueued;
+	if (numItems > capacity)
+	{
+		delete item;
+		--numItems;
+	}
+	else
+	{
+		item->next = freeItems;
+		freeItems = item;
+	}
+}
+
+// Record the end of a period in which codes were waiting for space in the queue
+void GCodeQueue::EndStall() noexcept
+{
+	if (stalled)
+	{
+		stalled = false;
+		totalStallMillis += millis() - stallStartTime;
+	}
+}
+
+// Set the number of codes that can be queued. If we reduce it while codes are queued, the excess items are deleted when they are released.
+GCodeResult GCodeQueue::SetCapacity(size_t newCapacity, const StringRef& reply) noexcept
+{
+	if (newCapacity > numItems)
+	{
+		const ptrdiff_t memoryNeeded = (newCapacity - numItems) * sizeof(QueuedCode) + 1024;		// allow some margin
+		const ptrdiff_t memoryAvailable = Tasks::GetNeverUsedRam();
+		if (memoryNeeded >= memoryAvailable)
+		{
+			reply.printf("insufficient RAM (available %d, needed %d)", memoryAvailable, memoryNeeded);
+			return GCodeResult::error;
+		}
+
+		while (numItems < newCapacity)
+		{
+			freeItems = new QueuedCode(freeItems);
+			++numItems;
+		}
+	}
+	else
+	{
+		while (numItems > newCapacity && freeItems != nullptr)
+		{
+			QueuedCode * const item = freeItems;
+			freeItems = item->next;
+			delete item;
+			--numItems;
+		}
+	}
+	capacity = newCapacity;
+	return GCodeResult::ok;
+}
+
 // These inherited virtual functions need to be defined but are not called
 void GCodeQueue::Reset() noexcept
 {
@@ -197,12 +284,8 @@ void GCodeQueue::PurgeEntries() noexcept
 	{
 		if (item->executeAtMove > reprap.GetMove().GetScheduledMoves())
 		{
-			// Release this item
+			// Unlink this item from the list and release it
 			QueuedCode *nextItem = item->Next();
-			item->next = freeItems;
-			freeItems = item;
-
-			// Unlink it from the list
 			if (lastItem == nullptr)
 			{
 				queuedItems = nextItem;
@@ -211,6 +294,7 @@ void GCodeQueue::PurgeEntries() noexcept
 			{
 				lastItem->next = nextItem;
 			}
+			ReleaseItem(item);
 			item = nextItem;
 		}
 		else
@@ -219,6 +303,7 @@ void GCodeQueue::PurgeEntries() noexcept
 			item = item->Next();
 		}
 	}
+	lastQueuedItem = lastItem;
 }
 
 void GCodeQueue::Clear() noexcept
@@ -227,18 +312,18 @@ void GCodeQueue::Clear() noexcept
 	{
 		QueuedCode * const item = queuedItems;
 		queuedItems = item->Next();
-		item->next = freeItems;
-		freeItems = item;
+		ReleaseItem(item);
 	}
+	lastQueuedItem = nullptr;
+	EndStall();
 }
 
 void GCodeQueue::Diagnostics(MessageType mtype) noexcept
 {
-	if (queuedItems == nullptr)
-	{
-		reprap.GetPlatform().Message(mtype, "Code queue is empty\n");
-	}
-	else
+	reprap.GetPlatform().MessageF(mtype, "Code queue %u of %u used (max %u), codes queued %" PRIu32 ", stalls %" PRIu32 " totalling %" PRIu32 "ms\n",
+									numQueued, capacity, maxQueued, numCodesQueued, numStalls, totalStallMillis);
+	maxQueued = numQueued;
+	if (queuedItems != nullptr)
 	{
 		const QueuedCode *item = queuedItems;
 		do
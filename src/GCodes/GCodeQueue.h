@@ -28,13 +28,30 @@ public:
 	void Clear() noexcept;												// Clean up all the stored codes
 	bool IsIdle() const noexcept;										// Return true if there is nothing to do
 
+	GCodeResult SetCapacity(size_t newCapacity, const StringRef& reply) noexcept;	// Set the number of codes that can be queued
+	size_t GetCapacity() const noexcept { return capacity; }
+	size_t GetMaxQueued() const noexcept { return maxQueued; }
+
 	void Diagnostics(MessageType mtype) noexcept;
 
 	static bool ShouldQueueCode(GCodeBuffer &gb) THROWS(GCodeException);	// Return true if this code should be queued
 
 private:
+	void ReleaseItem(QueuedCode *item) noexcept;
+	void EndStall() noexcept;
+
 	QueuedCode *freeItems;
-	QueuedCode *queuedItems;
+	QueuedCode *queuedItems;											// queued codes in order of the move they are to be executed at
+	QueuedCode *lastQueuedItem;
+	size_t capacity;													// how many codes we can queue
+	size_t numItems;													// how many items we have allocated, which is more than the capacity if it has been reduced while they were in use
+	size_t numQueued;
+	size_t maxQueued;													// the maximum number of codes queued since the last diagnostics report
+	uint32_t numCodesQueued;
+	uint32_t numStalls;													// how many codes had to wait because the queue was full
+	uint32_t stallStartTime;
+	uint32_t totalStallMillis;
+	bool stalled;
 };
 
 class QueuedCode
@@ -26,6 +26,7 @@
 #include "GCodes.h"
 
 #include "GCodeBuffer/GCodeBuffer.h"
+#include "GCodeBuffer/CompiledExpression.h"
 #include "GCodeQueue.h"
 #include <Heating/Heat.h>
 #include <Platform/Platform.h>
@@ -1404,6 +1405,12 @@ void GCodes::Diagnostics(MessageType mtype) noexcept
 	}
 
 	codeQueue->Diagnostics(mtype);
+#if SUPPORT_FILE_READ_AHEAD
+	fileGCode->GetFileInput()->Diagnostics(mtype);
+#endif
+#if SUPPORT_COMPILED_EXPRESSIONS
+	CompiledExpressionCache::Diagnostics(mtype);
+#endif
 }
 
 // Lock movement and wait for pending moves to finish.
@@ -1419,20 +1426,24 @@ bool GCodes::LockMovementAndWaitForStandstill(GCodeBuffer& gb) noexcept
 	// Last one gone?
 	if (moveState.segmentsLeft != 0)
 	{
+		gb.NoteResourceWait();
 		return false;
 	}
 
 	// Wait for all the queued moves to stop so we get the actual last position
 	if (!reprap.GetMove().WaitingForAllMovesFinished())
 	{
+		gb.NoteResourceWait();
 		return false;
 	}
 
 	if (&gb != queuedGCode && !IsCodeQueueIdle())		// wait for deferred command queue to catch up
 	{
+		gb.NoteResourceWait();
 		return false;
 	}
 
+	gb.NoteResourceWaitEnded();
 	gb.MotionStopped();									// must do this after we have finished waiting, so that we don't stop waiting when executing G4
 
 	if (RTOSIface::GetCurrentTask() == Tasks::GetMainTask())
@@ -1672,39 +1683,43 @@ bool GCodes::DoStraightMove(GCodeBuffer& gb, bool isCoordinated, const char *& e
 	moveState.usePressureAdvance = false;
 	axesToSenseLength.Clear();
 
-	// Check to see if the move is a 'homing' move that endstops are checked on.
-	// We handle H1 parameters affecting extrusion elsewhere.
-	if (gb.Seen('H') || (machineType != MachineType::laser && gb.Seen('S')))
+	// Most G0/G1 commands have only axis, extrusion and feed rate parameters, so check for the H, R and S parameters all at once before looking for them individually
+	const RestorePoint * rp = nullptr;
+	if (gb.SeenAny("HRS"))
 	{
-		const int ival = gb.GetIValue();
-		if (ival >= 1 && ival <= 4)
+		// Check to see if the move is a 'homing' move that endstops are checked on.
+		// We handle H1 parameters affecting extrusion elsewhere.
+		if (gb.Seen('H') || (machineType != MachineType::laser && gb.Seen('S')))
 		{
-			if (!LockMovementAndWaitForStandstill(gb))
+			const int ival = gb.GetIValue();
+			if (ival >= 1 && ival <= 4)
 			{
-				return false;
+				if (!LockMovementAndWaitForStandstill(gb))
+				{
+					return false;
+				}
+				moveState.moveType = ival;
+				moveState.tool = nullptr;
+			}
+			if (!gb.Seen('H'))
+			{
+				platform.Message(MessageType::WarningMessage, "Obsolete use of S parameter on G1 command. Use H parameter instead.\n");
 			}
-			moveState.moveType = ival;
-			moveState.tool = nullptr;
-		}
-		if (!gb.Seen('H'))
-		{
-			platform.Message(MessageType::WarningMessage, "Obsolete use of S parameter on G1 command. Use H parameter instead.\n");
 		}
-	}
 
-	// Check for 'R' parameter to move relative to a restore point
-	const RestorePoint * rp = nullptr;
-	if (moveState.moveType == 0 && gb.Seen('R'))
-	{
-		const uint32_t rParam = gb.GetUIValue();
-		if (rParam < ARRAY_SIZE(numberedRestorePoints))
+		// Check for 'R' parameter to move relative to a restore point
+		if (moveState.moveType == 0 && gb.Seen('R'))
 		{
-			rp = &numberedRestorePoints[rParam];
-		}
-		else
-		{
-			err = "G0/G1: bad restore point number";
-			return true;
+			const uint32_t rParam = gb.GetUIValue();
+			if (rParam < ARRAY_SIZE(numberedRestorePoints))
+			{
+				rp = &numberedRestorePoints[rParam];
+			}
+			else
+			{
+				err = "G0/G1: bad restore point number";
+				return true;
+			}
 		}
 	}
 
@@ -2014,6 +2029,9 @@ bool GCodes::DoStraightMove(GCodeBuffer& gb, bool isCoordinated, const char *& e
 	}
 
 	moveState.doingArcMove = false;
+#if SUPPORT_NATIVE_ARCS
+	moveState.nativeArc.isArc = false;
+#endif
 	FinaliseMove(gb);
 	UnlockAll(gb);			// allow pause
 	err = nullptr;
@@ -2347,16 +2365,26 @@ bool GCodes::DoArcMove(GCodeBuffer& gb, bool clockwise, const char *& err)
 		}
 	}
 
-	// Compute how many segments to use
-	// For the arc to deviate up to MaxArcDeviation from the ideal, the segment length should be sqrtf(8 * arcRadius * MaxArcDeviation + fsquare(MaxArcDeviation))
-	// We leave out the square term because it is very small
-	// In CNC applications even very small deviations can be visible, so we use a smaller segment length at low speeds
-	const float arcSegmentLength = constrain<float>
-									(	min<float>(fastSqrtf(8 * moveState.arcRadius * MaxArcDeviation), moveState.feedRate * StepClockRate * (1.0/MinArcSegmentsPerSec)),
-										MinArcSegmentLength,
-										MaxArcSegmentLength
-									);
-	moveState.totalSegments = max<unsigned int>((unsigned int)((moveState.arcRadius * totalArc)/arcSegmentLength + 0.8), 1u);
+#if SUPPORT_NATIVE_ARCS
+	// If the kinematics allows it, execute the whole arc as a single move
+	if (selectedPlane == 0 && SetUpNativeArc(axis0Mapping, axis1Mapping, totalArc, clockwise))
+	{
+		moveState.totalSegments = 1;
+	}
+	else
+#endif
+	{
+		// Compute how many segments to use
+		// For the arc to deviate up to MaxArcDeviation from the ideal, the segment length should be sqrtf(8 * arcRadius * MaxArcDeviation + fsquare(MaxArcDeviation))
+		// We leave out the square term because it is very small
+		// In CNC applications even very small deviations can be visible, so we use a smaller segment length at low speeds
+		const float arcSegmentLength = constrain<float>
+										(	min<float>(fastSqrtf(8 * moveState.arcRadius * MaxArcDeviation), moveState.feedRate * StepClockRate * (1.0/MinArcSegmentsPerSec)),
+											MinArcSegmentLength,
+											MaxArcSegmentLength
+										);
+		moveState.totalSegments = max<unsigned int>((unsigned int)((moveState.arcRadius * totalArc)/arcSegmentLength + 0.8), 1u);
+	}
 	moveState.arcAngleIncrement = totalArc/moveState.totalSegments;
 	if (clockwise)
 	{
@@ -2377,10 +2405,95 @@ bool GCodes::DoArcMove(GCodeBuffer& gb, bool clockwise, const char *& err)
 	return true;
 }
 
+#if SUPPORT_NATIVE_ARCS
+
+// Decide whether the XY arc move that DoArcMove has set up in moveState can be executed as a single move instead of being split into straight-line segments.
+// If it can, set up the native arc parameters and return true.
+bool GCodes::SetUpNativeArc(AxesBitmap axis0Mapping, AxesBitmap axis1Mapping, float totalArc, bool clockwise) noexcept
+{
+	moveState.nativeArc.isArc = false;
+
+	// We don't support native arcs when resuming part way through an arc, or if X or Y is mapped to more than one axis
+	if (moveFractionToSkip != 0.0 || axis0Mapping.CountSetBits() != 1 || axis1Mapping.CountSetBits() != 1)
+	{
+		return false;
+	}
+
+	const size_t axis0 = axis0Mapping.LowestSetBit();
+	const size_t axis1 = axis1Mapping.LowestSetBit();
+	if (axisScaleFactors[axis0] != axisScaleFactors[axis1] || !reprap.GetMove().CanDoNativeArc(axis0, axis1))
+	{
+		return false;
+	}
+
+	// If the end point is not on the arc then the segmented arc gets us there more accurately
+	const float radius = moveState.arcRadius * fabsf(axisScaleFactors[axis0]);
+	const float finalRadius = fastSqrtf(fsquare(moveState.coords[axis0] - moveState.arcCentre[axis0]) + fsquare(moveState.coords[axis1] - moveState.arcCentre[axis1]));
+	if (fabsf(finalRadius - radius) > MaxArcDeviation)
+	{
+		return false;
+	}
+
+	// The segmented arc has the position at the end of each segment checked against the machine limits. A native arc is a single move whose end point
+	// has already been checked, so check the points where the arc reaches its extent along each axis. The axes not in the arc move linearly with angle.
+	static constexpr float ExtremeCosines[4] = { 1.0, 0.0, -1.0, 0.0 };
+	static constexpr float ExtremeSines[4] = { 0.0, 1.0, 0.0, -1.0 };
+	for (unsigned int quadrant = 0; quadrant < 4; ++quadrant)
+	{
+		const float extremeAngle = (float)quadrant * (Pi/2);
+		float angleToExtreme = fmodf((clockwise) ? moveState.arcCurrentAngle - extremeAngle : extremeAngle - moveState.arcCurrentAngle, TwoPi);
+		if (angleToExtreme < 0.0)
+		{
+			angleToExtreme += TwoPi;
+		}
+		if (angleToExtreme < totalArc)
+		{
+			const float proportion = angleToExtreme/totalArc;
+			float coords[MaxAxes];
+			for (size_t axis = 0; axis < numVisibleAxes; ++axis)
+			{
+				coords[axis] = moveState.initialCoords[axis] + proportion * (moveState.coords[axis] - moveState.initialCoords[axis]);
+			}
+			coords[axis0] = moveState.arcCentre[axis0] + moveState.arcRadius * axisScaleFactors[axis0] * ExtremeCosines[quadrant];
+			coords[axis1] = moveState.arcCentre[axis1] + moveState.arcRadius * axisScaleFactors[axis1] * ExtremeSines[quadrant];
+			if (reprap.GetMove().GetKinematics().LimitPosition(coords, nullptr, numVisibleAxes, axesVirtuallyHomed, true, limitAxes) != LimitPositionResult::ok)
+			{
+				return false;								// use a segmented arc, which stops at the first segment that is outside the limits
+			}
+		}
+	}
+
+	// Mesh bed compensation is only applied at the ends of each move, so we can only use a native arc if it doesn't need segmenting because of the mesh
+	if (reprap.GetMove().IsUsingMesh())
+	{
+		const float extent = min<float>(2 * radius, radius * totalArc);
+		if (reprap.GetMove().AccessHeightMap().GetMinimumSegments(extent, extent) > 1)
+		{
+			return false;
+		}
+	}
+
+	moveState.nativeArc.centre[0] = moveState.arcCentre[axis0];
+	moveState.nativeArc.centre[1] = moveState.arcCentre[axis1];
+	moveState.nativeArc.radius = radius;
+	moveState.nativeArc.totalAngle = (clockwise) ? -totalArc : totalArc;
+	moveState.nativeArc.axis0 = (uint8_t)axis0;
+	moveState.nativeArc.axis1 = (uint8_t)axis1;
+	moveState.nativeArc.isArc = true;
+	return true;
+}
+
+#endif
+
 // Adjust the move parameters to account for segmentation and/or part of the move having been done already
 void GCodes::FinaliseMove(GCodeBuffer& gb) noexcept
 {
+#if SUPPORT_NATIVE_ARCS
+	// Pausing during a segmented arc move isn't safe because the arc centre get recomputed incorrectly when we resume, but a native arc is a single move
+	moveState.canPauseAfter = !moveState.checkEndstops && (!moveState.doingArcMove || moveState.nativeArc.isArc);
+#else
 	moveState.canPauseAfter = !moveState.checkEndstops && !moveState.doingArcMove;		// pausing during an arc move isn't safe because the arc centre get recomputed incorrectly when we resume
+#endif
 	moveState.filePos = (&gb == fileGCode) ? gb.GetFilePosition() : noFilePosition;
 	gb.MotionCommanded();
 
@@ -2566,6 +2679,9 @@ void GCodes::ClearMove() noexcept
 	moveState.segmentsLeft = 0;
 	moveState.segMoveState = SegmentedMoveState::inactive;
 	moveState.doingArcMove = false;
+#if SUPPORT_NATIVE_ARCS
+	moveState.nativeArc.isArc = false;
+#endif
 	moveState.checkEndstops = false;
 	moveState.reduceAcceleration = false;
 	moveState.moveType = 0;
@@ -2678,7 +2794,7 @@ bool GCodes::DoFileMacro(GCodeBuffer& gb, const char* fileName, bool reportMissi
 #endif
 	{
 #if HAS_MASS_STORAGE || HAS_EMBEDDED_FILES
-		FileStore * const f = platform.OpenSysFile(fileName, OpenMode::read);
+		FileStore * const f = platform.OpenSysFile(fileName, OpenMode::readCached);
 		if (f == nullptr)
 		{
 			if (reportMissing)
@@ -3121,6 +3237,9 @@ bool GCodes::QueueFileToPrint(const char* fileName, const StringRef& reply) noex
 	FileStore * const f = platform.OpenFile(Platform::GetGCodeDir(), fileName, OpenMode::read);
 	if (f != nullptr)
 	{
+#if SUPPORT_BINARY_GCODE
+		f->SetGCodeFileFormat(GCodeFileFormat::unknown);		// this file may be binary G-code, FileGCodeInput decides when it starts reading it
+#endif
 		fileToPrint.Set(f);
 		return true;
 	}
@@ -4630,14 +4749,17 @@ bool GCodes::LockResource(const GCodeBuffer& gb, Resource r) noexcept
 
 	if (resourceOwners[r] == &gb)
 	{
+		gb.NoteResourceWaitEnded();
 		return true;
 	}
 	if (resourceOwners[r] == nullptr)
 	{
 		resourceOwners[r] = &gb;
 		gb.LatestMachineState().lockedResources.SetBit(r);
+		gb.NoteResourceWaitEnded();
 		return true;
 	}
+	gb.NoteResourceWait();
 	return false;
 }
 
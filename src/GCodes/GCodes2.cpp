@@ -41,6 +41,10 @@
 # include <Display/Display.h>
 #endif
 
+#if SUPPORT_MACRO_CACHE
+# include <Storage/MacroCache.h>
+#endif
+
 #if SUPPORT_LED_STRIPS
 # include <Fans/LedStripDriver.h>
 #endif
@@ -68,6 +72,13 @@ bool GCodes::ActOnCode(GCodeBuffer& gb, const StringRef& reply) noexcept
 {
 	try
 	{
+		// Fast path for plain G0 and G1 commands, which make up most of a typical job file.
+		// These are never queued, so we can bypass the queue check and the generic G-code dispatch.
+		if (gb.GetCommandLetter() == 'G' && gb.HasCommandNumber() && (uint32_t)gb.GetCommandNumber() <= 1 && gb.GetCommandFraction() <= 0)
+		{
+			return HandleStraightMove(gb, gb.GetCommandNumber() == 1, reply);
+		}
+
 		// Can we queue this code?
 		if (gb.CanQueueCodes() && codeQueue->ShouldQueueCode(gb))
 		{
@@ -149,27 +160,7 @@ bool GCodes::HandleGcode(GCodeBuffer& gb, const StringRef& reply) THROWS(GCodeEx
 		{
 		case 0: // Rapid move
 		case 1: // Ordinary move
-			if (moveState.segmentsLeft != 0)								// do this check first to avoid locking movement unnecessarily
-			{
-				return false;
-			}
-			if (!LockMovement(gb))
-			{
-				return false;
-			}
-			{
-				const char* err = nullptr;
-				if (!DoStraightMove(gb, code == 1, err))
-				{
-					return false;
-				}
-				if (err != nullptr)
-				{
-					gb.SetState(GCodeState::abortWhenMovementFinished);		// empty the queue before ending simulation, and force the user position to be restored
-					gb.LatestMachineState().SetError(err);					// must do this *after* calling SetState
-				}
-			}
-			break;
+			return HandleStraightMove(gb, code == 1, reply);
 
 		case 2: // Clockwise arc
 		case 3: // Anti clockwise arc
@@ -448,6 +439,31 @@ bool GCodes::HandleGcode(GCodeBuffer& gb, const StringRef& reply) THROWS(GCodeEx
 	return HandleResult(gb, result, reply, nullptr);
 }
 
+// Handle G0 or G1. This is called directly from ActOnCode as well as from HandleGcode.
+bool GCodes::HandleStraightMove(GCodeBuffer& gb, bool isCoordinated, const StringRef& reply) THROWS(GCodeException)
+{
+	if (moveState.segmentsLeft != 0)										// do this check first to avoid locking movement unnecessarily
+	{
+		return false;
+	}
+	if (!LockMovement(gb))
+	{
+		return false;
+	}
+
+	const char* err = nullptr;
+	if (!DoStraightMove(gb, isCoordinated, err))
+	{
+		return false;
+	}
+	if (err != nullptr)
+	{
+		gb.SetState(GCodeState::abortWhenMovementFinished);					// empty the queue before ending simulation, and force the user position to be restored
+		gb.LatestMachineState().SetError(err);								// must do this *after* calling SetState
+	}
+	return HandleResult(gb, GCodeResult::ok, reply, nullptr);
+}
+
 bool GCodes::HandleMcode(GCodeBuffer& gb, const StringRef& reply) THROWS(GCodeException)
 {
 	const int code = gb.GetCommandNumber();
@@ -1113,6 +1129,12 @@ bool GCodes::HandleMcode(GCodeBuffer& gb, const StringRef& reply) THROWS(GCodeEx
 
 			// For case 32, see case 23
 
+#if SUPPORT_MACRO_CACHE
+			case 34:	// Configure macro cache
+				result = MacroCache::Configure(gb, reply);
+				break;
+#endif
+
 #if HAS_MASS_STORAGE || HAS_SBC_INTERFACE || HAS_EMBEDDED_FILES
 			case 36:	// Return file information
 				switch (gb.GetCommandFraction())
@@ -1187,7 +1209,31 @@ bool GCodes::HandleMcode(GCodeBuffer& gb, const StringRef& reply) THROWS(GCodeEx
 						gb.TryGetLimitedUIValue('S', newSimulationMode, seen, (uint32_t)SimulationMode::highest + 1);
 						if (seen)
 						{
+# if HAS_MASS_STORAGE
+							// In debug simulation mode the generated steps can be recorded to a file, e.g. M37 S1 T"steps.bin"
+							String<MaxFilenameLength> traceFileName;
+							bool traceSeen = false;
+							gb.TryGetQuotedString('T', traceFileName.GetRef(), traceSeen);
+							if (traceSeen && !LockMovementAndWaitForStandstill(gb))
+							{
+								return false;
+							}
+							result = ChangeSimulationMode(gb, reply, (SimulationMode)newSimulationMode);
+							if (traceSeen && result == GCodeResult::ok)
+							{
+								if ((SimulationMode)newSimulationMode == SimulationMode::debug)
+								{
+									result = reprap.GetMove().StartStepTrace(traceFileName.c_str(), reply);
+								}
+								else
+								{
+									reply.copy("Step trace is only available in simulation mode 1");
+									result = GCodeResult::warning;
+								}
+							}
+# else
 							result = ChangeSimulationMode(gb, reply, (SimulationMode)newSimulationMode);
+# endif
 						}
 						else
 						{
@@ -2883,6 +2929,13 @@ bool GCodes::HandleMcode(GCodeBuffer& gb, const StringRef& reply) THROWS(GCodeEx
 					bool dummy;
 					gb.TryGetQuotedString('K', key.GetRef(), dummy, true);
 					gb.TryGetQuotedString('F', flags.GetRef(), dummy, true);
+#if SUPPORT_BINARY_OBJECT_MODEL
+					if (strchr(flags.c_str(), 'b') != nullptr)
+					{
+						// G-code channels carry text, so CBOR is only available from rr_model and the SBC interface
+						throw GCodeException(gb.GetLineNumber(), -1, "M409 does not support flag 'b'");
+					}
+#endif
 					if (&gb == auxGCode)
 					{
 						lastAuxStatusReportType = ObjectModelAuxStatusReportType;
@@ -3764,8 +3817,34 @@ bool GCodes::HandleMcode(GCodeBuffer& gb, const StringRef& reply) THROWS(GCodeEx
 				break;
 #endif
 
-			case 595:	// Configure movement queue size
+			case 595:	// Configure movement queue size, the number of codes that can be queued and the file read-ahead buffer size
+				{
+					bool seenOther = false;
+					if (gb.Seen('C'))
+					{
+						seenOther = true;
+						result = codeQueue->SetCapacity(gb.GetLimitedUIValue('C', 1, MaxQueuedCodesLimit + 1), reply);
+					}
+#if SUPPORT_FILE_READ_AHEAD
+					if (result == GCodeResult::ok && gb.Seen('F'))
+					{
+						seenOther = true;
+						result = fileGCode->GetFileInput()->SetReadAheadBufferSize(gb.GetLimitedUIValue('F', MinFileReadAheadBufferSize, MaxFileReadAheadBufferSize + 1), reply);
+					}
+#endif
+					if (result != GCodeResult::ok || (seenOther && !gb.SeenAny("PSQR")))
+					{
+						break;
+					}
+				}
 				result = reprap.GetMove().ConfigureMovementQueue(gb, reply);
+				if (result == GCodeResult::ok && !gb.SeenAny("PSQR"))
+				{
+					reply.catf(", queued codes %u (max used %u)", codeQueue->GetCapacity(), codeQueue->GetMaxQueued());
+#if SUPPORT_FILE_READ_AHEAD
+					reply.catf(", file read-ahead buffers 2 x %u bytes", fileGCode->GetFileInput()->GetReadAheadBufferSize());
+#endif
+				}
 				break;
 
 			// For cases 600 and 601, see 226
@@ -327,7 +327,11 @@ void GridDefinition::PrintError(float originalAxis0range, float originalAxis1ran
 // Adding more fields to the header row can be handled in GridDefinition::ReadParameters(), though.
 const char * const HeightMap::HeightMapComment = "RepRapFirmware height map file v2";
 
-HeightMap::HeightMap() noexcept : useMap(false) { }
+HeightMap::HeightMap() noexcept : useMap(false)
+#if USE_MESH_CELL_COEFFICIENTS
+	, cellCoefficientsValid(false)
+#endif
+{ }
 
 void HeightMap::SetGrid(const GridDefinition& gd) noexcept
 {
@@ -339,6 +343,9 @@ void HeightMap::SetGrid(const GridDefinition& gd) noexcept
 void HeightMap::ClearGridHeights() noexcept
 {
 	gridHeightSet.ClearAll();
+#if USE_MESH_CELL_COEFFICIENTS
+	cellCoefficientsValid = false;
+#endif
 #if HAS_MASS_STORAGE
 	fileName.Clear();
 #endif
@@ -356,6 +363,9 @@ void HeightMap::SetGridHeight(size_t index, float height) noexcept
 	{
 		gridHeights[index] = height;
 		gridHeightSet.SetBit(index);
+#if USE_MESH_CELL_COEFFICIENTS
+		cellCoefficientsValid = false;
+#endif
 	}
 }
 
@@ -562,9 +572,45 @@ unsigned int HeightMap::GetStatistics(Deviation& deviation, float& minError, flo
 bool HeightMap::UseHeightMap(bool b) noexcept
 {
 	useMap = b && def.IsValid();
+#if USE_MESH_CELL_COEFFICIENTS
+	if (useMap && !cellCoefficientsValid)
+	{
+		CalculateCellCoefficients();
+	}
+#endif
 	return useMap;
 }
 
+#if USE_MESH_CELL_COEFFICIENTS
+
+// Calculate the bilinear interpolation coefficients for each cell of the grid, so that interpolating within a cell takes just 3 multiply-adds
+void HeightMap::CalculateCellCoefficients() noexcept
+{
+	for (uint32_t axis1Index = 0; axis1Index + 1 < def.nums[1]; ++axis1Index)
+	{
+		for (uint32_t axis0Index = 0; axis0Index + 1 < def.nums[0]; ++axis0Index)
+		{
+			const uint32_t indexX0Y0 = GetMapIndex(axis0Index, axis1Index);
+			const float hX0Y0 = gridHeights[indexX0Y0];
+			const float hX1Y0 = gridHeights[indexX0Y0 + 1];
+			const float hX0Y1 = gridHeights[indexX0Y0 + def.nums[0]];
+			const float hX1Y1 = gridHeights[indexX0Y0 + def.nums[0] + 1];
+			CellCoefficients& cc = cellCoefficients[indexX0Y0];
+			cc.a = hX0Y0;
+			cc.b = hX1Y0 - hX0Y0;
+			cc.c = hX0Y1 - hX0Y0;
+			cc.d = (hX1Y1 - hX1Y0) - (hX0Y1 - hX0Y0);
+		}
+	}
+
+	constexpr float fEPSILON = 0.01;
+	clampLimits[0] = def.mins[0] + (def.nums[0] - 1) * def.spacings[0] - fEPSILON;
+	clampLimits[1] = def.mins[1] + (def.nums[1] - 1) * def.spacings[1] - fEPSILON;
+	cellCoefficientsValid = true;
+}
+
+#endif
+
 // Compute the height error at the specified point
 float HeightMap::GetInterpolatedHeightError(float axis0, float axis1) const noexcept
 {
@@ -573,6 +619,24 @@ float HeightMap::GetInterpolatedHeightError(float axis0, float axis1) const noex
 		return 0.0;
 	}
 
+#if USE_MESH_CELL_COEFFICIENTS
+	if (cellCoefficientsValid)
+	{
+		// Clamp to rectangle so that we always use a valid cell
+		axis0 = constrain<float>(axis0, def.mins[0], clampLimits[0]);
+		axis1 = constrain<float>(axis1, def.mins[1], clampLimits[1]);
+
+		const float xf = (axis0 - def.mins[0]) * def.recipAxisSpacings[0];
+		const float xFloor = floorf(xf);
+		const float yf = (axis1 - def.mins[1]) * def.recipAxisSpacings[1];
+		const float yFloor = floorf(yf);
+		const float axis0Frac = xf - xFloor;
+		const float axis1Frac = yf - yFloor;
+		const CellCoefficients& cc = cellCoefficients[GetMapIndex((uint32_t)xFloor, (uint32_t)yFloor)];
+		return cc.a + (axis0Frac * (cc.b + axis1Frac * cc.d)) + (axis1Frac * cc.c);
+	}
+#endif
+
 	// Last grid point
 	const float xLast = def.mins[0] + (def.nums[0]-1)*def.spacings[0];
 	const float yLast = def.mins[1] + (def.nums[1]-1)*def.spacings[1];
@@ -698,6 +762,10 @@ void HeightMap::ExtrapolateMissing() noexcept
 			}
 		}
 	}
+
+#if USE_MESH_CELL_COEFFICIENTS
+	CalculateCellCoefficients();
+#endif
 }
 
 // End
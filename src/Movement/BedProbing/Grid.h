@@ -108,10 +108,26 @@ private:
 #endif
 	bool useMap;													// True to do bed compensation
 
+#if USE_MESH_CELL_COEFFICIENTS
+	// The height error within a cell is a + b * axis0Frac + c * axis1Frac + d * axis0Frac * axis1Frac.
+	// The coefficients of all four terms are stored together so that we fetch them from adjacent memory locations.
+	struct CellCoefficients
+	{
+		float a, b, c, d;
+	};
+
+	CellCoefficients cellCoefficients[MaxGridProbePoints];			// indexed in the same way as gridHeights by the grid point at the lower left corner of the cell
+	float clampLimits[2];											// the maximum axis coordinates for which we interpolate instead of extrapolating
+	bool cellCoefficientsValid;										// True if cellCoefficients is up to date with gridHeights
+#endif
+
 	uint32_t GetMapIndex(uint32_t axis0Index, uint32_t axis1Index) const noexcept { return (axis1Index * def.NumAxisPoints(0)) + axis0Index; }
 	void SetGridHeight(size_t index, float height) noexcept;							// Set the height of a grid point
 
 	float InterpolateAxis0Axis1(uint32_t axis0Index, uint32_t axis1Index, float axis0Frac, float axis1Frac) const noexcept;
+#if USE_MESH_CELL_COEFFICIENTS
+	void CalculateCellCoefficients() noexcept;
+#endif
 };
 
 #endif /* SRC_MOVEMENT_GRID_H_ */
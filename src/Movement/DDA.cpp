@@ -18,6 +18,10 @@
 # include <CAN/CanMotion.h>
 #endif
 
+#if HAS_MASS_STORAGE
+# include "StepTrace.h"
+#endif
+
 #ifdef DUET_NG
 # define DDA_MOVE_DEBUG	(0)
 #else
@@ -154,6 +158,10 @@ DDA::DDA(DDA* n) noexcept : next(n), prev(nullptr), state(empty)
 	}
 
 	flags.all = 0;						// in particular we need to set endCoordinatesValid and usePressureAdvance to false, also checkEndstops false for the ATE build
+#if SUPPORT_NATIVE_ARCS
+	arc.isArc = false;
+#endif
+	movingDrives.Clear();
 	virtualExtruderPosition = 0.0;
 	filePos = noFilePosition;
 
@@ -307,12 +315,13 @@ bool DDA::InitStandardMove(DDARing& ring, const RawMove &nextMove, bool doMotorM
 	}
 
 	flags.all = 0;														// set all flags false
+	movingDrives.Clear();
 
 	// 1. Compute the new endpoints and the movement vector
 	const Move& move = reprap.GetMove();
 	if (doMotorMapping)
 	{
-		if (!move.CartesianToMotorSteps(nextMove.coords, endPoint, nextMove.isCoordinated))		// transform the axis coordinates if on a delta or CoreXY printer
+		if (!move.CartesianToMotorSteps(nextMove.coords, endPoint, nextMove.isCoordinated, &ring.GetConversionState()))		// transform the axis coordinates if on a delta or CoreXY printer
 		{
 			return false;												// throw away the move if it couldn't be transformed
 		}
@@ -345,6 +354,7 @@ bool DDA::InitStandardMove(DDARing& ring, const RawMove &nextMove, bool doMotorM
 				directionVector[drive] = positionDelta;
 				if (positionDelta != 0.0)
 				{
+					movingDrives.SetBit(drive);
 					if (reprap.GetPlatform().IsAxisRotational(drive))
 					{
 						rotationalAxesMoving = true;
@@ -367,6 +377,7 @@ bool DDA::InitStandardMove(DDARing& ring, const RawMove &nextMove, bool doMotorM
 				directionVector[drive] = (float)delta/reprap.GetPlatform().DriveStepsPerUnit(drive);
 				if (delta != 0)
 				{
+					movingDrives.SetBit(drive);
 					if (reprap.GetPlatform().IsAxisRotational(drive))
 					{
 						rotationalAxesMoving = true;
@@ -393,6 +404,7 @@ bool DDA::InitStandardMove(DDARing& ring, const RawMove &nextMove, bool doMotorM
 			endCoordinates[drive] = directionVector[drive] = movement;			// for an extruder, endCoordinates is the amount of movement
 			if (movement != 0.0)
 			{
+				movingDrives.SetBit(drive);
 				extrudersMoving = true;
 				if (movement > 0.0)
 				{
@@ -415,6 +427,25 @@ bool DDA::InitStandardMove(DDARing& ring, const RawMove &nextMove, bool doMotorM
 		}
 	}
 
+#if SUPPORT_NATIVE_ARCS
+	arc = nextMove.nativeArc;
+	if (arc.isArc)
+	{
+		if (doMotorMapping)
+		{
+			// The arc axes move even if the arc ends where it started
+			movingDrives.SetBit(arc.axis0);
+			movingDrives.SetBit(arc.axis1);
+			linearAxesMoving = true;
+			flags.xyMoving = true;
+		}
+		else
+		{
+			arc.isArc = false;
+		}
+	}
+#endif
+
 	// 2. Throw it away if there's no real movement.
 	if (!(linearAxesMoving || rotationalAxesMoving || extrudersMoving))
 	{
@@ -470,7 +501,17 @@ bool DDA::InitStandardMove(DDARing& ring, const RawMove &nextMove, bool doMotorM
 		// This means that the user gets the feed rate that he asked for. It also makes the delta calculations simpler.
 		// First do the bed tilt compensation for deltas.
 		directionVector[Z_AXIS] += (directionVector[X_AXIS] * k.GetTiltCorrection(X_AXIS)) + (directionVector[Y_AXIS] * k.GetTiltCorrection(Y_AXIS));
+		if (directionVector[Z_AXIS] != 0.0)
+		{
+			movingDrives.SetBit(Z_AXIS);
+		}
 		totalDistance = NormaliseLinearMotion(reprap.GetPlatform().GetLinearAxes());
+#if SUPPORT_NATIVE_ARCS
+		if (arc.isArc)
+		{
+			totalDistance = NormaliseArcMotion(totalDistance);
+		}
+#endif
 	}
 	else if (rotationalAxesMoving)
 	{
@@ -480,22 +521,27 @@ bool DDA::InitStandardMove(DDARing& ring, const RawMove &nextMove, bool doMotorM
 	else
 	{
 		// Extruder-only movement. Normalise so that the magnitude is the total absolute movement. This gives the correct feed rate for mixing extruders.
-		totalDistance = 0.0;
-		for (size_t d = 0; d < MaxAxesPlusExtruders; d++)
-		{
-			totalDistance += fabsf(directionVector[d]);
-		}
+		float extrusion = 0.0;
+		const float * const dv = directionVector;
+		movingDrives.Iterate([&extrusion, dv](unsigned int d, unsigned int) noexcept { extrusion += fabsf(dv[d]); });
+		totalDistance = extrusion;
 		if (totalDistance > 0.0)		// should always be true
 		{
-			Scale(directionVector, 1.0/totalDistance);
+			Scale(directionVector, 1.0/totalDistance, movingDrives);
 		}
 	}
 
 	// 5. Compute the maximum acceleration available
 	float normalisedDirectionVector[MaxAxesPlusExtruders];			// used to hold a unit-length vector in the direction of motion
 	memcpyf(normalisedDirectionVector, directionVector, ARRAY_SIZE(normalisedDirectionVector));
-	Absolute(normalisedDirectionVector, MaxAxesPlusExtruders);
-	acceleration = beforePrepare.maxAcceleration = VectorBoxIntersection(normalisedDirectionVector, accelerations);
+	Absolute(normalisedDirectionVector, movingDrives);
+#if SUPPORT_NATIVE_ARCS
+	if (arc.isArc)
+	{
+		SetArcPeakDirections(normalisedDirectionVector);
+	}
+#endif
+	acceleration = beforePrepare.maxAcceleration = VectorBoxIntersection(normalisedDirectionVector, accelerations, movingDrives);
 	if (flags.xyMoving)											// apply M204 acceleration limits to XY moves
 	{
 		acceleration = min<float>(acceleration, (flags.isPrintingMove) ? move.GetMaxPrintingAcceleration() : move.GetMaxTravelAcceleration());
@@ -527,13 +573,19 @@ bool DDA::InitStandardMove(DDARing& ring, const RawMove &nextMove, bool doMotorM
 	// Don't use the constrain function in the following, because if we have a very small XY movement and a lot of extrusion, we may have to make the
 	// speed lower than the configured minimum movement speed. We must apply the minimum speed first and then limit it if necessary after that.
 	requestedSpeed = min<float>(max<float>(reqSpeed, reprap.GetPlatform().MinMovementSpeed()),
-								VectorBoxIntersection(normalisedDirectionVector, reprap.GetPlatform().MaxFeedrates()));
+								VectorBoxIntersection(normalisedDirectionVector, reprap.GetPlatform().MaxFeedrates(), movingDrives));
 
 	// On a Cartesian printer, it is OK to limit the X and Y speeds and accelerations independently, and in consequence to allow greater values
 	// for diagonal moves. On other architectures, this is not OK and any movement in the XY plane should be limited on other ways.
 	if (doMotorMapping)
 	{
 		k.LimitSpeedAndAcceleration(*this, normalisedDirectionVector, numVisibleAxes, flags.continuousRotationShortcut);	// give the kinematics the chance to further restrict the speed and acceleration
+#if SUPPORT_NATIVE_ARCS
+		if (arc.isArc)
+		{
+			SetUpArcMotors(k);
+		}
+#endif
 	}
 
 	// 7. Calculate the provisional accelerate and decelerate distances and the top speed
@@ -571,9 +623,14 @@ bool DDA::InitLeadscrewMove(DDARing& ring, float feedrate, const float adjustmen
 		directionVector[drive] = 0.0;
 	}
 
+	movingDrives.Clear();
 	for (size_t driver = 0; driver < MaxDriversPerAxis; ++driver)
 	{
 		directionVector[driver] = adjustments[driver];			// for leadscrew adjustment moves, store the adjustment needed in directionVector
+		if (adjustments[driver] != 0.0)
+		{
+			movingDrives.SetBit(driver);
+		}
 		const int32_t delta = lrintf(adjustments[driver] * reprap.GetPlatform().DriveStepsPerUnit(Z_AXIS));
 		if (delta != 0)
 		{
@@ -589,6 +646,9 @@ bool DDA::InitLeadscrewMove(DDARing& ring, float feedrate, const float adjustmen
 
 	// 3. Store some values
 	flags.all = 0;
+#if SUPPORT_NATIVE_ARCS
+	arc.isArc = false;
+#endif
 	flags.isLeadscrewAdjustmentMove = true;
 	virtualExtruderPosition = prev->virtualExtruderPosition;
 	tool = nullptr;
@@ -635,6 +695,7 @@ bool DDA::InitAsyncMove(DDARing& ring, const AsyncMove& nextMove) noexcept
 	// 1. Compute the new endpoints and the movement vector
 	bool realMove = false;
 
+	movingDrives.Clear();
 	for (size_t drive = 0; drive < MaxAxesPlusExtruders; drive++)
 	{
 		// Note, the correspondence between endCoordinates and endPoint will not be exact because of rounding error.
@@ -643,6 +704,10 @@ bool DDA::InitAsyncMove(DDARing& ring, const AsyncMove& nextMove) noexcept
 		// If it's a delta then we can only do async tower moves in the Z direction and on any additional linear axes
 		const size_t axisToUse = (reprap.GetMove().GetKinematics().GetMotionType(drive) == MotionType::segmentFreeDelta) ? Z_AXIS : drive;
 		directionVector[drive] = nextMove.movements[axisToUse];
+		if (directionVector[drive] != 0.0)
+		{
+			movingDrives.SetBit(drive);
+		}
 		const int32_t delta = lrintf(nextMove.movements[axisToUse] * reprap.GetPlatform().DriveStepsPerUnit(drive));
 		endPoint[drive] = prev->endPoint[drive] + delta;
 		endCoordinates[drive] = prev->endCoordinates[drive];
@@ -660,6 +725,9 @@ bool DDA::InitAsyncMove(DDARing& ring, const AsyncMove& nextMove) noexcept
 
 	// 3. Store some values
 	flags.all = 0;
+#if SUPPORT_NATIVE_ARCS
+	arc.isArc = false;
+#endif
 	virtualExtruderPosition = 0;
 	tool = nullptr;
 	filePos = noFilePosition;
@@ -698,6 +766,9 @@ bool DDA::InitFromRemote(const CanMessageMovementLinear& msg) noexcept
 	afterPrepare.moveStartTime = StepTimer::ConvertToLocalTime(msg.whenToExecute);
 	clocksNeeded = msg.accelerationClocks + msg.steadyClocks + msg.decelClocks;
 	flags.all = 0;
+#if SUPPORT_NATIVE_ARCS
+	arc.isArc = false;
+#endif
 	flags.isRemote = true;
 # if !USE_REMOTE_INPUT_SHAPING
 	flags.isPrintingMove = (msg.pressureAdvanceDrives != 0);
@@ -725,6 +796,7 @@ bool DDA::InitFromRemote(const CanMessageMovementLinear& msg) noexcept
 
 	shapedSegments = unshapedSegments = nullptr;
 	activeDMs = completedDMs = nullptr;
+	movingDrives.Clear();									// remote moves don't use directionVector, so make sure no bits are left over from the previous move in this DDA
 
 # if USE_REMOTE_INPUT_SHAPING
 	const size_t numDrivers = min<size_t>(msg.numDriversMinusOne + 1, min<size_t>(NumDirectDrivers, MaxLinearDriversPerCanSlave));
@@ -915,7 +987,7 @@ bool DDA::IsAccelerationMove() const noexcept
 pre(state == provisional)
 {
 //	if (reprap.Debug(moduleDda)) debugPrintf("Adjusting, %f\n", laDDA->targetNextSpeed);
-	unsigned int laDepth = 0;
+	unsigned int laDepth = 0, maxLaDepth = 0;
 	bool goingUp = true;
 
 	for(;;)					// this loop is used to nest lookahead without making recursive calls
@@ -951,8 +1023,25 @@ pre(state == provisional)
 				{
 					laDDA->MatchSpeeds();
 					const float maxStartSpeed = fastSqrtf(fsquare(laDDA->beforePrepare.targetNextSpeed) + (2 * laDDA->deceleration * laDDA->totalDistance));
-					laDDA->prev->beforePrepare.targetNextSpeed = min<float>(maxStartSpeed, laDDA->requestedSpeed);
-					// leave 'goingUp' true
+					const float prevTargetNextSpeed = min<float>(maxStartSpeed, laDDA->requestedSpeed);
+					if (prevTargetNextSpeed > laDDA->prev->endSpeed)
+					{
+						laDDA->prev->beforePrepare.targetNextSpeed = prevTargetNextSpeed;
+						// leave 'goingUp' true
+					}
+					else
+					{
+						// The previous move already ends at least as fast as this one can use, and we never reduce the end speed of a move during lookahead.
+						// So walking further back would not change any move, and this move is the high water mark of the lookahead.
+						// This stops long runs of short deceleration-only segments being walked again every time a move is added.
+						ring.RecordLookaheadCutShort();
+						const float maxEndSpeed = fastSqrtf(fsquare(laDDA->startSpeed) + (2 * laDDA->acceleration * laDDA->totalDistance));
+						if (maxEndSpeed < laDDA->beforePrepare.targetNextSpeed)
+						{
+							laDDA->beforePrepare.targetNextSpeed = maxEndSpeed;
+						}
+						goingUp = false;
+					}
 				}
 				else
 				{
@@ -1001,6 +1090,10 @@ pre(state == provisional)
 			// Still going up
 			laDDA = laDDA->prev;
 			++laDepth;
+			if (laDepth > maxLaDepth)
+			{
+				maxLaDepth = laDepth;
+			}
 #if 0
 			if (reprap.Debug(moduleDda))
 			{
@@ -1035,6 +1128,7 @@ LA_DEBUG;
 
 			if (laDepth == 0)
 			{
+				ring.RecordLookahead(maxLaDepth + 1);
 #if 0
 				if (reprap.Debug(moduleDda))
 				{
@@ -1079,6 +1173,7 @@ float DDA::AdvanceBabyStepping(DDARing& ring, size_t axis, float amount) noexcep
 			const float maxBabySteppingAmount = cdda->totalDistance * min<float>(0.1, 0.5 * platform.GetInstantDv(Z_AXIS)/cdda->topSpeed);
 			babySteppingToDo = constrain<float>(amount, -maxBabySteppingAmount, maxBabySteppingAmount);
 			cdda->directionVector[Z_AXIS] += babySteppingToDo/cdda->totalDistance;
+			cdda->movingDrives.SetBit(Z_AXIS);
 			cdda->totalDistance *= cdda->NormaliseLinearMotion(platform.GetLinearAxes());
 			cdda->RecalculateMove(ring);
 			babySteppingDone += babySteppingToDo;
@@ -1184,14 +1279,20 @@ void DDA::RecalculateMove(DDARing& ring) noexcept
 	if (flags.canPauseAfter && endSpeed != 0.0)
 	{
 		const Platform& p = reprap.GetPlatform();
-		for (size_t drive = 0; drive < MaxAxesPlusExtruders; ++drive)
-		{
-			if (endSpeed * fabsf(directionVector[drive]) > p.GetInstantDv(drive))
+		bool canPause = true;
+		movingDrives.Iterate([this, &p, &canPause](unsigned int drive, unsigned int) noexcept
 			{
-				flags.canPauseAfter = false;
-				break;
+#if SUPPORT_NATIVE_ARCS
+				if (endSpeed * fabsf(GetEndDirection(drive)) > p.GetInstantDv(drive))
+#else
+				if (endSpeed * fabsf(directionVector[drive]) > p.GetInstantDv(drive))
+#endif
+				{
+					canPause = false;
+				}
 			}
-		}
+		);
+		flags.canPauseAfter = canPause;
 	}
 
 	// We need to set the number of clocks needed here because we use it before the move has been frozen
@@ -1206,19 +1307,23 @@ void DDA::RecalculateMove(DDARing& ring) noexcept
 // On return, targetNextSpeed is the actual speed we can achieve without exceeding the jerk limits.
 void DDA::MatchSpeeds() noexcept
 {
-	for (size_t drive = 0; drive < MaxAxesPlusExtruders; ++drive)
-	{
-		if (directionVector[drive] != 0.0 || next->directionVector[drive] != 0.0)
+	// Only drives that are moving in this move or the next one can need their speed changes limiting
+	const Platform& p = reprap.GetPlatform();
+	(movingDrives | next->movingDrives).Iterate([this, &p](unsigned int drive, unsigned int) noexcept
 		{
+#if SUPPORT_NATIVE_ARCS
+			const float totalFraction = fabsf(GetEndDirection(drive) - next->GetStartDirection(drive));
+#else
 			const float totalFraction = fabsf(directionVector[drive] - next->directionVector[drive]);
+#endif
 			const float jerk = totalFraction * beforePrepare.targetNextSpeed;
-			const float allowedJerk = reprap.GetPlatform().GetInstantDv(drive);
+			const float allowedJerk = p.GetInstantDv(drive);
 			if (jerk > allowedJerk)
 			{
 				beforePrepare.targetNextSpeed = allowedJerk/totalFraction;
 			}
 		}
-	}
+	);
 }
 
 // This is called by Move::CurrentMoveCompleted to update the live coordinates from the move that has just finished
@@ -1468,7 +1573,13 @@ void DDA::Prepare(SimulationMode simMode) noexcept
 			{
 				// It's a linear axis
 				int32_t delta = endPoint[drive] - prev->endPoint[drive];
+#if SUPPORT_NATIVE_ARCS
+				// A motor driven by the axes of an arc may need to move even if its net movement is zero, e.g. when the arc is a complete circle
+				const bool isArcMotor = arc.isArc && arcMotors.IsBitSet(drive);
+				if (delta != 0 || isArcMotor)
+#else
 				if (delta != 0)
+#endif
 				{
 					platform.EnableDrivers(drive, false);
 					if (shapedSegments == nullptr)
@@ -1498,7 +1609,12 @@ void DDA::Prepare(SimulationMode simMode) noexcept
 						DriveMovement* const pdm = DriveMovement::Allocate(drive, DMState::idle);
 						pdm->direction = (delta >= 0);
 						pdm->totalSteps = labs(delta);
-						if (pdm->PrepareCartesianAxis(*this, params))
+#if SUPPORT_NATIVE_ARCS
+						const bool stepsToDo = (isArcMotor) ? pdm->PrepareArcAxis(*this, params, delta) : pdm->PrepareCartesianAxis(*this, params);
+#else
+						const bool stepsToDo = pdm->PrepareCartesianAxis(*this, params);
+#endif
+						if (stepsToDo)
 						{
 							pdm->directionChanged = false;
 							// Check for sensible values, print them if they look dubious
@@ -1637,6 +1753,18 @@ void DDA::Prepare(SimulationMode simMode) noexcept
 		}
 #endif
 
+#if SUPPORT_PRECALCULATED_STEPS
+		// Calculate the first few step times of each local drive now, to reduce the work that the step ISR has to do when the move starts.
+		// Don't do this for moves that check endstops, because they are slow and may be stopped part way through.
+		if (!flags.checkEndstops)
+		{
+			for (DriveMovement *pdm = activeDMs; pdm != nullptr; pdm = pdm->nextDM)
+			{
+				pdm->PrecalculateSteps(*this);
+			}
+		}
+#endif
+
 		if (reprap.Debug(moduleMove) && (reprap.Debug(moduleDda) || params.shapingPlan.debugPrint))		// show the prepared DDA if debug enabled for both modules
 		{
 			DebugPrintAll("pr");
@@ -1666,23 +1794,23 @@ void DDA::Prepare(SimulationMode simMode) noexcept
 
 // Take a unit positive-hyperquadrant vector, and return the factor needed to obtain
 // length of the vector as projected to touch box[].
-/*static*/ float DDA::VectorBoxIntersection(const float v[], const float box[]) noexcept
+// Only the elements of v[] that correspond to bits set in 'drives' may be nonzero.
+/*static*/ float DDA::VectorBoxIntersection(const float v[], const float box[], AxesBitmap drives) noexcept
 {
-	// Generate a vector length that is guaranteed to exceed the size of the box
+	// Generate a vector length that is guaranteed to exceed the size of the box.
+	// Summing over just the moving drives is sufficient because the sum of the components of v is at least 1.
 	float magnitude = 0.0;
-	for (size_t d = 0; d < MaxAxesPlusExtruders; d++)
-	{
-		magnitude += box[d];
-	}
+	drives.Iterate([&magnitude, box](unsigned int d, unsigned int) noexcept { magnitude += box[d]; });
 
 	// Now reduce the length until every axis fits
-	for (size_t d = 0; d < MaxAxesPlusExtruders; d++)
-	{
-		if (magnitude * v[d] > box[d])
-		{
-			magnitude = box[d]/v[d];
-		}
-	}
+	drives.Iterate([&magnitude, v, box](unsigned int d, unsigned int) noexcept
+					{
+						if (magnitude * v[d] > box[d])
+						{
+							magnitude = box[d]/v[d];
+						}
+					}
+				  );
 	return magnitude;
 }
 
@@ -1764,10 +1892,77 @@ float DDA::NormaliseLinearMotion(AxesBitmap linearAxes) noexcept
 	}
 
 	// Now normalise it
-	Scale(directionVector, 1.0/magnitude);
+	Scale(directionVector, 1.0/magnitude, movingDrives);
 	return magnitude;
 }
 
+#if SUPPORT_NATIVE_ARCS
+
+// Return the maximum value of |sin(x)| for x in the range 'from' to 'to', where 'to' is not less than 'from'
+static float MaxAbsSine(float from, float to) noexcept
+{
+	const float firstPeak = Pi/2 + ceilf((from - Pi/2)/Pi) * Pi;		// the first angle not less than 'from' at which |sin| is 1
+	return (firstPeak <= to) ? 1.0 : max<float>(fabsf(sinf(from)), fabsf(sinf(to)));
+}
+
+// Make the direction vector of an arc move unit-normal along the path of the move, and return the path length.
+// On entry the direction vector has been normalised by NormaliseLinearMotion, which treats the chord of the arc as the XY movement, and chordLength is the value it returned.
+// The components of the direction vector along the arc axes remain proportional to the chord, so that multiplying them by the path length still gives the net movement.
+float DDA::NormaliseArcMotion(float chordLength) noexcept
+{
+	const float scale = (chordLength > 0.0) ? chordLength : 1.0;		// NormaliseLinearMotion doesn't scale the vector if the length is zero
+	const float otherAxesSquared = max<float>(fsquare(chordLength) - fsquare(directionVector[arc.axis0] * scale) - fsquare(directionVector[arc.axis1] * scale), 0.0);
+	const float arcLength = arc.radius * fabsf(arc.totalAngle);
+	const float pathLength = fastSqrtf(fsquare(arcLength) + otherAxesSquared);
+	Scale(directionVector, scale/pathLength, movingDrives);
+
+	// Work out the directions of motion at the start and end of the arc, for use by the lookahead
+	arcStartAngle = atan2f(prev->GetEndCoordinate(arc.axis1, false) - arc.centre[1], prev->GetEndCoordinate(arc.axis0, false) - arc.centre[0]);
+	const float endAngle = arcStartAngle + arc.totalAngle;
+	const float arcFraction = (arc.totalAngle >= 0.0) ? arcLength/pathLength : -arcLength/pathLength;
+	arcStartDirection[0] = -sinf(arcStartAngle) * arcFraction;
+	arcStartDirection[1] = cosf(arcStartAngle) * arcFraction;
+	arcEndDirection[0] = -sinf(endAngle) * arcFraction;
+	arcEndDirection[1] = cosf(endAngle) * arcFraction;
+	return pathLength;
+}
+
+// Replace the arc axis components of the absolute normalised direction vector by the largest values that they reach during the arc.
+// The component along axis0 is proportional to sin(angle) and the component along axis1 to cos(angle) = sin(angle + Pi/2).
+void DDA::SetArcPeakDirections(float normalisedDirectionVector[]) const noexcept
+{
+	const float angle0 = arcStartAngle;
+	const float angle1 = arcStartAngle + arc.totalAngle;
+	const float fromAngle = min<float>(angle0, angle1);
+	const float toAngle = max<float>(angle0, angle1);
+	const float arcFraction = arc.radius * fabsf(arc.totalAngle)/totalDistance;
+	normalisedDirectionVector[arc.axis0] = arcFraction * MaxAbsSine(fromAngle, toAngle);
+	normalisedDirectionVector[arc.axis1] = arcFraction * MaxAbsSine(fromAngle + Pi/2, toAngle + Pi/2);
+}
+
+// Record which motors the arc axes drive, and limit the speed and acceleration so that none of those motors exceeds its limits.
+// Also limit the speed so that the centripetal acceleration doesn't exceed the acceleration that we are allowed to use.
+void DDA::SetUpArcMotors(const Kinematics& k) noexcept
+{
+	const Platform& p = reprap.GetPlatform();
+	const float arcFraction = arc.radius * fabsf(arc.totalAngle)/totalDistance;
+	arcMotors.Clear();
+	for (size_t motor = 0; motor < MaxAxes; ++motor)
+	{
+		const float factor0 = k.GetArcMotorFactor(arc.axis0, motor);
+		const float factor1 = k.GetArcMotorFactor(arc.axis1, motor);
+		if (factor0 != 0.0 || factor1 != 0.0)
+		{
+			arcMotors.SetBit(motor);
+			const float peakFraction = arcFraction * fastSqrtf(fsquare(factor0) + fsquare(factor1));		// the motor moves sinusoidally with this peak speed fraction
+			LimitSpeedAndAcceleration(p.MaxFeedrate(motor)/peakFraction, p.Acceleration(motor)/peakFraction);
+		}
+	}
+	requestedSpeed = min<float>(requestedSpeed, fastSqrtf(acceleration * arc.radius));
+}
+
+#endif
+
 // Return the magnitude of a vector over the specified orthogonal axes
 /*static*/ float DDA::Magnitude(const float v[], AxesBitmap axes) noexcept
 {
@@ -1785,13 +1980,16 @@ float DDA::NormaliseLinearMotion(AxesBitmap linearAxes) noexcept
 	}
 }
 
-// Move a vector into the positive hyperquadrant
-/*static*/ void DDA::Absolute(float v[], size_t dimensions) noexcept
+// Multiply a vector by a scalar, where only the elements corresponding to bits set in 'drives' may be nonzero
+/*static*/ void DDA::Scale(float v[], float scale, AxesBitmap drives) noexcept
 {
-	for (size_t d = 0; d < dimensions; d++)
-	{
-		v[d] = fabsf(v[d]);
-	}
+	drives.Iterate([v, scale](unsigned int d, unsigned int) noexcept { v[d] *= scale; });
+}
+
+// Move a vector into the positive hyperquadrant, where only the elements corresponding to bits set in 'drives' may be nonzero
+/*static*/ void DDA::Absolute(float v[], AxesBitmap drives) noexcept
+{
+	drives.Iterate([v](unsigned int d, unsigned int) noexcept { v[d] = fabsf(v[d]); });
 }
 
 // Check the endstops, given that we know that this move checks endstops.
@@ -1986,7 +2184,8 @@ uint32_t maxDelayIncrease;
 
 // Generate the step pulses of internal drivers used by this DDA
 // Sets the status to 'completed' if the move is complete and the next move should be started
-void DDA::StepDrivers(Platform& p, uint32_t now) noexcept
+// Returns the number of drives that we generated steps for
+unsigned int DDA::StepDrivers(Platform& p, uint32_t now) noexcept
 {
 	// Check endstop switches and Z probe if asked. This is not speed critical because fast moves do not use endstops or the Z probe.
 	if (flags.checkEndstops)		// if any homing switches or the Z probe is enabled in this move
@@ -1994,11 +2193,12 @@ void DDA::StepDrivers(Platform& p, uint32_t now) noexcept
 		CheckEndstops(p);			// call out to a separate function because this may help cache usage in the more common and time-critical case where we don't call it
 		if (state == completed)		// we may have completed the move due to triggering an endstop switch or Z probe
 		{
-			return;
+			return 0;
 		}
 	}
 
 	uint32_t driversStepping = 0;
+	unsigned int numDrivesStepped = 0;
 	DriveMovement* dm = activeDMs;
 	const uint32_t elapsedTime = (now - afterPrepare.moveStartTime) + StepTimer::MinInterruptInterval;
 #if 0	//DEBUG
@@ -2016,6 +2216,7 @@ void DDA::StepDrivers(Platform& p, uint32_t now) noexcept
 	while (dm != nullptr && elapsedTime >= dm->nextStepTime)		// if the next step is due
 	{
 		driversStepping |= p.GetDriversBitmap(dm->drive);
+		++numDrivesStepped;
 #if 0	// debug only
 		++stepsDone[dm->drive];
 #endif
@@ -2123,12 +2324,13 @@ void DDA::StepDrivers(Platform& p, uint32_t now) noexcept
 			state = completed;
 		}
 	}
+	return numDrivesStepped;
 }
 
 // Simulate stepping the drivers, for debugging.
 // This is basically a copy of DDA::SetDrivers except that instead of being called from the timer ISR and generating steps,
-// it is called from the Move task and outputs info on the step timings. It ignores endstops.
-void DDA::SimulateSteppingDrivers(Platform& p) noexcept
+// it is called from the Move task and outputs info on the step timings if DDA debug is enabled, and/or records them in the step trace. It ignores endstops.
+void DDA::SimulateSteppingDrivers(Platform& p, StepTrace *trace) noexcept
 {
 	static uint32_t lastStepTime;
 	static bool checkTiming = false;
@@ -2136,12 +2338,22 @@ void DDA::SimulateSteppingDrivers(Platform& p) noexcept
 	DriveMovement* dm = activeDMs;
 	if (dm != nullptr)
 	{
+		const bool printSteps = reprap.Debug(moduleDda);
 		const uint32_t dueTime = dm->nextStepTime;
 		while (dm != nullptr && dueTime >= dm->nextStepTime)			// if the next step is due
 		{
-			const uint32_t timeDiff = dm->nextStepTime - lastStepTime;
-			const bool badTiming = checkTiming && (timeDiff < 10 || timeDiff > 100000000);
-			debugPrintf("%10" PRIu32 " D%u %c%s", dm->nextStepTime, dm->drive, (dm->direction) ? 'F' : 'B', (badTiming) ? " *\n" : "\n");
+			if (printSteps)
+			{
+				const uint32_t timeDiff = dm->nextStepTime - lastStepTime;
+				const bool badTiming = checkTiming && (timeDiff < 10 || timeDiff > 100000000);
+				debugPrintf("%10" PRIu32 " D%u %c%s", dm->nextStepTime, dm->drive, (dm->direction) ? 'F' : 'B', (badTiming) ? " *\n" : "\n");
+			}
+#if HAS_MASS_STORAGE
+			if (trace != nullptr)
+			{
+				trace->RecordStep(dm->nextStepTime, dm->drive, dm->direction);
+			}
+#endif
 			dm = dm->nextDM;
 		}
 		lastStepTime = dueTime;
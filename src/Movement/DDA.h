@@ -23,6 +23,7 @@
 #endif
 
 class DDARing;
+class StepTrace;
 
 // Struct for passing parameters to the DriveMovement Prepare methods, also accessed by the input shaper
 struct PrepParams
@@ -99,8 +100,8 @@ public:
 #endif
 
 	void Start(Platform& p, uint32_t tim) noexcept SPEED_CRITICAL;					// Start executing the DDA, i.e. move the move.
-	void StepDrivers(Platform& p, uint32_t now) noexcept SPEED_CRITICAL;			// Take one step of the DDA, called by timer interrupt.
-	void SimulateSteppingDrivers(Platform& p) noexcept;								// For debugging use
+	unsigned int StepDrivers(Platform& p, uint32_t now) noexcept SPEED_CRITICAL;	// Take one step of the DDA, called by timer interrupt. Returns the number of drives stepped.
+	void SimulateSteppingDrivers(Platform& p, StepTrace *trace) noexcept;			// For debugging use, optionally recording the step stream
 	bool ScheduleNextStepInterrupt(StepTimer& timer) const noexcept SPEED_CRITICAL;	// Schedule the next interrupt, returning true if we can't because it is already due
 
 	void SetNext(DDA *n) noexcept { next = n; }
@@ -161,6 +162,7 @@ public:
 	void MoveAborted() noexcept;
 
 	uint32_t GetClocksNeeded() const noexcept { return clocksNeeded; }
+	uint32_t GetNumLocalSteps() const noexcept;										// Return the total number of steps that local drivers will take in this move
 	bool IsGoodToPrepare() const noexcept;
 	bool IsNonPrintingExtruderMove() const noexcept { return flags.isNonPrintingExtruderMove; }
 	void UpdateMovementAccumulators(volatile int32_t *accumulators) const noexcept;
@@ -251,6 +253,14 @@ private:
 	void EnsureUnshapedSegments(const PrepParams& params) noexcept;
 	void DebugPrintVector(const char *name, const float *vec, size_t len) const noexcept;
 
+#if SUPPORT_NATIVE_ARCS
+	float NormaliseArcMotion(float chordLength) noexcept;					// Make the direction vector unit-normal along the path of an arc move and return the path length
+	void SetArcPeakDirections(float normalisedDirectionVector[]) const noexcept;	// Replace the arc axis components of a normalised direction vector by their peak values during the arc
+	void SetUpArcMotors(const Kinematics& k) noexcept;						// Record which motors an arc move uses and limit its speed and acceleration to suit them
+	float GetStartDirection(size_t drive) const noexcept;					// Get a component of the direction of motion at the start of the move
+	float GetEndDirection(size_t drive) const noexcept;						// Get a component of the direction of motion at the end of the move
+#endif
+
 #if SUPPORT_CAN_EXPANSION
 	int32_t PrepareRemoteExtruder(size_t drive, float& extrusionPending, float speedChange) const noexcept;
 #endif
@@ -259,12 +269,13 @@ private:
     static float Normalise(float v[], AxesBitmap unitLengthAxes) noexcept;  // Normalise a vector to unit length over the specified axes
     static float Normalise(float v[]) noexcept; 							// Normalise a vector to unit length over all axes
 	float NormaliseLinearMotion(AxesBitmap linearAxes) noexcept;			// Make the direction vector unit-normal in XYZ
-    static void Absolute(float v[], size_t dimensions) noexcept;			// Put a vector in the positive hyperquadrant
+    static void Absolute(float v[], AxesBitmap drives) noexcept;			// Put a vector in the positive hyperquadrant, where only the specified elements may be nonzero
 
     static float Magnitude(const float v[]) noexcept;						// Get the magnitude measured over all axes and extruders
     static float Magnitude(const float v[], AxesBitmap axes) noexcept;  	// Return the length of a vector over the specified orthogonal axes
     static void Scale(float v[], float scale) noexcept;						// Multiply a vector by a scalar
-    static float VectorBoxIntersection(const float v[], const float box[]) noexcept;	// Compute the length that a vector would have to have to just touch the surface of a hyperbox of MaxAxesPlusExtruders dimensions.
+    static void Scale(float v[], float scale, AxesBitmap drives) noexcept;	// Multiply a vector by a scalar, where only the specified elements may be nonzero
+    static float VectorBoxIntersection(const float v[], const float box[], AxesBitmap drives) noexcept;	// Compute the length that a vector would have to have to just touch the surface of a hyperbox
 
     DDA *next;										// The next one in the ring
 	DDA *prev;										// The previous one in the ring
@@ -308,6 +319,7 @@ private:
 	int32_t endPoint[MaxAxesPlusExtruders];  		// Machine coordinates of the endpoint
 	float endCoordinates[MaxAxesPlusExtruders];		// The Cartesian coordinates at the end of the move plus extrusion amounts
 	float directionVector[MaxAxesPlusExtruders];	// The normalised direction vector - first 3 are XYZ Cartesian coordinates even on a delta
+	AxesBitmap movingDrives;						// Which elements of directionVector may be nonzero, so that loops over it can skip axes and extruders that are not moving
     float totalDistance;							// How long is the move in hypercuboid space
 	float acceleration;								// The acceleration to use
 	float deceleration;								// The deceleration to use
@@ -319,6 +331,15 @@ private:
 	float endSpeed;
 	float topSpeed;
 
+#if SUPPORT_NATIVE_ARCS
+	// Parameters of a native arc move. The components of directionVector along the arc axes are those of the chord.
+	NativeArcParameters arc;						// the arc details passed by GCodes, or arc.isArc false if this is not an arc move
+	float arcStartAngle;							// the angle of the start point from the centre, measured from the axis0 direction towards the axis1 direction
+	float arcStartDirection[2];						// the components of the direction of motion along the two arc axes at the start of the move
+	float arcEndDirection[2];						// the components of the direction of motion along the two arc axes at the end of the move
+	AxesBitmap arcMotors;							// the motors driven by the arc axes
+#endif
+
 	float proportionDone;							// what proportion of the extrusion in the G1 or G0 move of which this is a part has been done after this segment is complete
 	float initialUserC0, initialUserC1;				// if this is a segment of an arc move, the user X and Y coordinates at the start
 	uint32_t clocksNeeded;
@@ -384,6 +405,28 @@ inline DriveMovement *DDA::FindDM(size_t drive) const noexcept
 	return nullptr;
 }
 
+#if SUPPORT_NATIVE_ARCS
+
+// Get a component of the direction of motion at the start of the move. This differs from directionVector only for the arc axes of an arc move.
+inline float DDA::GetStartDirection(size_t drive) const noexcept
+{
+	return (!arc.isArc) ? directionVector[drive]
+			: (drive == arc.axis0) ? arcStartDirection[0]
+				: (drive == arc.axis1) ? arcStartDirection[1]
+					: directionVector[drive];
+}
+
+// Get a component of the direction of motion at the end of the move. This differs from directionVector only for the arc axes of an arc move.
+inline float DDA::GetEndDirection(size_t drive) const noexcept
+{
+	return (!arc.isArc) ? directionVector[drive]
+			: (drive == arc.axis0) ? arcEndDirection[0]
+				: (drive == arc.axis1) ? arcEndDirection[1]
+					: directionVector[drive];
+}
+
+#endif
+
 // Find the active DriveMovement record for a given drive, or return nullptr if there isn't one
 inline DriveMovement *DDA::FindActiveDM(size_t drive) const noexcept
 {
@@ -448,6 +491,21 @@ inline bool DDA::CanPauseAfter() const noexcept
 		;
 }
 
+// Return the total number of steps that local drivers will take in this move. Only valid after the move has been prepared.
+inline uint32_t DDA::GetNumLocalSteps() const noexcept
+{
+	uint32_t steps = 0;
+	for (const DriveMovement* dm = activeDMs; dm != nullptr; dm = dm->nextDM)
+	{
+		steps += dm->totalSteps;
+	}
+	for (const DriveMovement* dm = completedDMs; dm != nullptr; dm = dm->nextDM)
+	{
+		steps += dm->totalSteps;
+	}
+	return steps;
+}
+
 // Return the number of net steps already taken in this move by a particular drive
 inline int32_t DDA::GetStepsTaken(size_t drive) const noexcept
 {
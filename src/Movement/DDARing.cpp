@@ -11,11 +11,16 @@
 #include <Platform/Tasks.h>
 #include <GCodes/GCodeBuffer/GCodeBuffer.h>
 #include <Tools/Tool.h>
+#include "MovementArena.h"
 
 #if SUPPORT_CAN_EXPANSION
 # include "CAN/CanMotion.h"
 #endif
 
+#if HAS_MASS_STORAGE
+# include "StepTrace.h"
+#endif
+
 constexpr uint32_t MoveStartPollInterval = 10;					// delay in milliseconds between checking whether we should start moves
 
 // Object model table and functions
@@ -38,7 +43,7 @@ constexpr uint8_t DDARing::objectModelTableDescriptor[] = { 1, 2 };
 
 DEFINE_GET_OBJECT_MODEL_TABLE(DDARing)
 
-DDARing::DDARing() noexcept : gracePeriod(DefaultGracePeriod), scheduledMoves(0), completedMoves(0), numHiccups(0)
+DDARing::DDARing() noexcept : gracePeriod(DefaultGracePeriod), scheduledMoves(0), completedMoves(0), numHiccups(0), stepTrace(nullptr), recordStepIsrStats(false)
 {
 }
 
@@ -46,14 +51,16 @@ DDARing::DDARing() noexcept : gracePeriod(DefaultGracePeriod), scheduledMoves(0)
 void DDARing::Init1(unsigned int numDdas) noexcept
 {
 	numDdasInRing = numDdas;
+	maxDdasInUse = 0;
 
-	// Build the DDA ring
-	DDA *dda = new DDA(nullptr);
+	// Build the DDA ring, allocating the DDAs as a single block from the movement arena
+	DDA * const ddas = MovementArena::AllocateBlock<DDA>(numDdas);
+	DDA *dda = ::new (ddas) DDA(nullptr);
 	addPointer = dda;
 	for (size_t i = 1; i < numDdas; i++)
 	{
 		DDA * const oldDda = dda;
-		dda = new DDA(dda);
+		dda = ::new (ddas + i) DDA(dda);
 		oldDda->SetPrevious(dda);
 	}
 	addPointer->SetNext(dda);
@@ -71,6 +78,10 @@ void DDARing::Init2() noexcept
 	stepErrors = 0;
 	numLookaheadUnderruns = numPrepareUnderruns = numNoMoveUnderruns = numLookaheadErrors = 0;
 	waitingForRingToEmpty = false;
+	numStepsPrepared = 0;
+	whenPlannerStatsReset = millis();
+	numLookaheadDdasVisited = 0;
+	maxLookaheadDdasVisited = numLookaheadsCutShort = 0;
 
 	// Put the origin on the lookahead ring with default velocity in the previous position to the first one that will be used.
 	// Do this by calling SetLiveCoordinates and SetPositions, so that the motor coordinates will be correct too even on a delta.
@@ -115,9 +126,10 @@ void DDARing::Exit() noexcept
 GCodeResult DDARing::ConfigureMovementQueue(GCodeBuffer& gb, const StringRef& reply) THROWS(GCodeException)
 {
 	bool seen = false;
-	uint32_t numDdasWanted = 0, numDMsWanted = 0;
+	uint32_t numDdasWanted = 0, numDMsWanted = 0, numSegmentsWanted = 0;
 	gb.TryGetUIValue('P', numDdasWanted, seen);
 	gb.TryGetUIValue('S', numDMsWanted, seen);
+	gb.TryGetUIValue('Q', numSegmentsWanted, seen);
 	gb.TryGetUIValue('R', gracePeriod, seen);
 	if (seen)
 	{
@@ -129,11 +141,15 @@ GCodeResult DDARing::ConfigureMovementQueue(GCodeBuffer& gb, const StringRef& re
 		ptrdiff_t memoryNeeded = 0;
 		if (numDdasWanted > numDdasInRing)
 		{
-			memoryNeeded += (numDdasWanted - numDdasInRing) * (sizeof(DDA) + 8);
+			memoryNeeded += MovementArena::MemoryNeeded<DDA>(numDdasWanted - numDdasInRing);
 		}
 		if (numDMsWanted > DriveMovement::NumCreated())
 		{
-			memoryNeeded += (numDMsWanted - DriveMovement::NumCreated()) * (sizeof(DriveMovement) + 8);
+			memoryNeeded += MovementArena::MemoryNeeded<DriveMovement>(numDMsWanted - DriveMovement::NumCreated());
+		}
+		if (numSegmentsWanted > MoveSegment::NumCreated())
+		{
+			memoryNeeded += MovementArena::MemoryNeeded<MoveSegment>(numSegmentsWanted - MoveSegment::NumCreated());
 		}
 		if (memoryNeeded != 0)
 		{
@@ -145,26 +161,34 @@ GCodeResult DDARing::ConfigureMovementQueue(GCodeBuffer& gb, const StringRef& re
 				return GCodeResult::error;
 			}
 
-			// Allocate the extra DDAs and put them in the ring.
+			// Allocate the extra DDAs as a single block and put them in the ring.
 			// We must be careful that addPointer->next points to the same DDA as before.
 			//TODO can we combine this with the code in Init1?
-			while (numDdasWanted > numDdasInRing)
+			if (numDdasWanted > numDdasInRing)
 			{
-				DDA * const newDda = new DDA(addPointer);
-				newDda->SetPrevious(addPointer->GetPrevious());
-				addPointer->GetPrevious()->SetNext(newDda);
-				addPointer->SetPrevious(newDda);
-				++numDdasInRing;
+				const unsigned int numNewDdas = numDdasWanted - numDdasInRing;
+				DDA * const newDdas = MovementArena::AllocateBlock<DDA>(numNewDdas);
+				for (unsigned int i = 0; i < numNewDdas; ++i)
+				{
+					DDA * const newDda = ::new (newDdas + i) DDA(addPointer);
+					newDda->SetPrevious(addPointer->GetPrevious());
+					addPointer->GetPrevious()->SetNext(newDda);
+					addPointer->SetPrevious(newDda);
+				}
+				numDdasInRing = numDdasWanted;
 			}
 
-			// Allocate the extra DMs
+			// Allocate the extra DMs and move segments
 			DriveMovement::InitialAllocate(numDMsWanted);		// this will only create any extra ones wanted
+			MoveSegment::InitialAllocate(numSegmentsWanted);	// this will only create any extra ones wanted
 		}
 		reprap.MoveUpdated();
 	}
 	else
 	{
-		reply.printf("DDAs %u, DMs %u, GracePeriod %" PRIu32, numDdasInRing, DriveMovement::NumCreated(), gracePeriod);
+		reply.printf("DDAs %u (max used %u), DMs %u (max used %u), segments %u (max used %u), GracePeriod %" PRIu32,
+						numDdasInRing, maxDdasInUse, DriveMovement::NumCreated(), DriveMovement::MaxInUse(), MoveSegment::NumCreated(), MoveSegment::MaxInUse(),
+						gracePeriod);
 	}
 	return GCodeResult::ok;
 }
@@ -224,10 +248,11 @@ bool DDARing::CanAddMove() const noexcept
 // Add a new move, returning true if it represents real movement
 bool DDARing::AddStandardMove(const RawMove &nextMove, bool doMotorMapping) noexcept
 {
+	const uint32_t startTime = StepTimer::GetTimerTicks();
 	if (addPointer->InitStandardMove(*this, nextMove, doMotorMapping))
 	{
-		addPointer = addPointer->GetNext();
-		scheduledMoves++;
+		planTimes.Add(StepTimer::GetTimerTicks() - startTime);
+		MoveScheduled();
 		return true;
 	}
 	return false;
@@ -238,8 +263,7 @@ bool DDARing::AddSpecialMove(float feedRate, const float coords[MaxDriversPerAxi
 {
 	if (addPointer->InitLeadscrewMove(*this, feedRate, coords))
 	{
-		addPointer = addPointer->GetNext();
-		scheduledMoves++;
+		MoveScheduled();
 		return true;
 	}
 	return false;
@@ -252,8 +276,7 @@ bool DDARing::AddAsyncMove(const AsyncMove& nextMove) noexcept
 {
 	if (addPointer->InitAsyncMove(*this, nextMove))
 	{
-		addPointer = addPointer->GetNext();
-		scheduledMoves++;
+		MoveScheduled();
 		return true;
 	}
 	return false;
@@ -272,11 +295,18 @@ uint32_t DDARing::Spin(SimulationMode simulationMode, bool waitingForSpace, bool
 	if (simulationMode != SimulationMode::off && cdda != nullptr)
 	{
 		simulationTime += (float)cdda->GetClocksNeeded() * (1.0/StepClockRate);
-		if (simulationMode == SimulationMode::debug && reprap.Debug(moduleDda))
+		StepTrace * const trace = stepTrace;						// capture volatile variable
+		if (simulationMode == SimulationMode::debug && (trace != nullptr || reprap.Debug(moduleDda)))
 		{
+#if HAS_MASS_STORAGE
+			if (trace != nullptr)
+			{
+				trace->StartMove(cdda->GetClocksNeeded());
+			}
+#endif
 			do
 			{
-				cdda->SimulateSteppingDrivers(reprap.GetPlatform());
+				cdda->SimulateSteppingDrivers(reprap.GetPlatform(), trace);
 			} while (cdda->GetState() != DDA::completed);
 		}
 		else
@@ -377,7 +407,7 @@ uint32_t DDARing::Spin(SimulationMode simulationMode, bool waitingForSpace, bool
 			const bool wakeLaser = StartNextMove(p, StepTimer::GetTimerTicks());
 			if (ScheduleNextStepInterrupt())
 			{
-				Interrupt(p);
+				(void)GenerateSteps(p, currentDda, StepTimer::GetTimerTicks());	// this isn't a step interrupt, so don't include it in the step ISR statistics
 			}
 			SetBasePriority(0);
 
@@ -417,7 +447,10 @@ uint32_t DDARing::PrepareMoves(DDA *firstUnpreparedMove, int32_t moveTimeLeft, u
 #endif
 		  )
 	{
+		const uint32_t startTime = StepTimer::GetTimerTicks();
 		firstUnpreparedMove->Prepare(simulationMode);
+		prepareTimes.Add(StepTimer::GetTimerTicks() - startTime);
+		numStepsPrepared += firstUnpreparedMove->GetNumLocalSteps();
 		moveTimeLeft += firstUnpreparedMove->GetTimeLeft();
 		++alreadyPrepared;
 		firstUnpreparedMove = firstUnpreparedMove->GetNext();
@@ -453,71 +486,100 @@ float DDARing::PushBabyStepping(size_t axis, float amount) noexcept
 	return addPointer->AdvanceBabyStepping(*this, axis, amount);
 }
 
+// Read the SysTick counter, which counts down at the CPU clock rate and reloads every millisecond
+static inline uint32_t GetCpuCycleCount() noexcept
+{
+	return SysTick->VAL & 0x00FFFFFF;
+}
+
 // ISR for the step interrupt
 void DDARing::Interrupt(Platform& p) noexcept
 {
-	DDA* cdda = currentDda;										// capture volatile variable
+	DDA * const cdda = currentDda;								// capture volatile variable
 	if (cdda != nullptr)
 	{
-		uint32_t now = StepTimer::GetTimerTicks();
-		const uint32_t isrStartTime = now;
-		for (;;)
+		if (recordStepIsrStats)
+		{
+			const uint32_t startCycles = GetCpuCycleCount();
+			const uint32_t now = StepTimer::GetTimerTicks();
+			const int32_t lateness = (int32_t)(now - timer.GetWhenDue());
+			const unsigned int stepsDone = GenerateSteps(p, cdda, now);
+			const uint32_t endCycles = GetCpuCycleCount();
+
+			// The ISR never runs for as long as the SysTick reload period, so we only need to allow for one wrap round of the counter
+			isrDurations.Add(((startCycles >= endCycles) ? startCycles : startCycles + (SysTick->LOAD & 0x00FFFFFF) + 1) - endCycles);
+			isrLateness.Add((lateness > 0) ? (uint32_t)lateness : 0);		// the callback may be made slightly early if it was imminent
+			stepsPerIsr.Add(stepsDone);
+		}
+		else
+		{
+			(void)GenerateSteps(p, cdda, StepTimer::GetTimerTicks());
+		}
+	}
+}
+
+// Generate the steps that are due and schedule the next step interrupt. Called from the step ISR with a non-null current DDA.
+unsigned int DDARing::GenerateSteps(Platform& p, DDA *cdda, uint32_t now) noexcept
+{
+	const uint32_t isrStartTime = now;
+	unsigned int stepsDone = 0;
+	for (;;)
+	{
+		// Generate a step for the current move
+		stepsDone += cdda->StepDrivers(p, now);				// check endstops if necessary and step the drivers
+		if (cdda->GetState() == DDA::completed)
 		{
-			// Generate a step for the current move
-			cdda->StepDrivers(p, now);							// check endstops if necessary and step the drivers
-			if (cdda->GetState() == DDA::completed)
-			{
 #if SUPPORT_CAN_EXPANSION
-				if (cdda->IsCheckingEndstops())
-				{
-					CanMotion::FinishMoveUsingEndstops();		// Tell CAN-connected drivers to revert their position
-				}
-#endif
-				OnMoveCompleted(cdda, p);
-				cdda = currentDda;
-				if (cdda == nullptr)
-				{
-					break;
-				}
+			if (cdda->IsCheckingEndstops())
+			{
+				CanMotion::FinishMoveUsingEndstops();			// Tell CAN-connected drivers to revert their position
 			}
-
-			// Schedule a callback at the time when the next step is due, and quit unless it is due immediately
-			if (!cdda->ScheduleNextStepInterrupt(timer))
+#endif
+			OnMoveCompleted(cdda, p);
+			cdda = currentDda;
+			if (cdda == nullptr)
 			{
 				break;
 			}
+		}
 
-			// The next step is due immediately. Check whether we have been in this ISR for too long already and need to take a break
-			now = StepTimer::GetTimerTicks();
-			const uint32_t clocksTaken = now - isrStartTime;
-			if (clocksTaken >= DDA::MaxStepInterruptTime)
-			{
-				// Force a break by updating the move start time.
-				++numHiccups;
+		// Schedule a callback at the time when the next step is due, and quit unless it is due immediately
+		if (!cdda->ScheduleNextStepInterrupt(timer))
+		{
+			break;
+		}
+
+		// The next step is due immediately. Check whether we have been in this ISR for too long already and need to take a break
+		now = StepTimer::GetTimerTicks();
+		const uint32_t clocksTaken = now - isrStartTime;
+		if (clocksTaken >= DDA::MaxStepInterruptTime)
+		{
+			// Force a break by updating the move start time.
+			++numHiccups;
 #if SUPPORT_CAN_EXPANSION
-				uint32_t cumulativeHiccupTime = 0;
+			uint32_t cumulativeHiccupTime = 0;
 #endif
-				for (uint32_t hiccupTime = DDA::HiccupTime; ; hiccupTime += DDA::HiccupIncrement)
-				{
+			for (uint32_t hiccupTime = DDA::HiccupTime; ; hiccupTime += DDA::HiccupIncrement)
+			{
 #if SUPPORT_CAN_EXPANSION
-					cumulativeHiccupTime += cdda->InsertHiccup(now + hiccupTime);
+				cumulativeHiccupTime += cdda->InsertHiccup(now + hiccupTime);
 #else
-					cdda->InsertHiccup(now + hiccupTime);
+				cdda->InsertHiccup(now + hiccupTime);
 #endif
-					// Reschedule the next step interrupt. This time it should succeed if the hiccup time was long enough.
-					if (!cdda->ScheduleNextStepInterrupt(timer))
-					{
+				// Reschedule the next step interrupt. This time it should succeed if the hiccup time was long enough.
+				if (!cdda->ScheduleNextStepInterrupt(timer))
+				{
 #if SUPPORT_CAN_EXPANSION
-						CanMotion::InsertHiccup(cumulativeHiccupTime);
+					CanMotion::InsertHiccup(cumulativeHiccupTime);
 #endif
-						return;
-					}
-					// We probably had an interrupt that delayed us further. Recalculate the hiccup length, also we increase the hiccup time on each iteration.
-					now = StepTimer::GetTimerTicks();
+					return stepsDone;
 				}
+				// We probably had an interrupt that delayed us further. Recalculate the hiccup length, also we increase the hiccup time on each iteration.
+				now = StepTimer::GetTimerTicks();
 			}
 		}
 	}
+	return stepsDone;
 }
 
 // DDARing timer callback function
@@ -963,6 +1025,60 @@ void DDARing::Diagnostics(MessageType mtype, const char *prefix) noexcept
 									prefix, scheduledMoves, completedMoves, numHiccups, stepErrors, numLookaheadErrors, numLookaheadUnderruns, numPrepareUnderruns, numNoMoveUnderruns,
 									(cdda == nullptr) ? -1 : (int)cdda->GetState());
 	numHiccups = stepErrors = numLookaheadUnderruns = numPrepareUnderruns = numNoMoveUnderruns = numLookaheadErrors = 0;
+
+	// Report the planner throughput since we last reported it. Running a file in simulation mode and then using M122 gives the throughput of the planner alone.
+	const uint32_t now = millis();
+	const float secondsElapsed = (float)(now - whenPlannerStatsReset) * MillisToSeconds;
+	const float rateFactor = (secondsElapsed > 0.0) ? 1.0/secondsElapsed : 0.0;
+	String<StringLength256> scratchString;
+	scratchString.printf("Planner: moves added %" PRIu32 " (%.1f/s), prepared %" PRIu32 " (%.1f/s), steps %" PRIu32 " (%.0f/s)\n"
+							"Plan times (p50/p90/p99/max) ",
+							planTimes.GetNumSamples(), (double)(planTimes.GetNumSamples() * rateFactor),
+							prepareTimes.GetNumSamples(), (double)(prepareTimes.GetNumSamples() * rateFactor),
+							numStepsPrepared, (double)(numStepsPrepared * rateFactor));
+	planTimes.AppendPercentiles(scratchString.GetRef(), StepClockRate);
+	scratchString.cat(", prepare times ");
+	prepareTimes.AppendPercentiles(scratchString.GetRef(), StepClockRate);
+	scratchString.cat('\n');
+	reprap.GetPlatform().Message(mtype, scratchString.c_str());
+	reprap.GetPlatform().MessageF(mtype, "Lookahead: DDAs visited %" PRIu32 " (%.2f per move added, max %u), passes cut short %u\n",
+									numLookaheadDdasVisited,
+									(planTimes.GetNumSamples() == 0) ? 0.0 : (double)((float)numLookaheadDdasVisited/(float)planTimes.GetNumSamples()),
+									maxLookaheadDdasVisited, numLookaheadsCutShort);
+	planTimes.Clear();
+	prepareTimes.Clear();
+	numStepsPrepared = 0;
+	whenPlannerStatsReset = now;
+	numLookaheadDdasVisited = 0;
+	maxLookaheadDdasVisited = numLookaheadsCutShort = 0;
+
+	// Report the step ISR statistics. We don't reset these here, so that the object model can report them.
+	if (recordStepIsrStats)
+	{
+		scratchString.printf("Step ISRs %" PRIu32 ", durations (p50/p90/p99/max) ", isrDurations.GetNumSamples());
+		isrDurations.AppendPercentiles(scratchString.GetRef(), SystemCoreClock);
+		scratchString.cat(", lateness ");
+		isrLateness.AppendPercentiles(scratchString.GetRef(), StepClockRate);
+		scratchString.cat(", steps ");
+		stepsPerIsr.AppendPercentiles(scratchString.GetRef());
+		scratchString.cat('\n');
+	}
+	else
+	{
+		scratchString.copy("Step ISR statistics disabled, use M122 P110 S1 to enable them\n");
+	}
+	reprap.GetPlatform().Message(mtype, scratchString.c_str());
+}
+
+// Reset the step ISR statistics and enable or disable recording them
+void DDARing::EnableStepIsrStats(bool enable) noexcept
+{
+	SetBasePriority(NvicPriorityStep);							// lock out step interrupts
+	isrDurations.Clear();
+	isrLateness.Clear();
+	stepsPerIsr.Clear();
+	recordStepIsrStats = enable;
+	SetBasePriority(0);
 }
 
 #if SUPPORT_LASER
@@ -998,8 +1114,7 @@ void DDARing::AddShapedMoveFromRemote(const CanMessageMovementLinearShaped& msg)
 	{
 		if (addPointer->InitShapedFromRemote(msg))
 		{
-			addPointer = addPointer->GetNext();
-			scheduledMoves++;
+			MoveScheduled();
 		}
 	}
 }
@@ -1013,8 +1128,7 @@ void DDARing::AddMoveFromRemote(const CanMessageMovementLinear& msg) noexcept
 	{
 		if (addPointer->InitFromRemote(msg))
 		{
-			addPointer = addPointer->GetNext();
-			scheduledMoves++;
+			MoveScheduled();
 		}
 	}
 }
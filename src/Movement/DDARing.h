@@ -11,6 +11,8 @@
 #define SRC_MOVEMENT_DDARING_H_
 
 #include "DDA.h"
+#include "TimingHistogram.h"
+#include "Kinematics/Kinematics.h"
 
 class DDARing INHERIT_OBJECT_MODEL
 {
@@ -24,6 +26,7 @@ public:
 	void RecycleDDAs() noexcept;
 	bool CanAddMove() const noexcept;
 	bool AddStandardMove(const RawMove &nextMove, bool doMotorMapping) noexcept SPEED_CRITICAL;	// Set up a new move, returning true if it represents real movement
+	IncrementalConversionState& GetConversionState() noexcept { return conversionState; }		// Get the kinematics state for converting the endpoints of moves added to this ring
 	bool AddSpecialMove(float feedRate, const float coords[MaxDriversPerAxis]) noexcept;
 #if SUPPORT_ASYNC_MOVES
 	bool AddAsyncMove(const AsyncMove& nextMove) noexcept;
@@ -49,6 +52,7 @@ public:
 
 	float GetSimulationTime() const noexcept { return simulationTime; }
 	void ResetSimulationTime() noexcept { simulationTime = 0.0; }
+	void SetStepTrace(StepTrace *trace) noexcept { stepTrace = trace; }				// Set or clear the trace used to record steps in SimulationMode::debug
 
 #if HAS_SMART_DRIVERS
 	uint32_t GetStepInterval(size_t axis, uint32_t microstepShift) const noexcept;
@@ -80,8 +84,15 @@ public:
 #endif
 
 	void RecordLookaheadError() noexcept { ++numLookaheadErrors; }						// Record a lookahead error
+	void RecordLookahead(unsigned int ddasVisited) noexcept;								// Record how many DDAs a lookahead pass visited
+	void RecordLookaheadCutShort() noexcept { ++numLookaheadsCutShort; }				// Record that a lookahead pass stopped early because earlier moves could not be improved
 	void Diagnostics(MessageType mtype, const char *prefix) noexcept;
 
+	const TimingHistogram& GetStepIsrDurations() const noexcept { return isrDurations; }	// Step ISR durations in CPU clocks
+	const TimingHistogram& GetStepIsrLateness() const noexcept { return isrLateness; }	// Step ISR lateness in step clocks
+	const TimingHistogram& GetStepsPerIsr() const noexcept { return stepsPerIsr; }		// Number of drives stepped per step ISR
+	void EnableStepIsrStats(bool enable) noexcept;										// Reset the step ISR statistics and enable or disable recording them
+
 	bool SetWaitingToEmpty() noexcept;
 
 	GCodeResult ConfigureMovementQueue(GCodeBuffer& gb, const StringRef& reply) THROWS(GCodeException);
@@ -100,6 +111,9 @@ protected:
 private:
 	bool StartNextMove(Platform& p, uint32_t startTime) noexcept SPEED_CRITICAL;		// Start the next move, returning true if laser or IObits need to be controlled
 	uint32_t PrepareMoves(DDA *firstUnpreparedMove, int32_t moveTimeLeft, unsigned int alreadyPrepared, SimulationMode simulationMode) noexcept;
+	void MoveScheduled() noexcept;														// Advance the add pointer and count the move just added
+
+	unsigned int GenerateSteps(Platform& p, DDA *cdda, uint32_t now) noexcept SPEED_CRITICAL;	// Body of the step ISR, returns the number of drive steps generated
 
 	static void TimerCallback(CallbackParameter p) noexcept;
 
@@ -108,12 +122,15 @@ private:
 	DDA* volatile getPointer;
 	DDA* checkPointer;
 
+	IncrementalConversionState conversionState;									// Used only by the task that adds moves to this ring, to speed up converting their endpoints to motor positions
+
 	StepTimer timer;															// Timer object to control getting step interrupts
 
 	volatile float liveCoordinates[MaxAxesPlusExtruders];						// The endpoint that the machine moved to in the last completed move
 	volatile int32_t liveEndPoints[MaxAxesPlusExtruders];						// The XYZ endpoints of the last completed move in motor coordinates
 
 	unsigned int numDdasInRing;
+	unsigned int maxDdasInUse;													// High water mark of the number of DDAs holding moves that have not completed
 	uint32_t gracePeriod;														// The minimum idle time in milliseconds, before we should start a move. Better to have a few moves in the queue so that we can do lookahead
 
 	uint32_t scheduledMoves;													// Move counters for the code queue
@@ -127,6 +144,24 @@ private:
 	unsigned int stepErrors;													// count of step errors, for diagnostics
 
 	float simulationTime;														// Print time since we started simulating
+	StepTrace * volatile stepTrace;												// If not null, the steps generated in SimulationMode::debug are recorded here
+
+	// Planner throughput statistics, reported and reset by Diagnostics
+	TimingHistogram planTimes;													// Time taken to add each move to the ring including lookahead, in step clocks
+	TimingHistogram prepareTimes;												// Time taken to prepare each move, in step clocks
+	uint32_t numStepsPrepared;													// Number of local driver steps in the moves we prepared
+	uint32_t whenPlannerStatsReset;												// The millis() value when we last reset the planner statistics
+	uint32_t numLookaheadDdasVisited;											// Total number of DDAs visited by lookahead passes
+	unsigned int maxLookaheadDdasVisited;										// Maximum number of DDAs visited by a single lookahead pass
+	unsigned int numLookaheadsCutShort;											// Number of lookahead passes that stopped early because earlier moves could not be improved
+
+	// Step ISR statistics. These cost time in every step interrupt, so they are only recorded after M122 P110 S1 has been used to enable them.
+	// They are not reset by Diagnostics so that they can be read from the object model.
+	volatile bool recordStepIsrStats;											// True if the step ISR statistics are being recorded
+	TimingHistogram isrDurations;												// Time spent in each step ISR, in CPU clocks
+	TimingHistogram isrLateness;												// How late each step ISR started compared to when it was scheduled, in step clocks
+	TimingHistogram stepsPerIsr;												// Number of drive steps generated by each step ISR
+
 	volatile int32_t movementAccumulators[MaxAxesPlusExtruders]; 				// Accumulated motor steps, used by filament monitors
 	volatile uint32_t extrudersPrintingSince;									// The milliseconds clock time when extrudersPrinting was set to true
 
@@ -136,6 +171,28 @@ private:
 	volatile bool waitingForRingToEmpty;										// True if Move has signalled that we are waiting for this ring to empty
 };
 
+// Record how many DDAs a lookahead pass visited
+inline void DDARing::RecordLookahead(unsigned int ddasVisited) noexcept
+{
+	numLookaheadDdasVisited += ddasVisited;
+	if (ddasVisited > maxLookaheadDdasVisited)
+	{
+		maxLookaheadDdasVisited = ddasVisited;
+	}
+}
+
+// Advance the add pointer after adding a move to the ring, and update the high water mark of the number of DDAs in use
+inline void DDARing::MoveScheduled() noexcept
+{
+	addPointer = addPointer->GetNext();
+	++scheduledMoves;
+	const unsigned int ddasInUse = scheduledMoves - completedMoves;
+	if (ddasInUse > maxDdasInUse)
+	{
+		maxDdasInUse = ddasInUse;
+	}
+}
+
 // Start the next move. Return true if laser or IO bits need to be active
 // Must be called with base priority greater than or equal to the step interrupt, to avoid a race with the step ISR.
 inline bool DDARing::StartNextMove(Platform& p, uint32_t startTime) noexcept
@@ -9,6 +9,7 @@
 #include "DDA.h"
 #include "Move.h"
 #include "StepTimer.h"
+#include "MovementArena.h"
 #include <Platform/RepRap.h>
 #include <Math/Isqrt.h>
 #include "Kinematics/LinearDeltaKinematics.h"
@@ -27,32 +28,45 @@ static_assert(((int64_t)-10000000001 >> 1) == (int64_t)-5000000001);
 
 DriveMovement *DriveMovement::freeList = nullptr;
 unsigned int DriveMovement::numCreated = 0;
+unsigned int DriveMovement::numInUse = 0;
+unsigned int DriveMovement::maxInUse = 0;
 
+// Create DMs until we have the requested number, allocating them as a single block from the movement arena
 void DriveMovement::InitialAllocate(unsigned int num) noexcept
 {
-	while (num > numCreated)
+	if (num > numCreated)
 	{
-		freeList = new DriveMovement(freeList);
-		++numCreated;
+		const unsigned int numNeeded = num - numCreated;
+		DriveMovement * const block = MovementArena::AllocateBlock<DriveMovement>(numNeeded);
+		for (unsigned int i = numNeeded; i != 0; )
+		{
+			--i;
+			freeList = ::new (block + i) DriveMovement(freeList);		// build the free list backwards so that the DMs get used in address order
+		}
+		numCreated = num;
 	}
 }
 
-// Allocate a DM, from the freelist if possible, else create a new one
+// Allocate a DM from the freelist, first adding a few more to the pool from the movement arena if it is empty
 DriveMovement *DriveMovement::Allocate(size_t p_drive, DMState st) noexcept
 {
-	DriveMovement * dm = freeList;
-	if (dm != nullptr)
+	if (freeList == nullptr)
 	{
-		freeList = dm->nextDM;
-		dm->nextDM = nullptr;
+		InitialAllocate(numCreated + NumToAddWhenExhausted);
 	}
-	else
+	DriveMovement * const dm = freeList;
+	freeList = dm->nextDM;
+	dm->nextDM = nullptr;
+	++numInUse;
+	if (numInUse > maxInUse)
 	{
-		dm = new DriveMovement(nullptr);
-		++numCreated;
+		maxInUse = numInUse;
 	}
 	dm->drive = (uint8_t)p_drive;
 	dm->state = st;
+#if SUPPORT_PRECALCULATED_STEPS
+	dm->numPrecalculatedSteps = dm->nextPrecalculatedStep = 0;
+#endif
 	return dm;
 }
 
@@ -77,6 +91,14 @@ void DriveMovement::DebugPrint() const noexcept
 			debugPrintf(" hmz0s=%.4e minusAaPlusBbTimesS=%.4e dSquaredMinusAsquaredMinusBsquared=%.4e drev=%.4e\n",
 							(double)mp.delta.fHmz0s, (double)mp.delta.fMinusAaPlusBbTimesS, (double)mp.delta.fDSquaredMinusAsquaredMinusBsquaredTimesSsquared, (double)mp.delta.reverseStartDistance);
 		}
+# if SUPPORT_NATIVE_ARCS
+		else if (isArc)
+		{
+			debugPrintf(" amp=%.4e sa=%.4e ar=%.4e sd=%.4e hc=%u pc=%u/%u ends=%" PRIu32 ",%" PRIu32 ",%" PRIu32 "\n",
+							(double)mp.arc.amplitude, (double)mp.arc.startAngle, (double)mp.arc.angleRate, (double)mp.arc.startDepth,
+							mp.arc.firstHalfCycle, mp.arc.currentPiece, mp.arc.numPieces, mp.arc.pieceEndStep[0], mp.arc.pieceEndStep[1], mp.arc.pieceEndStep[2]);
+		}
+# endif
 		else if (isExtruder)
 		{
 			debugPrintf(" pa=%" PRIu32 " eed=%.4e ebf=%.4e\n", (uint32_t)mp.cart.pressureAdvanceK, (double)mp.cart.extraExtrusionDistance, (double)mp.cart.extrusionBroughtForwards);
@@ -425,6 +447,7 @@ bool DriveMovement::PrepareCartesianAxis(const DDA& dda, const PrepParams& param
 #endif
 	isDelta = false;
 	isExtruder = false;
+	isArc = false;
 	currentSegment = (dda.shapedSegments != nullptr) ? dda.shapedSegments : dda.unshapedSegments;
 	nextStep = 0;									// must do this before calling NewCartesianSegment
 
@@ -607,6 +630,7 @@ bool DriveMovement::PrepareDeltaAxis(const DDA& dda, const PrepParams& params) n
 #endif
 
 	isDelta = true;
+	isArc = false;
 	currentSegment = (dda.shapedSegments != nullptr) ? dda.shapedSegments : dda.unshapedSegments;
 
 	nextStep = 0;									// must do this before calling NewDeltaSegment
@@ -865,6 +889,7 @@ bool DriveMovement::PrepareExtruder(const DDA& dda, const PrepParams& params) no
 	currentSegment = dda.unshapedSegments;
 	isDelta = false;
 	isExtruder = true;
+	isArc = false;
 
 	nextStep = 0;									// must do this before calling NewExtruderSegment
 	if (!NewExtruderSegment())
@@ -879,6 +904,202 @@ bool DriveMovement::PrepareExtruder(const DDA& dda, const PrepParams& params) no
 	return CalcNextStepTime(dda);
 }
 
+#if SUPPORT_NATIVE_ARCS
+
+// Prepare this DM for a motor driven by the axes of a native arc move, returning true if there are steps to do.
+// The motor position is mc + factor0 * r * cos(theta) + factor1 * r * sin(theta) where theta is the angle around the arc, which we rewrite as mc + R * cos(psi)
+// where psi increases as the move progresses. So the motor reverses each time psi passes a multiple of Pi. Within each half cycle the motor moves monotonically.
+// 'netSteps' is the net number of steps that the motor must move, which may be zero for a complete circle.
+bool DriveMovement::PrepareArcAxis(const DDA& dda, const PrepParams& params, int32_t netSteps) noexcept
+{
+	const Kinematics& k = reprap.GetMove().GetKinematics();
+	const float a = dda.arc.radius * k.GetArcMotorFactor(dda.arc.axis0, drive);
+	const float b = dda.arc.radius * k.GetArcMotorFactor(dda.arc.axis1, drive);
+	const float phase = atan2f(b, a);
+	float startAngle = (dda.arc.totalAngle >= 0.0) ? dda.arcStartAngle - phase : phase - dda.arcStartAngle;
+	startAngle -= floorf(startAngle * (1.0/TwoPi)) * TwoPi;
+	if (startAngle >= TwoPi || startAngle < 0.0)			// guard against rounding error
+	{
+		startAngle = 0.0;
+	}
+	const float totalAngle = fabsf(dda.arc.totalAngle);
+	const float amplitude = fastSqrtf(fsquare(a) + fsquare(b)) * reprap.GetPlatform().DriveStepsPerUnit(drive);
+
+	mp.arc.amplitude = amplitude;
+	mp.arc.startAngle = startAngle;
+	mp.arc.angleRate = totalAngle/dda.totalDistance;
+	mp.arc.recipAngleRate = dda.totalDistance/totalAngle;
+	mp.arc.startDepth = 2 * amplitude * fsquare(sinf(0.5 * startAngle));
+	mp.arc.firstHalfCycle = (uint8_t)(startAngle * (1.0/Pi));
+	const unsigned int lastHalfCycle = max<int>((int)ceilf((startAngle + totalAngle) * (1.0/Pi)) - 1, (int)mp.arc.firstHalfCycle);
+	mp.arc.numPieces = (uint8_t)min<unsigned int>(lastHalfCycle + 1 - mp.arc.firstHalfCycle, MaxArcPieces);
+
+	// Work out how many steps there are in each piece. The motor moves backwards during even half cycles and forwards during odd ones.
+	// Each piece except the last one ends at an extreme of the movement. Make the last one end at the required net position.
+	int32_t pieceStartPosition = 0;
+	uint32_t stepsSoFar = 0;
+	mp.arc.initialDirection = ((mp.arc.firstHalfCycle & 1) != 0);
+	for (unsigned int piece = 0; piece < mp.arc.numPieces; ++piece)
+	{
+		const bool forwards = ((mp.arc.firstHalfCycle + piece) & 1) != 0;
+		int32_t pieceSteps;
+		if (piece + 1 < mp.arc.numPieces)
+		{
+			pieceSteps = (forwards) ? (int32_t)floorf(mp.arc.startDepth - (float)pieceStartPosition)
+									: (int32_t)floorf((float)pieceStartPosition - (mp.arc.startDepth - 2 * amplitude));
+			if (pieceSteps < 0)
+			{
+				pieceSteps = 0;
+			}
+		}
+		else
+		{
+			pieceSteps = (forwards) ? netSteps - pieceStartPosition : pieceStartPosition - netSteps;
+			if (pieceSteps < 0)
+			{
+				// Rounding error means that we need to move the other way to reach the end point
+				if (piece == 0)
+				{
+					mp.arc.initialDirection = !forwards;
+				}
+				else
+				{
+					// Extend the previous piece instead
+					stepsSoFar -= pieceSteps;
+					mp.arc.pieceEndStep[piece - 1] = stepsSoFar;
+				}
+				pieceSteps = (piece == 0) ? -pieceSteps : 0;
+			}
+		}
+		pieceStartPosition += (forwards) ? pieceSteps : -pieceSteps;
+		stepsSoFar += (uint32_t)pieceSteps;
+		mp.arc.pieceEndStep[piece] = stepsSoFar;
+	}
+
+	totalSteps = stepsSoFar;
+	if (totalSteps == 0)
+	{
+		return false;
+	}
+
+	// Skip any pieces at the start that have no steps
+	mp.arc.currentPiece = 0;
+	while (mp.arc.pieceEndStep[mp.arc.currentPiece] == 0)
+	{
+		++mp.arc.currentPiece;
+	}
+	mp.arc.pieceStartPosition = 0;
+	direction = (mp.arc.initialDirection != 0) == ((mp.arc.currentPiece & 1) == 0);
+	reverseStartStep = (mp.arc.currentPiece + 1u < mp.arc.numPieces) ? mp.arc.pieceEndStep[mp.arc.currentPiece] + 1 : totalSteps + 1;
+
+	distanceSoFar = 0.0;
+	timeSoFar = 0.0;
+	isDelta = false;
+	isExtruder = false;
+	isArc = true;
+	state = DMState::arc;
+	currentSegment = (dda.shapedSegments != nullptr) ? dda.shapedSegments : dda.unshapedSegments;
+	nextStep = 0;									// must do this before calling NewArcSegment
+	if (!NewArcSegment())
+	{
+		return false;
+	}
+
+	// Prepare for the first step
+	nextStepTime = 0;
+	stepsTakenThisSegment = 0;						// no steps taken yet since the start of the segment
+	stepsTillRecalc = 0;							// so that we don't skip the calculation
+	return CalcNextStepTime(dda);
+}
+
+// This is called when currentSegment has just been changed to a new segment. Return true if there is a new segment to execute.
+bool DriveMovement::NewArcSegment() noexcept
+{
+	while (true)
+	{
+		if (currentSegment == nullptr)
+		{
+			return false;
+		}
+
+		// Set up pA, pB and pC such that the time is pB + pC * distance for linear segments, or pB +/- sqrt(pA + pC * distance) for other segments
+		pC = currentSegment->GetC();
+		if (currentSegment->IsLinear())
+		{
+			pB = currentSegment->CalcLinearB(distanceSoFar, timeSoFar);
+		}
+		else
+		{
+			pA = currentSegment->CalcNonlinearA(distanceSoFar);
+			pB = currentSegment->CalcNonlinearB(timeSoFar);
+		}
+
+		distanceSoFar += currentSegment->GetSegmentLength();
+		timeSoFar += currentSegment->GetSegmentTime();
+
+		segmentStepLimit = (currentSegment->GetNext() == nullptr) ? totalSteps + 1 : GetArcStepsAtDistance(distanceSoFar) + 1;
+		if (nextStep < segmentStepLimit)
+		{
+			return true;
+		}
+
+		currentSegment = currentSegment->GetNext();						// skip this segment
+	}
+}
+
+// Return the number of steps that have been taken when the specified distance along the path has been moved
+uint32_t DriveMovement::GetArcStepsAtDistance(float distance) const noexcept
+{
+	const float angle = mp.arc.startAngle + distance * mp.arc.angleRate;
+	const float position = mp.arc.startDepth - 2 * mp.arc.amplitude * fsquare(sinf(0.5 * angle));
+	const unsigned int piece = (unsigned int)constrain<int>((int)(angle * (1.0/Pi)) - (int)mp.arc.firstHalfCycle, 0, mp.arc.numPieces - 1);
+
+	// Find the position and step number at the start of that piece
+	int32_t pieceStartPosition = 0;
+	uint32_t pieceStartStep = 0;
+	bool forwards = mp.arc.initialDirection;
+	for (unsigned int i = 0; i < piece; ++i)
+	{
+		const int32_t pieceSteps = (int32_t)(mp.arc.pieceEndStep[i] - pieceStartStep);
+		pieceStartPosition += (forwards) ? pieceSteps : -pieceSteps;
+		pieceStartStep = mp.arc.pieceEndStep[i];
+		forwards = !forwards;
+	}
+
+	const float stepsIntoPiece = floorf((forwards) ? position - (float)pieceStartPosition : (float)pieceStartPosition - position);
+	return pieceStartStep + (uint32_t)constrain<float>(stepsIntoPiece, 0.0, (float)(mp.arc.pieceEndStep[piece] - pieceStartStep));
+}
+
+// Return the net movement in the forwards direction after the specified number of steps
+int32_t DriveMovement::GetArcNetSteps(uint32_t stepsTaken) const noexcept
+{
+	int32_t position = 0;
+	uint32_t pieceStartStep = 0;
+	bool forwards = mp.arc.initialDirection;
+	for (unsigned int i = 0; i < mp.arc.numPieces && stepsTaken > pieceStartStep; ++i)
+	{
+		const int32_t pieceSteps = (int32_t)(min<uint32_t>(mp.arc.pieceEndStep[i], stepsTaken) - pieceStartStep);
+		position += (forwards) ? pieceSteps : -pieceSteps;
+		pieceStartStep = mp.arc.pieceEndStep[i];
+		forwards = !forwards;
+	}
+	return position;
+}
+
+// Return the phase angle at which the motor is the specified number of steps below its maximum position, in the specified half cycle of its movement
+float DriveMovement::GetArcAngle(float depth, unsigned int halfCycle) const noexcept
+{
+	const float twoAmplitude = 2 * mp.arc.amplitude;
+	const float d = constrain<float>(depth, 0.0, twoAmplitude);
+
+	// Use 1 - cos(x) = 2 * sin^2(x/2) because it is much more accurate than acos near the extremes of the movement
+	const float x = (d <= mp.arc.amplitude) ? 2 * asinf(fastSqrtf(d/twoAmplitude))
+					: Pi - 2 * asinf(fastSqrtf((twoAmplitude - d)/twoAmplitude));
+	return (float)halfCycle * Pi + (((halfCycle & 1) != 0) ? Pi - x : x);
+}
+
+#endif
+
 #if MS_USE_FPU
 
 // Version of fastSqrtf that allows for slightly negative operands caused by rounding error
@@ -896,6 +1117,40 @@ static inline uint32_t LimISqrt64(int64_t num) noexcept
 
 #endif
 
+#if SUPPORT_PRECALCULATED_STEPS
+
+// Calculate the times of the steps following the first one in advance, so that the step ISR only has to fetch them.
+// This is called by the Move task when it has finished preparing the move, after the time of the first step has been calculated and before the ISR can see this DM.
+// We don't do this for delta movement or if the direction may reverse during the move, because then the ISR may need to change the direction pin between steps.
+void DriveMovement::PrecalculateSteps(const DDA& dda) noexcept
+{
+	numPrecalculatedSteps = nextPrecalculatedStep = 0;
+	if (isDelta || reverseStartStep <= totalSteps || state < DMState::firstMotionState)
+	{
+		return;
+	}
+
+	// Calculating the step times advances the state of this DM to that of the last step we calculate, including nextStep.
+	// GetNextStepToIssue() subtracts the steps that the ISR has not issued yet, so the position is still right if the move is stopped or aborted.
+	const DriveMovement saved = *this;
+	unsigned int numCalculated = 0;
+	while (numCalculated < NumPrecalculatedSteps && nextStep < totalSteps)
+	{
+		if (!CalcNextStepTime(dda))
+		{
+			// We got a step error. Restore everything so that the ISR gets the same error when it reaches that step.
+			*this = saved;
+			return;
+		}
+		precalculatedStepTimes[numCalculated++] = nextStepTime;
+	}
+
+	nextStepTime = saved.nextStepTime;					// the ISR still has to issue the step it was going to issue before
+	numPrecalculatedSteps = numCalculated;
+}
+
+#endif
+
 // Calculate and store the time since the start of the move when the next step for the specified DriveMovement is due.
 // We have already incremented nextStep and checked that it does not exceed totalSteps, so at least one more step is due
 // Return true if all OK, false to abort this move because the calculation has gone wrong
@@ -913,6 +1168,9 @@ pre(nextStep <= totalSteps; stepsTillRecalc == 0)
 			const bool more =
 #if SUPPORT_LINEAR_DELTA
 								(isDelta) ? NewDeltaSegment(dda) :
+#endif
+#if SUPPORT_NATIVE_ARCS
+								(isArc) ? NewArcSegment() :
 #endif
 									(isExtruder) ? NewExtruderSegment()
 										: NewCartesianSegment();
@@ -1092,6 +1350,39 @@ pre(nextStep <= totalSteps; stepsTillRecalc == 0)
 		}
 		break;
 
+#if SUPPORT_NATIVE_ARCS
+	case DMState::arc:
+		{
+			// Check whether we have reached the end of the current half cycle, in which case the motor reverses
+			if (nextStep > mp.arc.pieceEndStep[mp.arc.currentPiece])
+			{
+				do
+				{
+					const uint32_t pieceStartStep = (mp.arc.currentPiece == 0) ? 0 : mp.arc.pieceEndStep[mp.arc.currentPiece - 1];
+					const int32_t pieceSteps = (int32_t)(mp.arc.pieceEndStep[mp.arc.currentPiece] - pieceStartStep);
+					mp.arc.pieceStartPosition += (direction) ? pieceSteps : -pieceSteps;
+					++mp.arc.currentPiece;
+					direction = !direction;
+				} while (nextStep > mp.arc.pieceEndStep[mp.arc.currentPiece]);
+				directionChanged = true;
+				reverseStartStep = (mp.arc.currentPiece + 1u < mp.arc.numPieces) ? mp.arc.pieceEndStep[mp.arc.currentPiece] + 1 : totalSteps + 1;
+			}
+
+			// Find the angle at which the motor reaches the required position, then the corresponding distance along the path
+			const uint32_t pieceStartStep = (mp.arc.currentPiece == 0) ? 0 : mp.arc.pieceEndStep[mp.arc.currentPiece - 1];
+			const int32_t stepsIntoPiece = (int32_t)(nextStep + stepsTillRecalc - pieceStartStep);
+			const int32_t position = (direction) ? mp.arc.pieceStartPosition + stepsIntoPiece : mp.arc.pieceStartPosition - stepsIntoPiece;
+			const float angle = GetArcAngle(mp.arc.startDepth - (float)position, mp.arc.firstHalfCycle + mp.arc.currentPiece);
+			const float distance = max<float>((angle - mp.arc.startAngle) * mp.arc.recipAngleRate, 0.0);
+
+			const float pCd = pC * distance;
+			nextCalcStepTime = (currentSegment->IsLinear()) ? pB + pCd
+								: (currentSegment->IsAccelerating()) ? pB + fastLimSqrtf(pA + pCd)
+									 : pB - fastLimSqrtf(pA + pCd);
+		}
+		break;
+#endif
+
 	default:
 		return false;
 	}
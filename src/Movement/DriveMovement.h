@@ -18,6 +18,17 @@ class ExtruderShaper;
 
 #define EVEN_STEPS			(1)						// 1 to generate steps at even intervals when doing double/quad/octal stepping
 
+#if SUPPORT_NATIVE_ARCS
+# if !MS_USE_FPU
+#  error "Native arc moves need floating point move segments"
+# endif
+constexpr unsigned int MaxArcPieces = 3;			// the maximum number of monotonic pieces in the movement of a motor during an arc of up to 360 degrees
+#endif
+
+#if SUPPORT_PRECALCULATED_STEPS
+constexpr unsigned int NumPrecalculatedSteps = 8;	// the maximum number of step times per drive that the Move task calculates in advance
+#endif
+
 enum class DMState : uint8_t
 {
 	idle = 0,
@@ -33,6 +44,10 @@ enum class DMState : uint8_t
 
 	deltaNormal,									// moving forwards without reversing in this segment, or in reverse
 	deltaForwardsReversing,							// moving forwards to start with, reversing before the end of this segment
+
+#if SUPPORT_NATIVE_ARCS
+	arc,											// moving sinusoidally because the drive is driven by the axes of a native arc move
+#endif
 };
 
 // This class describes a single movement of one drive
@@ -54,30 +69,49 @@ public:
 	bool PrepareDeltaAxis(const DDA& dda, const PrepParams& params) noexcept SPEED_CRITICAL;
 #endif
 	bool PrepareExtruder(const DDA& dda, const PrepParams& params) noexcept SPEED_CRITICAL;
+#if SUPPORT_NATIVE_ARCS
+	bool PrepareArcAxis(const DDA& dda, const PrepParams& params, int32_t netSteps) noexcept SPEED_CRITICAL;
+#endif
+#if SUPPORT_PRECALCULATED_STEPS
+	void PrecalculateSteps(const DDA& dda) noexcept;
+#endif
 
 	void DebugPrint() const noexcept;
 	int32_t GetNetStepsLeft() const noexcept;
 	int32_t GetNetStepsTaken() const noexcept;
+	uint32_t GetNextStepToIssue() const noexcept;
 
 #if HAS_SMART_DRIVERS
 	uint32_t GetStepInterval(uint32_t microstepShift) const noexcept;	// Get the current full step interval for this axis or extruder
 #endif
 
+	static constexpr unsigned int NumToAddWhenExhausted = 4;			// how many DMs we add to the pool if the free list runs out
+
 	static void InitialAllocate(unsigned int num) noexcept;
 	static unsigned int NumCreated() noexcept { return numCreated; }
+	static unsigned int MaxInUse() noexcept { return maxInUse; }
 	static DriveMovement *Allocate(size_t p_drive, DMState st) noexcept;
 	static void Release(DriveMovement *item) noexcept;
 
 private:
 	bool CalcNextStepTimeFull(const DDA &dda) noexcept SPEED_CRITICAL;
+	static void ExtendStepPulse() noexcept;
 	bool NewCartesianSegment() noexcept SPEED_CRITICAL;
 	bool NewExtruderSegment() noexcept SPEED_CRITICAL;
 #if SUPPORT_LINEAR_DELTA
 	bool NewDeltaSegment(const DDA& dda) noexcept SPEED_CRITICAL;
 #endif
+#if SUPPORT_NATIVE_ARCS
+	bool NewArcSegment() noexcept SPEED_CRITICAL;
+	uint32_t GetArcStepsAtDistance(float distance) const noexcept;		// get the number of steps taken when the specified distance along the arc has been moved
+	float GetArcAngle(float depth, unsigned int halfCycle) const noexcept SPEED_CRITICAL;	// get the phase angle at which the motor reaches the specified depth
+	int32_t GetArcNetSteps(uint32_t stepsTaken) const noexcept;			// get the net movement after the specified number of steps
+#endif
 
 	static DriveMovement *freeList;
 	static unsigned int numCreated;
+	static unsigned int numInUse;
+	static unsigned int maxInUse;							// high water mark of numInUse
 
 	// Parameters common to Cartesian, delta and extruder moves
 
@@ -90,7 +124,8 @@ private:
 			directionChanged : 1,						// set by CalcNextStepTime if the direction is changed
 			isDelta : 1,								// true if this DM uses segment-free delta kinematics
 			isExtruder : 1,								// true if this DM is for an extruder (only matters if !isDelta)
-					: 2,								// padding to make the next field last
+			isArc : 1,									// true if this DM is for a motor driven by the axes of a native arc move
+					: 1,								// padding to make the next field last
 			stepsTakenThisSegment : 2;					// how many steps we have taken this phase, counts from 0 to 2. Last field in the byte so that we can increment it efficiently.
 	uint8_t stepsTillRecalc;							// how soon we need to recalculate
 
@@ -151,7 +186,34 @@ private:
 #endif
 			float extrusionBroughtForwards;				// the amount of extrusion brought forwards from previous moves. Only needed for debug output.
 		} cart;
+
+#if SUPPORT_NATIVE_ARCS
+		// Parameters for a motor driven by the axes of a native arc move. The motor position relative to the arc centre is amplitude * cos(angle),
+		// where the phase angle increases linearly with the distance moved along the path. The movement is split into monotonic pieces at the extremes.
+		struct ArcParameters
+		{
+			float amplitude;							// the amplitude of the motor movement in steps
+			float startAngle;							// the phase angle at the start of the move, from 0 to 2 * Pi
+			float angleRate;							// the phase angle change per mm moved along the path
+			float recipAngleRate;						// the reciprocal of angleRate
+			float startDepth;							// how far the motor is below its maximum position at the start of the move, in steps
+			int32_t pieceStartPosition;					// the motor position relative to the start of the move at the start of the current piece
+			uint32_t pieceEndStep[MaxArcPieces];		// the number of the last step in each piece
+			uint8_t firstHalfCycle;						// the half cycle of the motor movement that the first piece is in
+			uint8_t numPieces;
+			uint8_t currentPiece;
+			uint8_t initialDirection;					// the direction of the first piece, true = forwards
+		} arc;
+#endif
 	} mp;
+
+#if SUPPORT_PRECALCULATED_STEPS
+	// When steps have been precalculated, nextStep and the rest of the calculation state are those of the last precalculated step.
+	// The steps in precalculatedStepTimes that the ISR hasn't used yet have not been issued, so use GetNextStepToIssue() to find how many steps have been taken.
+	uint8_t numPrecalculatedSteps;						// how many step times after nextStepTime the Move task calculated in advance
+	uint8_t nextPrecalculatedStep;						// the index of the next precalculated step time for the ISR to use
+	uint32_t precalculatedStepTimes[NumPrecalculatedSteps];
+#endif
 };
 
 // Calculate and store the time since the start of the move when the next step for the specified DriveMovement is due.
@@ -160,6 +222,14 @@ private:
 // We inline this part to speed things up when we are doing double/quad/octal stepping.
 inline bool DriveMovement::CalcNextStepTime(const DDA &dda) noexcept
 {
+#if SUPPORT_PRECALCULATED_STEPS
+	if (nextPrecalculatedStep < numPrecalculatedSteps)
+	{
+		nextStepTime = precalculatedStepTimes[nextPrecalculatedStep++];	// the Move task calculated this step time when it prepared the move, and nextStep already allows for it
+		ExtendStepPulse();
+		return true;
+	}
+#endif
 	++nextStep;
 	if (nextStep <= totalSteps)
 	{
@@ -169,64 +239,88 @@ inline bool DriveMovement::CalcNextStepTime(const DDA &dda) noexcept
 #if EVEN_STEPS
 			nextStepTime += stepInterval;
 #endif
-#ifdef DUET3_MB6HC							// we need to increase the minimum step pulse length to be long enough for the TMC5160
-			asm volatile("nop");
-			asm volatile("nop");
-			asm volatile("nop");
-			asm volatile("nop");
-			asm volatile("nop");
-			asm volatile("nop");
-#endif
+			ExtendStepPulse();
 			return true;
 		}
 		return CalcNextStepTimeFull(dda);
 	}
 
 	state = DMState::idle;
+	ExtendStepPulse();
+	return false;
+}
+
+// Make sure that the step pulse we just started is long enough. Called when we return from CalcNextStepTime without doing a full calculation.
+inline void DriveMovement::ExtendStepPulse() noexcept
+{
 #ifdef DUET3_MB6HC							// we need to increase the minimum step pulse length to be long enough for the TMC5160
-			asm volatile("nop");
-			asm volatile("nop");
-			asm volatile("nop");
-			asm volatile("nop");
-			asm volatile("nop");
-			asm volatile("nop");
+	asm volatile("nop");
+	asm volatile("nop");
+	asm volatile("nop");
+	asm volatile("nop");
+	asm volatile("nop");
+	asm volatile("nop");
+#endif
+}
+
+// Return the number of the next step that the ISR will issue.
+// This is nextStep less the number of precalculated steps that the ISR has not issued yet.
+inline uint32_t DriveMovement::GetNextStepToIssue() const noexcept
+{
+#if SUPPORT_PRECALCULATED_STEPS
+	return nextStep - (numPrecalculatedSteps - nextPrecalculatedStep);
+#else
+	return nextStep;
 #endif
-	return false;
 }
 
 // Return the number of net steps left for the move in the forwards direction.
-// We have already taken nextSteps - 1 steps, unless nextStep is zero.
+// We have already taken stepNum - 1 steps, unless stepNum is zero.
 inline int32_t DriveMovement::GetNetStepsLeft() const noexcept
 {
+	const uint32_t stepNum = GetNextStepToIssue();
+#if SUPPORT_NATIVE_ARCS
+	if (isArc)
+	{
+		return GetArcNetSteps(totalSteps) - GetArcNetSteps((stepNum == 0) ? 0 : stepNum - 1);
+	}
+#endif
 	int32_t netStepsLeft;
 	if (reverseStartStep > totalSteps)		// if no reverse phase
 	{
-		netStepsLeft = (nextStep == 0) ? (int32_t)totalSteps : (int32_t)totalSteps - (int32_t)nextStep + 1;
+		netStepsLeft = (stepNum == 0) ? (int32_t)totalSteps : (int32_t)totalSteps - (int32_t)stepNum + 1;
 	}
-	else if (nextStep >= reverseStartStep)
+	else if (stepNum >= reverseStartStep)
 	{
-		netStepsLeft = (int32_t)totalSteps - (int32_t)nextStep + 1;
+		netStepsLeft = (int32_t)totalSteps - (int32_t)stepNum + 1;
 	}
 	else
 	{
 		const int32_t totalNetSteps = (int32_t)(2 * reverseStartStep) - (int32_t)totalSteps - 2;
-		netStepsLeft = (nextStep == 0) ? totalNetSteps : totalNetSteps - (int32_t)nextStep + 1;
+		netStepsLeft = (stepNum == 0) ? totalNetSteps : totalNetSteps - (int32_t)stepNum + 1;
 	}
 	return (direction) ? netStepsLeft : -netStepsLeft;
 }
 
 // Return the number of net steps already taken for the move in the forwards direction.
-// We have already taken nextSteps - 1 steps, unless nextStep is zero.
+// We have already taken stepNum - 1 steps, unless stepNum is zero.
 inline int32_t DriveMovement::GetNetStepsTaken() const noexcept
 {
+	const uint32_t stepNum = GetNextStepToIssue();
+#if SUPPORT_NATIVE_ARCS
+	if (isArc)
+	{
+		return GetArcNetSteps((stepNum == 0) ? 0 : stepNum - 1);
+	}
+#endif
 	int32_t netStepsTaken;
-	if (nextStep < reverseStartStep || reverseStartStep > totalSteps)				// if no reverse phase, or not started it yet
+	if (stepNum < reverseStartStep || reverseStartStep > totalSteps)				// if no reverse phase, or not started it yet
 	{
-		netStepsTaken = (nextStep == 0) ? 0 : (int32_t)nextStep - 1;
+		netStepsTaken = (stepNum == 0) ? 0 : (int32_t)stepNum - 1;
 	}
 	else
 	{
-		netStepsTaken = (int32_t)nextStep - (int32_t)(2 * reverseStartStep) + 1;	// allowing for direction having changed
+		netStepsTaken = (int32_t)stepNum - (int32_t)(2 * reverseStartStep) + 1;	// allowing for direction having changed
 	}
 	return (direction) ? netStepsTaken : -netStepsTaken;
 }
@@ -236,6 +330,7 @@ inline void DriveMovement::Release(DriveMovement *item) noexcept
 {
 	item->nextDM = freeList;
 	freeList = item;
+	--numInUse;
 }
 
 #if HAS_SMART_DRIVERS
@@ -243,7 +338,8 @@ inline void DriveMovement::Release(DriveMovement *item) noexcept
 // Get the current full step interval for this axis or extruder
 inline uint32_t DriveMovement::GetStepInterval(uint32_t microstepShift) const noexcept
 {
-	return (nextStep < totalSteps && nextStep > (1u << microstepShift))				// if at least 1 full step done
+	const uint32_t stepNum = GetNextStepToIssue();
+	return (stepNum < totalSteps && stepNum > (1u << microstepShift))				// if at least 1 full step done
 				? stepInterval << microstepShift									// return the interval between steps converted to full steps
 					: 0;
 }
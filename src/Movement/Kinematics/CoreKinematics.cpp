@@ -463,4 +463,28 @@ AxesBitmap CoreKinematics::GetLinearAxes() const noexcept
 	return AxesBitmap::MakeLowestNBits(reprap.GetGCodes().GetVisibleAxes());	// we can babystep all axes
 }
 
+#if SUPPORT_NATIVE_ARCS
+
+// Return true if circular arcs in the plane of the two specified axes can be executed directly instead of being split into straight-line segments.
+// All motor positions are linear functions of the axis positions, so we just need to check that the motors that the arc axes drive are not also driven by other axes.
+bool CoreKinematics::SupportsNativeArcs(size_t axis0, size_t axis1) const noexcept
+{
+	for (size_t motor = 0; motor < MaxAxes; ++motor)
+	{
+		if (inverseMatrix(axis0, motor) != 0.0 || inverseMatrix(axis1, motor) != 0.0)
+		{
+			for (size_t axis = 0; axis < MaxAxes; ++axis)
+			{
+				if (axis != axis0 && axis != axis1 && inverseMatrix(axis, motor) != 0.0)
+				{
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+#endif
+
 // End
@@ -27,6 +27,10 @@ public:
 	void LimitSpeedAndAcceleration(DDA& dda, const float *normalisedDirectionVector, size_t numVisibleAxes, bool continuousRotationShortcut) const noexcept override;
 	AxesBitmap GetConnectedAxes(size_t axis) const noexcept override;
 	AxesBitmap GetLinearAxes() const noexcept override;
+#if SUPPORT_NATIVE_ARCS
+	bool SupportsNativeArcs(size_t axis0, size_t axis1) const noexcept override;
+	float GetArcMotorFactor(size_t axis, size_t motor) const noexcept override { return inverseMatrix(axis, motor); }
+#endif
 
 protected:
 	DECLARE_OBJECT_MODEL
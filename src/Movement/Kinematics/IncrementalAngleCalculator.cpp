@@ -0,0 +1,49 @@
+/*
+ * IncrementalAngleCalculator.cpp
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#include "IncrementalAngleCalculator.h"
+#include <cmath>
+
+// Return the angle of the vector (x, y) in the range -Pi to +Pi, using the previous result if the vector is close enough to the previous one
+float IncrementalAngleCalculator::Atan2(float y, float x) noexcept
+{
+	constexpr float Pi = 3.141592653589793;
+	constexpr float TwoPi = 3.141592653589793 * 2.0;
+
+	if (callsTillFullCalc != 0)
+	{
+		const float dot = x * lastX + y * lastY;
+		const float cross = lastX * y - lastY * x;
+		if (dot > 0.0 && fabsf(cross) <= MaxTangent * dot)
+		{
+			// atan(t) = t - t^3/3 + t^5/5 - ..., so with |t| <= 0.05 the error from ignoring the remaining terms is less than 2e-10
+			const float t = cross/dot;
+			const float tSquared = t * t;
+			float angle = lastAngle + t * (1.0 - tSquared * ((1.0/3.0) - tSquared * (1.0/5.0)));
+			if (angle > Pi)
+			{
+				angle -= TwoPi;
+			}
+			else if (angle <= -Pi)
+			{
+				angle += TwoPi;
+			}
+			--callsTillFullCalc;
+			lastX = x;
+			lastY = y;
+			lastAngle = angle;
+			return angle;
+		}
+	}
+
+	lastAngle = atan2f(y, x);
+	lastX = x;
+	lastY = y;
+	callsTillFullCalc = AnglesPerFullCalculation;
+	return lastAngle;
+}
+
+// End
@@ -0,0 +1,32 @@
+/*
+ * IncrementalAngleCalculator.h
+ *
+ *  Created on: 16 Oct 2026
+ *
+ *  This file only depends on the standard library so that it can be tested on the host (see folder Tests).
+ */
+
+#ifndef SRC_MOVEMENT_KINEMATICS_INCREMENTALANGLECALCULATOR_H_
+#define SRC_MOVEMENT_KINEMATICS_INCREMENTALANGLECALCULATOR_H_
+
+// Class to speed up converting a sequence of nearby positions to angles, as happens when a straight move is segmented on a SCARA or polar printer.
+// Instead of calling atan2f we add the angle between the new and previous vectors to the previous angle, using the first few terms of the series for atan.
+// Rounding errors accumulate, so we do the full calculation periodically.
+// The result depends only on the vector passed and the previous vector, so the calculator doesn't need to be reset when the machine position or the kinematics changes.
+class IncrementalAngleCalculator
+{
+public:
+	static constexpr unsigned int AnglesPerFullCalculation = 8;	// we do the full atan2 calculation at least every this number of conversions
+
+	IncrementalAngleCalculator() noexcept : callsTillFullCalc(0) { }
+
+	float Atan2(float y, float x) noexcept;				// return the same as atan2f(y, x) to within rounding error
+
+private:
+	static constexpr float MaxTangent = 0.05;			// the series is only used when the angle changes by less than about 2.9 degrees
+
+	float lastX, lastY, lastAngle;
+	unsigned int callsTillFullCalc;
+};
+
+#endif /* SRC_MOVEMENT_KINEMATICS_INCREMENTALANGLECALCULATOR_H_ */
@@ -11,6 +11,7 @@
 #include <RepRapFirmware.h>
 #include <Math/Matrix.h>
 #include <ObjectModel/ObjectModel.h>
+#include "IncrementalAngleCalculator.h"
 
 inline floatc_t fcsquare(floatc_t a)
 {
@@ -76,6 +77,15 @@ struct SegmentationType
 	}
 };
 
+// The state used by kinematics to convert the positions of successive segments of moves incrementally.
+// CartesianToMotorSteps is called from more than one task and from ISRs, so each caller that converts a sequence of positions owns one of these.
+struct IncrementalConversionState
+{
+	static constexpr size_t NumAngleCalculators = 2;
+
+	IncrementalAngleCalculator angleCalculators[NumAngleCalculators];
+};
+
 class Kinematics INHERIT_OBJECT_MODEL
 {
 public:
@@ -104,6 +114,14 @@ public:
 	// Return true if successful, false if we were unable to convert
 	virtual bool CartesianToMotorSteps(const float machinePos[], const float stepsPerMm[], size_t numVisibleAxes, size_t numTotalAxes, int32_t motorPos[], bool isCoordinated) const noexcept = 0;
 
+	// Convert Cartesian coordinates to motor positions as CartesianToMotorSteps does, when converting the endpoints of successive moves or segments.
+	// 'state' belongs to the caller and may be used by the kinematics to speed up converting positions close to the previous one.
+	// The default implementation ignores it.
+	virtual bool CartesianToMotorStepsIncremental(const float machinePos[], const float stepsPerMm[], size_t numVisibleAxes, size_t numTotalAxes, int32_t motorPos[], bool isCoordinated, IncrementalConversionState& state) const noexcept
+	{
+		return CartesianToMotorSteps(machinePos, stepsPerMm, numVisibleAxes, numTotalAxes, motorPos, isCoordinated);
+	}
+
 	// Convert motor positions (measured in steps from reference position) to Cartesian coordinates
 	// 'motorPos' is the input vector of motor positions
 	// 'stepsPerMm' is as configured in M92. On a Scara or polar machine this would actually be steps per degree.
@@ -203,6 +221,15 @@ public:
 	// This is called to determine whether we can babystep the specified axis independently of regular motion.
 	virtual AxesBitmap GetLinearAxes() const noexcept = 0;
 
+#if SUPPORT_NATIVE_ARCS
+	// Return true if circular arcs in the plane of the two specified axes can be executed directly instead of being split into straight-line segments.
+	// This requires the position of each motor driven by those axes to be a linear function of the positions of those two axes only.
+	virtual bool SupportsNativeArcs(size_t axis0, size_t axis1) const noexcept { return false; }
+
+	// Return how far the specified motor moves when the specified axis moves 1mm. Only called for arc axes after SupportsNativeArcs has returned true.
+	virtual float GetArcMotorFactor(size_t axis, size_t motor) const noexcept { return 0.0; }
+#endif
+
 	// Override this virtual destructor if your constructor allocates any dynamic memory
 	virtual ~Kinematics() { }
 
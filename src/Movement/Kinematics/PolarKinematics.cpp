@@ -126,16 +126,37 @@ bool PolarKinematics::Configure(unsigned int mCode, GCodeBuffer& gb, const Strin
 // 'motorPos' is the output vector of motor positions
 // Return true if successful, false if we were unable to convert
 bool PolarKinematics::CartesianToMotorSteps(const float machinePos[], const float stepsPerMm[], size_t numVisibleAxes, size_t numTotalAxes, int32_t motorPos[], bool isCoordinated) const noexcept
+{
+	DoCartesianToMotorSteps(machinePos, stepsPerMm, numVisibleAxes, motorPos, nullptr);
+	return true;
+}
+
+// Convert Cartesian coordinates to motor positions, using the caller's state to speed up calculating the turntable angle of successive segments
+bool PolarKinematics::CartesianToMotorStepsIncremental(const float machinePos[], const float stepsPerMm[], size_t numVisibleAxes, size_t numTotalAxes, int32_t motorPos[], bool isCoordinated, IncrementalConversionState& state) const noexcept
+{
+	DoCartesianToMotorSteps(machinePos, stepsPerMm, numVisibleAxes, motorPos, &state.angleCalculators[0]);
+	return true;
+}
+
+// Convert Cartesian coordinates to motor positions. If angleCalculator is not null then use it to calculate the turntable angle.
+void PolarKinematics::DoCartesianToMotorSteps(const float machinePos[], const float stepsPerMm[], size_t numVisibleAxes, int32_t motorPos[], IncrementalAngleCalculator *null angleCalculator) const noexcept
 {
 	motorPos[0] = lrintf(fastSqrtf(fsquare(machinePos[0]) + fsquare(machinePos[1])) * stepsPerMm[0]);
-	motorPos[1] = (motorPos[0] == 0.0) ? 0 : lrintf(atan2f(machinePos[1], machinePos[0]) * RadiansToDegrees * stepsPerMm[1]);
+	if (motorPos[0] == 0)
+	{
+		motorPos[1] = 0;
+	}
+	else
+	{
+		const float angle = (angleCalculator == nullptr) ? atan2f(machinePos[1], machinePos[0]) : angleCalculator->Atan2(machinePos[1], machinePos[0]);
+		motorPos[1] = lrintf(angle * RadiansToDegrees * stepsPerMm[1]);
+	}
 
 	// Transform remaining axes linearly
 	for (size_t axis = Z_AXIS; axis < numVisibleAxes; ++axis)
 	{
 		motorPos[axis] = lrintf(machinePos[axis] * stepsPerMm[axis]);
 	}
-	return true;
 }
 
 // Convert motor positions (measured in steps from reference position) to Cartesian coordinates
@@ -61,7 +61,8 @@ const char *ScaraKinematics::GetName(bool forStatusReport) const noexcept
 // If the position is not reachable because it is out of radius limits, set theta and psi to NaN and return false.
 // Otherwise set theta and psi to the required values and return true if they are in range.
 // Note: theta and psi are now returned in degrees.
-bool ScaraKinematics::CalculateThetaAndPsi(const float machinePos[], bool isCoordinated, float& theta, float& psi, bool& armMode) const noexcept
+// If incState is not null, use it to speed up calculating the angles when the position is close to the one it was last used for.
+bool ScaraKinematics::CalculateThetaAndPsi(const float machinePos[], bool isCoordinated, float& theta, float& psi, bool& armMode, IncrementalConversionState *null incState) const noexcept
 {
 	const float x = machinePos[X_AXIS] + xOffset;
 	const float y = machinePos[Y_AXIS] + yOffset;
@@ -75,8 +76,8 @@ bool ScaraKinematics::CalculateThetaAndPsi(const float machinePos[], bool isCoor
 		return false;		// not reachable
 	}
 
-	psi = acosf(cosPsi) * RadiansToDegrees;
 	const float sinPsi = fastSqrtf(square);
+	psi = ((incState == nullptr) ? acosf(cosPsi) : incState->angleCalculators[1].Atan2(sinPsi, cosPsi)) * RadiansToDegrees;	// Atan2 gives the same as acosf(cosPsi) because sinPsi is positive
 	const float SCARA_K1 = proximalArmLength + distalArmLength * cosPsi;
 	const float SCARA_K2 = distalArmLength * sinPsi;
 
@@ -89,7 +90,8 @@ bool ScaraKinematics::CalculateThetaAndPsi(const float machinePos[], bool isCoor
 			// The following equations choose arm mode 0 i.e. distal arm rotated anticlockwise relative to proximal arm
 			if (supportsContinuousRotation[1] || (psi >= psiLimits[0] && psi <= psiLimits[1]))
 			{
-				theta = atan2f(SCARA_K1 * y - SCARA_K2 * x, SCARA_K1 * x + SCARA_K2 * y) * RadiansToDegrees;
+				const float ty = SCARA_K1 * y - SCARA_K2 * x, tx = SCARA_K1 * x + SCARA_K2 * y;
+				theta = ((incState == nullptr) ? atan2f(ty, tx) : incState->angleCalculators[0].Atan2(ty, tx)) * RadiansToDegrees;
 				if (supportsContinuousRotation[0] || (theta >= thetaLimits[0] && theta <= thetaLimits[1]))
 				{
 					break;
@@ -101,7 +103,8 @@ bool ScaraKinematics::CalculateThetaAndPsi(const float machinePos[], bool isCoor
 			// The following equations choose arm mode 1 i.e. distal arm rotated clockwise relative to proximal arm
 			if (supportsContinuousRotation[1] || ((-psi) >= psiLimits[0] && (-psi) <= psiLimits[1]))
 			{
-				theta = atan2f(SCARA_K1 * y + SCARA_K2 * x, SCARA_K1 * x - SCARA_K2 * y) * RadiansToDegrees;
+				const float ty = SCARA_K1 * y + SCARA_K2 * x, tx = SCARA_K1 * x - SCARA_K2 * y;
+				theta = ((incState == nullptr) ? atan2f(ty, tx) : incState->angleCalculators[0].Atan2(ty, tx)) * RadiansToDegrees;
 				if (supportsContinuousRotation[0] || (theta >= thetaLimits[0] && theta <= thetaLimits[1]))
 				{
 					psi = -psi;
@@ -133,8 +136,20 @@ bool ScaraKinematics::CalculateThetaAndPsi(const float machinePos[], bool isCoor
 }
 
 // Convert Cartesian coordinates to motor coordinates, returning true if successful
-// In the following, theta is the proximal arm angle relative to the X axis, psi is the distal arm angle relative to the proximal arm
 bool ScaraKinematics::CartesianToMotorSteps(const float machinePos[], const float stepsPerMm[], size_t numVisibleAxes, size_t numTotalAxes, int32_t motorPos[], bool isCoordinated) const noexcept
+{
+	return DoCartesianToMotorSteps(machinePos, stepsPerMm, numVisibleAxes, motorPos, isCoordinated, nullptr);
+}
+
+// Convert Cartesian coordinates to motor coordinates, using the caller's state to speed up calculating the arm angles of successive segments
+bool ScaraKinematics::CartesianToMotorStepsIncremental(const float machinePos[], const float stepsPerMm[], size_t numVisibleAxes, size_t numTotalAxes, int32_t motorPos[], bool isCoordinated, IncrementalConversionState& state) const noexcept
+{
+	return DoCartesianToMotorSteps(machinePos, stepsPerMm, numVisibleAxes, motorPos, isCoordinated, &state);
+}
+
+// Convert Cartesian coordinates to motor coordinates, returning true if successful. If incState is not null, use it when calculating the arm angles.
+// In the following, theta is the proximal arm angle relative to the X axis, psi is the distal arm angle relative to the proximal arm
+bool ScaraKinematics::DoCartesianToMotorSteps(const float machinePos[], const float stepsPerMm[], size_t numVisibleAxes, int32_t motorPos[], bool isCoordinated, IncrementalConversionState *null incState) const noexcept
 {
 	float theta, psi;
 	if (machinePos[0] == cachedX && machinePos[1] == cachedY)
@@ -146,7 +161,7 @@ bool ScaraKinematics::CartesianToMotorSteps(const float machinePos[], const floa
 	else
 	{
 		bool armMode = currentArmMode;
-		if (!CalculateThetaAndPsi(machinePos, isCoordinated, theta, psi, armMode))
+		if (!CalculateThetaAndPsi(machinePos, isCoordinated, theta, psi, armMode, incState))
 		{
 			return false;
 		}
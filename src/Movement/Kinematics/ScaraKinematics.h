@@ -31,6 +31,7 @@ public:
 	const char *GetName(bool forStatusReport) const noexcept override;
 	bool Configure(unsigned int mCode, GCodeBuffer& gb, const StringRef& reply, bool& error) THROWS(GCodeException) override;
 	bool CartesianToMotorSteps(const float machinePos[], const float stepsPerMm[], size_t numVisibleAxes, size_t numTotalAxes, int32_t motorPos[], bool isCoordinated) const noexcept override;
+	bool CartesianToMotorStepsIncremental(const float machinePos[], const float stepsPerMm[], size_t numVisibleAxes, size_t numTotalAxes, int32_t motorPos[], bool isCoordinated, IncrementalConversionState& state) const noexcept override;
 	void MotorStepsToCartesian(const int32_t motorPos[], const float stepsPerMm[], size_t numVisibleAxes, size_t numTotalAxes, float machinePos[]) const noexcept override;
 	bool IsReachable(float axesCoords[MaxAxes], AxesBitmap axes) const noexcept override;
 	LimitPositionResult LimitPosition(float finalCoords[], const float * null initialCoords, size_t numAxes, AxesBitmap axesToLimit, bool isCoordinated, bool applyM208Limits) const noexcept override;
@@ -59,7 +60,8 @@ private:
 	static constexpr const char *HomeDistalFileName = "homedistal.g";
 
 	void Recalc() noexcept;
-	bool CalculateThetaAndPsi(const float machinePos[], bool isCoordinated, float& theta, float& psi, bool& armMode) const noexcept;
+	bool CalculateThetaAndPsi(const float machinePos[], bool isCoordinated, float& theta, float& psi, bool& armMode, IncrementalConversionState *null incState = nullptr) const noexcept;
+	bool DoCartesianToMotorSteps(const float machinePos[], const float stepsPerMm[], size_t numVisibleAxes, int32_t motorPos[], bool isCoordinated, IncrementalConversionState *null incState) const noexcept;
 
 	// Primary parameters
 	float proximalArmLength;
@@ -35,12 +35,17 @@
 
 #include "Move.h"
 #include "StepTimer.h"
+#include "MovementArena.h"
 #include <Platform/Platform.h>
 #include <GCodes/GCodeBuffer/GCodeBuffer.h>
 #include <Tools/Tool.h>
 #include <Endstops/ZProbe.h>
 #include <Platform/TaskPriorities.h>
 
+#if HAS_MASS_STORAGE
+# include "StepTrace.h"
+#endif
+
 #if SUPPORT_IOBITS
 # include <Platform/PortControl.h>
 #endif
@@ -100,6 +105,7 @@ constexpr ObjectModelTableEntry Move::objectModelTable[] =
 	{ "calibration",			OBJECT_MODEL_FUNC(self, 3),																		ObjectModelEntryFlags::none },
 	{ "compensation",			OBJECT_MODEL_FUNC(self, 6),																		ObjectModelEntryFlags::none },
 	{ "currentMove",			OBJECT_MODEL_FUNC(self, 2),																		ObjectModelEntryFlags::live },
+	{ "diagnostics",			OBJECT_MODEL_FUNC(self, 9 + SUPPORT_COORDINATE_ROTATION),										ObjectModelEntryFlags::live },
 	{ "extruders",				OBJECT_MODEL_FUNC_NOSELF(&extrudersArrayDescriptor),											ObjectModelEntryFlags::live },
 	{ "idle",					OBJECT_MODEL_FUNC(self, 1),																		ObjectModelEntryFlags::none },
 	{ "kinematics",				OBJECT_MODEL_FUNC(self->kinematics),															ObjectModelEntryFlags::none },
@@ -166,16 +172,26 @@ constexpr ObjectModelTableEntry Move::objectModelTable[] =
 	{ "tanYZ",					OBJECT_MODEL_FUNC(self->tanYZ, 4),																ObjectModelEntryFlags::none },
 
 #if SUPPORT_COORDINATE_ROTATION
-	// 8. move.rotation members
+	// 9. move.rotation members
 	{ "angle",					OBJECT_MODEL_FUNC_NOSELF(reprap.GetGCodes().GetRotationAngle()),								ObjectModelEntryFlags::none },
 	{ "centre",					OBJECT_MODEL_FUNC_NOSELF(&rotationCentreArrayDescriptor),										ObjectModelEntryFlags::none },
 #endif
+
+	// 9 or 10. move.diagnostics members (step ISR statistics of the main ring)
+	{ "isrDurationMax",			OBJECT_MODEL_FUNC(TimingHistogram::ToMicroseconds(self->mainDDARing.GetStepIsrDurations().GetMax(), SystemCoreClock), 1),			ObjectModelEntryFlags::live },
+	{ "isrDurationP50",			OBJECT_MODEL_FUNC(TimingHistogram::ToMicroseconds(self->mainDDARing.GetStepIsrDurations().GetPercentile(50), SystemCoreClock), 1),	ObjectModelEntryFlags::live },
+	{ "isrDurationP99",			OBJECT_MODEL_FUNC(TimingHistogram::ToMicroseconds(self->mainDDARing.GetStepIsrDurations().GetPercentile(99), SystemCoreClock), 1),	ObjectModelEntryFlags::live },
+	{ "isrLatenessMax",			OBJECT_MODEL_FUNC(TimingHistogram::ToMicroseconds(self->mainDDARing.GetStepIsrLateness().GetMax(), StepClockRate), 1),			ObjectModelEntryFlags::live },
+	{ "isrLatenessP99",			OBJECT_MODEL_FUNC(TimingHistogram::ToMicroseconds(self->mainDDARing.GetStepIsrLateness().GetPercentile(99), StepClockRate), 1),	ObjectModelEntryFlags::live },
+	{ "isrStepsMax",			OBJECT_MODEL_FUNC((int32_t)self->mainDDARing.GetStepsPerIsr().GetMax()),										ObjectModelEntryFlags::live },
+	{ "isrStepsP99",			OBJECT_MODEL_FUNC((int32_t)self->mainDDARing.GetStepsPerIsr().GetPercentile(99)),								ObjectModelEntryFlags::live },
+	{ "numIsrs",				OBJECT_MODEL_FUNC((int32_t)self->mainDDARing.GetStepIsrDurations().GetNumSamples()),							ObjectModelEntryFlags::live },
 };
 
 constexpr uint8_t Move::objectModelTableDescriptor[] =
 {
-	9 + SUPPORT_COORDINATE_ROTATION,
-	17 + SUPPORT_WORKPLACE_COORDINATES,
+	10 + SUPPORT_COORDINATE_ROTATION,
+	18 + SUPPORT_WORKPLACE_COORDINATES,
 	2,
 	4 + SUPPORT_LASER,
 	3,
@@ -185,8 +201,9 @@ constexpr uint8_t Move::objectModelTableDescriptor[] =
 	2,
 	4,
 #if SUPPORT_COORDINATE_ROTATION
-	2
+	2,
 #endif
+	8
 };
 
 DEFINE_GET_OBJECT_MODEL_TABLE(Move)
@@ -262,6 +279,11 @@ void Move::Exit() noexcept
 {
 	for (;;)
 	{
+#if HAS_MASS_STORAGE
+		// Close and open step traces here, between calls to DDARing::Spin, because Spin records steps in the trace
+		ChangeStepTrace();
+#endif
+
 		// Recycle the DDAs for completed moves, checking for DDA errors to print if Move debug is enabled
 		mainDDARing.RecycleDDAs();
 #if SUPPORT_ASYNC_MOVES
@@ -450,6 +472,47 @@ bool Move::IsAccessibleProbePoint(float axesCoords[MaxAxes], AxesBitmap axes) co
 	return kinematics->IsReachable(axesCoords, axes);
 }
 
+#if SUPPORT_NATIVE_ARCS
+
+// Return true if we can execute arcs in the plane of the specified machine axes as single moves instead of segmenting them
+bool Move::CanDoNativeArc(size_t axis0, size_t axis1) const noexcept
+{
+	// Axis skew compensation would turn the circle into an ellipse
+	if (tanXY != 0.0 || tanXZ != 0.0 || tanYZ != 0.0)
+	{
+		return false;
+	}
+
+	const Platform& p = reprap.GetPlatform();
+	if (p.IsAxisRotational(axis0) || p.IsAxisRotational(axis1) || !kinematics->SupportsNativeArcs(axis0, axis1))
+	{
+		return false;
+	}
+
+# if SUPPORT_CAN_EXPANSION
+	// Remote drivers only understand linear movement, so all the motors driven by the arc axes must be local
+	const AxesBitmap motors = kinematics->GetConnectedAxes(axis0) | kinematics->GetConnectedAxes(axis1);
+	for (size_t motor = 0; motor < MaxAxes; ++motor)
+	{
+		if (motors.IsBitSet(motor))
+		{
+			const AxisDriversConfig& config = p.GetAxisDriversConfig(motor);
+			for (size_t i = 0; i < config.numDrivers; ++i)
+			{
+				if (config.driverNumbers[i].IsRemote())
+				{
+					return false;
+				}
+			}
+		}
+	}
+# endif
+
+	return true;
+}
+
+#endif
+
 // Pause the print as soon as we can, returning true if we are able to skip any moves and updating 'rp' to the first move we skipped.
 bool Move::PausePrint(RestorePoint& rp) noexcept
 {
@@ -477,8 +540,9 @@ void Move::Diagnostics(MessageType mtype) noexcept
 	scratchString.copy(GetCompensationTypeString());
 
 	Platform& p = reprap.GetPlatform();
-	p.MessageF(mtype, "=== Move ===\nDMs created %u, segments created %u, maxWait %" PRIu32 "ms, bed compensation in use: %s, comp offset %.3f\n",
-						DriveMovement::NumCreated(), MoveSegment::NumCreated(), longestGcodeWaitInterval, scratchString.c_str(), (double)zShift);
+	p.MessageF(mtype, "=== Move ===\nDMs created %u (max used %u), segments created %u (max used %u), arena %u bytes, maxWait %" PRIu32 "ms, bed compensation in use: %s, comp offset %.3f\n",
+						DriveMovement::NumCreated(), DriveMovement::MaxInUse(), MoveSegment::NumCreated(), MoveSegment::MaxInUse(), MovementArena::GetBytesAllocated(),
+						longestGcodeWaitInterval, scratchString.c_str(), (double)zShift);
 	longestGcodeWaitInterval = 0;
 
 #if 0	// debug only
@@ -522,6 +586,14 @@ void Move::Diagnostics(MessageType mtype) noexcept
 #endif
 }
 
+void Move::EnableStepIsrStats(bool enable) noexcept
+{
+	for (DDARing& ring : rings)
+	{
+		ring.EnableStepIsrStats(enable);
+	}
+}
+
 // Set the current position to be this
 void Move::SetNewPosition(const float positionNow[MaxAxesPlusExtruders], bool doBedCompensation) noexcept
 {
@@ -554,10 +626,14 @@ void Move::MotorStepsToCartesian(const int32_t motorPos[], size_t numVisibleAxes
 // Convert Cartesian coordinates to motor steps, axes only, returning true if successful.
 // Used to perform movement and G92 commands.
 // This may be called from an ISR, e.g. via Kinematics::OnHomingSwitchTriggered, DDA::SetPositions and Move::EndPointToMachine
-bool Move::CartesianToMotorSteps(const float machinePos[MaxAxes], int32_t motorPos[MaxAxes], bool isCoordinated) const noexcept
-{
-	const bool b = kinematics->CartesianToMotorSteps(machinePos, reprap.GetPlatform().GetDriveStepsPerUnit(),
-														reprap.GetGCodes().GetVisibleAxes(), reprap.GetGCodes().GetTotalAxes(), motorPos, isCoordinated);
+// If incState is not null then it belongs to the caller and the kinematics may use it to speed up converting successive positions.
+bool Move::CartesianToMotorSteps(const float machinePos[MaxAxes], int32_t motorPos[MaxAxes], bool isCoordinated, IncrementalConversionState *null incState) const noexcept
+{
+	const bool b = (incState == nullptr)
+					? kinematics->CartesianToMotorSteps(machinePos, reprap.GetPlatform().GetDriveStepsPerUnit(),
+														reprap.GetGCodes().GetVisibleAxes(), reprap.GetGCodes().GetTotalAxes(), motorPos, isCoordinated)
+						: kinematics->CartesianToMotorStepsIncremental(machinePos, reprap.GetPlatform().GetDriveStepsPerUnit(),
+																		reprap.GetGCodes().GetVisibleAxes(), reprap.GetGCodes().GetTotalAxes(), motorPos, isCoordinated, *incState);
 	if (reprap.Debug(moduleMove) && !inInterrupt())
 	{
 		if (!b)
@@ -938,8 +1014,91 @@ void Move::Simulate(SimulationMode simMode) noexcept
 	{
 		mainDDARing.ResetSimulationTime();
 	}
+#if HAS_MASS_STORAGE
+	if (simMode != SimulationMode::debug)
+	{
+		StopStepTrace();
+	}
+#endif
+}
+
+#if HAS_MASS_STORAGE
+
+// Start recording the steps generated in SimulationMode::debug to a binary trace file
+GCodeResult Move::StartStepTrace(const char *filename, const StringRef& reply) noexcept
+{
+	FileStore * const f = reprap.GetPlatform().OpenSysFile(filename, OpenMode::write);
+	if (f == nullptr)
+	{
+		reply.printf("Failed to create step trace file %s", filename);
+		return GCodeResult::error;
+	}
+	RequestStepTraceChange(new StepTrace(f));
+	return GCodeResult::ok;
+}
+
+// Stop recording steps. The Move task closes the trace file.
+void Move::StopStepTrace() noexcept
+{
+	RequestStepTraceChange(nullptr);
+}
+
+// Ask the Move task to close the current step trace and change to another one, which may be null.
+// The Move task may be recording steps in the current trace, so it must be the one to close it.
+void Move::RequestStepTraceChange(StepTrace *trace) noexcept
+{
+	StepTrace *unusedTrace;
+	{
+		AtomicCriticalSectionLocker lock;
+		unusedTrace = (stepTraceChangeRequested) ? requestedStepTrace : nullptr;
+		requestedStepTrace = trace;
+		stepTraceChangeRequested = true;
+	}
+
+	// If the Move task hadn't yet acted on an earlier request then it never used the trace from that request, so we can delete it here
+	if (unusedTrace != nullptr)
+	{
+		(void)unusedTrace->Close();
+		delete unusedTrace;
+	}
+	MoveAvailable();
 }
 
+// Act on a request to change the step trace. Called only by the Move task.
+void Move::ChangeStepTrace() noexcept
+{
+	if (!stepTraceChangeRequested)
+	{
+		return;
+	}
+
+	StepTrace *newTrace;
+	{
+		AtomicCriticalSectionLocker lock;
+		newTrace = requestedStepTrace;
+		requestedStepTrace = nullptr;
+		stepTraceChangeRequested = false;
+	}
+
+	mainDDARing.SetStepTrace(newTrace);
+	if (stepTrace != nullptr)
+	{
+		const uint32_t numSteps = stepTrace->GetNumStepsRecorded();
+		if (stepTrace->Close())
+		{
+			reprap.GetPlatform().MessageF(UsbMessage, "Step trace closed, %" PRIu32 " steps recorded\n", numSteps);
+		}
+		else
+		{
+			reprap.GetPlatform().Message(ErrorMessage, "Failed to write step trace file\n");
+		}
+		delete stepTrace;
+	}
+	stepTrace = newTrace;
+}
+
+#endif
+
 // Adjust the leadscrews
 // This is only ever called after bed probing, so we can assume that no such move is already pending.
 void Move::AdjustLeadscrews(const floatc_t corrections[]) noexcept
@@ -108,17 +108,21 @@ public:
 	ExtruderShaper& GetExtruderShaper(size_t extruder) noexcept { return extruderShapers[extruder]; }
 
 	void Diagnostics(MessageType mtype) noexcept;							// Report useful stuff
+	void EnableStepIsrStats(bool enable) noexcept;							// Reset the step ISR statistics of all rings and enable or disable recording them
 
 	// Kinematics and related functions
 	Kinematics& GetKinematics() const noexcept { return *kinematics; }
 	bool SetKinematics(KinematicsType k) noexcept;											// Set kinematics, return true if successful
-	bool CartesianToMotorSteps(const float machinePos[MaxAxes], int32_t motorPos[MaxAxes], bool isCoordinated) const noexcept;
+	bool CartesianToMotorSteps(const float machinePos[MaxAxes], int32_t motorPos[MaxAxes], bool isCoordinated, IncrementalConversionState *null incState = nullptr) const noexcept;
 																							// Convert Cartesian coordinates to delta motor coordinates, return true if successful
 	void MotorStepsToCartesian(const int32_t motorPos[], size_t numVisibleAxes, size_t numTotalAxes, float machinePos[]) const noexcept;
 																							// Convert motor coordinates to machine coordinates
 	void AdjustMotorPositions(const float adjustment[], size_t numMotors) noexcept;			// Perform motor endpoint adjustment
 	const char* GetGeometryString() const noexcept { return kinematics->GetName(true); }
 	bool IsAccessibleProbePoint(float axesCoords[MaxAxes], AxesBitmap axes) const noexcept;
+#if SUPPORT_NATIVE_ARCS
+	bool CanDoNativeArc(size_t axis0, size_t axis1) const noexcept;						// Return true if we can execute arcs in the plane of these axes without segmenting them
+#endif
 
 	// Temporary kinematics functions
 #if SUPPORT_LINEAR_DELTA
@@ -133,6 +137,10 @@ public:
 
 	void Simulate(SimulationMode simMode) noexcept;											// Enter or leave simulation mode
 	float GetSimulationTime() const noexcept { return mainDDARing.GetSimulationTime(); }	// Get the accumulated simulation time
+#if HAS_MASS_STORAGE
+	GCodeResult StartStepTrace(const char *filename, const StringRef& reply) noexcept;		// Start recording the steps generated in SimulationMode::debug
+	void StopStepTrace() noexcept;															// Stop recording steps, the Move task closes the trace file
+#endif
 
 	bool PausePrint(RestorePoint& rp) noexcept;												// Pause the print as soon as we can, returning true if we were able to
 #if HAS_VOLTAGE_MONITOR || HAS_STALL_DETECT
@@ -241,6 +249,11 @@ private:
 
 	const char *GetCompensationTypeString() const noexcept;
 
+#if HAS_MASS_STORAGE
+	void RequestStepTraceChange(StepTrace *trace) noexcept;										// Ask the Move task to close the current step trace and change to another one
+	void ChangeStepTrace() noexcept;															// Called by the Move task to act on a request to change the step trace
+#endif
+
 	// Move task stack size
 	// 250 is not enough when Move and DDA debug are enabled
 	// deckingman's system (MB6HC with CAN expansion) needs at least 365 in 3.3beta3
@@ -261,6 +274,11 @@ private:
 	DDARing& mainDDARing = rings[0];					// The DDA ring used for regular moves
 
 	SimulationMode simulationMode;						// Are we simulating, or really printing?
+#if HAS_MASS_STORAGE
+	StepTrace *stepTrace = nullptr;						// Step trace file we are recording in SimulationMode::debug, if any. Only the Move task uses this.
+	StepTrace *requestedStepTrace = nullptr;			// The step trace that the Move task should change to, protected by a critical section
+	volatile bool stepTraceChangeRequested = false;		// True if the Move task should change to requestedStepTrace, only set or cleared in a critical section
+#endif
 	MoveState moveState;								// whether the idle timer is active
 
 	float maxPrintingAcceleration;
@@ -6,34 +6,45 @@
  */
 
 #include "MoveSegment.h"
+#include "MovementArena.h"
 
 // Static members
 
 MoveSegment *MoveSegment::freeList = nullptr;
 unsigned int MoveSegment::numCreated = 0;
+unsigned int MoveSegment::numInUse = 0;
+unsigned int MoveSegment::maxInUse = 0;
 
+// Create MoveSegments until we have the requested number, allocating them as a single block from the movement arena
 void MoveSegment::InitialAllocate(unsigned int num) noexcept
 {
-	while (num > numCreated)
+	if (num > numCreated)
 	{
-		freeList = new MoveSegment(freeList);
-		++numCreated;
+		const unsigned int numNeeded = num - numCreated;
+		MoveSegment * const block = MovementArena::AllocateBlock<MoveSegment>(numNeeded);
+		for (unsigned int i = numNeeded; i != 0; )
+		{
+			--i;
+			freeList = ::new (block + i) MoveSegment(freeList);		// build the free list backwards so that the segments get used in address order
+		}
+		numCreated = num;
 	}
 }
 
-// Allocate a MoveSegment, from the freelist if possible, else create a new one. Not thread-safe. Clears the flags.
+// Allocate a MoveSegment from the freelist, first adding a few more to the pool from the movement arena if it is empty. Not thread-safe. Clears the flags.
 MoveSegment *MoveSegment::Allocate(MoveSegment *next) noexcept
 {
-	MoveSegment * ms = freeList;
-	if (ms != nullptr)
+	if (freeList == nullptr)
 	{
-		freeList = ms->GetNext();
-		ms->nextAndFlags = reinterpret_cast<uint32_t>(next);
+		InitialAllocate(numCreated + NumToAddWhenExhausted);
 	}
-	else
+	MoveSegment * const ms = freeList;
+	freeList = ms->GetNext();
+	ms->nextAndFlags = reinterpret_cast<uint32_t>(next);
+	++numInUse;
+	if (numInUse > maxInUse)
 	{
-		ms = new MoveSegment(next);
-		++numCreated;
+		maxInUse = numInUse;
 	}
 	return ms;
 }
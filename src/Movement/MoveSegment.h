@@ -193,6 +193,9 @@ public:
 
 	static void InitialAllocate(unsigned int num) noexcept;
 	static unsigned int NumCreated() noexcept { return numCreated; }
+	static unsigned int MaxInUse() noexcept { return maxInUse; }
+
+	static constexpr unsigned int NumToAddWhenExhausted = 8;			// how many segments we add to the pool if the free list runs out
 
 	static constexpr unsigned int SFdistance = 10;
 	static constexpr unsigned int SFstepsPerMm = 16;
@@ -212,6 +215,8 @@ private:
 
 	static MoveSegment *freeList;
 	static unsigned int numCreated;
+	static unsigned int numInUse;
+	static unsigned int maxInUse;							// high water mark of numInUse
 
 	static_assert(sizeof(MoveSegment*) == sizeof(uint32_t));
 
@@ -376,6 +381,7 @@ inline void MoveSegment::Release(MoveSegment *item) noexcept
 {
 	item->nextAndFlags = reinterpret_cast<uint32_t>(freeList);
 	freeList = item;
+	--numInUse;
 }
 
 #endif /* SRC_MOVEMENT_MOVESEGMENT_H_ */
@@ -0,0 +1,20 @@
+/*
+ * MovementArena.cpp
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#include "MovementArena.h"
+#include <Platform/Tasks.h>
+
+size_t MovementArena::bytesAllocated = 0;
+
+// Allocate a block of permanent memory starting on a cache line boundary
+void *MovementArena::Allocate(size_t bytes) noexcept
+{
+	void * const ret = Tasks::AllocPermanent(bytes, (std::align_val_t)CacheLineSize);
+	bytesAllocated += bytes;
+	return ret;
+}
+
+// End
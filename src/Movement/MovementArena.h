@@ -0,0 +1,42 @@
+/*
+ * MovementArena.h
+ *
+ *  Created on: 16 Oct 2026
+ *
+ *  The movement arena provides the memory for the DDAs, DriveMovements and MoveSegments.
+ *  Objects are allocated in blocks that start on a cache line boundary, so that the objects created together (e.g. the whole DDA ring) are contiguous.
+ *  Like the rest of our permanent allocations the memory is never returned to the heap, so the pools can grow (e.g. using M595) but not shrink.
+ */
+
+#ifndef SRC_MOVEMENT_MOVEMENTARENA_H_
+#define SRC_MOVEMENT_MOVEMENTARENA_H_
+
+#include <RepRapFirmware.h>
+
+class MovementArena
+{
+public:
+	static constexpr size_t CacheLineSize = 32;									// the data cache line size of the Cortex-M7, also suitable for processors without a cache
+
+	// Allocate uninitialised memory for an array of objects. The caller must construct them using placement new.
+	template<class T> static T *AllocateBlock(unsigned int num) noexcept
+	{
+		static_assert(alignof(T) <= CacheLineSize);
+		return static_cast<T*>(Allocate(num * sizeof(T)));
+	}
+
+	// Return the amount of memory we would need to allocate a block of objects
+	template<class T> static constexpr size_t MemoryNeeded(unsigned int num) noexcept
+	{
+		return (num == 0) ? 0 : num * sizeof(T) + CacheLineSize;
+	}
+
+	static size_t GetBytesAllocated() noexcept { return bytesAllocated; }
+
+private:
+	static void *Allocate(size_t bytes) noexcept;
+
+	static size_t bytesAllocated;
+};
+
+#endif /* SRC_MOVEMENT_MOVEMENTARENA_H_ */
@@ -21,6 +21,9 @@ void RawMove::SetDefaults(size_t firstDriveToZero) noexcept
 	filePos = noFilePosition;
 	tool = nullptr;
 	cosXyAngle = 1.0;
+#if SUPPORT_NATIVE_ARCS
+	nativeArc.isArc = false;
+#endif
 	for (size_t drive = firstDriveToZero; drive < MaxAxesPlusExtruders; ++drive)
 	{
 		coords[drive] = 0.0;			// clear extrusion
@@ -10,6 +10,21 @@
 
 #include "RepRapFirmware.h"
 
+#if SUPPORT_NATIVE_ARCS
+
+// Details of an arc move that is executed as a single move instead of being split into straight-line segments
+struct NativeArcParameters
+{
+	float centre[2];												// the machine coordinates of the arc centre along the two arc axes
+	float radius;													// the radius of the arc in machine coordinates
+	float totalAngle;												// the angle swept by the arc in radians, positive if anticlockwise
+	uint8_t axis0, axis1;											// the machine axes of the arc plane
+	bool isArc;														// true if this move is a native arc move
+	uint8_t padding;
+};
+
+#endif
+
 // Details of a move that are passed from GCodes to Move
 struct RawMove
 {
@@ -21,6 +36,9 @@ struct RawMove
 	float proportionDone;											// what proportion of the entire move has been done when this segment is complete
 	float cosXyAngle;												// the cosine of the change in XY angle between the previous move and this move
 	const Tool *tool;												// which tool (if any) is being used
+#if SUPPORT_NATIVE_ARCS
+	NativeArcParameters nativeArc;									// the arc parameters if this is a native arc move
+#endif
 #if SUPPORT_LASER || SUPPORT_IOBITS
 	LaserPwmOrIoBits laserPwmOrIoBits;								// the laser PWM or port bit settings required
 #else
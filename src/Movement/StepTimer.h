@@ -42,6 +42,9 @@ public:
 	// Cancel any scheduled callbacks
 	void CancelCallback() noexcept;
 
+	// Get the time at which the callback was most recently scheduled, so that callbacks can measure how late they were called
+	Ticks GetWhenDue() const noexcept { return whenDue; }
+
 	// As CancelCallback but base priority >= NvicPriorityStep when called
 	void CancelCallbackFromIsr() noexcept SPEED_CRITICAL;
 
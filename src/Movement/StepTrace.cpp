@@ -0,0 +1,71 @@
+/*
+ * StepTrace.cpp
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#include "StepTrace.h"
+
+#if HAS_MASS_STORAGE
+
+#include <Storage/FileStore.h>
+
+static inline void PutU32(uint8_t *p, uint32_t val) noexcept
+{
+	p[0] = (uint8_t)val;
+	p[1] = (uint8_t)(val >> 8);
+	p[2] = (uint8_t)(val >> 16);
+	p[3] = (uint8_t)(val >> 24);
+}
+
+StepTrace::StepTrace(FileStore *f) noexcept
+	: file(f), moveStartTime(0), nextMoveStartTime(0), numStepsRecorded(0), bufferIndex(0), writeError(false)
+{
+	memcpy(buffer, "RRFSTEP", 8);												// this copies the terminating null too
+	PutU32(buffer + 8, FormatVersion);
+	PutU32(buffer + 12, StepClockRate);
+	bufferIndex = 16;
+}
+
+// Call this before simulating each move. Moves are simulated back-to-back, so each one starts when the previous one ends.
+void StepTrace::StartMove(uint32_t clocksNeeded) noexcept
+{
+	moveStartTime = nextMoveStartTime;
+	nextMoveStartTime += clocksNeeded;
+}
+
+void StepTrace::RecordStep(uint32_t stepTimeInMove, uint8_t drive, bool direction) noexcept
+{
+	if (bufferIndex + RecordSize > BufferSize)
+	{
+		WriteBuffer();
+	}
+	uint8_t * const p = buffer + bufferIndex;
+	PutU32(p, moveStartTime + stepTimeInMove);
+	p[4] = drive;
+	p[5] = (direction) ? 1 : 0;
+	bufferIndex += RecordSize;
+	++numStepsRecorded;
+}
+
+void StepTrace::WriteBuffer() noexcept
+{
+	if (bufferIndex != 0 && !writeError)
+	{
+		writeError = !file->Write(buffer, bufferIndex);
+	}
+	bufferIndex = 0;
+}
+
+// Flush and close the file, returning true if there were no write errors
+bool StepTrace::Close() noexcept
+{
+	WriteBuffer();
+	const bool ok = file->Close() && !writeError;
+	file = nullptr;
+	return ok;
+}
+
+#endif
+
+// End
@@ -0,0 +1,51 @@
+/*
+ * StepTrace.h
+ *
+ *  Created on: 16 Oct 2026
+ *
+ *  This class records the step stream generated in SimulationMode::debug to a compact binary file, so that the step streams produced
+ *  by two firmware builds can be compared using Tools/steptrace/steptracecmp.py.
+ *
+ *  File format (all values little-endian):
+ *    Header:  8 bytes "RRFSTEP" followed by a null, uint32_t format version (currently 1), uint32_t step clock rate
+ *    Records: uint32_t step time in step clocks since the trace was started, uint8_t logical drive number, uint8_t direction (1 = forwards)
+ */
+
+#ifndef SRC_MOVEMENT_STEPTRACE_H_
+#define SRC_MOVEMENT_STEPTRACE_H_
+
+#include <RepRapFirmware.h>
+
+#if HAS_MASS_STORAGE
+
+class StepTrace
+{
+public:
+	StepTrace(FileStore *f) noexcept;
+
+	void StartMove(uint32_t clocksNeeded) noexcept;								// call this before simulating each move
+	void RecordStep(uint32_t stepTimeInMove, uint8_t drive, bool direction) noexcept;
+	bool Close() noexcept;														// flush and close the file, returning true if there were no write errors
+
+	uint32_t GetNumStepsRecorded() const noexcept { return numStepsRecorded; }
+
+	static constexpr uint32_t FormatVersion = 1;
+
+private:
+	static constexpr size_t RecordSize = 6;
+	static constexpr size_t BufferSize = 85 * RecordSize;						// just under one 512-byte sector
+
+	void WriteBuffer() noexcept;
+
+	FileStore *file;
+	uint32_t moveStartTime;														// when the move currently being simulated started, in step clocks since the trace was started
+	uint32_t nextMoveStartTime;
+	uint32_t numStepsRecorded;
+	size_t bufferIndex;
+	bool writeError;
+	uint8_t buffer[BufferSize];
+};
+
+#endif
+
+#endif /* SRC_MOVEMENT_STEPTRACE_H_ */
@@ -0,0 +1,53 @@
+/*
+ * TimingHistogram.cpp
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#include "TimingHistogram.h"
+
+void TimingHistogram::Clear() noexcept
+{
+	for (uint32_t& b : buckets)
+	{
+		b = 0;
+	}
+	numSamples = maxVal = 0;
+}
+
+// Return an upper bound for the value at the specified percentile, or zero if we have no samples
+uint32_t TimingHistogram::GetPercentile(unsigned int percent) const noexcept
+{
+	if (numSamples == 0)
+	{
+		return 0;
+	}
+
+	const uint32_t threshold = (uint32_t)(((uint64_t)numSamples * percent + 99)/100);
+	uint32_t cumulative = 0;
+	for (size_t i = 0; i < NumBuckets - 1; ++i)
+	{
+		cumulative += buckets[i];
+		if (cumulative >= threshold)
+		{
+			return min<uint32_t>((1u << i) - 1, maxVal);
+		}
+	}
+	return maxVal;
+}
+
+// Append the 50th, 90th and 99th percentiles and the maximum to a string, converted from clocks at the specified rate to microseconds
+void TimingHistogram::AppendPercentiles(const StringRef& str, uint32_t clockRate) const noexcept
+{
+	const auto toMicros = [clockRate](uint32_t clocks) noexcept -> uint32_t { return (uint32_t)(((uint64_t)clocks * 1000000u)/clockRate); };
+	str.catf("%" PRIu32 "/%" PRIu32 "/%" PRIu32 "/%" PRIu32 "us",
+				toMicros(GetPercentile(50)), toMicros(GetPercentile(90)), toMicros(GetPercentile(99)), toMicros(maxVal));
+}
+
+// Append the 50th, 90th and 99th percentiles and the maximum to a string as raw values
+void TimingHistogram::AppendPercentiles(const StringRef& str) const noexcept
+{
+	str.catf("%" PRIu32 "/%" PRIu32 "/%" PRIu32 "/%" PRIu32, GetPercentile(50), GetPercentile(90), GetPercentile(99), maxVal);
+}
+
+// End
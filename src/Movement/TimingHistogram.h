@@ -0,0 +1,53 @@
+/*
+ * TimingHistogram.h
+ *
+ *  Created on: 16 Oct 2026
+ *
+ *  This class accumulates a histogram of timing values (normally in step clocks) using logarithmically-spaced buckets,
+ *  so that we can report approximate percentiles without having to store the individual samples.
+ */
+
+#ifndef SRC_MOVEMENT_TIMINGHISTOGRAM_H_
+#define SRC_MOVEMENT_TIMINGHISTOGRAM_H_
+
+#include <RepRapFirmware.h>
+
+class TimingHistogram
+{
+public:
+	// Bucket 0 holds zero values. Bucket N (N > 0) holds values in the range 2^(N-1) to (2^N - 1). The last bucket also holds all larger values.
+	static constexpr size_t NumBuckets = 20;
+
+	TimingHistogram() noexcept { Clear(); }
+
+	void Clear() noexcept;
+	void Add(uint32_t val) noexcept;
+
+	uint32_t GetNumSamples() const noexcept { return numSamples; }
+	uint32_t GetMax() const noexcept { return maxVal; }
+	uint32_t GetPercentile(unsigned int percent) const noexcept;				// return an upper bound for the value at the specified percentile
+
+	void AppendPercentiles(const StringRef& str, uint32_t clockRate) const noexcept;	// append p50/p90/p99/max converted to microseconds
+	void AppendPercentiles(const StringRef& str) const noexcept;						// append p50/p90/p99/max as raw values
+
+	static float ToMicroseconds(uint32_t clocks, uint32_t clockRate) noexcept { return (float)clocks * (1000000.0f/(float)clockRate); }
+
+private:
+	uint32_t buckets[NumBuckets];
+	uint32_t numSamples;
+	uint32_t maxVal;
+};
+
+// Add a sample. This is cheap enough to be called from the Move task for every move, and from the step ISR.
+inline void TimingHistogram::Add(uint32_t val) noexcept
+{
+	const size_t bucket = (val == 0) ? 0 : min<size_t>(32 - __builtin_clz(val), NumBuckets - 1);
+	++buckets[bucket];
+	++numSamples;
+	if (val > maxVal)
+	{
+		maxVal = val;
+	}
+}
+
+#endif /* SRC_MOVEMENT_TIMINGHISTOGRAM_H_ */
@@ -1028,7 +1028,13 @@ void HttpResponder::SendJsonResponse(const char *_ecv_array command) noexcept
 		return;
 	}
 
-	// Send the JSON response
+	// Send the JSON response. Object model responses are in CBOR if the client asked for binary.
+#if SUPPORT_BINARY_OBJECT_MODEL
+	const char *_ecv_array _ecv_null const flagsVal = (StringEqualsIgnoreCase(command, "model")) ? GetKeyValue("flags") : nullptr;
+	const bool isBinary = (flagsVal != nullptr && strchr(flagsVal, 'b') != nullptr);
+#else
+	constexpr bool isBinary = false;
+#endif
 	bool keepOpen = false;
 	if (mayKeepOpen)
 	{
@@ -1053,8 +1059,8 @@ void HttpResponder::SendJsonResponse(const char *_ecv_array command) noexcept
 					"Cache-Control: no-cache, no-store, must-revalidate\r\n"
 					"Pragma: no-cache\r\n"
 					"Expires: 0\r\n"
-					"Content-Type: application/json\r\n"
 				);
+	outBuf->catf("Content-Type: %s\r\n", (isBinary) ? "application/cbor" : "application/json");
 	const unsigned int replyLength = (jsonResponse != nullptr) ? jsonResponse->Length() : 0;
 	outBuf->catf("Content-Length: %u\r\n", replyLength);
 	AddCorsHeader();
@@ -0,0 +1,49 @@
+/*
+ * JsonToCbor.cpp
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#include "JsonToCbor.h"
+
+#if SUPPORT_BINARY_OBJECT_MODEL
+
+#include "JsonToCborConverter.h"
+#include <Platform/OutputMemory.h>
+
+OutputBuffer *_ecv_null JsonToCbor::Convert(OutputBuffer *json) noexcept
+{
+	OutputBuffer *cbor;
+	if (!OutputBuffer::Allocate(cbor))
+	{
+		OutputBuffer::ReleaseAll(json);
+		return nullptr;
+	}
+
+	// Release the JSON buffers as we finish with them, so that they can be reused for the CBOR
+	JsonToCborConverter<OutputBuffer, OutputBuffer> converter(json, *cbor);
+	bool ok = true;
+	while (!converter.IsFinished())
+	{
+		while (json != nullptr && json != converter.GetCurrentBuffer())
+		{
+			json = OutputBuffer::Release(json);
+		}
+		if (cbor->HadOverflow() || !converter.ConvertNext())
+		{
+			ok = false;
+			break;
+		}
+	}
+	OutputBuffer::ReleaseAll(json);
+
+	if (!ok || cbor->HadOverflow())
+	{
+		OutputBuffer::ReleaseAll(cbor);
+	}
+	return cbor;
+}
+
+#endif
+
+// End
@@ -0,0 +1,34 @@
+/*
+ * JsonToCbor.h
+ *
+ *  Created on: 16 Oct 2026
+ *
+ *  Conversion of object model responses from JSON to CBOR (RFC 8949), used when a client of rr_model or the SBC interface includes 'b' in the report flags.
+ *  This only reduces the size of the response on the wire. The object model is still reported as JSON first and then converted, so it takes the firmware
+ *  slightly longer to produce the response than the JSON alone. The conversion itself is in JsonToCborConverter.h.
+ *  The structure of the response is unchanged, so a client decodes it to the same tree of values as the JSON would give:
+ *   JSON objects and arrays become indefinite-length CBOR maps and arrays
+ *   strings (including keys) become definite-length text strings, with escape sequences removed
+ *   integers become CBOR unsigned or negative integers
+ *   numbers with a decimal point become half-precision floats if that is exact, otherwise single-precision floats
+ *   true, false and null become the corresponding CBOR simple values
+ *  Commas, colons, quotes and most of the length of numbers are saved, which typically makes the response about 25% smaller.
+ */
+
+#ifndef SRC_OBJECTMODEL_JSONTOCBOR_H_
+#define SRC_OBJECTMODEL_JSONTOCBOR_H_
+
+#include <RepRapFirmware.h>
+
+#if SUPPORT_BINARY_OBJECT_MODEL
+
+namespace JsonToCbor
+{
+	// Convert a chain of output buffers holding JSON to CBOR. The JSON buffers are released as they are converted, so the conversion needs few extra buffers.
+	// Return the CBOR, or nullptr if we ran out of buffers or the JSON was malformed.
+	OutputBuffer *_ecv_null Convert(OutputBuffer *json) noexcept;
+}
+
+#endif
+
+#endif /* SRC_OBJECTMODEL_JSONTOCBOR_H_ */
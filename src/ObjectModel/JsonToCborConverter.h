@@ -0,0 +1,407 @@
+/*
+ * JsonToCborConverter.h
+ *
+ *  Created on: 16 Oct 2026
+ *
+ *  The conversion of JSON text to CBOR used by JsonToCbor. See JsonToCbor.h for how the values are encoded.
+ *  This file only depends on the standard library so that it can be tested on the host (see folder Tests). It reads the JSON from a chain of
+ *  buffers of type Buffer, which must provide Data(), DataLength() and Next(), and appends the CBOR to an object of type Output, which must
+ *  provide cat(char) and cat(const char *, size_t). In the firmware both are OutputBuffer.
+ */
+
+#ifndef SRC_OBJECTMODEL_JSONTOCBORCONVERTER_H_
+#define SRC_OBJECTMODEL_JSONTOCBORCONVERTER_H_
+
+#include <ecv_duet3d.h>
+#include <General/SafeStrtod.h>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace Cbor
+{
+	// CBOR major types and initial bytes
+	constexpr uint8_t UnsignedInteger = 0;
+	constexpr uint8_t NegativeInteger = 1;
+	constexpr uint8_t TextString = 3;
+
+	constexpr uint8_t IndefiniteArray = 0x9F;
+	constexpr uint8_t IndefiniteMap = 0xBF;
+	constexpr uint8_t False = 0xF4;
+	constexpr uint8_t True = 0xF5;
+	constexpr uint8_t Null = 0xF6;
+	constexpr uint8_t HalfFloat = 0xF9;
+	constexpr uint8_t SingleFloat = 0xFA;
+	constexpr uint8_t Break = 0xFF;
+}
+
+template<class Buffer, class Output> class JsonToCborConverter
+{
+public:
+	JsonToCborConverter(const Buffer *_ecv_null json, Output& p_out) noexcept : out(p_out), finished(false) { reader.buf = json; reader.pos = 0; }
+
+	bool ConvertNext() noexcept;													// convert the next token of the JSON, returning false if it was malformed
+	bool IsFinished() const noexcept { return finished; }							// return true if we have converted all the JSON
+	const Buffer *_ecv_null GetCurrentBuffer() const noexcept { return reader.buf; }	// get the buffer we are reading, the ones before it are no longer needed
+
+private:
+	static constexpr size_t MaxNumberLength = 31;
+
+	// Read position within a chain of buffers
+	struct ChainReader
+	{
+		const Buffer *_ecv_null buf;
+		size_t pos;
+
+		// Get the next character, or -1 at the end of the chain
+		int Get() noexcept
+		{
+			while (buf != nullptr && pos >= buf->DataLength())
+			{
+				buf = buf->Next();
+				pos = 0;
+			}
+			return (buf == nullptr) ? -1 : (int)(uint8_t)buf->Data()[pos++];
+		}
+
+		int Peek() const noexcept
+		{
+			ChainReader temp = *this;
+			return temp.Get();
+		}
+	};
+
+	void AppendByte(uint8_t b) noexcept { out.cat((char)b); }
+	void AppendHead(uint8_t majorType, uint64_t val) noexcept;
+	void AppendFloat(float f) noexcept;
+	bool ConvertString() noexcept;
+	bool ConvertNumber(char firstChar) noexcept;
+	bool ConvertLiteral(const char *_ecv_array rest, uint8_t code) noexcept;
+
+	static int ReadStringChar(ChainReader& rdr, char chars[3]) noexcept;
+
+	ChainReader reader;
+	Output& out;
+	bool finished;
+};
+
+// Append the initial bytes of a data item with the specified major type and argument
+template<class Buffer, class Output> void JsonToCborConverter<Buffer, Output>::AppendHead(uint8_t majorType, uint64_t val) noexcept
+{
+	const uint8_t mt = majorType << 5;
+	if (val < 24)
+	{
+		AppendByte(mt | (uint8_t)val);
+		return;
+	}
+
+	unsigned int numBytes;
+	if (val <= 0xFF)
+	{
+		AppendByte(mt | 24);
+		numBytes = 1;
+	}
+	else if (val <= 0xFFFF)
+	{
+		AppendByte(mt | 25);
+		numBytes = 2;
+	}
+	else if (val <= 0xFFFFFFFF)
+	{
+		AppendByte(mt | 26);
+		numBytes = 4;
+	}
+	else
+	{
+		AppendByte(mt | 27);
+		numBytes = 8;
+	}
+
+	while (numBytes != 0)
+	{
+		--numBytes;
+		AppendByte((uint8_t)(val >> (8 * numBytes)));
+	}
+}
+
+// Append a float, using half precision if that represents it exactly. Values such as 0.5 and 25.0 are common in the object model.
+template<class Buffer, class Output> void JsonToCborConverter<Buffer, Output>::AppendFloat(float f) noexcept
+{
+	uint32_t bits;
+	memcpy(&bits, &f, sizeof(bits));
+	const uint32_t sign = (bits >> 16) & 0x8000;
+	const int32_t exponent = (int32_t)((bits >> 23) & 0xFF) - 127;
+	const uint32_t mantissa = bits & 0x007FFFFF;
+
+	if ((bits & 0x7FFFFFFF) == 0 || (exponent >= -14 && exponent <= 15 && (mantissa & 0x1FFF) == 0))
+	{
+		const uint32_t half = ((bits & 0x7FFFFFFF) == 0) ? sign : sign | ((uint32_t)(exponent + 15) << 10) | (mantissa >> 13);
+		AppendByte(Cbor::HalfFloat);
+		AppendByte((uint8_t)(half >> 8));
+		AppendByte((uint8_t)half);
+	}
+	else
+	{
+		AppendByte(Cbor::SingleFloat);
+		AppendByte((uint8_t)(bits >> 24));
+		AppendByte((uint8_t)(bits >> 16));
+		AppendByte((uint8_t)(bits >> 8));
+		AppendByte((uint8_t)bits);
+	}
+}
+
+// Read one character of a JSON string and undo any escape sequence.
+// Return the number of bytes of UTF8 stored in 'chars', or 0 if we reached the closing quote, or -1 if the string is malformed.
+template<class Buffer, class Output> int JsonToCborConverter<Buffer, Output>::ReadStringChar(ChainReader& rdr, char chars[3]) noexcept
+{
+	int c = rdr.Get();
+	if (c == '"')
+	{
+		return 0;
+	}
+	if (c < 0)
+	{
+		return -1;
+	}
+	if (c != '\\')
+	{
+		chars[0] = (char)c;
+		return 1;
+	}
+
+	c = rdr.Get();
+	switch (c)
+	{
+	case 'n':	chars[0] = '\n'; return 1;
+	case 'r':	chars[0] = '\r'; return 1;
+	case 't':	chars[0] = '\t'; return 1;
+	case 'b':	chars[0] = '\b'; return 1;
+	case 'f':	chars[0] = '\f'; return 1;
+	case '"':
+	case '\\':
+	case '/':
+		chars[0] = (char)c;
+		return 1;
+
+	case 'u':
+		{
+			uint32_t codePoint = 0;
+			for (unsigned int i = 0; i < 4; ++i)
+			{
+				c = rdr.Get();
+				if (c < 0 || !isxdigit(c))
+				{
+					return -1;
+				}
+				codePoint = (codePoint << 4) | (uint32_t)(isdigit(c) ? c - '0' : (tolower(c) - 'a') + 10);
+			}
+			if (codePoint < 0x80)
+			{
+				chars[0] = (char)codePoint;
+				return 1;
+			}
+			if (codePoint < 0x800)
+			{
+				chars[0] = (char)(0xC0 | (codePoint >> 6));
+				chars[1] = (char)(0x80 | (codePoint & 0x3F));
+				return 2;
+			}
+			chars[0] = (char)(0xE0 | (codePoint >> 12));
+			chars[1] = (char)(0x80 | ((codePoint >> 6) & 0x3F));
+			chars[2] = (char)(0x80 | (codePoint & 0x3F));
+			return 3;
+		}
+
+	default:
+		return -1;
+	}
+}
+
+// Convert a string whose opening quote we have already read
+template<class Buffer, class Output> bool JsonToCborConverter<Buffer, Output>::ConvertString() noexcept
+{
+	// Most strings have no escape sequences and end in the same buffer that they start in, so handle those quickly
+	if (reader.buf != nullptr && reader.pos < reader.buf->DataLength())
+	{
+		const char *_ecv_array const start = reader.buf->Data() + reader.pos;
+		const size_t maxLength = reader.buf->DataLength() - reader.pos;
+		for (size_t length = 0; length < maxLength; ++length)
+		{
+			const char c = start[length];
+			if (c == '"')
+			{
+				AppendHead(Cbor::TextString, length);
+				out.cat(start, length);
+				reader.pos += length + 1;
+				return true;
+			}
+			if (c == '\\')
+			{
+				break;
+			}
+		}
+	}
+
+	// CBOR needs the length before the text, so find it before converting the string
+	char chars[3];
+	int n;
+	size_t length = 0;
+	ChainReader lookahead = reader;
+	while ((n = ReadStringChar(lookahead, chars)) > 0)
+	{
+		length += (size_t)n;
+	}
+	if (n < 0)
+	{
+		return false;
+	}
+
+	AppendHead(Cbor::TextString, length);
+	while ((n = ReadStringChar(reader, chars)) > 0)
+	{
+		out.cat(chars, (size_t)n);
+	}
+	return true;
+}
+
+// Convert a number whose first character we have already read. Numbers without a decimal point or exponent are integers.
+template<class Buffer, class Output> bool JsonToCborConverter<Buffer, Output>::ConvertNumber(char firstChar) noexcept
+{
+	char text[MaxNumberLength + 1];
+	size_t length = 0;
+	text[length++] = firstChar;
+	bool isFloat = false;
+	while (true)
+	{
+		const int c = reader.Peek();
+		if (c == '.' || c == 'e' || c == 'E')
+		{
+			isFloat = true;
+		}
+		else if (c < 0 || (!isdigit(c) && c != '-' && c != '+'))
+		{
+			break;
+		}
+		if (length == MaxNumberLength)
+		{
+			return false;
+		}
+		text[length++] = (char)reader.Get();
+	}
+	text[length] = 0;
+
+	if (!isFloat)
+	{
+		const bool negative = (text[0] == '-');
+		const char *_ecv_array p = (negative) ? text + 1 : text;
+		if (*p == 0)
+		{
+			return false;
+		}
+
+		uint64_t val = 0;
+		while (*p != 0)
+		{
+			const unsigned int digit = (unsigned int)(*p - '0');
+			if (digit > 9 || val > (std::numeric_limits<uint64_t>::max() - digit)/10)
+			{
+				break;													// not a valid integer or too large, so let the float conversion handle it
+			}
+			val = (10 * val) + digit;
+			++p;
+		}
+
+		if (*p == 0)
+		{
+			if (!negative)
+			{
+				AppendHead(Cbor::UnsignedInteger, val);
+			}
+			else if (val == 0)
+			{
+				AppendHead(Cbor::UnsignedInteger, 0);					// -0
+			}
+			else
+			{
+				AppendHead(Cbor::NegativeInteger, val - 1);
+			}
+			return true;
+		}
+	}
+
+	const char *_ecv_array endPtr;
+	const float f = SafeStrtof(text, &endPtr);
+	if (*endPtr != 0)
+	{
+		return false;
+	}
+	AppendFloat(f);
+	return true;
+}
+
+// Convert true, false or null
+template<class Buffer, class Output> bool JsonToCborConverter<Buffer, Output>::ConvertLiteral(const char *_ecv_array rest, uint8_t code) noexcept
+{
+	while (*rest != 0)
+	{
+		if (reader.Get() != *rest++)
+		{
+			return false;
+		}
+	}
+	AppendByte(code);
+	return true;
+}
+
+// Convert the next token of the JSON, returning false if it was malformed. Objects and arrays are converted to indefinite-length maps and arrays,
+// so we don't need to know how many elements they have before we start or keep a stack of them.
+template<class Buffer, class Output> bool JsonToCborConverter<Buffer, Output>::ConvertNext() noexcept
+{
+	const int c = reader.Get();
+	switch (c)
+	{
+	case -1:
+		finished = true;
+		return true;
+
+	case '{':
+		AppendByte(Cbor::IndefiniteMap);
+		return true;
+
+	case '[':
+		AppendByte(Cbor::IndefiniteArray);
+		return true;
+
+	case '}':
+	case ']':
+		AppendByte(Cbor::Break);
+		return true;
+
+	case ',':
+	case ':':
+	case ' ':
+	case '\t':
+	case '\r':
+	case '\n':
+		return true;
+
+	case '"':
+		return ConvertString();
+
+	case 't':
+		return ConvertLiteral("rue", Cbor::True);
+
+	case 'f':
+		return ConvertLiteral("alse", Cbor::False);
+
+	case 'n':
+		return ConvertLiteral("ull", Cbor::Null);
+
+	default:
+		return (c == '-' || isdigit(c)) && ConvertNumber((char)c);
+	}
+}
+
+#endif /* SRC_OBJECTMODEL_JSONTOCBORCONVERTER_H_ */
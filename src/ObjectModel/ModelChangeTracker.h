@@ -0,0 +1,51 @@
+/*
+ * ModelChangeTracker.h
+ *
+ *  Created on: 16 Oct 2026
+ *
+ *  Change sequence numbers for the top-level sections of the object model, used for reports that include only what has changed since a client's previous report.
+ *  This file only depends on the standard library so that it can be tested on the host (see folder Tests).
+ */
+
+#ifndef SRC_OBJECTMODEL_MODELCHANGETRACKER_H_
+#define SRC_OBJECTMODEL_MODELCHANGETRACKER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Every change to a section takes the next value of a global change counter and records it against the section.
+// A report gives the client the value of the counter before the report was generated, and the client passes it back as the token in its next request.
+// Sections whose sequence number is greater than the token have changed since that report, so they must be reported in full.
+template<size_t NumSections> class ModelChangeTracker
+{
+public:
+	static constexpr uint32_t InitialSeq = 1;			// the sequence number of sections that haven't changed since startup, so that clients asking for changes since 0 get everything
+
+	ModelChangeTracker() noexcept : currentSeq(InitialSeq)
+	{
+		for (uint32_t& seq : sectionSeqs)
+		{
+			seq = InitialSeq;
+		}
+	}
+
+	void SectionChanged(size_t section) noexcept { sectionSeqs[section] = ++currentSeq; }
+	uint32_t GetSectionSeq(size_t section) const noexcept { return sectionSeqs[section]; }
+	uint32_t GetToken() const noexcept { return currentSeq; }		// get the token for a report, before generating the report
+
+	// Return true if the client may not have seen the latest change to a section with the specified sequence number.
+	// The counter starts again after a restart, so tokens from before the restart may be ahead of it. We treat tokens that we haven't issued since
+	// startup as 0, so that the client gets the whole model.
+	bool ChangedSinceToken(uint32_t sectionSeq, uint32_t token) const noexcept
+	{
+		const bool tokenValid = token - InitialSeq <= currentSeq - InitialSeq;
+		return !tokenValid || (int32_t)(sectionSeq - token) > 0;
+	}
+
+private:
+	std::atomic<uint32_t> currentSeq;
+	uint32_t sectionSeqs[NumSections];
+};
+
+#endif /* SRC_OBJECTMODEL_MODELCHANGETRACKER_H_ */
@@ -12,6 +12,7 @@
 #include <Platform/RepRap.h>
 #include <Platform/Platform.h>
 #include <Platform/OutputMemory.h>
+#include "ObjectModelCache.h"
 #include <cstring>
 #include <General/SafeStrtod.h>
 #include <General/IP4String.h>
@@ -46,7 +47,11 @@ void ExpressionValue::AppendAsString(const StringRef& str) const noexcept
 		break;
 
 	case TypeCode::Float:
-		str.catf(GetFloatFormatString(), (double)fVal);
+		{
+			char temp[FormattedFloatBufferSize];
+			FormatFixedFloat(temp, fVal, GetFloatDigitsAfterPoint());
+			str.cat(temp);
+		}
 		break;
 
 	case TypeCode::Uint32:
@@ -296,10 +301,16 @@ ObjectModel::ObjectModel() noexcept
 // Constructor used when reporting the OM as JSON
 ObjectExplorationContext::ObjectExplorationContext(const GCodeBuffer *_ecv_null gbp, bool wal, const char *reportFlags, unsigned int initialMaxDepth, size_t initialBufferOffset) noexcept
 	: startMillis(millis()), initialBufOffset(initialBufferOffset), maxDepth(initialMaxDepth), currentDepth(0), startElement(0), nextElement(-1), numIndicesProvided(0), numIndicesCounted(0),
-	  line(-1), column(-1), gb(gbp),
+	  line(-1), column(-1), gb(gbp), changedSince(0),
+#if SUPPORT_OBJECT_MODEL_CACHE
+	  sectionChangeSeq(0),
+#endif
 	  shortForm(false), wantArrayLength(wal), wantExists(false),
 	  includeNonLive(true), includeImportant(false), includeNulls(false),
-	  excludeVerbose(true), excludeObsolete(true),
+	  excludeVerbose(true), excludeObsolete(true), changesOnly(false),
+#if SUPPORT_OBJECT_MODEL_CACHE
+	  recordingJson(false),
+#endif
 	  obsoleteFieldQueried(false)
 {
 	while (true)
@@ -334,6 +345,20 @@ ObjectExplorationContext::ObjectExplorationContext(const GCodeBuffer *_ecv_null
 				++reportFlags;
 			}
 			break;
+		case 'u':
+			// Report only the changes since the change sequence token that follows. Sections that have changed are reported in full, others are reported as if 'f' was given.
+			changesOnly = true;
+			includeNonLive = false;
+			changedSince = 0;
+			while (isdigit(*reportFlags))
+			{
+				changedSince = (10 * changedSince) + (*reportFlags - '0');
+				++reportFlags;
+			}
+			break;
+		case 'b':
+			// Binary encoding of the response is done by RepRap::GetModelResponse
+			break;
 		case 'a':
 			startElement = 0;
 			while (isdigit(*reportFlags))
@@ -355,14 +380,39 @@ ObjectExplorationContext::ObjectExplorationContext(const GCodeBuffer *_ecv_null
 // Constructor when evaluating expressions
 ObjectExplorationContext::ObjectExplorationContext(const GCodeBuffer *_ecv_null gbp, bool wal, bool wex, int p_line, int p_col) noexcept
 	: startMillis(millis()), initialBufOffset(0), maxDepth(99), currentDepth(0), startElement(0), nextElement(-1), numIndicesProvided(0), numIndicesCounted(0),
-	  line(p_line), column(p_col), gb(gbp),
+	  line(p_line), column(p_col), gb(gbp), changedSince(0),
+#if SUPPORT_OBJECT_MODEL_CACHE
+	  sectionChangeSeq(0),
+#endif
 	  shortForm(false), wantArrayLength(wal), wantExists(wex),
 	  includeNonLive(true), includeImportant(false), includeNulls(false),
-	  excludeVerbose(false), excludeObsolete(false),
+	  excludeVerbose(false), excludeObsolete(false), changesOnly(false),
+#if SUPPORT_OBJECT_MODEL_CACHE
+	  recordingJson(false),
+#endif
 	  obsoleteFieldQueried(false)
 {
 }
 
+#if SUPPORT_OBJECT_MODEL_CACHE
+
+// Make the key that identifies the JSON of an entry in the object model cache
+void ObjectExplorationContext::MakeCacheKey(ObjectModelCacheKey& key, const ObjectModel *self, const ObjectModelTableEntry *entry) const noexcept
+{
+	static_assert(ObjectModelCacheKey::MaxIndices >= MaxIndices, "ObjectModelCacheKey can't hold all the indices");
+	key.self = self;
+	key.entry = entry;
+	key.numIndices = numIndicesCounted;
+	for (size_t i = 0; i < numIndicesCounted; ++i)
+	{
+		key.indices[i] = indices[i];
+	}
+	key.reportOptions = (shortForm) | (includeNonLive << 1) | (includeImportant << 2) | (includeNulls << 3) | (excludeVerbose << 4) | (excludeObsolete << 5)
+						| (min<unsigned int>(maxDepth - currentDepth, 255) << 8);
+}
+
+#endif
+
 int32_t ObjectExplorationContext::GetIndex(size_t n) const THROWS(GCodeException)
 {
 	if (n < numIndicesCounted)
@@ -447,6 +497,20 @@ void ObjectModel::ReportAsJson(OutputBuffer* buf, ObjectExplorationContext& cont
 				size_t numEntries = descriptor[tableNumber + 1];
 				while (numEntries != 0)
 				{
+					// When reporting changes only, report all of any entry that has changed since the client's token and only the live parts of the others
+					uint32_t changeSeq;
+					const bool haveChangeSeq = GetEntryChangeSequence(tbl, changeSeq);
+					const bool reportInFull = haveChangeSeq && context.ReportingChangesOnly() && ChangedSinceToken(changeSeq, context.GetChangeToken());
+					if (reportInFull)
+					{
+						context.SetIncludeNonLive(true);
+					}
+#if SUPPORT_OBJECT_MODEL_CACHE
+					if (haveChangeSeq)
+					{
+						context.SetSectionChangeSeq(changeSeq);			// read the sequence number before we generate any JSON to be cached
+					}
+#endif
 					if (tbl->Matches(filter, context))
 					{
 						if (tbl->ReportAsJson(buf, context, classDescriptor, this, filter, !added))
@@ -454,6 +518,16 @@ void ObjectModel::ReportAsJson(OutputBuffer* buf, ObjectExplorationContext& cont
 							added = true;
 						}
 					}
+					if (reportInFull)
+					{
+						context.SetIncludeNonLive(false);
+					}
+#if SUPPORT_OBJECT_MODEL_CACHE
+					if (haveChangeSeq)
+					{
+						context.SetSectionChangeSeq(0);
+					}
+#endif
 					--numEntries;
 					++tbl;
 				}
@@ -848,35 +922,26 @@ const ObjectModelTableEntry* ObjectModel::FindObjectModelTableEntry(const Object
 	}
 
 	const ObjectModelTableEntry *tbl = classDescriptor->omt;
+#if USE_OBJECT_MODEL_HASH_INDEX
+	const uint8_t *_ecv_array hashIndex = classDescriptor->omh;
+#endif
 	for (size_t i = 0; i < tableNumber; ++i)
 	{
 		tbl += descriptor[i + 1];
+#if USE_OBJECT_MODEL_HASH_INDEX
+		hashIndex += ObjectModelTableSearch::HashIndexSectionSize(descriptor[i + 1]);
+#endif
 	}
 
 	const size_t numEntries = descriptor[tableNumber + 1];
-	size_t low = 0, high = numEntries;
-	while (high > low)
+#if USE_OBJECT_MODEL_HASH_INDEX
+	// An empty or wildcard ID matches whichever entry the binary search looks at first, so only use the hash index for other IDs
+	if (idString[0] != 0 && idString[0] != '*')
 	{
-		const size_t mid = (high - low)/2 + low;
-		const int t = tbl[mid].IdCompare(idString);
-		if (t == 0)
-		{
-			return &tbl[mid];
-		}
-		if (t > 0)
-		{
-			low = mid + 1u;
-		}
-		else
-		{
-			high = mid;
-		}
+		return ObjectModelTableSearch::FindUsingHashIndex(tbl, numEntries, hashIndex, idString);
 	}
-	if (low < numEntries && tbl[low].IdCompare(idString) == 0)
-	{
-		return &tbl[low];
-	}
-	return nullptr;
+#endif
+	return ObjectModelTableSearch::FindUsingBinarySearch(tbl, numEntries, idString);
 }
 
 /*static*/ const char* ObjectModel::GetNextElement(const char *id) noexcept
@@ -908,29 +973,67 @@ bool ObjectModelTableEntry::ReportAsJson(OutputBuffer* buf, ObjectExplorationCon
 			buf->cat(name);
 			buf->cat("\":");
 		}
-		self->ReportItemAsJson(buf, context, classDescriptor, val, nextElement);
+#if SUPPORT_OBJECT_MODEL_CACHE
+		// Entries that are not live only change when the sequence number of their section changes, so if we are reporting all of one we may be able to use the cache
+		if (   *nextElement == 0
+			&& ((uint8_t)flags & (uint8_t)ObjectModelEntryFlags::live) == 0
+			&& (val.GetType() == TypeCode::ObjectModel_tc || val.GetType() == TypeCode::Array)
+			&& context.CanUseCache()
+		   )
+		{
+			ReportItemAsJsonUsingCache(buf, context, classDescriptor, self, val);
+		}
+		else
+#endif
+		{
+			self->ReportItemAsJson(buf, context, classDescriptor, val, nextElement);
+		}
 		return true;
 	}
 	return false;
 }
 
-// Compare an ID with the name of this object
-int ObjectModelTableEntry::IdCompare(const char *id) const noexcept
+#if SUPPORT_OBJECT_MODEL_CACHE
+
+// Report the value of this element as JSON, using the cached JSON if we have it. If we don't then cache the JSON we generate.
+void ObjectModelTableEntry::ReportItemAsJsonUsingCache(OutputBuffer* buf, ObjectExplorationContext& context, const ObjectModelClassDescriptor *classDescriptor,
+														const ObjectModel *self, const ExpressionValue& val) const THROWS(GCodeException)
 {
-	if (id[0] == 0 || id[0] == '*')
+	ObjectModelCacheKey key;
+	context.MakeCacheKey(key, self, this);
+	const uint32_t changeSeq = context.GetSectionChangeSeq();
+	switch (ObjectModelCache::Find(key, changeSeq, buf))
 	{
-		return 0;
+	case ObjectModelCache::LookupResult::hit:
+		return;
+
+	case ObjectModelCache::LookupResult::tooLong:
+		self->ReportItemAsJson(buf, context, classDescriptor, val, "");
+		return;
+
+	case ObjectModelCache::LookupResult::miss:
+		break;
 	}
 
-	const char *n = name;
-	while (*id == *n && *n != 0)
+	const size_t startLength = buf->Length();
+	const int previousNextElement = context.GetNextElement();
+	context.SetRecordingJson(true);
+	self->ReportItemAsJson(buf, context, classDescriptor, val, "");
+	context.SetRecordingJson(false);
+
+	// Don't cache the JSON if it is incomplete
+	if (!buf->HadOverflow() && context.GetNextElement() == previousNextElement)
 	{
-		++id;
-		++n;
+		ObjectModelCache::Store(key, changeSeq, buf, startLength, buf->Length() - startLength);
 	}
-	return (*n == 0 && (*id == 0 || *id == '.' || *id == '[' || *id == '^')) ? 0
-		: (*id > *n && *id != '^') ? 1
-			: -1;
+}
+
+#endif
+
+// Compare an ID with the name of this object
+int ObjectModelTableEntry::IdCompare(const char *id) const noexcept
+{
+	return ObjectModelTableSearch::CompareId(name, id);
 }
 
 // Get the value of an object
@@ -947,14 +1050,7 @@ decrease(strlen(idString))	// recursion variant
 		const ObjectModelTableEntry * const e = FindObjectModelTableEntry(classDescriptor, tableNumber, idString);
 		if (e != nullptr)
 		{
-			if (e->IsObsolete())
-			{
-				context.SetObsoleteFieldQueried();
-			}
-			idString = GetNextElement(idString);
-			const ExpressionValue val = e->func(this, context);
-			context.CheckStack(StackUsage::GetObjectValue_noTable);
-			return GetObjectValue(context, classDescriptor, val, idString);
+			return GetObjectValueUsingTableEntry(context, classDescriptor, e, GetNextElement(idString));
 		}
 		if (tableNumber != 0)
 		{
@@ -971,6 +1067,32 @@ decrease(strlen(idString))	// recursion variant
 	throw context.ConstructParseException("unknown value '%s'", idString);
 }
 
+// Find the table 0 entry for the first element of a path, also returning the class descriptor whose table it is in
+const ObjectModelTableEntry * null ObjectModel::FindFirstElementEntry(const char *_ecv_array idString, const ObjectModelClassDescriptor * null& classDescriptor) const noexcept
+{
+	for (classDescriptor = GetObjectModelClassDescriptor(); classDescriptor != nullptr; classDescriptor = classDescriptor->parent)
+	{
+		const ObjectModelTableEntry * const e = FindObjectModelTableEntry(classDescriptor, 0, idString);
+		if (e != nullptr)
+		{
+			return e;
+		}
+	}
+	return nullptr;
+}
+
+// Get the value of an object given the table entry for the first element of its path. 'idString' is the rest of the path.
+ExpressionValue ObjectModel::GetObjectValueUsingTableEntry(ObjectExplorationContext& context, const ObjectModelClassDescriptor *classDescriptor, const ObjectModelTableEntry *e, const char *_ecv_array idString) const THROWS(GCodeException)
+{
+	if (e->IsObsolete())
+	{
+		context.SetObsoleteFieldQueried();
+	}
+	const ExpressionValue val = e->func(this, context);
+	context.CheckStack(StackUsage::GetObjectValue_noTable);
+	return GetObjectValue(context, classDescriptor, val, idString);
+}
+
 ExpressionValue ObjectModel::GetObjectValue(ObjectExplorationContext& context, const ObjectModelClassDescriptor *classDescriptor, const ExpressionValue& val, const char *_ecv_array idString) const THROWS(GCodeException)
 decrease(strlen(idString))	// recursion variant
 {
@@ -1204,7 +1326,7 @@ void ObjectModel::ReportFloat(OutputBuffer *buf, const ExpressionValue& val) noe
 	}
 	else
 	{
-		buf->catf(val.GetFloatFormatString(), (double)val.fVal);
+		buf->catFloat(val.fVal, val.GetFloatDigitsAfterPoint());
 	}
 }
 
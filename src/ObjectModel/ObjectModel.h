@@ -18,6 +18,7 @@
 #include <General/Bitmap.h>
 #include <RTOSIface/RTOSIface.h>
 #include <Networking/NetworkDefs.h>
+#include "ObjectModelTableSearch.h"
 
 // Type codes to indicate what type of expression we have and how it is represented.
 // The "Special" type is for items that we have to evaluate when we are ready to write them out, in particular strings whose storage might disappear.
@@ -65,6 +66,7 @@ enum class ExpansionDetail : uint32_t
 class ObjectModel;
 class ObjectModelArrayDescriptor;
 class ObjectModelTableEntry;
+struct ObjectModelCacheKey;
 class IoPort;
 class UniqueId;
 
@@ -191,8 +193,8 @@ struct ExpressionValue
 	{ return DriverId(uVal); }
 #endif
 
-	// Get the format string to use assuming this is a floating point number
-	const char *_ecv_array GetFloatFormatString() const noexcept { return ::GetFloatFormatString(fVal, param); }
+	// Get the number of decimal digits to display assuming this is a floating point number
+	unsigned int GetFloatDigitsAfterPoint() const noexcept { return ::GetFloatDigitsAfterPoint(fVal, param); }
 
 	// Append a string representation of this value to a string
 	void AppendAsString(const StringRef& str) const noexcept;
@@ -244,6 +246,16 @@ public:
 	bool WantExists() const noexcept { return wantExists; }
 	bool ShouldIncludeNulls() const noexcept { return includeNulls; }
 	bool ShouldIncludeImportant() const noexcept { return includeImportant; }
+	bool ReportingChangesOnly() const noexcept { return changesOnly; }
+	uint32_t GetChangeToken() const noexcept { return changedSince; }
+	void SetIncludeNonLive(bool b) noexcept { includeNonLive = b; }
+#if SUPPORT_OBJECT_MODEL_CACHE
+	void SetSectionChangeSeq(uint32_t seq) noexcept { sectionChangeSeq = seq; }
+	uint32_t GetSectionChangeSeq() const noexcept { return sectionChangeSeq; }
+	bool CanUseCache() const noexcept { return sectionChangeSeq != 0 && !recordingJson && !wantArrayLength && startElement == 0; }
+	void SetRecordingJson(bool b) noexcept { recordingJson = b; }
+	void MakeCacheKey(ObjectModelCacheKey& key, const ObjectModel *self, const ObjectModelTableEntry *entry) const noexcept;
+#endif
 	uint64_t GetStartMillis() const { return startMillis; }
 	size_t GetInitialBufferOffset() const noexcept { return initialBufOffset; }
 
@@ -269,6 +281,10 @@ private:
 	int line;
 	int column;
 	const GCodeBuffer *_ecv_null gb;
+	uint32_t changedSince;							// the change sequence token supplied by the client, when reporting changes only
+#if SUPPORT_OBJECT_MODEL_CACHE
+	uint32_t sectionChangeSeq;						// the change sequence number of the top-level section we are reporting, or 0 if we don't track it
+#endif
 	unsigned int shortForm : 1,
 				wantArrayLength : 1,
 				wantExists : 1,
@@ -277,6 +293,10 @@ private:
 				includeNulls : 1,
 				excludeVerbose : 1,
 				excludeObsolete : 1,
+				changesOnly : 1,
+#if SUPPORT_OBJECT_MODEL_CACHE
+				recordingJson : 1,					// true while we are generating JSON to be cached, so that we don't cache the entries within it separately
+#endif
 				obsoleteFieldQueried : 1;
 };
 
@@ -304,6 +324,12 @@ public:
 	// Get the value of an object via the table
 	ExpressionValue GetObjectValueUsingTableNumber(ObjectExplorationContext& context, const ObjectModelClassDescriptor * null classDescriptor, const char *_ecv_array idString, uint8_t tableNumber) const THROWS(GCodeException);
 
+	// Find the table 0 entry for the first element of a path, so that a caller that evaluates the same path repeatedly need only search for it once
+	const ObjectModelTableEntry * null FindFirstElementEntry(const char *_ecv_array idString, const ObjectModelClassDescriptor * null& classDescriptor) const noexcept;
+
+	// Get the value of an object given the table entry for the first element of its path and the rest of the path
+	ExpressionValue GetObjectValueUsingTableEntry(ObjectExplorationContext& context, const ObjectModelClassDescriptor *classDescriptor, const ObjectModelTableEntry *e, const char *_ecv_array idString) const THROWS(GCodeException);
+
 	// Function to report a value or object as JSON. This does not need to handle 'var' or 'global' because those are checked for before this is called.
 	void ReportItemAsJson(OutputBuffer *buf, ObjectExplorationContext& context, const ObjectModelClassDescriptor *classDescriptor,
 							const ExpressionValue& val, const char *_ecv_array filter) const THROWS(GCodeException);
@@ -327,6 +353,12 @@ protected:
 
 	virtual const ObjectModelClassDescriptor *GetObjectModelClassDescriptor() const noexcept = 0;
 
+	// Get the change sequence number of one of our table entries, returning false if we don't track changes to it. Overridden in class RepRap.
+	virtual bool GetEntryChangeSequence(const ObjectModelTableEntry *entry, uint32_t& seq) const noexcept { return false; }
+
+	// Return true if a table entry with the specified change sequence number may have changed since the client's change token. Overridden in class RepRap.
+	virtual bool ChangedSinceToken(uint32_t changeSeq, uint32_t token) const noexcept { return true; }
+
 	__attribute__ ((noinline)) void ReportItemAsJsonFull(OutputBuffer *buf, ObjectExplorationContext& context, const ObjectModelClassDescriptor *null classDescriptor,
 															const ExpressionValue& val, const char *filter) const THROWS(GCodeException);
 private:
@@ -383,6 +415,12 @@ public:
 	// Compare the name of this field with the filter string that we are trying to match
 	int IdCompare(const char *id) const noexcept;
 
+#if SUPPORT_OBJECT_MODEL_CACHE
+	// Report the value of this element as JSON using the cache if we can
+	__attribute__ ((noinline)) void ReportItemAsJsonUsingCache(OutputBuffer* buf, ObjectExplorationContext& context, const ObjectModelClassDescriptor *classDescriptor,
+																const ObjectModel *_ecv_from self, const ExpressionValue& val) const THROWS(GCodeException);
+#endif
+
 	// Return true if a section of the OMT is ordered
 	static inline constexpr bool IsOrdered(const ObjectModelTableEntry *_ecv_array omt, size_t len) noexcept
 	{
@@ -400,6 +438,7 @@ public:
 	{
 		return IsOrdered(descriptor[0], descriptor + 1, omt);
 	}
+
 };
 
 struct ObjectModelClassDescriptor
@@ -407,8 +446,31 @@ struct ObjectModelClassDescriptor
 	const ObjectModelTableEntry *omt;
 	const uint8_t *omd;
 	const ObjectModelClassDescriptor *parent;
+#if USE_OBJECT_MODEL_HASH_INDEX
+	const uint8_t *omh;
+#endif
 };
 
+#if USE_OBJECT_MODEL_HASH_INDEX
+
+// Holder for the hash index of a class. Classes that use DECLARE_OBJECT_MODEL make this a friend so that it can read their tables.
+template<class C> struct ObjectModelTableIndex
+{
+	static constexpr ObjectModelTableHashIndex<ObjectModelTableSearch::HashIndexSize(C::objectModelTableDescriptor)> index{C::objectModelTableDescriptor, C::objectModelTable, ARRAY_SIZE(C::objectModelTable)};
+};
+
+# define OMT_HASH_INDEX_FRIEND		template<class T> friend struct ObjectModelTableIndex;
+# define OMT_HASH_INDEX(_class)		, ObjectModelTableIndex<_class>::index.data
+# define OMT_HASH_INDEX_OK(_class)	(ObjectModelTableIndex<_class>::index.ok)
+
+#else
+
+# define OMT_HASH_INDEX_FRIEND		// nothing
+# define OMT_HASH_INDEX(_class)		// nothing
+# define OMT_HASH_INDEX_OK(_class)	(true)
+
+#endif
+
 // Use this macro to inherit from ObjectModel
 #define INHERIT_OBJECT_MODEL	: public ObjectModel
 
@@ -417,7 +479,8 @@ struct ObjectModelClassDescriptor
 	const ObjectModelClassDescriptor *GetObjectModelClassDescriptor() const noexcept override; \
 	static const ObjectModelTableEntry objectModelTable[]; \
 	static const uint8_t objectModelTableDescriptor[]; \
-	static const ObjectModelClassDescriptor objectModelClassDescriptor;
+	static const ObjectModelClassDescriptor objectModelClassDescriptor; \
+	OMT_HASH_INDEX_FRIEND
 
 #define DECLARE_OBJECT_MODEL_VIRTUAL \
 	virtual const ObjectModelClassDescriptor *GetObjectModelClassDescriptor() const noexcept override = 0;
@@ -427,22 +490,24 @@ struct ObjectModelClassDescriptor
 #define OMT_ORDERING_OK(_class)	(ObjectModelTableEntry::IsOrdered(_class::objectModelTableDescriptor, _class::objectModelTable))
 
 #define DEFINE_GET_OBJECT_MODEL_TABLE(_class) \
-	const ObjectModelClassDescriptor _class::objectModelClassDescriptor = { _class::objectModelTable, _class::objectModelTableDescriptor, nullptr }; \
+	const ObjectModelClassDescriptor _class::objectModelClassDescriptor = { _class::objectModelTable, _class::objectModelTableDescriptor, nullptr OMT_HASH_INDEX(_class) }; \
 	const ObjectModelClassDescriptor *_class::GetObjectModelClassDescriptor() const noexcept \
 	{ \
 		static_assert(DESCRIPTOR_OK(_class), "Bad descriptor length"); \
 		static_assert(!DESCRIPTOR_OK(_class) || OMT_SIZE_OK(_class), "Mismatched object model table and descriptor"); \
 		static_assert(!DESCRIPTOR_OK(_class) || !OMT_SIZE_OK(_class) || OMT_ORDERING_OK(_class), "Object model table must be ordered"); \
+		static_assert(!DESCRIPTOR_OK(_class) || !OMT_SIZE_OK(_class) || OMT_HASH_INDEX_OK(_class), "Failed to build object model table hash index"); \
 		return &objectModelClassDescriptor; \
 	}
 
 #define DEFINE_GET_OBJECT_MODEL_TABLE_WITH_PARENT(_class, _parent) \
-	const ObjectModelClassDescriptor _class::objectModelClassDescriptor = { _class::objectModelTable, _class::objectModelTableDescriptor, &_parent::objectModelClassDescriptor }; \
+	const ObjectModelClassDescriptor _class::objectModelClassDescriptor = { _class::objectModelTable, _class::objectModelTableDescriptor, &_parent::objectModelClassDescriptor OMT_HASH_INDEX(_class) }; \
 	const ObjectModelClassDescriptor *_class::GetObjectModelClassDescriptor() const noexcept \
 	{ \
 		static_assert(DESCRIPTOR_OK(_class), "Bad descriptor length"); \
 		static_assert(!DESCRIPTOR_OK(_class) || OMT_SIZE_OK(_class), "Mismatched object model table and descriptor"); \
 		static_assert(!DESCRIPTOR_OK(_class) || !OMT_SIZE_OK(_class) || OMT_ORDERING_OK(_class), "Object model table must be ordered"); \
+		static_assert(!DESCRIPTOR_OK(_class) || !OMT_SIZE_OK(_class) || OMT_HASH_INDEX_OK(_class), "Failed to build object model table hash index"); \
 		return &objectModelClassDescriptor; \
 	}
 
@@ -0,0 +1,174 @@
+/*
+ * ObjectModelCache.cpp
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#include "ObjectModelCache.h"
+
+#if SUPPORT_OBJECT_MODEL_CACHE
+
+#include <Platform/Heap.h>
+#include <Platform/OutputMemory.h>
+#include <Platform/Platform.h>
+#include <Platform/RepRap.h>
+#include <RTOSIface/RTOSIface.h>
+
+constexpr size_t MaxCachedLength = 2000;				// must fit in a string heap block
+
+struct CachedJson
+{
+	ObjectModelCacheKey key;
+	uint32_t changeSeq;									// the sequence number of the section containing the entry when we generated the JSON
+	uint32_t lastUsed;
+	StringHandle json;									// null if the JSON was too long to cache
+	size_t length;										// 0 if this cache slot is free
+};
+
+// Private data
+static Mutex cacheMutex;
+static CachedJson cache[NumObjectModelCacheEntries];
+static size_t bytesUsed = 0;
+static uint32_t useCounter = 0;
+static uint32_t numHits = 0, numMisses = 0;
+static uint64_t bytesSaved = 0;
+
+bool ObjectModelCacheKey::operator==(const ObjectModelCacheKey& other) const noexcept
+{
+	if (self != other.self || entry != other.entry || reportOptions != other.reportOptions || numIndices != other.numIndices)
+	{
+		return false;
+	}
+	for (size_t i = 0; i < numIndices; ++i)
+	{
+		if (indices[i] != other.indices[i])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Free a cache slot. The cache mutex must be owned by the caller.
+static void FreeSlot(CachedJson& cj) noexcept
+{
+	if (!cj.json.IsNull())
+	{
+		bytesUsed -= cj.length;
+		cj.json.Delete();
+	}
+	cj.length = 0;
+}
+
+void ObjectModelCache::Init() noexcept
+{
+	cacheMutex.Create("OMCache");
+}
+
+// Look for the JSON of an entry. If we have it and it is current then append it to the buffer.
+ObjectModelCache::LookupResult ObjectModelCache::Find(const ObjectModelCacheKey& key, uint32_t changeSeq, OutputBuffer *buf) noexcept
+{
+	MutexLocker lock(cacheMutex);
+	for (CachedJson& cj : cache)
+	{
+		if (cj.length != 0 && cj.key == key)
+		{
+			if (cj.changeSeq != changeSeq)
+			{
+				FreeSlot(cj);										// the section has changed since we cached this
+				break;
+			}
+			cj.lastUsed = ++useCounter;
+			if (cj.json.IsNull())
+			{
+				return LookupResult::tooLong;
+			}
+			buf->cat(cj.json.Get().Ptr(), cj.length);
+			++numHits;
+			bytesSaved += cj.length;
+			return LookupResult::hit;
+		}
+	}
+	++numMisses;
+	return LookupResult::miss;
+}
+
+// Cache the JSON of an entry, which occupies 'length' bytes of the buffer chain starting at 'offset'.
+// If it is too long then we record that instead, so that next time the entries within it can be cached.
+void ObjectModelCache::Store(const ObjectModelCacheKey& key, uint32_t changeSeq, const OutputBuffer *buf, size_t offset, size_t length) noexcept
+{
+	if (length == 0)
+	{
+		return;
+	}
+
+	const bool tooLong = (length > MaxCachedLength);
+	MutexLocker lock(cacheMutex);
+
+	// Another task may have cached the same entry while we were generating it
+	for (CachedJson& cj : cache)
+	{
+		if (cj.length != 0 && cj.key == key)
+		{
+			FreeSlot(cj);
+		}
+	}
+
+	// Free least recently used slots until there is a free slot and room for the text
+	while (true)
+	{
+		CachedJson *oldest = nullptr;
+		CachedJson *freeSlot = nullptr;
+		for (CachedJson& cj : cache)
+		{
+			if (cj.length == 0)
+			{
+				freeSlot = &cj;
+			}
+			else if (oldest == nullptr || (int32_t)(cj.lastUsed - oldest->lastUsed) < 0)
+			{
+				oldest = &cj;
+			}
+		}
+
+		if (freeSlot != nullptr && (tooLong || bytesUsed + length <= ObjectModelCacheSize))
+		{
+			freeSlot->key = key;
+			freeSlot->changeSeq = changeSeq;
+			freeSlot->lastUsed = ++useCounter;
+			freeSlot->length = length;
+			if (!tooLong)
+			{
+				freeSlot->json = StringHandle(buf, offset, length);
+				bytesUsed += length;
+			}
+			return;
+		}
+
+		if (oldest == nullptr)
+		{
+			return;
+		}
+		FreeSlot(*oldest);
+	}
+}
+
+void ObjectModelCache::Diagnostics(MessageType mtype) noexcept
+{
+	MutexLocker lock(cacheMutex);
+	unsigned int numEntries = 0;
+	for (const CachedJson& cj : cache)
+	{
+		if (cj.length != 0)
+		{
+			++numEntries;
+		}
+	}
+	const uint32_t numLookups = numHits + numMisses;
+	reprap.GetPlatform().MessageF(mtype, "Object model cache: %u entries using %u bytes, %" PRIu32 " hits (%u%%), %" PRIu32 " misses, %" PRIu64 " bytes saved\n",
+									numEntries, bytesUsed, numHits, (numLookups == 0) ? 0 : (unsigned int)(((uint64_t)numHits * 100)/numLookups), numMisses, bytesSaved);
+}
+
+#endif
+
+// End
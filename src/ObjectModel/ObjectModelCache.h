@@ -0,0 +1,48 @@
+/*
+ * ObjectModelCache.h
+ *
+ *  Created on: 16 Oct 2026
+ *
+ *  The object model cache holds the JSON of recently-reported object model entries that are not flagged live, such as limits, network,
+ *  move.kinematics and the static parts of tools and boards. These only change when the sequence number of the top-level section
+ *  that contains them changes, so each cached entry records the sequence number it was generated at and is discarded when that changes.
+ *  The text is held in the string heap.
+ */
+
+#ifndef SRC_OBJECTMODEL_OBJECTMODELCACHE_H_
+#define SRC_OBJECTMODEL_OBJECTMODELCACHE_H_
+
+#include <RepRapFirmware.h>
+
+#if SUPPORT_OBJECT_MODEL_CACHE
+
+class ObjectModel;
+class ObjectModelTableEntry;
+
+// Key used to look up the JSON of an object model entry
+struct ObjectModelCacheKey
+{
+	static constexpr size_t MaxIndices = 4;
+
+	const ObjectModel *self;					// the object that owns the table entry
+	const ObjectModelTableEntry *entry;
+	int32_t indices[MaxIndices];				// the array indices in effect, because some entries depend on them
+	uint16_t reportOptions;						// the report flags and remaining depth that affect the JSON we generate
+	uint8_t numIndices;
+
+	bool operator==(const ObjectModelCacheKey& other) const noexcept;
+};
+
+namespace ObjectModelCache
+{
+	enum class LookupResult : uint8_t { hit, miss, tooLong };
+
+	void Init() noexcept;
+	LookupResult Find(const ObjectModelCacheKey& key, uint32_t changeSeq, OutputBuffer *buf) noexcept;		// if the JSON is cached then append it to the buffer
+	void Store(const ObjectModelCacheKey& key, uint32_t changeSeq, const OutputBuffer *buf, size_t offset, size_t length) noexcept;	// cache JSON that has just been generated
+	void Diagnostics(MessageType mtype) noexcept;
+}
+
+#endif
+
+#endif /* SRC_OBJECTMODEL_OBJECTMODELCACHE_H_ */
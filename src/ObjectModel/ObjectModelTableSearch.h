@@ -0,0 +1,191 @@
+/*
+ * ObjectModelTableSearch.h
+ *
+ *  Created on: 16 Oct 2026
+ *
+ *  Finding entries in a section of an object model table (OMT), either by binary search or using a perfect hash index built at compile time.
+ *  Both methods must find the same entry for every ID, so they share the comparison and the ID terminators here.
+ *  This file only depends on the standard library so that it can be tested on the host (see folder Tests). The functions are templates
+ *  taking the type of the table entries, which must have a member 'name'. In the firmware this is ObjectModelTableEntry.
+ */
+
+#ifndef SRC_OBJECTMODEL_OBJECTMODELTABLESEARCH_H_
+#define SRC_OBJECTMODEL_OBJECTMODELTABLESEARCH_H_
+
+#include <ecv_duet3d.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace ObjectModelTableSearch
+{
+	// Return true if a character ends the first element of an ID or filter string
+	inline constexpr bool IsIdTerminator(char c) noexcept
+	{
+		return c == 0 || c == '.' || c == '[' || c == '^';
+	}
+
+	// Compare the name of a table entry with the first element of an ID or filter string.
+	// Return 0 if they match, 1 if the ID comes after the name and -1 if it comes before it. An empty or wildcard ID matches every name.
+	// The terminator is treated as the end of the ID, so that the ordering is the same as the ordering of the names by strcmp.
+	inline int CompareId(const char *_ecv_array name, const char *_ecv_array id) noexcept
+	{
+		if (id[0] == 0 || id[0] == '*')
+		{
+			return 0;
+		}
+
+		while (*id == *name && *name != 0)
+		{
+			++id;
+			++name;
+		}
+		const unsigned int idChar = (IsIdTerminator(*id)) ? 0 : (uint8_t)*id;
+		const unsigned int nameChar = (uint8_t)*name;
+		return (idChar == nameChar) ? 0 : (idChar > nameChar) ? 1 : -1;
+	}
+
+	// Find an entry using binary search. The names in the section must be in strcmp order.
+	template<class Entry> const Entry *_ecv_null FindUsingBinarySearch(const Entry *_ecv_array tbl, size_t numEntries, const char *_ecv_array id) noexcept
+	{
+		size_t low = 0, high = numEntries;
+		while (high > low)
+		{
+			const size_t mid = (high - low)/2 + low;
+			const int t = CompareId(tbl[mid].name, id);
+			if (t == 0)
+			{
+				return &tbl[mid];
+			}
+			if (t > 0)
+			{
+				low = mid + 1u;
+			}
+			else
+			{
+				high = mid;
+			}
+		}
+		return nullptr;
+	}
+
+	// Hash the first element of an ID or filter string, or the name of a table entry
+	inline constexpr uint32_t HashId(const char *_ecv_array id, uint16_t seed) noexcept
+	{
+		uint32_t h = 2166136261u ^ ((uint32_t)seed * 0x9E3779B9u);
+		while (!IsIdTerminator(*id))
+		{
+			h = (h ^ (uint8_t)*id++) * 16777619u;
+		}
+		return h ^ (h >> 16);
+	}
+
+	// Return the number of hash slots for a section of the OMT. This is a power of 2 and at least twice the number of entries, so that finding a perfect hash is quick.
+	inline constexpr size_t NumHashSlots(size_t numEntries) noexcept
+	{
+		size_t numSlots = 2;
+		while (numSlots < 2 * numEntries)
+		{
+			numSlots <<= 1;
+		}
+		return numSlots;
+	}
+
+	// Return the number of bytes of hash index needed for a section of the OMT
+	inline constexpr size_t HashIndexSectionSize(size_t numEntries) noexcept
+	{
+		return (numEntries == 0) ? 0 : 2 + NumHashSlots(numEntries);
+	}
+
+	// Return the number of bytes of hash index needed for the whole OMT
+	inline constexpr size_t HashIndexSize(const uint8_t *_ecv_array descriptor) noexcept
+	{
+		size_t size = 0;
+		for (size_t i = 1; i <= descriptor[0]; ++i)
+		{
+			size += HashIndexSectionSize(descriptor[i]);
+		}
+		return size;
+	}
+
+	// Find an entry using the hash index of its section. The ID must not be empty or a wildcard.
+	template<class Entry> const Entry *_ecv_null FindUsingHashIndex(const Entry *_ecv_array tbl, size_t numEntries, const uint8_t *_ecv_array hashIndex, const char *_ecv_array id) noexcept
+	{
+		if (numEntries == 0)
+		{
+			return nullptr;
+		}
+		const uint16_t seed = hashIndex[0] | ((uint16_t)hashIndex[1] << 8);
+		const size_t slot = HashId(id, seed) & (NumHashSlots(numEntries) - 1);
+		const size_t entryNumber = hashIndex[2 + slot];
+		return (entryNumber != 0 && CompareId(tbl[entryNumber - 1].name, id) == 0) ? &tbl[entryNumber - 1] : nullptr;
+	}
+}
+
+// Perfect hash index for an object model table, built at compile time so that we can find an entry using one hash and one string comparison.
+// For each section of the table that has entries there is a 2-byte seed for the hash function, followed by the hash slots.
+// Each slot holds 1 + the number within the section of the entry whose name hashes to it, or 0 if no name does.
+// The seed search tries at most MaxSeeds seeds per section. For the largest tables a seed is found after a few tries, so this stays well within the compiler's constexpr limits.
+template<size_t Size> struct ObjectModelTableHashIndex
+{
+	static constexpr uint32_t MaxSeeds = 4096;
+
+	uint8_t data[(Size == 0) ? 1 : Size];
+	bool ok;
+
+	template<class Entry> constexpr ObjectModelTableHashIndex(const uint8_t *_ecv_array descriptor, const Entry *_ecv_array omt, size_t omtSize) noexcept : data{}, ok(true)
+	{
+		size_t pos = 0;
+		size_t entriesLeft = omtSize;
+		for (size_t section = 1; section <= descriptor[0]; ++section)
+		{
+			const size_t numEntries = descriptor[section];
+			if (numEntries == 0)
+			{
+				continue;
+			}
+			if (numEntries > entriesLeft)
+			{
+				ok = false;
+				return;
+			}
+
+			const size_t numSlots = ObjectModelTableSearch::NumHashSlots(numEntries);
+			uint8_t *_ecv_array const slots = data + pos + 2;
+			bool found = false;
+			for (uint32_t seed = 0; seed < MaxSeeds && !found; ++seed)
+			{
+				for (size_t i = 0; i < numSlots; ++i)
+				{
+					slots[i] = 0;
+				}
+				found = true;
+				for (size_t i = 0; i < numEntries; ++i)
+				{
+					const size_t slot = ObjectModelTableSearch::HashId(omt[i].name, (uint16_t)seed) & (numSlots - 1);
+					if (slots[slot] != 0)
+					{
+						found = false;
+						break;
+					}
+					slots[slot] = (uint8_t)(i + 1);
+				}
+				if (found)
+				{
+					data[pos] = (uint8_t)seed;
+					data[pos + 1] = (uint8_t)(seed >> 8);
+				}
+			}
+			if (!found)
+			{
+				ok = false;
+				return;
+			}
+
+			pos += ObjectModelTableSearch::HashIndexSectionSize(numEntries);
+			omt += numEntries;
+			entriesLeft -= numEntries;
+		}
+	}
+};
+
+#endif /* SRC_OBJECTMODEL_OBJECTMODELTABLESEARCH_H_ */
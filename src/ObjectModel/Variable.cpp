@@ -18,98 +18,57 @@ Variable::~Variable()
 	val.Release();
 }
 
+bool VariableSet::LinkedVariable::HasName(const char *str) const noexcept
+{
+	auto vname = v.GetName();
+	return strcmp(vname.Ptr(), str) == 0;
+}
+
 Variable* VariableSet::Lookup(const char *str) noexcept
 {
-	LinkedVariable *lv;
-	for (lv = root; lv != nullptr; lv = lv->next)
-	{
-		auto vname = lv->v.GetName();
-		if (strcmp(vname.Ptr(), str) == 0)
-		{
-			return &(lv->v);
-		}
-	}
-	return nullptr;
+	LinkedVariable * const lv = variables.Find(str);
+	return (lv == nullptr) ? nullptr : &(lv->v);
 }
 
 const Variable* VariableSet::Lookup(const char *str) const noexcept
 {
-	const LinkedVariable *lv;
-	for (lv = root; lv != nullptr; lv = lv->next)
-	{
-		auto vname = lv->v.GetName();
-		if (strcmp(vname.Ptr(), str) == 0)
-		{
-			return &(lv->v);
-		}
-	}
-	return nullptr;
+	const LinkedVariable * const lv = variables.Find(str);
+	return (lv == nullptr) ? nullptr : &(lv->v);
 }
 
 void VariableSet::InsertNew(const char *str, ExpressionValue pVal, int8_t pScope) noexcept
 {
-	LinkedVariable * const toInsert = new LinkedVariable(str, pVal, pScope, root);
-	root = toInsert;
+	variables.InsertFirst(new LinkedVariable(str, pVal, pScope));
 }
 
 // Remove all variables with a scope greater than the parameter
 void VariableSet::EndScope(uint8_t blockNesting) noexcept
 {
-	LinkedVariable *prev = nullptr;
-	for (LinkedVariable *lv = root; lv != nullptr; )
+	LinkedVariable *lv;
+	while ((lv = variables.RemoveFirstOutOfScope(blockNesting)) != nullptr)
 	{
-		if (lv->v.GetScope() > blockNesting)
-		{
-			LinkedVariable *temp = lv;
-			lv = lv->next;
-			if (prev == nullptr)
-			{
-				root = lv;
-			}
-			else
-			{
-				prev->next = lv;
-			}
-			delete temp;
-		}
-		else
-		{
-			prev = lv;
-			lv = lv->next;
-		}
+		delete lv;
 	}
 }
 
 void VariableSet::Delete(const char *str) noexcept
 {
-	LinkedVariable *prev = nullptr;
-	for (LinkedVariable *lv = root; lv != nullptr; lv = lv->next)
+	LinkedVariable * const toDelete = variables.Find(str);
+	if (toDelete != nullptr)
 	{
-		auto vname = lv->v.GetName();
-		if (strcmp(vname.Ptr(), str) == 0)
-		{
-			if (prev == nullptr)
-			{
-				root = lv->next;
-			}
-			else
-			{
-				prev->next = lv->next;
-			}
-			delete lv;
-			break;
-		}
-		prev = lv;
+		variables.Remove(toDelete);
+		delete toDelete;
 	}
 }
 
 void VariableSet::Clear() noexcept
 {
-	while (root != nullptr)
+	LinkedVariable *lv = variables.RemoveAll();
+	while (lv != nullptr)
 	{
-		LinkedVariable *lv = root;
-		root = lv->next;
+		LinkedVariable * const next = lv->next;
 		delete lv;
+		lv = next;
 	}
 }
 
@@ -122,14 +81,13 @@ VariableSet::~VariableSet()
 void VariableSet::AssignFrom(VariableSet& other) noexcept
 {
 	Clear();
-	root = other.root;
-	other.root = nullptr;
+	variables.TakeFrom(other.variables);
 }
 
 void VariableSet::IterateWhile(function_ref<bool(unsigned int, const Variable&) /*noexcept*/ > func) const noexcept
 {
 	unsigned int num = 0;
-	for (const LinkedVariable *lv = root; lv != nullptr; lv = lv->next)
+	for (const LinkedVariable *lv = variables.GetFirst(); lv != nullptr; lv = lv->next)
 	{
 		if (!func(num, lv->v))
 		{
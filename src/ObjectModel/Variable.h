@@ -13,6 +13,7 @@
 #include <Platform/Heap.h>
 #include <ObjectModel/ObjectModel.h>
 #include <General/function_ref.h>
+#include "VariableList.h"
 
 // Class to represent a variable having a name and a value
 class Variable
@@ -32,12 +33,11 @@ private:
 	int8_t scope;								// -1 for a parameter, else the block nesting level when it was created
 };
 
-// Class to represent a collection of variables.
-// For now this is just a linked list, but it could be changed to a hash table for faster lookup and insertion.
+// Class to represent a collection of variables, held in a VariableList. They are reported in the object model in the order of the list, which is reverse order of creation.
 class VariableSet
 {
 public:
-	VariableSet() noexcept : root(nullptr) { }
+	VariableSet() noexcept { }
 	~VariableSet();
 	VariableSet(const VariableSet&) = delete;
 	VariableSet& operator=(const VariableSet& other) = delete;
@@ -59,13 +59,19 @@ private:
 	{
 		DECLARE_FREELIST_NEW_DELETE(LinkedVariable)
 
-		LinkedVariable(const char *_ecv_array str, ExpressionValue pVal, int8_t pScope, LinkedVariable *p_next) : next(p_next), v(str, pVal, pScope) {}
+		LinkedVariable(const char *_ecv_array str, ExpressionValue pVal, int8_t pScope)
+			: next(nullptr), nextInBucket(nullptr), hash(VariableList<LinkedVariable>::Hash(str)), v(str, pVal, pScope) {}
+
+		int8_t GetScope() const noexcept { return v.GetScope(); }
+		bool HasName(const char *_ecv_array str) const noexcept;
 
 		LinkedVariable * null next;
+		LinkedVariable * null nextInBucket;
+		uint32_t hash;
 		Variable v;
 	};
 
-	LinkedVariable * null root;
+	VariableList<LinkedVariable> variables;
 };
 
 #endif /* SRC_GCODES_VARIABLE_H_ */
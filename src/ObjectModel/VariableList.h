@@ -0,0 +1,222 @@
+/*
+ * VariableList.h
+ *
+ *  Created on: 16 Oct 2026
+ *
+ *  The list and hash index used by VariableSet to hold its variables.
+ *  This file only depends on the standard library so that it can be tested on the host (see folder Tests). The list doesn't own the entries,
+ *  which must be of a type that has members 'next', 'nextInBucket' and 'hash' and functions GetScope() and HasName(const char *).
+ *  In the firmware the entries are VariableSet::LinkedVariable.
+ */
+
+#ifndef SRC_OBJECTMODEL_VARIABLELIST_H_
+#define SRC_OBJECTMODEL_VARIABLELIST_H_
+
+#include <ecv_duet3d.h>
+#include <cstddef>
+#include <cstdint>
+
+// A list of entries in reverse order of insertion.
+// When there are more than a few entries we also index them by a hash of their names, so that lookup doesn't need to scan the whole list.
+// Entries are always inserted at the current block nesting level, so the list is in non-increasing order of scope and RemoveFirstOutOfScope
+// only needs to look at the start of it.
+template<class Entry> class VariableList
+{
+public:
+	static constexpr unsigned int MinEntriesToIndex = 8;				// we create the hash index when there are this many entries
+	static constexpr unsigned int InitialNumBuckets = 16;				// must be a power of 2
+	static constexpr unsigned int MaxNumBuckets = 1024;					// must be a power of 2
+	static constexpr unsigned int MaxAverageChainLength = 2;			// we double the number of buckets when the average chain length exceeds this
+
+	VariableList() noexcept : root(nullptr), buckets(nullptr), numBuckets(0), numEntries(0) { }
+	~VariableList() { DeleteIndex(); }
+	VariableList(const VariableList&) = delete;
+	VariableList& operator=(const VariableList& other) = delete;
+
+	static uint32_t Hash(const char *_ecv_array str) noexcept;
+
+	Entry *_ecv_null GetFirst() const noexcept { return root; }
+	unsigned int GetNumEntries() const noexcept { return numEntries; }
+	unsigned int GetNumBuckets() const noexcept { return numBuckets; }
+
+	Entry *_ecv_null Find(const char *_ecv_array str) const noexcept;
+	void InsertFirst(Entry *entry) noexcept;							// the hash of the entry must already be set
+	Entry *_ecv_null RemoveFirstOutOfScope(int blockNesting) noexcept;	// remove and return the first entry if its scope is greater than the parameter
+	void Remove(Entry *entry) noexcept;
+	Entry *_ecv_null RemoveAll() noexcept;								// empty the list and return the entries, still linked by 'next'
+	void TakeFrom(VariableList& other) noexcept;						// take the entries of another list, this list must be empty
+
+private:
+	static bool Matches(const Entry *entry, uint32_t hash, const char *_ecv_array str) noexcept;
+
+	void AddToIndex(Entry *entry) noexcept;
+	void RemoveFromIndex(Entry *entry) noexcept;
+	void RebuildIndex(unsigned int newNumBuckets) noexcept;
+	void DeleteIndex() noexcept;
+	Entry *_ecv_null *GetBucket(uint32_t hash) const noexcept { return &buckets[hash & (numBuckets - 1)]; }
+
+	Entry *_ecv_null root;
+	Entry *_ecv_null *_ecv_null buckets;								// hash index, or nullptr if there are too few entries to make it worthwhile
+	uint16_t numBuckets;
+	uint16_t numEntries;
+};
+
+// FNV-1a hash of a variable name
+template<class Entry> uint32_t VariableList<Entry>::Hash(const char *_ecv_array str) noexcept
+{
+	uint32_t hash = 2166136261u;
+	while (*str != 0)
+	{
+		hash = (hash ^ (uint8_t)*str++) * 16777619u;
+	}
+	return hash;
+}
+
+// Check whether an entry has the specified name. Comparing the hash first saves comparing the name in most cases.
+template<class Entry> bool VariableList<Entry>::Matches(const Entry *entry, uint32_t hash, const char *_ecv_array str) noexcept
+{
+	return entry->hash == hash && entry->HasName(str);
+}
+
+template<class Entry> Entry *_ecv_null VariableList<Entry>::Find(const char *_ecv_array str) const noexcept
+{
+	const uint32_t hash = Hash(str);
+	if (buckets != nullptr)
+	{
+		for (Entry *entry = *GetBucket(hash); entry != nullptr; entry = entry->nextInBucket)
+		{
+			if (Matches(entry, hash, str))
+			{
+				return entry;
+			}
+		}
+	}
+	else
+	{
+		for (Entry *entry = root; entry != nullptr; entry = entry->next)
+		{
+			if (Matches(entry, hash, str))
+			{
+				return entry;
+			}
+		}
+	}
+	return nullptr;
+}
+
+template<class Entry> void VariableList<Entry>::InsertFirst(Entry *entry) noexcept
+{
+	entry->next = root;
+	entry->nextInBucket = nullptr;
+	root = entry;
+	++numEntries;
+	if (buckets != nullptr)
+	{
+		AddToIndex(entry);
+		if (numEntries > MaxAverageChainLength * numBuckets && numBuckets < MaxNumBuckets)
+		{
+			RebuildIndex(2 * numBuckets);
+		}
+	}
+	else if (numEntries >= MinEntriesToIndex)
+	{
+		RebuildIndex(InitialNumBuckets);
+	}
+}
+
+// Because the list is in non-increasing order of scope, the entries with a scope greater than the parameter are all at the start of it
+template<class Entry> Entry *_ecv_null VariableList<Entry>::RemoveFirstOutOfScope(int blockNesting) noexcept
+{
+	Entry * const entry = root;
+	if (entry == nullptr || entry->GetScope() <= blockNesting)
+	{
+		return nullptr;
+	}
+	root = entry->next;
+	RemoveFromIndex(entry);
+	--numEntries;
+	return entry;
+}
+
+template<class Entry> void VariableList<Entry>::Remove(Entry *entry) noexcept
+{
+	for (Entry *_ecv_null *pp = &root; *pp != nullptr; pp = &(*pp)->next)
+	{
+		if (*pp == entry)
+		{
+			*pp = entry->next;
+			RemoveFromIndex(entry);
+			--numEntries;
+			break;
+		}
+	}
+}
+
+template<class Entry> Entry *_ecv_null VariableList<Entry>::RemoveAll() noexcept
+{
+	DeleteIndex();
+	Entry * const entries = root;
+	root = nullptr;
+	numEntries = 0;
+	return entries;
+}
+
+template<class Entry> void VariableList<Entry>::TakeFrom(VariableList& other) noexcept
+{
+	DeleteIndex();
+	root = other.root;
+	buckets = other.buckets;
+	numBuckets = other.numBuckets;
+	numEntries = other.numEntries;
+	other.root = nullptr;
+	other.buckets = nullptr;
+	other.numBuckets = 0;
+	other.numEntries = 0;
+}
+
+template<class Entry> void VariableList<Entry>::AddToIndex(Entry *entry) noexcept
+{
+	Entry *_ecv_null *const bucket = GetBucket(entry->hash);
+	entry->nextInBucket = *bucket;
+	*bucket = entry;
+}
+
+template<class Entry> void VariableList<Entry>::RemoveFromIndex(Entry *entry) noexcept
+{
+	if (buckets != nullptr)
+	{
+		for (Entry *_ecv_null *pp = GetBucket(entry->hash); *pp != nullptr; pp = &(*pp)->nextInBucket)
+		{
+			if (*pp == entry)
+			{
+				*pp = entry->nextInBucket;
+				break;
+			}
+		}
+	}
+}
+
+// Create the hash index or change its size
+template<class Entry> void VariableList<Entry>::RebuildIndex(unsigned int newNumBuckets) noexcept
+{
+	delete[] buckets;
+	buckets = new Entry *_ecv_null[newNumBuckets];
+	numBuckets = newNumBuckets;
+	for (unsigned int i = 0; i < newNumBuckets; ++i)
+	{
+		buckets[i] = nullptr;
+	}
+	for (Entry *entry = root; entry != nullptr; entry = entry->next)
+	{
+		AddToIndex(entry);
+	}
+}
+
+template<class Entry> void VariableList<Entry>::DeleteIndex() noexcept
+{
+	delete[] buckets;
+	buckets = nullptr;
+	numBuckets = 0;
+}
+
+#endif /* SRC_OBJECTMODEL_VARIABLELIST_H_ */
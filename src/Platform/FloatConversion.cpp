@@ -0,0 +1,140 @@
+/*
+ * FloatConversion.cpp
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#include "FloatConversion.h"
+#include <General/SafeVsnprintf.h>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <limits>
+
+// Try to convert a plain decimal number such as -123.456 to a float quickly, returning true if successful.
+// G-code numbers have few significant digits and no exponent. When the digits form an integer that is exactly representable as a float and there are
+// no more than 10 digits after the decimal point, dividing that integer by a power of 10 gives the correctly-rounded result, the same as strtof would.
+// If we return false then the caller must use the general conversion routine instead.
+bool ReadDecimalFloat(const char *_ecv_array s, float& rslt, const char *_ecv_array& endptr) noexcept
+{
+	static constexpr float PowersOfTen[] = { 1.0, 1.0e1, 1.0e2, 1.0e3, 1.0e4, 1.0e5, 1.0e6, 1.0e7, 1.0e8, 1.0e9, 1.0e10 };	// these are all exact
+	constexpr unsigned int MaxSignificantDigits = 9;												// so that the integer fits in 32 bits
+	constexpr uint32_t MaxExactMantissa = (uint32_t)1 << 24;
+
+	const char *_ecv_array p = s;
+	const bool negative = (*p == '-');
+	if (negative || *p == '+')
+	{
+		++p;
+	}
+
+	uint32_t mantissa = 0;
+	unsigned int significantDigits = 0, digitsAfterPoint = 0;
+	bool seenDigit = false, seenPoint = false;
+	for (;; ++p)
+	{
+		const char c = *p;
+		if (isdigit(c))
+		{
+			seenDigit = true;
+			if (mantissa != 0 || c != '0')
+			{
+				if (++significantDigits > MaxSignificantDigits)
+				{
+					return false;
+				}
+				mantissa = (10 * mantissa) + (c - '0');
+			}
+			if (seenPoint)
+			{
+				++digitsAfterPoint;
+			}
+		}
+		else if (c == '.' && !seenPoint)
+		{
+			seenPoint = true;
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	// Leave anything unusual such as an exponent, a hex number or a missing number to the general routine
+	if (   !seenDigit || mantissa > MaxExactMantissa || digitsAfterPoint >= sizeof(PowersOfTen)/sizeof(PowersOfTen[0])
+		|| *p == 'e' || *p == 'E' || *p == 'x' || *p == 'X'
+	   )
+	{
+		return false;
+	}
+
+	const float val = (float)mantissa / PowersOfTen[digitsAfterPoint];
+	rslt = (negative) ? -val : val;
+	endptr = p;
+	return true;
+}
+
+// Format a floating point number in the same way as printf format "%.Nf" where N is numDigitsAfterPoint, which is limited to MaxFloatDigitsDisplayedAfterPoint.
+// The buffer must have room for FormattedFloatBufferSize characters. Return the number of characters written, not including the null terminator.
+// This is much faster than calling printf because apart from very large values, NaNs and infinities we do the conversion in integer arithmetic.
+size_t FormatFixedFloat(char *_ecv_array buf, float val, unsigned int numDigitsAfterPoint) noexcept
+{
+	static constexpr uint32_t PowersOfTen[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000 };
+	static constexpr const char *_ecv_array FormatStrings[] = { "%.0f", "%.1f", "%.2f", "%.3f", "%.4f", "%.5f", "%.6f", "%.7f" };
+	static_assert(sizeof(PowersOfTen)/sizeof(PowersOfTen[0]) == MaxFloatDigitsDisplayedAfterPoint + 1);
+	static_assert(sizeof(FormatStrings)/sizeof(FormatStrings[0]) == MaxFloatDigitsDisplayedAfterPoint + 1);
+
+	numDigitsAfterPoint = std::min<unsigned int>(numDigitsAfterPoint, MaxFloatDigitsDisplayedAfterPoint);
+
+	// A float has a 24-bit mantissa and the powers of 10 we use are less than 2^24, so the scaled value is exact in double precision
+	const double scaled = fabs((double)val) * PowersOfTen[numDigitsAfterPoint];
+	if (!(scaled < 4.0e18))											// this is also true if the value is a NaN
+	{
+		return SafeSnprintf(buf, FormattedFloatBufferSize, FormatStrings[numDigitsAfterPoint], (double)val);
+	}
+
+	// Round to nearest, with ties to even like printf
+	uint64_t intVal = (uint64_t)scaled;
+	const double remainder = scaled - (double)intVal;
+	if (remainder > 0.5 || (remainder == 0.5 && (intVal & 1u) != 0))
+	{
+		++intVal;
+	}
+
+	// Generate the digits in reverse order, at least one more than the number of decimal places. Avoid 64-bit division when we can.
+	char digits[20];
+	size_t numDigits = 0;
+	while (intVal > std::numeric_limits<uint32_t>::max())
+	{
+		digits[numDigits++] = '0' + (char)(intVal % 10);
+		intVal /= 10;
+	}
+	uint32_t intVal32 = (uint32_t)intVal;
+	do
+	{
+		digits[numDigits++] = '0' + (char)(intVal32 % 10);
+		intVal32 /= 10;
+	} while (intVal32 != 0 || numDigits <= numDigitsAfterPoint);
+
+	char *p = buf;
+	if (std::signbit(val))
+	{
+		*p++ = '-';
+	}
+	while (numDigits > numDigitsAfterPoint)
+	{
+		*p++ = digits[--numDigits];
+	}
+	if (numDigitsAfterPoint != 0)
+	{
+		*p++ = '.';
+		while (numDigits != 0)
+		{
+			*p++ = digits[--numDigits];
+		}
+	}
+	*p = 0;
+	return p - buf;
+}
+
+// End
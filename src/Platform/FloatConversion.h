@@ -0,0 +1,27 @@
+/*
+ * FloatConversion.h
+ *
+ *  Created on: 16 Oct 2026
+ *
+ *  Fast conversions between floats and decimal text, for the common cases that we meet when reading G-code and writing responses.
+ *  These functions only depend on the standard library so that they can be tested on the host (see folder Tests).
+ */
+
+#ifndef SRC_PLATFORM_FLOATCONVERSION_H_
+#define SRC_PLATFORM_FLOATCONVERSION_H_
+
+#include <ecv_duet3d.h>
+#include <cstddef>
+#include <cstdint>
+
+constexpr unsigned int MaxFloatDigitsDisplayedAfterPoint = 7;
+constexpr size_t FormattedFloatBufferSize = 50;						// enough for the longest float formatted with MaxFloatDigitsDisplayedAfterPoint decimal places
+
+// Try to convert a plain decimal number such as -123.456 to a float quickly, returning true if successful.
+// If we return false then the caller must use the general conversion routine instead.
+bool ReadDecimalFloat(const char *_ecv_array s, float& rslt, const char *_ecv_array& endptr) noexcept;
+
+// Format a floating point number in the same way as printf format "%.Nf" where N is numDigitsAfterPoint, which is limited to MaxFloatDigitsDisplayedAfterPoint
+size_t FormatFixedFloat(char *_ecv_array buf, float val, unsigned int numDigitsAfterPoint) noexcept;
+
+#endif /* SRC_PLATFORM_FLOATCONVERSION_H_ */
@@ -13,6 +13,7 @@
 #include <Platform/Tasks.h>
 #include <Platform/Platform.h>
 #include <Platform/RepRap.h>
+#include <Platform/OutputMemory.h>
 #include <General/String.h>
 #include <atomic>
 
@@ -353,6 +354,43 @@ StringHandle::StringHandle(const char *s, size_t len) noexcept
 	}
 }
 
+// Build a handle from part of the text in a chain of output buffers. The length must be less than the size of a heap block.
+StringHandle::StringHandle(const OutputBuffer *buf, size_t offset, size_t len) noexcept
+{
+	if (len == 0)
+	{
+		slotPtr = nullptr;
+	}
+	else
+	{
+		WriteLocker locker(heapLock);							// prevent other tasks modifying the heap
+		IndexSlot * const slot = AllocateHandle();
+		StorageSpace * const space = AllocateSpace(len + 1);
+		len = min<size_t>(len, space->length - 1);
+
+		// Skip the buffers that end before the text we want
+		while (buf != nullptr && offset >= buf->DataLength())
+		{
+			offset -= buf->DataLength();
+			buf = buf->Next();
+		}
+
+		size_t copied = 0;
+		while (buf != nullptr && copied < len)
+		{
+			const size_t toCopy = min<size_t>(buf->DataLength() - offset, len - copied);
+			memcpy(space->data + copied, buf->Data() + offset, toCopy);
+			copied += toCopy;
+			offset = 0;
+			buf = buf->Next();
+		}
+		space->data[copied] = 0;
+		slot->storage = space;
+		slot->refCount = 1;
+		slotPtr = slot;
+	}
+}
+
 #if 0	// This constructor is currently unused, but may be useful in future
 // Build a handle by concatenating two strings
 StringHandle::StringHandle(const char *s1, const char *s2) noexcept
@@ -17,6 +17,7 @@ class IndexSlot;
 class StorageSpace;
 class HeapBlock;
 class IndexBlock;
+class OutputBuffer;
 
 // Note: StringHandle is a union member in ExpressionValue, therefore it cannot have a non-trivial destructor, copy constructor etc.
 // This means that when an object containing a StringHandle is copied or destroyed, that object must handle the reference count.
@@ -27,6 +28,7 @@ public:
 	StringHandle() noexcept { slotPtr = nullptr; }
 	explicit StringHandle(const char *s) noexcept;
 	StringHandle(const char *s, size_t len) noexcept;
+	StringHandle(const OutputBuffer *buf, size_t offset, size_t len) noexcept;
 
 #if 0	// unused
 	StringHandle(const char *s1, const char *s2) noexcept;
@@ -263,6 +263,14 @@ size_t OutputBuffer::cat(StringRef &str) noexcept
 	return cat(str.c_str(), str.strlen());
 }
 
+// Append a float formatted as if by printf format "%.Nf" where N is numDigitsAfterPoint, which is much faster than calling catf
+size_t OutputBuffer::catFloat(float f, unsigned int numDigitsAfterPoint) noexcept
+{
+	char temp[FormattedFloatBufferSize];
+	const size_t len = FormatFixedFloat(temp, f, numDigitsAfterPoint);
+	return cat(temp, len);
+}
+
 // Encode a character in JSON format, and append it to the buffer and return the number of bytes written
 size_t OutputBuffer::EncodeChar(char c) noexcept
 {
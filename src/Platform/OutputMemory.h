@@ -60,6 +60,7 @@ public:
 	size_t cat(const char *_ecv_array src, size_t len) noexcept;
 	size_t lcat(const char *_ecv_array src, size_t len) noexcept;
 	size_t cat(StringRef &str) noexcept;
+	size_t catFloat(float f, unsigned int numDigitsAfterPoint) noexcept;		// append a float as if formatted by printf format "%.Nf"
 
 	size_t EncodeChar(char c) noexcept;
 	size_t EncodeReply(OutputBuffer *src) noexcept;
@@ -2371,6 +2371,10 @@ GCodeResult Platform::DiagnosticTest(GCodeBuffer& gb, const StringRef& reply, Ou
 #endif
 		break;
 
+	case (unsigned int)DiagnosticTestType::StepIsrStats:
+		reprap.GetMove().EnableStepIsrStats(!gb.Seen('S') || gb.GetUIValue() != 0);
+		break;
+
 #if HAS_VOLTAGE_MONITOR
 	case (unsigned int)DiagnosticTestType::UndervoltageEvent:
 		reprap.GetGCodes().LowVoltagePause();
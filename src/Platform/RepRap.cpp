@@ -24,6 +24,18 @@
 #include <Accelerometers/Accelerometers.h>
 #include "Version.h"
 
+#if SUPPORT_MACRO_CACHE
+# include <Storage/MacroCache.h>
+#endif
+
+#if SUPPORT_OBJECT_MODEL_CACHE
+# include <ObjectModel/ObjectModelCache.h>
+#endif
+
+#if SUPPORT_BINARY_OBJECT_MODEL
+# include <ObjectModel/JsonToCbor.h>
+#endif
+
 #ifdef DUET_NG
 # include "DueXn.h"
 #endif
@@ -341,6 +353,9 @@ constexpr ObjectModelTableEntry RepRap::objectModelTable[] =
 #endif
 	{ "logLevel",				OBJECT_MODEL_FUNC(self->platform->GetLogLevel()),						ObjectModelEntryFlags::none },
 	{ "machineMode",			OBJECT_MODEL_FUNC(self->gCodes->GetMachineModeString()),				ObjectModelEntryFlags::none },
+#if SUPPORT_MACRO_CACHE
+	{ "macroCache",				OBJECT_MODEL_FUNC(self, 7),												ObjectModelEntryFlags::live },
+#endif
 	{ "macroRestarted",			OBJECT_MODEL_FUNC(self->gCodes->GetMacroRestarted()),					ObjectModelEntryFlags::none },
 	{ "messageBox",				OBJECT_MODEL_FUNC_IF(self->mbox.active, self, 5),						ObjectModelEntryFlags::important },
 	{ "msUpTime",				OBJECT_MODEL_FUNC_NOSELF((int32_t)(context.GetStartMillis() % 1000u)),	ObjectModelEntryFlags::live },
@@ -395,11 +410,20 @@ constexpr ObjectModelTableEntry RepRap::objectModelTable[] =
 	{ "volChanges",				OBJECT_MODEL_FUNC_NOSELF(&volChangesArrayDescriptor),					ObjectModelEntryFlags::live },
 	{ "volumes",				OBJECT_MODEL_FUNC((int32_t)self->volumesSeq),							ObjectModelEntryFlags::live },
 #endif
+
+#if SUPPORT_MACRO_CACHE
+	// 7. MachineModel.state.macroCache
+	{ "files",					OBJECT_MODEL_FUNC_NOSELF((int32_t)MacroCache::GetNumFiles()),			ObjectModelEntryFlags::live },
+	{ "hits",					OBJECT_MODEL_FUNC_NOSELF((int32_t)MacroCache::GetHits()),				ObjectModelEntryFlags::live },
+	{ "misses",					OBJECT_MODEL_FUNC_NOSELF((int32_t)MacroCache::GetMisses()),				ObjectModelEntryFlags::live },
+	{ "size",					OBJECT_MODEL_FUNC_NOSELF((int32_t)MacroCache::GetBudget()),				ObjectModelEntryFlags::none },
+	{ "used",					OBJECT_MODEL_FUNC_NOSELF((int32_t)MacroCache::GetBytesUsed()),			ObjectModelEntryFlags::live },
+#endif
 };
 
 constexpr uint8_t RepRap::objectModelTableDescriptor[] =
 {
-	7,																						// number of sub-tables
+	7 + SUPPORT_MACRO_CACHE,																// number of sub-tables
 	15 + SUPPORT_SCANNER + (HAS_MASS_STORAGE | HAS_EMBEDDED_FILES | HAS_SBC_INTERFACE),		// root
 #if HAS_MASS_STORAGE || HAS_EMBEDDED_FILES || HAS_SBC_INTERFACE
 	8, 																						// directories
@@ -407,15 +431,51 @@ constexpr uint8_t RepRap::objectModelTableDescriptor[] =
 	0,																						// directories
 #endif
 	25,																						// limits
-	20 + HAS_VOLTAGE_MONITOR + SUPPORT_LASER,												// state
+	20 + HAS_VOLTAGE_MONITOR + SUPPORT_LASER + SUPPORT_MACRO_CACHE,							// state
 	2,																						// state.beep
 	6,																						// state.messageBox
 	12 + HAS_NETWORKING + SUPPORT_SCANNER +
-	2 * HAS_MASS_STORAGE + (HAS_MASS_STORAGE | HAS_EMBEDDED_FILES | HAS_SBC_INTERFACE)		// seqs
+	2 * HAS_MASS_STORAGE + (HAS_MASS_STORAGE | HAS_EMBEDDED_FILES | HAS_SBC_INTERFACE),		// seqs
+#if SUPPORT_MACRO_CACHE
+	5,																						// state.macroCache
+#endif
 };
 
 DEFINE_GET_OBJECT_MODEL_TABLE(RepRap)
 
+// Names of the root object model entries whose changes we track, in the order of enum ModelSection
+static constexpr const char *_ecv_array ModelSectionNames[] =
+{
+	"boards", "directories", "fans", "global", "heat", "inputs", "job", "move", "network", "scanner", "sensors", "spindles", "state", "tools", "volumes"
+};
+
+static_assert(ARRAY_SIZE(ModelSectionNames) == (size_t)RepRap::ModelSection::numSections, "ModelSectionNames doesn't match enum ModelSection");
+
+// Get the change sequence number of a root object model entry, returning false if we don't track changes to it
+bool RepRap::GetEntryChangeSequence(const ObjectModelTableEntry *entry, uint32_t& seq) const noexcept
+{
+	if (entry < objectModelTable || entry >= objectModelTable + objectModelTableDescriptor[1])
+	{
+		return false;															// not a root entry
+	}
+
+	if (strcmp(entry->name, "limits") == 0)
+	{
+		seq = modelChanges.InitialSeq;											// the limits never change
+		return true;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(ModelSectionNames); ++i)
+	{
+		if (strcmp(entry->name, ModelSectionNames[i]) == 0)
+		{
+			seq = modelChanges.GetSectionSeq(i);
+			return true;
+		}
+	}
+	return false;																// 'seqs' is all live data, so it is always reported
+}
+
 #endif
 
 ReadWriteLock RepRap::toolListLock;
@@ -474,6 +534,9 @@ static void CheckWatchBuffer(unsigned int module) noexcept
 void RepRap::Init() noexcept
 {
 	OutputBuffer::Init();
+#if SUPPORT_OBJECT_MODEL_CACHE
+	ObjectModelCache::Init();
+#endif
 	platform = new Platform();
 #if HAS_SBC_INTERFACE
 	sbcInterface = new SbcInterface();				// needs to be allocated early on Duet 2 so as to avoid using any of the last 64K of RAM
@@ -931,6 +994,9 @@ void RepRap::Diagnostics(MessageType mtype) noexcept
 	// Now print diagnostics for other modules
 	Tasks::Diagnostics(mtype);
 	platform->Diagnostics(mtype);				// this includes a call to our Timing() function
+#if SUPPORT_OBJECT_MODEL_CACHE
+	ObjectModelCache::Diagnostics(mtype);
+#endif
 #if HAS_MASS_STORAGE || HAS_EMBEDDED_FILES
 	MassStorage::Diagnostics(mtype);
 #endif
@@ -1950,27 +2016,33 @@ OutputBuffer *RepRap::GetLegacyStatusResponse(uint8_t type, int seq) const noexc
 	// Send the heater actual temperatures. If there is no bed heater, send zero for PanelDue.
 	const int8_t bedHeater = (MaxBedHeaters > 0) ? heat->GetBedHeater(0) : -1;
 	ch = ',';
-	response->catf("[%.1f", (double)((bedHeater == -1) ? 0.0 : heat->GetHeaterTemperature(bedHeater)));
+	response->cat('[');
+	response->catFloat((bedHeater == -1) ? 0.0f : heat->GetHeaterTemperature(bedHeater), 1);
 	for (size_t heater = DefaultE0Heater; heater < GetToolHeatersInUse(); heater++)
 	{
-		response->catf("%c%.1f", ch, (double)(heat->GetHeaterTemperature(heater)));
+		response->cat(ch);
+		response->catFloat(heat->GetHeaterTemperature(heater), 1);
 		ch = ',';
 	}
 	response->cat((ch == '[') ? "[]" : "]");
 
 	// Send the heater active temperatures
-	response->catf(",\"active\":[%.1f", (double)((bedHeater == -1) ? 0.0 : heat->GetActiveTemperature(bedHeater)));
+	response->cat(",\"active\":[");
+	response->catFloat((bedHeater == -1) ? 0.0f : heat->GetActiveTemperature(bedHeater), 1);
 	for (size_t heater = DefaultE0Heater; heater < GetToolHeatersInUse(); heater++)
 	{
-		response->catf(",%.1f", (double)(heat->GetActiveTemperature(heater)));
+		response->cat(',');
+		response->catFloat(heat->GetActiveTemperature(heater), 1);
 	}
 	response->cat(']');
 
 	// Send the heater standby temperatures
-	response->catf(",\"standby\":[%.1f", (double)((bedHeater == -1) ? 0.0 : heat->GetStandbyTemperature(bedHeater)));
+	response->cat(",\"standby\":[");
+	response->catFloat((bedHeater == -1) ? 0.0f : heat->GetStandbyTemperature(bedHeater), 1);
 	for (size_t heater = DefaultE0Heater; heater < GetToolHeatersInUse(); heater++)
 	{
-		response->catf(",%.1f", (double)(heat->GetStandbyTemperature(heater)));
+		response->cat(',');
+		response->catFloat(heat->GetStandbyTemperature(heater), 1);
 	}
 	response->cat(']');
 
@@ -2493,7 +2565,7 @@ void RepRap::AppendFloatArray(OutputBuffer *buf, const char *name, size_t numVal
 			buf->cat(',');
 		}
 		const float fVal = HideNan(func(i));
-		buf->catf(GetFloatFormatString(fVal, numDecimalDigits), (double)fVal);
+		buf->catFloat(fVal, GetFloatDigitsAfterPoint(fVal, numDecimalDigits));
 	}
 	buf->cat(']');
 }
@@ -2538,6 +2610,7 @@ void RepRap::AppendStringArray(OutputBuffer *buf, const char *name, size_t numVa
 
 // Return a query into the object model, or return nullptr if no buffer available
 // We append a newline to help PanelDue resync after receiving corrupt or incomplete data. DWC ignores it.
+// If the flags include 'b' and the request didn't come from a G-code channel then we convert the response to CBOR and there is no newline.
 OutputBuffer *RepRap::GetModelResponse(const GCodeBuffer *_ecv_null gb, const char *key, const char *flags) const THROWS(GCodeException)
 {
 	OutputBuffer *outBuf;
@@ -2554,11 +2627,32 @@ OutputBuffer *RepRap::GetModelResponse(const GCodeBuffer *_ecv_null gb, const ch
 			++key;
 		}
 
+		// If the client wants only the changes since its last report, get the sequence number to give it for next time before we generate the report
+		const bool changesOnly = (strchr(flags, 'u') != nullptr);
+		const uint32_t changeSeq = modelChanges.GetToken();
+
 		try
 		{
 			reprap.ReportAsJson(gb, outBuf, key, flags, wantArrayLength);
-			outBuf->cat("}\n");
-			if (outBuf->HadOverflow())
+			if (changesOnly)
+			{
+				outBuf->catf(",\"seq\":%" PRIu32, changeSeq);
+			}
+			outBuf->cat('}');
+#if SUPPORT_BINARY_OBJECT_MODEL
+			if (gb == nullptr && strchr(flags, 'b') != nullptr)
+			{
+				if (!outBuf->HadOverflow())
+				{
+					outBuf = JsonToCbor::Convert(outBuf);		// this returns nullptr if it runs out of buffers
+				}
+			}
+			else
+#endif
+			{
+				outBuf->cat('\n');
+			}
+			if (outBuf != nullptr && outBuf->HadOverflow())
 			{
 				OutputBuffer::ReleaseAll(outBuf);
 			}
@@ -26,6 +26,7 @@ Licence: GPL
 #include <RTOSIface/RTOSIface.h>
 #include <General/function_ref.h>
 #include <ObjectModel/GlobalVariables.h>
+#include <ObjectModel/ModelChangeTracker.h>
 
 #if SUPPORT_CAN_EXPANSION
 # include <CAN/ExpansionManager.h>
@@ -184,21 +185,24 @@ public:
 
 	void KickHeatTaskWatchdog() noexcept { heatTaskIdleTicks = 0; }
 
-	void BoardsUpdated() noexcept { ++boardsSeq; }
-	void DirectoriesUpdated() noexcept { ++directoriesSeq; }
-	void FansUpdated() noexcept { ++fansSeq; }
-	void GlobalUpdated() noexcept { ++globalSeq; }
-	void HeatUpdated() noexcept { ++heatSeq; }
-	void InputsUpdated() noexcept { ++inputsSeq; }
-	void JobUpdated() noexcept { ++jobSeq; }
-	void MoveUpdated() noexcept { ++moveSeq; }
-	void NetworkUpdated() noexcept { ++networkSeq; }
-	void ScannerUpdated() noexcept { ++scannerSeq; }
-	void SensorsUpdated() noexcept { ++sensorsSeq; }
-	void SpindlesUpdated() noexcept { ++spindlesSeq; }
-	void StateUpdated() noexcept { ++stateSeq; }
-	void ToolsUpdated() noexcept { ++toolsSeq; }
-	void VolumesUpdated() noexcept { ++volumesSeq; }
+	// Top-level sections of the object model whose changes we track, so that we can report only the sections that have changed since a client last asked
+	enum class ModelSection : uint8_t { boards = 0, directories, fans, global, heat, inputs, job, move, network, scanner, sensors, spindles, state, tools, volumes, numSections };
+
+	void BoardsUpdated() noexcept { ++boardsSeq; SectionChanged(ModelSection::boards); }
+	void DirectoriesUpdated() noexcept { ++directoriesSeq; SectionChanged(ModelSection::directories); }
+	void FansUpdated() noexcept { ++fansSeq; SectionChanged(ModelSection::fans); }
+	void GlobalUpdated() noexcept { ++globalSeq; SectionChanged(ModelSection::global); }
+	void HeatUpdated() noexcept { ++heatSeq; SectionChanged(ModelSection::heat); }
+	void InputsUpdated() noexcept { ++inputsSeq; SectionChanged(ModelSection::inputs); }
+	void JobUpdated() noexcept { ++jobSeq; SectionChanged(ModelSection::job); }
+	void MoveUpdated() noexcept { ++moveSeq; SectionChanged(ModelSection::move); }
+	void NetworkUpdated() noexcept { ++networkSeq; SectionChanged(ModelSection::network); }
+	void ScannerUpdated() noexcept { ++scannerSeq; SectionChanged(ModelSection::scanner); }
+	void SensorsUpdated() noexcept { ++sensorsSeq; SectionChanged(ModelSection::sensors); }
+	void SpindlesUpdated() noexcept { ++spindlesSeq; SectionChanged(ModelSection::spindles); }
+	void StateUpdated() noexcept { ++stateSeq; SectionChanged(ModelSection::state); }
+	void ToolsUpdated() noexcept { ++toolsSeq; SectionChanged(ModelSection::tools); }
+	void VolumesUpdated() noexcept { ++volumesSeq; SectionChanged(ModelSection::volumes); }
 
 	ReadLockedPointer<const VariableSet> GetGlobalVariablesForReading() noexcept { return globalVariables.GetForReading(); }
 	WriteLockedPointer<VariableSet> GetGlobalVariablesForWriting() noexcept { return globalVariables.GetForWriting(); }
@@ -215,6 +219,11 @@ protected:
 	OBJECT_MODEL_ARRAY(volumes)
 	OBJECT_MODEL_ARRAY(volChanges)
 
+#if SUPPORT_OBJECT_MODEL
+	bool GetEntryChangeSequence(const ObjectModelTableEntry *entry, uint32_t& seq) const noexcept override;
+	bool ChangedSinceToken(uint32_t changeSeq, uint32_t token) const noexcept override { return modelChanges.ChangedSinceToken(changeSeq, token); }
+#endif
+
 private:
 	static void EncodeString(StringRef& response, const char* src, size_t spaceToLeave, bool allowControlChars = false, char prefix = 0) noexcept;
 	static void AppendFloatArray(OutputBuffer *buf, const char *name, size_t numValues, function_ref<float(size_t)> func, unsigned int numDecimalDigits) noexcept;
@@ -226,6 +235,7 @@ private:
 	const char* GetStatusString() const noexcept;
 	void ReportToolTemperatures(const StringRef& reply, const Tool *tool, bool includeNumber) const noexcept;
 	bool RunStartupFile(const char *filename) noexcept;
+	void SectionChanged(ModelSection section) noexcept { modelChanges.SectionChanged((size_t)section); }
 
 	static constexpr uint32_t MaxTicksInSpinState = 20000;	// timeout before we reset the processor
 	static constexpr uint32_t HighTicksInSpinState = 16000;	// how long before we warn that timeout is approaching
@@ -266,6 +276,8 @@ private:
 	uint16_t boardsSeq, directoriesSeq, fansSeq, heatSeq, inputsSeq, jobSeq, moveSeq, globalSeq;
 	uint16_t networkSeq, scannerSeq, sensorsSeq, spindlesSeq, stateSeq, toolsSeq, volumesSeq;
 
+	ModelChangeTracker<(size_t)ModelSection::numSections> modelChanges;		// change sequence numbers used for delta reports
+
 	GlobalVariables globalVariables;
 
 	Tool* toolList;								// the tool list is sorted in order of increasing tool number
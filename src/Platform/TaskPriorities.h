@@ -16,6 +16,9 @@ namespace TaskPriority
 #if HAS_SBC_INTERFACE
 	constexpr unsigned int SbcPriority = 2;							// priority for SBC task
 #endif
+#if SUPPORT_FILE_READ_AHEAD
+	constexpr unsigned int FileReadAheadPriority = 2;				// priority for the task that reads job files ahead of the parser
+#endif
 #if defined(LPC_NETWORKING)
     constexpr int TcpPriority  = 2;
     //EMAC priority = 3 defined in FreeRTOSIPConfig.h
@@ -174,6 +174,17 @@ bool PrintMonitor::GetPrintingFileInfo(GCodeFileInfo& info) noexcept
 	return true;
 }
 
+#if SUPPORT_BINARY_GCODE
+
+// Return the format of the file being printed if we have read its header, else unknown
+GCodeFileFormat PrintMonitor::GetPrintingFileFormat() const noexcept
+{
+	ReadLocker locker(printMonitorLock);
+	return (printingFileParsed) ? printingFileInfo.gcodeFileFormat : GCodeFileFormat::unknown;
+}
+
+#endif
+
 void PrintMonitor::SetPrintingFileInfo(const char *filename, GCodeFileInfo &info) noexcept
 {
 	{
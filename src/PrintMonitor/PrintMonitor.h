@@ -60,6 +60,9 @@ public:
 	const char *GetPrintingFilename() const noexcept { return (isPrinting) ? filenameBeingPrinted.c_str() : nullptr; }
 	bool GetPrintingFileInfo(GCodeFileInfo& info) noexcept;
 	void SetPrintingFileInfo(const char *filename, GCodeFileInfo& info) noexcept;
+#if SUPPORT_BINARY_GCODE
+	GCodeFileFormat GetPrintingFileFormat() const noexcept;	// Return the format of the file being printed if we have read its header, else unknown
+#endif
 
 	GCodeResult ProcessM73(GCodeBuffer& gb, const StringRef& reply) THROWS(GCodeException);
 	void SetSlicerTimeLeft(float seconds) noexcept;
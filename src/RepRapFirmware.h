@@ -135,6 +135,7 @@ namespace CanInterface
 #include <General/Bitmap.h>
 #include <General/SafeStrtod.h>
 #include <General/SafeVsnprintf.h>
+#include <Platform/FloatConversion.h>
 #include <RRF3Common.h>
 
 #define THROWS(...)				// expands to nothing, for providing exception specifications
@@ -543,8 +544,7 @@ static inline constexpr float InverseConvertAcceleration(float accel) noexcept
 	return accel * (float)StepClockRateSquared;
 }
 
-constexpr unsigned int MaxFloatDigitsDisplayedAfterPoint = 7;
-const char *_ecv_array GetFloatFormatString(float val, unsigned int numDigitsAfterPoint) noexcept;
+unsigned int GetFloatDigitsAfterPoint(float val, unsigned int numDigitsAfterPoint) noexcept;	// see also FormatFixedFloat in Platform/FloatConversion.h
 
 #if SUPPORT_WORKPLACE_COORDINATES
 constexpr size_t NumCoordinateSystems = 9;							// G54 up to G59.3
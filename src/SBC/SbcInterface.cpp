@@ -1424,6 +1424,7 @@ FileHandle SbcInterface::OpenFile(const char *filename, OpenMode mode, FilePosit
 	switch (mode)
 	{
 	case OpenMode::read:
+	case OpenMode::readCached:
 		fileOperation = FileOperation::openRead;
 		break;
 
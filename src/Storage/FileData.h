@@ -140,6 +140,20 @@ public:
 		return not_null(f)->Length();
 	}
 
+# if SUPPORT_BINARY_GCODE
+	GCodeFileFormat GetGCodeFileFormat() const noexcept
+	pre(IsLive())
+	{
+		return not_null(f)->GetGCodeFileFormat();
+	}
+
+	void SetGCodeFileFormat(GCodeFileFormat fmt) noexcept
+	pre(IsLive())
+	{
+		not_null(f)->SetGCodeFileFormat(fmt);
+	}
+# endif
+
 	// Move operator
 	void MoveFrom(FileData& other) noexcept
 	{
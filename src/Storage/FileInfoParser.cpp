@@ -12,6 +12,10 @@
 #include <PrintMonitor/PrintMonitor.h>
 #include <GCodes/GCodes.h>
 
+#if SUPPORT_BINARY_GCODE
+# include <GCodes/BinaryGCodeBlock.h>
+#endif
+
 #if HAS_MASS_STORAGE || HAS_EMBEDDED_FILES
 
 FileInfoParser::FileInfoParser() noexcept
@@ -138,6 +142,14 @@ GCodeResult FileInfoParser::GetFileInfo(const char *filePath, GCodeFileInfo& inf
 				}
 				buf[sizeToScan] = 0;
 
+#if SUPPORT_BINARY_GCODE
+				// Record the format of the file, so that we don't need to read the header again when we print it
+				if (bufferStartFileOffset == 0)
+				{
+					parsedFileInfo.gcodeFileFormat = (BinaryGCode::IsHeader(buf, sizeToScan)) ? GCodeFileFormat::binary : GCodeFileFormat::text;
+				}
+#endif
+
 				// Record performance data
 				uint32_t now = millis();
 				accumulatedReadTime += now - startTime;
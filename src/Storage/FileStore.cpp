@@ -18,6 +18,10 @@
 # include <Movement/StepTimer.h>
 #endif
 
+#if SUPPORT_MACRO_CACHE
+# include "MacroCache.h"
+#endif
+
 #if HAS_SBC_INTERFACE
 # include <SBC/SbcInterface.h>
 #endif
@@ -47,6 +51,13 @@ void FileStore::Init() noexcept
 #if HAS_EMBEDDED_FILES || HAS_SBC_INTERFACE
 	offset = 0;
 #endif
+#if SUPPORT_MACRO_CACHE
+	cachedMacro = nullptr;
+	cachedOffset = 0;
+#endif
+#if SUPPORT_BINARY_GCODE
+	gcodeFileFormat = GCodeFileFormat::unknown;
+#endif
 }
 
 // Open a local file (for example on an SD card).
@@ -54,6 +65,9 @@ void FileStore::Init() noexcept
 bool FileStore::Open(const char *_ecv_array filePath, OpenMode mode, uint32_t preAllocSize) noexcept
 {
 	const bool writing = (mode == OpenMode::write || mode == OpenMode::writeWithCrc || mode == OpenMode::append);
+#if SUPPORT_BINARY_GCODE
+	gcodeFileFormat = GCodeFileFormat::text;				// only the file being printed may be binary G-code, see GCodes::QueueFileToPrint
+#endif
 #if HAS_EMBEDDED_FILES
 # if HAS_SBC_INTERFACE
 	if (!reprap.UsingSbcInterface())
@@ -84,6 +98,17 @@ bool FileStore::Open(const char *_ecv_array filePath, OpenMode mode, uint32_t pr
 #if HAS_MASS_STORAGE || HAS_SBC_INTERFACE
 	writeBuffer = nullptr;
 
+# if SUPPORT_MACRO_CACHE
+	if (mode == OpenMode::readCached
+#  if HAS_SBC_INTERFACE
+		&& !reprap.UsingSbcInterface()
+#  endif
+	   )
+	{
+		return OpenCached(filePath);
+	}
+# endif
+
 	// Try to allocate a write buffer
 	if (writing)
 	{
@@ -180,6 +205,52 @@ bool FileStore::Open(const char *_ecv_array filePath, OpenMode mode, uint32_t pr
 #endif
 }
 
+#if SUPPORT_MACRO_CACHE
+
+// Open a macro file for reading from the macro cache, loading it into the cache if necessary.
+// If the file is too large to cache then we read it from the file system as usual.
+bool FileStore::OpenCached(const char *_ecv_array filePath) noexcept
+{
+	cachedMacro = MacroCache::Find(filePath);
+	if (cachedMacro == nullptr)
+	{
+		const FRESULT openReturn = f_open(&file, filePath, FA_OPEN_EXISTING | FA_READ);
+		if (openReturn != FR_OK)
+		{
+			if (reprap.Debug(moduleStorage))
+			{
+				reprap.GetPlatform().MessageF(WarningMessage, "Failed to open %s to read, error code %d\n", filePath, (int)openReturn);
+			}
+			return false;
+		}
+
+		cachedMacro = MacroCache::Load(filePath, file);
+		if (cachedMacro == nullptr)
+		{
+			// Read the file in the usual way
+			if (f_lseek(&file, 0) != FR_OK)
+			{
+				(void)f_close(&file);
+				return false;
+			}
+			calcCrc = false;
+			usageMode = FileUseMode::readOnly;
+			openCount = 1;
+			reprap.VolumesUpdated();
+			return true;
+		}
+		(void)f_close(&file);
+	}
+
+	cachedOffset = 0;
+	calcCrc = false;
+	usageMode = FileUseMode::readOnly;
+	openCount = 1;
+	return true;
+}
+
+#endif
+
 #if HAS_MASS_STORAGE || HAS_SBC_INTERFACE || HAS_EMBEDDED_FILES
 
 // This may be called from an ISR, in which case we need to defer the close
@@ -256,6 +327,13 @@ bool FileStore::Seek(FilePosition pos) noexcept
 			return false;
 		}
 #endif
+#if SUPPORT_MACRO_CACHE
+		if (cachedMacro != nullptr)
+		{
+			cachedOffset = min<FilePosition>(pos, cachedMacro->GetLength());
+			return true;
+		}
+#endif
 #if HAS_MASS_STORAGE
 		return f_lseek(&file, pos) == FR_OK;
 #elif HAS_EMBEDDED_FILES
@@ -279,6 +357,12 @@ FilePosition FileStore::Position() const noexcept
 		return offset;
 	}
 #endif
+#if SUPPORT_MACRO_CACHE
+	if (cachedMacro != nullptr)
+	{
+		return cachedOffset;
+	}
+#endif
 #if HAS_MASS_STORAGE
 	return (usageMode == FileUseMode::readOnly || usageMode == FileUseMode::readWrite) ? file.fptr : 0;
 #elif HAS_EMBEDDED_FILES
@@ -303,6 +387,12 @@ FilePosition FileStore::Length() const noexcept
 			return length;
 		}
 #endif
+#if SUPPORT_MACRO_CACHE
+		if (cachedMacro != nullptr)
+		{
+			return cachedMacro->GetLength();
+		}
+#endif
 #if HAS_MASS_STORAGE
 		return f_size(&file);
 #elif HAS_EMBEDDED_FILES
@@ -394,6 +484,15 @@ int FileStore::Read(char *_ecv_array extBuf, size_t nBytes) noexcept
 			return bytesRead;
 		}
 #endif
+#if SUPPORT_MACRO_CACHE
+		if (cachedMacro != nullptr)
+		{
+			const size_t bytesRead = min<size_t>(nBytes, cachedMacro->GetLength() - cachedOffset);
+			memcpy(extBuf, cachedMacro->GetData() + cachedOffset, bytesRead);
+			cachedOffset += bytesRead;
+			return (int)bytesRead;
+		}
+#endif
 #if HAS_MASS_STORAGE
 		{
 			UINT bytes_read;
@@ -461,11 +560,26 @@ int FileStore::ReadLine(char *_ecv_array buf, size_t nBytes) noexcept
 
 bool FileStore::ForceClose() noexcept
 {
+#if SUPPORT_MACRO_CACHE
+	if (cachedMacro != nullptr)
+	{
+		MacroCache::Release(cachedMacro);
+		cachedMacro = nullptr;
+		usageMode = FileUseMode::free;
+		closeRequested = false;
+		openCount = 0;
+		return true;
+	}
+#endif
+
 #if HAS_MASS_STORAGE || HAS_SBC_INTERFACE
 	bool ok = true;
 	if (usageMode == FileUseMode::readWrite)
 	{
 		ok = Flush();
+# if SUPPORT_MACRO_CACHE
+		MacroCache::InvalidateAll();		// the file we wrote may be in the cache
+# endif
 	}
 
 	if (writeBuffer != nullptr)
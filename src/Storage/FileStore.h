@@ -13,6 +13,7 @@
 
 class Platform;
 class FileWriteBuffer;
+struct CachedMacro;
 
 #if HAS_EMBEDDED_FILES
 typedef int32_t FileIndex;
@@ -23,11 +24,23 @@ typedef int32_t FileIndex;
 enum class OpenMode : uint8_t
 {
 	read,			// open an existing file for reading
+	readCached,		// open an existing file for reading, using the macro cache if it is enabled
 	write,			// write a file, replacing any existing file of the same name
 	writeWithCrc,	// as write but calculate the CRC as we go
 	append			// append to an existing file, or create a new file if it is not found
 };
 
+#if SUPPORT_BINARY_GCODE
+
+enum class GCodeFileFormat : uint8_t
+{
+	unknown,		// we haven't checked the format yet
+	text,			// an ordinary G-code file
+	binary			// a binary G-code file, see class BinaryGCodeDecoder
+};
+
+#endif
+
 enum class FileUseMode : uint8_t
 {
 	free,			// file object is free
@@ -59,6 +72,11 @@ public:
 	FilePosition Position() const noexcept;						// Return the current position in the file, assuming we are reading the file
 	void Duplicate() noexcept;									// Create a second reference to this file
 
+#if SUPPORT_BINARY_GCODE
+	GCodeFileFormat GetGCodeFileFormat() const noexcept { return gcodeFileFormat; }
+	void SetGCodeFileFormat(GCodeFileFormat fmt) noexcept { gcodeFileFormat = fmt; }
+#endif
+
 #if HAS_MASS_STORAGE || HAS_SBC_INTERFACE
 	FileWriteBuffer *GetWriteBuffer() const noexcept;			// Return a pointer to the remaining space for writing
 	bool Write(char b) noexcept;								// Write 1 byte
@@ -91,6 +109,9 @@ public:
 private:
 	void Init() noexcept;
 	bool Store(const char *_ecv_array s, size_t len, size_t *bytesWritten) noexcept;	// Write data to the non-volatile storage
+#if SUPPORT_MACRO_CACHE
+	bool OpenCached(const char *_ecv_array filePath) noexcept;
+#endif
 
 	volatile unsigned int openCount;
 
@@ -117,9 +138,18 @@ private:
 	FilePosition offset;
 #endif
 
+#if SUPPORT_MACRO_CACHE
+	CachedMacro *cachedMacro;				// if this is not null then we are reading the file from the macro cache
+	FilePosition cachedOffset;
+#endif
+
 	volatile bool closeRequested;
 	FileUseMode usageMode;
 
+#if SUPPORT_BINARY_GCODE
+	GCodeFileFormat gcodeFileFormat;		// the format of the file, unknown for the file being printed until a FileGCodeInput has checked it
+#endif
+
 #if HAS_MASS_STORAGE || HAS_SBC_INTERFACE
 	bool calcCrc;
 #endif
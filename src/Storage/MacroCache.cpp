@@ -0,0 +1,197 @@
+/*
+ * MacroCache.cpp
+ *
+ *  Created on: 16 Oct 2026
+ */
+
+#include "MacroCache.h"
+
+#if SUPPORT_MACRO_CACHE
+
+#include <GCodes/GCodeBuffer/GCodeBuffer.h>
+#include <Platform/RepRap.h>
+#include <RTOSIface/RTOSIface.h>
+
+// Private data
+static Mutex cacheMutex;
+static CachedMacro *cachedFiles = nullptr;				// list of cached files, in no particular order
+static size_t budget = DefaultMacroCacheSize;
+static size_t bytesUsed = 0;							// includes bytes reserved for files that are being loaded
+static unsigned int numFiles = 0;
+static uint32_t useCounter = 0;
+static uint32_t numHits = 0, numMisses = 0;
+static uint32_t generation = 0;							// incremented by InvalidateAll, so that Load can tell whether the file may have changed while it was reading it
+
+// Free a cache entry that is no longer in the list and no longer in use
+static void DeleteEntry(CachedMacro *cm) noexcept
+{
+	delete[] cm->storage;
+	delete cm;
+}
+
+// Unlink a cache entry from the list. The cache mutex must be owned by the caller.
+static void RemoveEntry(CachedMacro **pp) noexcept
+{
+	CachedMacro * const cm = *pp;
+	*pp = cm->next;
+	bytesUsed -= cm->GetSize();
+	--numFiles;
+	if (cm->refCount == 0)
+	{
+		DeleteEntry(cm);
+	}
+	else
+	{
+		cm->isValid = false;							// it will be deleted when it is released
+	}
+}
+
+// Remove least recently used files that are not in use until there is room for 'size' more bytes, returning true if successful.
+// The cache mutex must be owned by the caller.
+static bool MakeRoom(size_t size) noexcept
+{
+	while (bytesUsed + size > budget)
+	{
+		CachedMacro **oldest = nullptr;
+		for (CachedMacro **pp = &cachedFiles; *pp != nullptr; pp = &(*pp)->next)
+		{
+			if ((*pp)->refCount == 0 && (oldest == nullptr || (int32_t)((*pp)->lastUsed - (*oldest)->lastUsed) < 0))
+			{
+				oldest = pp;
+			}
+		}
+		if (oldest == nullptr)
+		{
+			return false;
+		}
+		RemoveEntry(oldest);
+	}
+	return true;
+}
+
+void MacroCache::Init() noexcept
+{
+	cacheMutex.Create("MacroCache");
+}
+
+// Find a file in the cache. If found, increment its reference count and return it.
+CachedMacro *MacroCache::Find(const char *filePath) noexcept
+{
+	MutexLocker lock(cacheMutex);
+	for (CachedMacro *cm = cachedFiles; cm != nullptr; cm = cm->next)
+	{
+		if (strcmp(cm->GetPath(), filePath) == 0)
+		{
+			++cm->refCount;
+			cm->lastUsed = ++useCounter;
+			++numHits;
+			return cm;
+		}
+	}
+	++numMisses;
+	return nullptr;
+}
+
+// Read a file that has just been opened into the cache, returning the cache entry with a reference count of 1.
+// Return nullptr if the file doesn't fit in the cache, we failed to read it, or the cache was invalidated while we were reading it.
+// In those cases the file pointer may have been moved.
+CachedMacro *MacroCache::Load(const char *filePath, FIL& file) noexcept
+{
+	const FilePosition length = f_size(&file);
+	const size_t pathLength = strlen(filePath);
+	const size_t size = pathLength + 1 + length;
+
+	// Reserve the space first. We mustn't hold the cache mutex while we read the file, because InvalidateAll may be called by a task that owns the volume mutex.
+	uint32_t loadGeneration;
+	{
+		MutexLocker lock(cacheMutex);
+		if (size > budget || !MakeRoom(size))
+		{
+			return nullptr;
+		}
+		bytesUsed += size;
+		loadGeneration = generation;
+	}
+
+	CachedMacro * const cm = new CachedMacro;
+	cm->storage = new char[size];
+	cm->pathLength = pathLength;
+	cm->length = length;
+	memcpy(cm->storage, filePath, pathLength + 1);
+
+	UINT bytesRead;
+	if (f_read(&file, cm->storage + pathLength + 1, length, &bytesRead) != FR_OK || bytesRead != length)
+	{
+		DeleteEntry(cm);
+		MutexLocker lock(cacheMutex);
+		bytesUsed -= size;
+		return nullptr;
+	}
+
+	MutexLocker lock(cacheMutex);
+	if (generation != loadGeneration)
+	{
+		// The file may have been written, deleted or renamed while we were reading it, so don't cache what we read
+		bytesUsed -= size;
+		DeleteEntry(cm);
+		return nullptr;
+	}
+	cm->refCount = 1;
+	cm->lastUsed = ++useCounter;
+	cm->isValid = true;
+	cm->next = cachedFiles;
+	cachedFiles = cm;
+	++numFiles;
+	return cm;
+}
+
+// Release a cache entry that was returned by Find or Load
+void MacroCache::Release(CachedMacro *cm) noexcept
+{
+	MutexLocker lock(cacheMutex);
+	--cm->refCount;
+	if (cm->refCount == 0 && !cm->isValid)
+	{
+		DeleteEntry(cm);
+	}
+}
+
+// Remove all files from the cache. Files that are in use remain readable until they are closed.
+void MacroCache::InvalidateAll() noexcept
+{
+	MutexLocker lock(cacheMutex);
+	++generation;
+	while (cachedFiles != nullptr)
+	{
+		RemoveEntry(&cachedFiles);
+	}
+}
+
+// Process M34. S parameter sets the size of the cache in bytes, S0 disables it.
+GCodeResult MacroCache::Configure(GCodeBuffer& gb, const StringRef& reply) THROWS(GCodeException)
+{
+	if (gb.Seen('S'))
+	{
+		const size_t newBudget = gb.GetUIValue();
+		MutexLocker lock(cacheMutex);
+		budget = newBudget;
+		(void)MakeRoom(0);
+		reprap.StateUpdated();
+	}
+	else
+	{
+		reply.printf("Macro cache size %u bytes, %u files using %u bytes, %" PRIu32 " hits, %" PRIu32 " misses",
+						budget, numFiles, bytesUsed, numHits, numMisses);
+	}
+	return GCodeResult::ok;
+}
+
+size_t MacroCache::GetBudget() noexcept { return budget; }
+size_t MacroCache::GetBytesUsed() noexcept { return bytesUsed; }
+unsigned int MacroCache::GetNumFiles() noexcept { return numFiles; }
+uint32_t MacroCache::GetHits() noexcept { return numHits; }
+uint32_t MacroCache::GetMisses() noexcept { return numMisses; }
+
+#endif
+
+// End
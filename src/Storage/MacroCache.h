@@ -0,0 +1,56 @@
+/*
+ * MacroCache.h
+ *
+ *  Created on: 16 Oct 2026
+ *
+ *  The macro cache holds the contents of recently-used macro files in RAM, so that frequently-run macros such as tool change and homing files
+ *  don't have to be read from the SD card each time. Files opened in OpenMode::readCached are served from the cache.
+ *  The cache is cleared whenever a file is written, deleted or renamed, or a volume is unmounted.
+ */
+
+#ifndef SRC_STORAGE_MACROCACHE_H_
+#define SRC_STORAGE_MACROCACHE_H_
+
+#include <RepRapFirmware.h>
+
+#if SUPPORT_MACRO_CACHE
+
+#include <Libraries/Fatfs/ff.h>
+#include <GCodes/GCodeException.h>
+
+// An entry in the macro cache. The storage holds the path, a null terminator and then the file contents.
+struct CachedMacro
+{
+	CachedMacro *next;
+	char *storage;
+	size_t pathLength;
+	FilePosition length;
+	uint32_t lastUsed;
+	unsigned int refCount;
+	bool isValid;							// false if this entry has been removed from the cache but is still in use
+
+	const char *GetPath() const noexcept { return storage; }
+	const char *GetData() const noexcept { return storage + pathLength + 1; }
+	FilePosition GetLength() const noexcept { return length; }
+	size_t GetSize() const noexcept { return pathLength + 1 + length; }
+};
+
+namespace MacroCache
+{
+	void Init() noexcept;
+	CachedMacro *Find(const char *filePath) noexcept;					// find a file in the cache and increment its reference count
+	CachedMacro *Load(const char *filePath, FIL& file) noexcept;			// read an open file into the cache and return it with a reference count of 1, or nullptr if it won't fit
+	void Release(CachedMacro *cm) noexcept;								// decrement the reference count
+	void InvalidateAll() noexcept;										// remove all files from the cache
+	GCodeResult Configure(GCodeBuffer& gb, const StringRef& reply) THROWS(GCodeException);	// process M34
+
+	size_t GetBudget() noexcept;
+	size_t GetBytesUsed() noexcept;
+	unsigned int GetNumFiles() noexcept;
+	uint32_t GetHits() noexcept;
+	uint32_t GetMisses() noexcept;
+}
+
+#endif
+
+#endif /* SRC_STORAGE_MACROCACHE_H_ */
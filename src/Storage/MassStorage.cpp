@@ -23,6 +23,10 @@ static_assert(SD_MMC_MEM_CNT == NumSdCards);
 # include <GCodes/GCodeBuffer/GCodeBuffer.h>
 #endif
 
+#if SUPPORT_MACRO_CACHE
+# include "MacroCache.h"
+#endif
+
 // A note on using mutexes:
 // Each SD card volume has its own mutex. There is also one for the file table, and one for the find first/find next buffer.
 // The FatFS subsystem locks and releases the appropriate volume mutex when it is called.
@@ -243,6 +247,9 @@ static bool VolumeUpdated(const char *path) noexcept
 		if (volume < ARRAY_SIZE(info))
 		{
 			++info[volume].seq;
+# if SUPPORT_MACRO_CACHE
+			MacroCache::InvalidateAll();
+# endif
 			return true;
 		}
 	}
@@ -256,6 +263,9 @@ static unsigned int InternalUnmount(size_t card, bool doClose) noexcept
 	MutexLocker lock1(fsMutex);
 	MutexLocker lock2(inf.volMutex);
 	const unsigned int invalidated = MassStorage::InvalidateFiles(&inf.fileSystem, doClose);
+# if SUPPORT_MACRO_CACHE
+	MacroCache::InvalidateAll();
+# endif
 	const char path[3] = { (char)('0' + card), ':', 0 };
 	f_mount(nullptr, path, 0);
 	inf.Clear(card);
@@ -330,6 +340,9 @@ static const char* TranslateCardError(sd_mmc_err_t err) noexcept
 void MassStorage::Init() noexcept
 {
 	fsMutex.Create("FileSystem");
+# if SUPPORT_MACRO_CACHE
+	MacroCache::Init();
+# endif
 
 #if HAS_MASS_STORAGE || HAS_EMBEDDED_FILES
 	dirMutex.Create("DirSearch");